@@ -0,0 +1,291 @@
+// CSCIUtils microbenchmark cases implementation file.
+
+#include "BenchCases.h"
+
+namespace csci
+{
+namespace bench
+{
+
+// Results are stored here so the compiler can't drop the work.
+
+static volatile uint32_t Sink;
+static volatile double   DoubleSink;
+
+/************************** TEST DATA ******************************/
+
+// Color ratios (clear, red, green, blue) for each tape color and
+// one unknown color, so getTapeColor() takes every path.
+
+static const double Ratios[8][4] =
+{
+  { 1.00, 0.333, 0.333, 0.333 },    // White
+  { 0.05, 0.333, 0.333, 0.333 },    // Black
+  { 0.40, 0.333, 0.333, 0.333 },    // Gray
+  { 0.20, 0.600, 0.200, 0.200 },    // Red
+  { 0.20, 0.200, 0.400, 0.400 },    // Green
+  { 0.20, 0.150, 0.300, 0.550 },    // Blue
+  { 0.80, 0.450, 0.420, 0.130 },    // Yellow
+  { 0.20, 0.100, 0.800, 0.100 }     // Unknown
+};
+
+// Raw TCS34725 readings (r, g, b, c).
+
+static const uint16_t RawReadings[4][4] =
+{
+  { 1000, 1000, 1000, 3000 },       // White
+  {  450,   75,   75,  600 },       // Red
+  {   90,  180,  330,  600 },       // Blue
+  {  400,  400,  400, 1200 }        // Gray
+};
+
+// Movements, so adjustDistance() takes every path.
+
+static const MoveState Moves[8] =
+{
+  MoveState::msForward, MoveState::msReverse, MoveState::msLeft,
+  MoveState::msRight, MoveState::msDiagFL, MoveState::msDiagRR,
+  MoveState::msRotateCW, MoveState::msRotateCCW
+};
+
+/************************* BENCH OBJECTS ***************************/
+
+// adjustDistance() is protected; expose it for timing.
+
+class BenchDriveTrain : public TMDriveTrain
+{
+  public:
+  BenchDriveTrain(PRIZM& prizm, EXPANSION& exc)
+    : TMDriveTrain(prizm, exc, 36.0 / 35.5, 36.0 / 32.75, 36.0 / 34.0, 360.0 / 355.0)
+  { }
+
+  using StaticTMDriveTrain::adjustDistance;
+};
+
+static PRIZM               Prizm;
+static EXPANSION           Exc;
+static BenchDriveTrain     Drive(Prizm, Exc);
+static DriveTrain&         VirtualDrive = Drive;
+static StaticTMDriveTrain  StaticDrive(Prizm, Exc, 36.0 / 35.5, 36.0 / 32.75,
+                                       36.0 / 34.0, 360.0 / 355.0);
+static ColorSensor         Sensor;
+static SerialMonitor       Monitor(115200);
+static TimerMillis         MillisTimer;
+static TimerMicros         MicrosTimer;
+
+// The PRIZM's green LED (pin 7) and Start button (pin 8), through
+// the runtime and the compile time pin classes.
+
+static DigitalLed           Led(7);
+static FastDigitalLed<7>    FastLed;
+static PushButton           Button(8);
+static FastPushButton<8>    FastButton;
+
+void setupCases()
+{
+  Drive.setSpeedFraction(0.27);
+  StaticDrive.setSpeedFraction(0.27);
+  Sensor.setWhiteBalance(1.0 / 3000.0, 1.0, 1.0, 1.0);
+  Monitor.setup();
+
+  // Long intervals, so the timers never expire while timed.
+
+  MillisTimer.start(0xFFFFFFFFUL);
+  MicrosTimer.start(0xFFFFFFFFUL);
+}
+
+/*************************** CASES *********************************/
+
+static void emptyLoop(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Sink = count;
+  }
+}
+
+static void tapeColor(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    const double* ratio = Ratios[count & 7];
+    ColorRatios ratios(ratio[0], ratio[1], ratio[2], ratio[3]);
+
+    Sink = ratios.getTapeColor();
+  }
+}
+
+static void colorRatios(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    const uint16_t* raw = RawReadings[count & 3];
+    ColorRatios ratios;
+
+    Sensor.getColorRatios(raw[0], raw[1], raw[2], raw[3], ratios);
+    DoubleSink = ratios.getRRatio();
+  }
+}
+
+static void timerMillisDone(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Sink = MillisTimer.done();
+  }
+}
+
+static void timerMicrosDone(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Sink = MicrosTimer.done();
+  }
+}
+
+static void adjustDistance(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    DoubleSink = Drive.adjustDistance(Moves[count & 7], 19.05);
+  }
+}
+
+// The same conversion through the virtual interface and statically.
+
+static void mmTravelTime(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Sink = VirtualDrive.getMMTravelTime(Moves[count & 7], 19.05);
+  }
+}
+
+static void staticMMTravelTime(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Sink = StaticDrive.getMMTravelTime(Moves[count & 7], 19.05);
+  }
+}
+
+// SerialMonitor cases include sending: on the robot that's the UART
+// (at 115200 baud, once the transmit buffer fills); on the host it's
+// discarded.
+
+static void sendLong(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Monitor.sendLongValue(-123456L - count);
+  }
+}
+
+static void sendDouble(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Monitor.sendDoubleValue(12.345 + count);
+  }
+}
+
+static void sendText(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Monitor.sendText(F("Tape "));
+  }
+}
+
+// The paths sendText() and sendDoubleValue() used to take: a String
+// built on the heap, and Print's float printing.
+
+static void sendString(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Monitor.sendText(String(F("Tape ")));
+  }
+}
+
+static void printDouble(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Monitor.print(12.345 + count, 3);
+  }
+}
+
+static void formatFixed(uint16_t iterations)
+{
+  char buffer[FormatBufferSize];
+
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Sink = csci::formatFixed(buffer, 12.345 + count, 3);
+  }
+}
+
+static void ledOnOff(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Led.on();
+    Led.off();
+  }
+}
+
+static void fastLedOnOff(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    FastLed.on();
+    FastLed.off();
+  }
+}
+
+static void buttonClosed(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Sink = Button.closed();
+  }
+}
+
+static void fastButtonClosed(uint16_t iterations)
+{
+  for ( uint16_t count = 0; count < iterations; ++count )
+  {
+    Sink = FastButton.closed();
+  }
+}
+
+const BenchCase Cases[] =
+{
+  { "empty_loop",                     emptyLoop },
+  { "ColorRatios::getTapeColor",      tapeColor },
+  { "ColorSensor::getColorRatios",    colorRatios },
+  { "TimerMillis::done",              timerMillisDone },
+  { "TimerMicros::done",              timerMicrosDone },
+  { "DriveTrain::adjustDistance",     adjustDistance },
+  { "TMDriveTrain::getMMTravelTime",  mmTravelTime },
+  { "StaticTMDriveTrain::getMMTravelTime", staticMMTravelTime },
+  { "SerialMonitor::sendLongValue",   sendLong },
+  { "SerialMonitor::sendDoubleValue", sendDouble },
+  { "SerialMonitor::sendText",        sendText },
+  { "SerialMonitor::sendText(String)", sendString },
+  { "Print::print(double)",           printDouble },
+  { "formatFixed",                    formatFixed },
+  { "DigitalLed::on+off",             ledOnOff },
+  { "FastDigitalLed::on+off",         fastLedOnOff },
+  { "PushButton::closed",             buttonClosed },
+  { "FastPushButton::closed",         fastButtonClosed }
+};
+
+// A case added without updating NumCases would go untimed on the
+// robot.
+
+static_assert(sizeof(Cases) / sizeof(Cases[0]) == NumCases, "Update NumCases in BenchCases.h");
+
+}   // End namespace bench
+}   // End namespace csci
@@ -0,0 +1,41 @@
+#ifndef INCLUDE_CSCI_BENCH_CASES
+#define INCLUDE_CSCI_BENCH_CASES
+
+// CSCIUtils microbenchmark cases header file.
+//
+// Each case runs one CSCIUtils hot path "iterations" times.  The same
+// cases are timed on the robot (CSCIBench.ino, in CPU cycles) and on
+// the host (BenchMain.cpp, in nanoseconds), and both write results
+// the same way (see BenchMain.cpp) so runs can be compared as the
+// library is optimized.
+
+#include <CSCIUtils.h>
+
+namespace csci
+{
+namespace bench
+{
+
+typedef void (*BenchRoutine)(uint16_t iterations);
+
+struct BenchCase
+{
+  const char*   name;
+  BenchRoutine  routine;
+};
+
+// The cases.  Cases[0] is an empty loop, timed to subtract loop
+// overhead from the others.  (NumCases is a constant so the robot can
+// size its result arrays with it; update it with Cases[].)
+
+static const uint8_t    NumCases = 18;
+extern const BenchCase  Cases[];
+
+// Create the objects the cases use.  Call once before timing.
+
+void setupCases();
+
+}   // End namespace bench
+}   // End namespace csci
+
+#endif    // INCLUDE_CSCI_BENCH_CASES
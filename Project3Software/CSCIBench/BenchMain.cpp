@@ -0,0 +1,235 @@
+// CSCIUtils microbenchmark host program (csci_bench).  The robot
+// version is CSCIBench.ino.
+//
+// Usage: csci_bench [--output FILE] [--baseline FILE] [--max-regression PCT]
+//                   [--min-millis N] [--repeats N] [--filter TEXT]
+//
+//   --output FILE         Write results to FILE (default stdout).
+//   --baseline FILE       Compare with earlier results (stderr table).
+//   --max-regression PCT  Exit with status 1 if any case got more than
+//                         PCT percent slower than the baseline.
+//   --min-millis N        Time each repeat for at least N ms (default 100).
+//   --repeats N           Repeats per case; the fastest counts (default 5).
+//   --filter TEXT         Only run cases whose names contain TEXT.
+//
+// Results are CSV, one case per line, after the loop overhead (the
+// empty_loop case) is taken off:
+//
+//   benchmark,unit,per_op,iterations
+//   ColorRatios::getTapeColor,ns,21.37,5111860
+//
+// The robot writes the same format with unit "cycles", plus a
+// heap_bytes column (ignored when read as a baseline).
+//
+// (Only built for the host; the Arduino IDE also compiles this file
+// as part of the CSCIBench sketch.)
+
+#ifdef CSCI_HOST
+
+#include "BenchCases.h"
+#include <CSCIHost.h>
+#include <chrono>
+#include <map>
+#include <string>
+
+using namespace csci;
+
+// Returns the fastest time per call (in nanoseconds) of a case.
+
+static double timeCase(bench::BenchRoutine routine, double minMillis, unsigned repeats,
+                       uint64_t& iterations)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  const uint16_t Batch = 1000;
+  double best = 0.0;
+
+  iterations = 0;
+
+  for ( unsigned repeat = 0; repeat < repeats; ++repeat )
+  {
+    uint64_t count = 0;
+    Clock::time_point start = Clock::now();
+    double elapsedNanos = 0.0;
+
+    do
+    {
+      routine(Batch);
+      count += Batch;
+      elapsedNanos = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    } while ( elapsedNanos < minMillis * 1000000.0 );
+
+    double perOp = elapsedNanos / count;
+
+    if ( (repeat == 0) || (perOp < best) )
+    {
+      best = perOp;
+    }
+
+    iterations += count;
+  }
+
+  return best;
+}
+
+// Read a results file into "results" (name -> per_op).  Returns
+// "false" if it can't be read.
+
+static bool readResults(const char* path, std::map<std::string, double>& results)
+{
+  FILE* file = fopen(path, "r");
+
+  if ( file == NULL )
+  {
+    return false;
+  }
+
+  char line[256];
+
+  while ( fgets(line, sizeof(line), file) != NULL )
+  {
+    char* unit = strchr(line, ',');
+    char* perOp = ( unit != NULL ) ? strchr(unit + 1, ',') : NULL;
+
+    if ( perOp != NULL )
+    {
+      *unit = '\0';
+      results[line] = atof(perOp + 1);
+    }
+  }
+
+  fclose(file);
+  return true;
+}
+
+static int usage(const char* program)
+{
+  fprintf(stderr, "Usage: %s [--output FILE] [--baseline FILE] [--max-regression PCT]\n"
+                  "         [--min-millis N] [--repeats N] [--filter TEXT]\n",
+          program);
+  return 1;
+}
+
+int main(int argc, char** argv)
+{
+  const char* outputPath = NULL;
+  const char* baselinePath = NULL;
+  const char* filter = NULL;
+  double maxRegression = -1.0;
+  double minMillis = 100.0;
+  unsigned repeats = 5;
+
+  for ( int arg = 1; arg < argc; ++arg )
+  {
+    bool hasValue = ( arg + 1 < argc );
+
+    if ( (strcmp(argv[arg], "--output") == 0) && hasValue )
+    {
+      outputPath = argv[++arg];
+    }
+    else if ( (strcmp(argv[arg], "--baseline") == 0) && hasValue )
+    {
+      baselinePath = argv[++arg];
+    }
+    else if ( (strcmp(argv[arg], "--max-regression") == 0) && hasValue )
+    {
+      maxRegression = atof(argv[++arg]);
+    }
+    else if ( (strcmp(argv[arg], "--min-millis") == 0) && hasValue )
+    {
+      minMillis = atof(argv[++arg]);
+    }
+    else if ( (strcmp(argv[arg], "--repeats") == 0) && hasValue )
+    {
+      repeats = static_cast<unsigned>(strtoul(argv[++arg], NULL, 0));
+    }
+    else if ( (strcmp(argv[arg], "--filter") == 0) && hasValue )
+    {
+      filter = argv[++arg];
+    }
+    else
+    {
+      return usage(argv[0]);
+    }
+  }
+
+  if ( repeats == 0 )
+  {
+    return usage(argv[0]);
+  }
+
+  std::map<std::string, double> baseline;
+
+  if ( (baselinePath != NULL) && !readResults(baselinePath, baseline) )
+  {
+    fprintf(stderr, "Can't read %s\n", baselinePath);
+    return 1;
+  }
+
+  FILE* output = stdout;
+
+  if ( (outputPath != NULL) && ((output = fopen(outputPath, "w")) == NULL) )
+  {
+    fprintf(stderr, "Can't write %s\n", outputPath);
+    return 1;
+  }
+
+  // SerialMonitor cases format, but don't print.
+
+  host::setSerialOutput(NULL);
+  bench::setupCases();
+
+  uint64_t iterations;
+  double overhead = timeCase(bench::Cases[0].routine, minMillis, repeats, iterations);
+  bool regressed = false;
+
+  fprintf(output, "benchmark,unit,per_op,iterations\n");
+
+  if ( baselinePath != NULL )
+  {
+    fprintf(stderr, "%-34s %10s %10s %8s\n", "benchmark", "baseline", "ns", "change");
+  }
+
+  for ( uint8_t index = 1; index < bench::NumCases; ++index )
+  {
+    const bench::BenchCase& benchCase = bench::Cases[index];
+
+    if ( (filter != NULL) && (strstr(benchCase.name, filter) == NULL) )
+    {
+      continue;
+    }
+
+    double perOp = timeCase(benchCase.routine, minMillis, repeats, iterations) - overhead;
+
+    if ( perOp < 0.0 )
+    {
+      perOp = 0.0;
+    }
+
+    fprintf(output, "%s,ns,%.3f,%llu\n", benchCase.name, perOp,
+            static_cast<unsigned long long>(iterations));
+
+    std::map<std::string, double>::const_iterator base = baseline.find(benchCase.name);
+
+    if ( base != baseline.end() )
+    {
+      double change = ( base->second > 0.0 ) ? 100.0 * (perOp - base->second) / base->second : 0.0;
+
+      fprintf(stderr, "%-34s %10.3f %10.3f %+7.1f%%\n", benchCase.name, base->second, perOp, change);
+
+      if ( (maxRegression >= 0.0) && (change > maxRegression) )
+      {
+        regressed = true;
+      }
+    }
+  }
+
+  if ( output != stdout )
+  {
+    fclose(output);
+  }
+
+  return regressed ? 1 : 0;
+}
+
+#endif    // CSCI_HOST
@@ -0,0 +1,182 @@
+// CSCIUtils microbenchmarks, robot version.
+//
+// Times each case in BenchCases.cpp in CPU cycles, counted by
+// Timer1 at the full 16 MHz clock, and sends the results over Serial
+// (115200 baud) in the same CSV format the host program (csci_bench,
+// BenchMain.cpp) writes, with unit "cycles".  Copy the lines from the
+// "benchmark,..." header on into a file to keep, or pass it to
+// csci_bench --baseline.
+//
+// The SerialMonitor cases send their own text first; results are
+// sent afterwards so they aren't mixed with it.
+//
+// The robot also reports each case's peak heap use (heap_bytes: the
+// most heap one call used, even if it was freed again), which shows
+// the cases that build Strings.
+
+#include <PRIZM.h>        // Tetrix PRIZM and EXPANSION controller library
+#include <CSCIUtils.h>    // CSCI Library routines
+#include "BenchCases.h"
+
+// Calls per case.  (The cycle counter wraps after 2^32 cycles, so
+// keep Iterations times the slowest case well below that.)
+
+const uint16_t Iterations = 200;
+
+// Each case's results are kept (6 bytes a case) until all are timed.
+
+static_assert(csci::bench::NumCases <= 40, "Too many cases for the robot's RAM");
+
+csci::SerialMonitor SMonitor(115200);
+
+/************************ CYCLE COUNTER ****************************/
+// Timer1 counts CPU cycles; overflows extend it to 32 bits.
+
+volatile uint16_t Timer1Overflows = 0;
+
+ISR(TIMER1_OVF_vect)
+{
+  ++Timer1Overflows;
+}
+
+void startCycleCounter()
+{
+  TCCR1A = 0;                 // Normal mode
+  TCCR1B = _BV(CS10);         // No prescaling
+  TCNT1 = 0;
+  TIFR1 = _BV(TOV1);          // Clear any pending overflow
+  TIMSK1 = _BV(TOIE1);
+}
+
+uint32_t readCycles()
+{
+  uint8_t sreg = SREG;
+
+  cli();
+
+  uint16_t count = TCNT1;
+  uint16_t overflows = Timer1Overflows;
+
+  // An overflow that hasn't been serviced yet belongs to this count
+  // if the count has just wrapped.
+
+  if ( (TIFR1 & _BV(TOV1)) && (count < 0x8000) )
+  {
+    ++overflows;
+  }
+
+  SREG = sreg;
+
+  return (static_cast<uint32_t>(overflows) << 16) | count;
+}
+
+// Top of the heap (avr-libc's __brkval, 0 until the first malloc()).
+
+extern char* __brkval;
+extern char  __heap_start;
+
+uintptr_t heapTop()
+{
+  return reinterpret_cast<uintptr_t>(( __brkval != 0 ) ? __brkval : &__heap_start);
+}
+
+// Free memory between the top of the heap and the stack is painted
+// before a call.  avr-libc's malloc() starts each block it carves
+// from free memory with the block's size (a size_t), and the size
+// stays put when the block is freed (and __brkval drops back), so
+// walking the blocks laid down from the old top of the heap finds
+// the highest byte the heap reached, whether or not the blocks were
+// written.  (Checking for overwritten paint would stop short at
+// allocated bytes never written.)  Heap blocks reused from below the
+// top of the heap aren't counted.
+
+const uint8_t Paint = 0xA5;
+
+uint16_t peakHeapBytes(csci::bench::BenchRoutine routine)
+{
+  uint8_t* bottom = reinterpret_cast<uint8_t*>(heapTop());
+  uint8_t* top = reinterpret_cast<uint8_t*>(SP);
+
+  for ( uint8_t* byte = bottom; byte < top; ++byte )
+  {
+    *byte = Paint;
+  }
+
+  routine(1);
+
+  uint8_t* block = bottom;
+
+  while ( block + sizeof(size_t) <= top )
+  {
+    // Still painted: no block here.
+
+    if ( (block[0] == Paint) && (block[1] == Paint) )
+    {
+      break;
+    }
+
+    size_t size = *reinterpret_cast<size_t*>(block);
+
+    if ( size > static_cast<size_t>(top - block) - sizeof(size_t) )
+    {
+      break;    // Not a block size
+    }
+
+    block += sizeof(size_t) + size;
+  }
+
+  return static_cast<uint16_t>(block - bottom);
+}
+
+uint32_t timeCase(csci::bench::BenchRoutine routine)
+{
+  uint32_t start = readCycles();
+
+  routine(Iterations);
+
+  return readCycles() - start;
+}
+
+/*************************** SKETCH ********************************/
+
+void setup()
+{
+  SMonitor.setup();
+  csci::bench::setupCases();
+  startCycleCounter();
+
+  // Time every case, then report.
+
+  uint32_t cycles[csci::bench::NumCases];
+  uint16_t heapBytes[csci::bench::NumCases];
+
+  for ( uint8_t index = 0; index < csci::bench::NumCases; ++index )
+  {
+    cycles[index] = timeCase(csci::bench::Cases[index].routine);
+    heapBytes[index] = peakHeapBytes(csci::bench::Cases[index].routine);
+  }
+
+  SMonitor.sendNewline();
+  SMonitor.sendText(F("benchmark,unit,per_op,iterations,heap_bytes"));
+  SMonitor.sendNewline();
+
+  for ( uint8_t index = 1; index < csci::bench::NumCases; ++index )
+  {
+    // Take off the loop overhead (the empty loop case).
+
+    uint32_t net = ( cycles[index] > cycles[0] ) ? cycles[index] - cycles[0] : 0;
+
+    SMonitor.sendText(csci::bench::Cases[index].name);
+    SMonitor.sendText(F(",cycles,"));
+    SMonitor.sendDoubleValue(static_cast<double>(net) / Iterations, 1);
+    SMonitor.sendText(F(","));
+    SMonitor.sendUnsignedLongValue(Iterations);
+    SMonitor.sendText(F(","));
+    SMonitor.sendUnsignedIntegerValue(heapBytes[index]);
+    SMonitor.sendNewline();
+  }
+}
+
+void loop()
+{
+}
@@ -0,0 +1,45 @@
+#ifndef INCLUDE_CSCI_HOST_TCS34725
+#define INCLUDE_CSCI_HOST_TCS34725
+
+// Host (Linux) stand-in for the Adafruit TCS34725 color sensor
+// library.  Raw readings come from the ColorDevice attached with
+// host::attachColorSensor() (see CSCIHost.h).  Reading the sensor
+// takes one integration time, as on the robot.
+
+#include <Arduino.h>
+
+#define TCS34725_INTEGRATIONTIME_2_4MS  0xFF
+#define TCS34725_INTEGRATIONTIME_24MS   0xF6
+#define TCS34725_INTEGRATIONTIME_50MS   0xEB
+#define TCS34725_INTEGRATIONTIME_101MS  0xD5
+#define TCS34725_INTEGRATIONTIME_154MS  0xC0
+#define TCS34725_INTEGRATIONTIME_700MS  0x00
+
+typedef enum
+{
+  TCS34725_GAIN_1X  = 0x00,
+  TCS34725_GAIN_4X  = 0x01,
+  TCS34725_GAIN_16X = 0x02,
+  TCS34725_GAIN_60X = 0x03
+} tcs34725Gain_t;
+
+class Adafruit_TCS34725
+{
+  public:
+  Adafruit_TCS34725(uint8_t integrationTime = TCS34725_INTEGRATIONTIME_2_4MS,
+                    tcs34725Gain_t gain = TCS34725_GAIN_1X)
+    : m_integrationTime(integrationTime), m_gain(gain) { }
+
+  bool begin();
+
+  void setIntegrationTime(uint8_t integrationTime) { m_integrationTime = integrationTime; }
+  void setGain(tcs34725Gain_t gain) { m_gain = gain; }
+
+  void getRawData(uint16_t* r, uint16_t* g, uint16_t* b, uint16_t* c);
+
+  protected:
+  uint8_t         m_integrationTime;
+  tcs34725Gain_t  m_gain;
+};
+
+#endif    // INCLUDE_CSCI_HOST_TCS34725
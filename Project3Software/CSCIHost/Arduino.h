@@ -0,0 +1,201 @@
+#ifndef INCLUDE_CSCI_HOST_ARDUINO
+#define INCLUDE_CSCI_HOST_ARDUINO
+
+// Host (Linux) stand-in for the Arduino core header.
+//
+// Declares the subset of the Arduino API used by CSCIUtils, the
+// PRIZM library and the robot sketch.  Time comes from a virtual
+// clock and pins from pluggable devices (see CSCIHost.h).
+//
+// NOTE: Only compiled for the host build (CSCI_HOST defined).  On the
+//       robot the real Arduino core is used.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include <avr/pgmspace.h>
+
+// On AVR, "abs" is a macro that works for any type.  Pick up the
+// floating point overloads so abs(double) isn't truncated to int.
+
+using std::abs;
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+/************************** CONSTANTS ******************************/
+
+#define HIGH          1
+#define LOW           0
+
+#define INPUT         0
+#define OUTPUT        1
+#define INPUT_PULLUP  2
+
+#define DEC           10
+#define HEX           16
+#define OCT           8
+#define BIN           2
+
+#define PI            3.1415926535897932384626433832795
+#define HALF_PI       1.5707963267948966192313216916398
+#define TWO_PI        6.283185307179586476925286766559
+#define DEG_TO_RAD    0.017453292519943295769236907684886
+#define RAD_TO_DEG    57.295779513082320876798154814105
+
+/*************************** MACROS ********************************/
+
+#define lowByte(w)    ((uint8_t) ((w) & 0xff))
+#define highByte(w)   ((uint8_t) ((w) >> 8))
+
+#define bitRead(value, bit)   (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit)    ((value) |= (1UL << (bit)))
+#define bitClear(value, bit)  ((value) &= ~(1UL << (bit)))
+#define bit(b)                (1UL << (b))
+
+/**************************** TIME *********************************/
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+/**************************** PINS *********************************/
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int  digitalRead(uint8_t pin);
+int  analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout = 1000000UL);
+
+/************************* INTERRUPTS ******************************/
+
+void noInterrupts();
+void interrupts();
+
+/*************************** STRING ********************************/
+// Flash strings (F("...")) are ordinary strings on the host.
+
+class __FlashStringHelper;
+
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+class String
+{
+  public:
+  String(const char* text = "") : m_text(text ? text : "") { }
+  String(const __FlashStringHelper* text)
+    : m_text(reinterpret_cast<const char*>(text)) { }
+  String(char c) : m_text(1, c) { }
+  String(int value, unsigned char base = DEC);
+  String(unsigned int value, unsigned char base = DEC);
+  String(long value, unsigned char base = DEC);
+  String(unsigned long value, unsigned char base = DEC);
+  String(double value, unsigned char decimals = 2);
+
+  const char*   c_str() const { return m_text.c_str(); }
+  unsigned int  length() const { return m_text.length(); }
+
+  String& operator+=(const String& rhs) { m_text += rhs.m_text; return *this; }
+
+  friend String operator+(const String& lhs, const String& rhs)
+    { String result(lhs); result += rhs; return result; }
+
+  bool operator==(const String& rhs) const { return m_text == rhs.m_text; }
+  bool operator!=(const String& rhs) const { return m_text != rhs.m_text; }
+
+  protected:
+  std::string m_text;
+};
+
+/*************************** PRINT *********************************/
+// Print formats values the way the Arduino core does.
+
+class Print
+{
+  public:
+  virtual ~Print() { }
+
+  virtual size_t write(uint8_t value) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* text)
+    { return ( text == NULL ) ? 0 : write(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+
+  virtual int  availableForWrite() { return 0; }
+  virtual void flush() { }
+
+  size_t print(const __FlashStringHelper* text);
+  size_t print(const String& text);
+  size_t print(const char* text);
+  size_t print(char c);
+  size_t print(unsigned char value, int base = DEC);
+  size_t print(int value, int base = DEC);
+  size_t print(unsigned int value, int base = DEC);
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(double value, int decimals = 2);
+
+  size_t println();
+
+  template <typename T>
+  size_t println(T value) { size_t n = print(value); return n + println(); }
+
+  template <typename T>
+  size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+
+  protected:
+  size_t printNumber(unsigned long value, uint8_t base);
+  size_t printFloat(double value, uint8_t decimals);
+};
+
+/*************************** STREAM ********************************/
+
+class Stream : public Print
+{
+  public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+/********************** HARDWARE SERIAL ****************************/
+// Output goes to the host's standard output (see CSCIHost.h to
+// redirect or silence it).  Input comes from host::serialInput().
+
+class HardwareSerial : public Stream
+{
+  public:
+  void begin(unsigned long baud) { m_baud = baud; }
+  void end() { }
+
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  int  availableForWrite() override;
+  int  available() override;
+  int  read() override;
+  int  peek() override;
+
+  operator bool() const { return true; }
+
+  protected:
+  unsigned long m_baud = 9600;
+};
+
+extern HardwareSerial Serial;
+
+// Sketch entry points (defined by the sketch).
+
+void setup();
+void loop();
+
+#endif    // INCLUDE_CSCI_HOST_ARDUINO
@@ -0,0 +1,500 @@
+// Host (Linux) platform layer implementation file.
+//
+// Virtual clock, device registry and the Arduino core time, pin,
+// watchdog and color sensor routines built on them.
+
+#include "CSCIHost.h"
+#include <Adafruit_TCS34725.h>
+#include <avr/wdt.h>
+#include <vector>
+
+namespace csci
+{
+namespace host
+{
+
+static const uint8_t NumPins = 20;      // ATmega328P digital + analog pins
+static const uint8_t NumI2C = 128;      // 7 bit I2C addresses
+
+/*********************** DEFAULT DEVICES ***************************/
+
+// Default pin: reads back what was last written (or set as input).
+
+class DefaultPin : public PinDevice
+{
+  public:
+  void digitalWrite(uint8_t pin, uint8_t value) override
+    { m_output[pin] = value; m_input[pin] = value; }
+  int  digitalRead(uint8_t pin) override { return m_input[pin]; }
+  int  analogRead(uint8_t pin) override { return m_analog[pin]; }
+  void analogWrite(uint8_t pin, int value) override { m_output[pin] = value; }
+
+  // Like an ultrasonic sensor with nothing in range: no echo, after
+  // the sensor's maximum echo time.
+
+  unsigned long pulseIn(uint8_t, uint8_t, unsigned long timeout,
+                        unsigned long& elapsedMicros) override
+  {
+    const unsigned long NoEchoMicros = 18500;
+
+    elapsedMicros = ( timeout < NoEchoMicros ) ? timeout : NoEchoMicros;
+    return 0;
+  }
+
+  int m_output[NumPins] = { 0 };
+  int m_input[NumPins] = { 0 };
+  int m_analog[NumPins] = { 0 };
+};
+
+// Default color sensor: always white.
+
+class DefaultColor : public ColorDevice
+{
+  public:
+  void getRawData(uint16_t& r, uint16_t& g, uint16_t& b, uint16_t& c) override
+  {
+    r = 1000;
+    g = 1000;
+    b = 1000;
+    c = 3000;
+  }
+};
+
+/************************ PLATFORM STATE ***************************/
+
+struct Platform
+{
+  uint64_t              nowMicros = 0;
+  uint32_t              callCostMicros = 4;   // AVR micros() resolution
+  uint64_t              timeLimitMicros = 0;
+  bool                  advancing = false;
+  DefaultPin            defaultPin;
+  DefaultColor          defaultColor;
+  PinDevice*            pins[NumPins] = { NULL };
+  I2CDevice*            i2c[NumI2C] = { NULL };
+  ColorDevice*          color = NULL;
+  I2CStats              i2cTotal = I2CStats();
+  I2CStats              i2cStats[NumI2C] = { I2CStats() };
+  FILE*                 i2cRecord = NULL;
+  std::vector<Device*>  devices;
+};
+
+static Platform& platform()
+{
+  static Platform state;
+
+  return state;
+}
+
+static PinDevice& pinDevice(uint8_t pin)
+{
+  Platform& state = platform();
+
+  if ( (pin < NumPins) && (state.pins[pin] != NULL) )
+  {
+    return *state.pins[pin];
+  }
+
+  return state.defaultPin;
+}
+
+static void addUnique(Device* device)
+{
+  std::vector<Device*>& devices = platform().devices;
+
+  for ( size_t index = 0; index < devices.size(); ++index )
+  {
+    if ( devices[index] == device )
+    {
+      return;
+    }
+  }
+
+  devices.push_back(device);
+}
+
+/************************ START BUTTON *****************************/
+
+StartButton::StartButton(uint32_t periodMillis, uint32_t pressMillis)
+  : m_periodMillis(periodMillis),
+    m_pressMillis(pressMillis)
+{
+}
+
+int StartButton::digitalRead(uint8_t /* pin */)
+{
+  // Pressed (LOW) at the end of each period.
+
+  uint32_t phase = static_cast<uint32_t>((nowMicros() / 1000) % m_periodMillis);
+
+  return ( phase >= m_periodMillis - m_pressMillis ) ? LOW : HIGH;
+}
+
+uint32_t StartButton::getClickCount() const
+{
+  return static_cast<uint32_t>((nowMicros() / 1000) / m_periodMillis);
+}
+
+/*********************** VIRTUAL CLOCK *****************************/
+
+uint64_t nowMicros()
+{
+  return platform().nowMicros;
+}
+
+void chargeCall()
+{
+  advanceMicros(platform().callCostMicros);
+}
+
+void advanceMicros(uint64_t micros)
+{
+  Platform& state = platform();
+
+  state.nowMicros += micros;
+
+  // Devices may not move time themselves.
+
+  if ( !state.advancing )
+  {
+    state.advancing = true;
+
+    for ( size_t index = 0; index < state.devices.size(); ++index )
+    {
+      state.devices[index]->advance(state.nowMicros);
+    }
+
+    state.advancing = false;
+  }
+
+  if ( (state.timeLimitMicros > 0) && (state.nowMicros >= state.timeLimitMicros) )
+  {
+    exit(0);
+  }
+}
+
+void setCallCostMicros(uint32_t micros)
+{
+  platform().callCostMicros = micros;
+}
+
+void setTimeLimitMicros(uint64_t micros)
+{
+  platform().timeLimitMicros = micros;
+}
+
+/************************** DEVICES ********************************/
+
+void attachPin(uint8_t pin, PinDevice* device)
+{
+  if ( pin >= NumPins )
+  {
+    return;
+  }
+
+  platform().pins[pin] = device;
+
+  if ( device != NULL )
+  {
+    addUnique(device);
+  }
+}
+
+void attachI2C(uint8_t address, I2CDevice* device)
+{
+  if ( address >= NumI2C )
+  {
+    return;
+  }
+
+  platform().i2c[address] = device;
+
+  if ( device != NULL )
+  {
+    addUnique(device);
+  }
+}
+
+void attachColorSensor(ColorDevice* device)
+{
+  platform().color = device;
+
+  if ( device != NULL )
+  {
+    addUnique(device);
+  }
+}
+
+void addDevice(Device* device)
+{
+  if ( device != NULL )
+  {
+    addUnique(device);
+  }
+}
+
+I2CDevice* findI2C(uint8_t address)
+{
+  return ( address < NumI2C ) ? platform().i2c[address] : NULL;
+}
+
+void setPinInput(uint8_t pin, int level)
+{
+  if ( pin < NumPins )
+  {
+    platform().defaultPin.m_input[pin] = level;
+  }
+}
+
+void setAnalogInput(uint8_t pin, int value)
+{
+  if ( pin < NumPins )
+  {
+    platform().defaultPin.m_analog[pin] = value;
+  }
+}
+
+int getPinOutput(uint8_t pin)
+{
+  return ( pin < NumPins ) ? platform().defaultPin.m_output[pin] : 0;
+}
+
+/************************** I2C BUS ********************************/
+
+void chargeI2C(uint8_t address, uint8_t length, bool acknowledged, uint32_t clockHz)
+{
+  Platform& state = platform();
+  uint64_t micros = i2cBusMicros(length, acknowledged, clockHz);
+
+  I2CStats* stats[] = { &state.i2cTotal, &state.i2cStats[address & 0x7F] };
+
+  for ( size_t index = 0; index < 2; ++index )
+  {
+    ++stats[index]->transactions;
+    stats[index]->busMicros += micros;
+
+    if ( acknowledged )
+    {
+      stats[index]->bytes += length;
+    }
+    else
+    {
+      ++stats[index]->nacks;
+    }
+  }
+
+  advanceMicros(micros);
+}
+
+uint64_t i2cBusMicros(uint8_t length, bool acknowledged, uint32_t clockHz)
+{
+  // Start, address + data bytes (8 bits + ACK each), stop.
+
+  uint32_t bits = 1 + 9 * (1 + (acknowledged ? length : 0)) + 1;
+
+  return (static_cast<uint64_t>(bits) * 1000000 + clockHz - 1) / clockHz;
+}
+
+const I2CStats& getI2CStats()
+{
+  return platform().i2cTotal;
+}
+
+const I2CStats& getI2CStats(uint8_t address)
+{
+  return platform().i2cStats[address & 0x7F];
+}
+
+void resetI2CStats()
+{
+  Platform& state = platform();
+
+  state.i2cTotal = I2CStats();
+
+  for ( size_t index = 0; index < NumI2C; ++index )
+  {
+    state.i2cStats[index] = I2CStats();
+  }
+}
+
+// Writes "length" bytes as hex ("-" if none).
+
+static void recordBytes(FILE* file, const uint8_t* data, uint8_t length)
+{
+  if ( length == 0 )
+  {
+    fputc('-', file);
+  }
+
+  for ( uint8_t index = 0; index < length; ++index )
+  {
+    fprintf(file, "%02X", data[index]);
+  }
+}
+
+void setI2CRecord(FILE* file)
+{
+  platform().i2cRecord = file;
+}
+
+void recordI2CWrite(uint8_t address, const uint8_t* data, uint8_t length, uint8_t status)
+{
+  FILE* file = platform().i2cRecord;
+
+  if ( file != NULL )
+  {
+    fprintf(file, "@i2c W %02X ", address);
+    recordBytes(file, data, length);
+    fprintf(file, " %u\n", status);
+  }
+}
+
+void recordI2CRead(uint8_t address, uint8_t requested, const uint8_t* data, uint8_t length)
+{
+  FILE* file = platform().i2cRecord;
+
+  if ( file != NULL )
+  {
+    fprintf(file, "@i2c R %02X %02X ", address, requested);
+    recordBytes(file, data, length);
+    fputc('\n', file);
+  }
+}
+
+}   // End namespace host
+}   // End namespace csci
+
+using namespace csci;
+
+/*************************** ARDUINO *******************************/
+
+unsigned long millis()
+{
+  host::chargeCall();
+
+  return static_cast<unsigned long>(host::nowMicros() / 1000);
+}
+
+unsigned long micros()
+{
+  host::chargeCall();
+
+  // Wraps at 32 bits, like the AVR.
+
+  return static_cast<uint32_t>(host::nowMicros());
+}
+
+void delay(unsigned long ms)
+{
+  host::advanceMicros(static_cast<uint64_t>(ms) * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  host::advanceMicros(us);
+}
+
+void yield()
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  host::pinDevice(pin).pinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  host::chargeCall();
+
+  host::pinDevice(pin).digitalWrite(pin, value);
+
+  // The default pin remembers outputs even when a device serves it.
+
+  if ( (pin < host::NumPins) && (host::platform().pins[pin] != NULL) )
+  {
+    host::platform().defaultPin.m_output[pin] = value;
+  }
+}
+
+int digitalRead(uint8_t pin)
+{
+  host::chargeCall();
+
+  return host::pinDevice(pin).digitalRead(pin);
+}
+
+int analogRead(uint8_t pin)
+{
+  // The ATmega328P takes about 104 microseconds per conversion.
+
+  host::advanceMicros(104);
+
+  return host::pinDevice(pin).analogRead(pin);
+}
+
+void analogWrite(uint8_t pin, int value)
+{
+  host::pinDevice(pin).analogWrite(pin, value);
+}
+
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout)
+{
+  unsigned long elapsedMicros = 0;
+  unsigned long duration = host::pinDevice(pin).pulseIn(pin, state, timeout, elapsedMicros);
+
+  host::advanceMicros(elapsedMicros);
+
+  return duration;
+}
+
+void noInterrupts()
+{
+}
+
+void interrupts()
+{
+}
+
+/*************************** WATCHDOG ******************************/
+
+void wdt_enable(int /* timeout */)
+{
+  // Only used to reset the board, which ends a host run.
+
+  fflush(stdout);
+  fprintf(stderr, "Watchdog reset at %.3f s (virtual)\n",
+          host::nowMicros() / 1000000.0);
+  exit(0);
+}
+
+void wdt_disable()
+{
+}
+
+void wdt_reset()
+{
+}
+
+/************************ COLOR SENSOR *****************************/
+
+bool Adafruit_TCS34725::begin()
+{
+  return true;
+}
+
+void Adafruit_TCS34725::getRawData(uint16_t* r, uint16_t* g, uint16_t* b, uint16_t* c)
+{
+  // A reading takes one integration time (2.4 ms per step).
+
+  host::advanceMicros((256 - static_cast<uint32_t>(m_integrationTime)) * 2400);
+
+  host::ColorDevice* device = host::platform().color;
+
+  if ( device == NULL )
+  {
+    device = &host::platform().defaultColor;
+  }
+
+  device->getRawData(*r, *g, *b, *c);
+}
@@ -0,0 +1,254 @@
+#ifndef INCLUDE_CSCI_HOST
+#define INCLUDE_CSCI_HOST
+
+// Host (Linux) platform layer header file.
+//
+// The host build replaces the Arduino core, Wire, EEPROM and the
+// TCS34725 library with the stand-ins in this directory, so
+// CSCIUtils, the PRIZM library and the sketch compile and run
+// natively.  This header is how a host program (or a simulator)
+// controls that platform:
+//
+//   Virtual clock - Time only moves when the program waits (delay(),
+//                   delayMicroseconds(), pulseIn()) or polls the
+//                   clock, pins or Serial (each poll costs a little
+//                   time, so busy-wait loops finish).  Nothing depends on
+//                   the host's real time, so runs are repeatable.
+//
+//   Devices       - Pins, I2C addresses and the color sensor are
+//                   served by pluggable devices.  Devices are told
+//                   whenever time moves so they can simulate.
+//
+//   I2C bus       - Wire transactions take the time the bytes take on
+//                   the bus, and are counted per address.
+//
+//   Serial        - Output goes to a FILE (stdout by default, or none);
+//                   input is queued by the host program.
+
+#include <Arduino.h>
+#include <stdio.h>
+
+namespace csci
+{
+namespace host
+{
+
+/*************************** DEVICE ********************************/
+// A Device is anything simulated.  advance() is called every time
+// the virtual clock moves.
+
+class Device
+{
+  public:
+  virtual ~Device() { }
+
+  // Time has moved to "nowMicros".
+
+  virtual void advance(uint64_t /* nowMicros */) { }
+};
+
+/************************* PIN DEVICE ******************************/
+// A PinDevice serves one or more Arduino pins.
+
+class PinDevice : public Device
+{
+  public:
+  virtual void pinMode(uint8_t /* pin */, uint8_t /* mode */) { }
+  virtual void digitalWrite(uint8_t /* pin */, uint8_t /* value */) { }
+  virtual int  digitalRead(uint8_t /* pin */) { return LOW; }
+  virtual int  analogRead(uint8_t /* pin */) { return 0; }
+  virtual void analogWrite(uint8_t /* pin */, int /* value */) { }
+
+  // Measure a pulse.  Returns its length (in microseconds) and the
+  // time (in microseconds) the measurement took in "elapsedMicros".
+  // Returns 0 if no pulse started before the timeout.
+
+  virtual unsigned long pulseIn(uint8_t /* pin */, uint8_t /* state */,
+                                unsigned long timeout,
+                                unsigned long& elapsedMicros)
+    { elapsedMicros = timeout; return 0; }
+};
+
+/************************* I2C DEVICE ******************************/
+// An I2CDevice serves one I2C address.
+
+class I2CDevice : public Device
+{
+  public:
+  // The master wrote "length" bytes.  Returns an endTransmission()
+  // status (0 = success, 3 = data not acknowledged).
+
+  virtual uint8_t receive(const uint8_t* data, uint8_t length) = 0;
+
+  // The master requested "length" bytes.  Fill "data" and return the
+  // number of bytes sent.
+
+  virtual uint8_t request(uint8_t* data, uint8_t length) = 0;
+};
+
+/************************ COLOR DEVICE *****************************/
+// A ColorDevice supplies TCS34725 raw readings.
+
+class ColorDevice : public Device
+{
+  public:
+  virtual void getRawData(uint16_t& r, uint16_t& g, uint16_t& b, uint16_t& c) = 0;
+};
+
+/************************ START BUTTON *****************************/
+// StartButton models the PRIZM Start button (pin 8, pressed = LOW),
+// clicking it by itself so the sketch never waits forever.  The
+// button is pressed for "pressMillis" once every "periodMillis".
+
+class StartButton : public PinDevice
+{
+  public:
+  StartButton(uint32_t periodMillis = 2000, uint32_t pressMillis = 200);
+
+  int digitalRead(uint8_t pin) override;
+
+  // Returns the number of clicks so far.
+
+  uint32_t getClickCount() const;
+
+  protected:
+  uint32_t  m_periodMillis;
+  uint32_t  m_pressMillis;
+};
+
+/*********************** VIRTUAL CLOCK *****************************/
+
+// Returns the virtual time (in microseconds).
+
+uint64_t nowMicros();
+
+// Move the virtual clock forward.
+
+void advanceMicros(uint64_t micros);
+
+// Set the time (in microseconds) each call to millis(), micros(),
+// digitalRead(), digitalWrite() or Serial.available() takes, and
+// charge that time for a call.  Charging every polled call means
+// any polling loop lets time pass.
+
+void setCallCostMicros(uint32_t micros);
+void chargeCall();
+
+// End the program (exit(0)) once the virtual clock reaches "micros"
+// (0 = never).
+
+void setTimeLimitMicros(uint64_t micros);
+
+/************************** DEVICES ********************************/
+
+// Attach a device to a pin (NULL restores the default pin, which
+// reads back whatever was last written or set).
+
+void attachPin(uint8_t pin, PinDevice* device);
+
+// Attach a device to an I2C address (NULL detaches).
+
+void attachI2C(uint8_t address, I2CDevice* device);
+
+// Returns the device attached to an I2C address (NULL if none).
+
+I2CDevice* findI2C(uint8_t address);
+
+// Attach the color sensor device (NULL restores the default, which
+// always reads white).
+
+void attachColorSensor(ColorDevice* device);
+
+// Add a device that is told when time moves, but serves nothing.
+
+void addDevice(Device* device);
+
+// Default pin access: set the level/value read from a pin, and get
+// the value last written to a pin.
+
+void setPinInput(uint8_t pin, int level);
+void setAnalogInput(uint8_t pin, int value);
+int  getPinOutput(uint8_t pin);
+
+/************************** I2C BUS ********************************/
+
+// I2C bus use: transactions (writes and reads), bytes transferred
+// (not counting address bytes), transactions not acknowledged and
+// time on the bus.
+
+struct I2CStats
+{
+  uint32_t  transactions;
+  uint32_t  bytes;
+  uint32_t  nacks;
+  uint64_t  busMicros;
+};
+
+// Charge the bus time of one transaction with "address" moving
+// "length" data bytes at "clockHz" (called by Wire).  A transaction
+// not acknowledged ends after the address byte.
+
+void chargeI2C(uint8_t address, uint8_t length, bool acknowledged, uint32_t clockHz);
+
+// Returns the time (in microseconds) such a transaction takes.
+
+uint64_t i2cBusMicros(uint8_t length, bool acknowledged, uint32_t clockHz);
+
+// Returns bus use for all addresses or for one address.
+
+const I2CStats& getI2CStats();
+const I2CStats& getI2CStats(uint8_t address);
+
+void resetI2CStats();
+
+// Record every Wire transaction to "file" (NULL = off), in the trace
+// format of I2CReplay.h, which the PRIZM profiler's recorder also
+// writes on the robot.
+
+void setI2CRecord(FILE* file);
+
+// Record a write (with its endTransmission() status) or a read (of
+// "requested" bytes, "length" received).  Called by Wire.
+
+void recordI2CWrite(uint8_t address, const uint8_t* data, uint8_t length, uint8_t status);
+void recordI2CRead(uint8_t address, uint8_t requested, const uint8_t* data, uint8_t length);
+
+/*************************** SERIAL ********************************/
+
+// Send Serial output to "file" (NULL discards it).
+
+void setSerialOutput(FILE* file);
+
+// Queue bytes to be read from Serial.
+
+void serialInput(const uint8_t* data, size_t length);
+
+// Returns the number of bytes written to Serial.
+
+uint32_t getSerialBytesWritten();
+
+// A Print that writes to a FILE (for library dump() routines).
+
+class FilePrint : public Print
+{
+  public:
+  FilePrint(FILE* file) : m_file(file) { }
+
+  size_t write(uint8_t value) override { return ( fputc(value, m_file) == EOF ) ? 0 : 1; }
+
+  protected:
+  FILE* m_file;
+};
+
+/*************************** EEPROM ********************************/
+
+// Load/save the EEPROM contents from/to a binary image file.
+// Returns "false" if the file can't be read/written.
+
+bool loadEEPROM(const char* path);
+bool saveEEPROM(const char* path);
+
+}   // End namespace host
+}   // End namespace csci
+
+#endif    // INCLUDE_CSCI_HOST
@@ -0,0 +1,75 @@
+// Host (Linux) EEPROM implementation file.
+
+#include "CSCIHost.h"
+#include <EEPROM.h>
+
+EEPROMClass EEPROM;
+
+EEPROMClass::EEPROMClass()
+  : m_writeCount(0)
+{
+  memset(m_data, 0xFF, sizeof(m_data));
+}
+
+uint8_t EEPROMClass::read(int address) const
+{
+  // Addresses wrap, as on the ATmega328P.
+
+  return m_data[static_cast<unsigned int>(address) % Size];
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+  m_data[static_cast<unsigned int>(address) % Size] = value;
+  ++m_writeCount;
+
+  // An EEPROM write takes 3.3 milliseconds.
+
+  csci::host::advanceMicros(3300);
+}
+
+void EEPROMClass::update(int address, uint8_t value)
+{
+  if ( read(address) != value )
+  {
+    write(address, value);
+  }
+}
+
+namespace csci
+{
+namespace host
+{
+
+bool loadEEPROM(const char* path)
+{
+  FILE* file = fopen(path, "rb");
+
+  if ( file == NULL )
+  {
+    return false;
+  }
+
+  size_t count = fread(EEPROM.data(), 1, EEPROM.length(), file);
+  fclose(file);
+
+  return ( count == EEPROM.length() );
+}
+
+bool saveEEPROM(const char* path)
+{
+  FILE* file = fopen(path, "wb");
+
+  if ( file == NULL )
+  {
+    return false;
+  }
+
+  size_t count = fwrite(EEPROM.data(), 1, EEPROM.length(), file);
+  fclose(file);
+
+  return ( count == EEPROM.length() );
+}
+
+}   // End namespace host
+}   // End namespace csci
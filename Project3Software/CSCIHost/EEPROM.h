@@ -0,0 +1,38 @@
+#ifndef INCLUDE_CSCI_HOST_EEPROM
+#define INCLUDE_CSCI_HOST_EEPROM
+
+// Host (Linux) stand-in for the Arduino EEPROM library.  Contents
+// start erased (0xFF), like a new ATmega328P, and last until the
+// program exits (see CSCIHost.h to load/save an image file).
+
+#include <Arduino.h>
+
+class EEPROMClass
+{
+  public:
+  static const uint16_t Size = 1024;    // ATmega328P EEPROM size
+
+  EEPROMClass();
+
+  uint8_t  read(int address) const;
+  void     write(int address, uint8_t value);
+  void     update(int address, uint8_t value);
+  uint16_t length() const { return Size; }
+
+  // Returns the number of write cycles (writes that changed a byte,
+  // or any write()) since the program started.
+
+  uint32_t getWriteCount() const { return m_writeCount; }
+
+  // Raw contents (for loading/saving an image).
+
+  uint8_t* data() { return m_data; }
+
+  protected:
+  uint8_t   m_data[Size];
+  uint32_t  m_writeCount;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif    // INCLUDE_CSCI_HOST_EEPROM
@@ -0,0 +1,243 @@
+// Occupancy grid replay (csci_grid): maps a sketch's pose and range
+// telemetry into an OccupancyGrid (see CSCIUtils/CSCIOccupancyGrid.h),
+// prints the map, and checks cells of it.
+//
+// Usage: csci_grid [--cell MM] [--mount X,Y,ANGLE,SIGN]
+//                  [--free X,Y]... [--occupied X,Y]... [FILE]
+//
+//   --cell MM        Grid cell size (default 100).
+//   --mount ...      Range finder mount: X and Y (mm) from the car's
+//                    center, the servo angle that points straight
+//                    ahead, and 1 if larger angles point left, else -1
+//                    (default 140,0,90,1).
+//   --free X,Y       Check the cell at X,Y (mm) is free...
+//   --occupied X,Y   ... or occupied (csMaybe or csOccupied).
+//   FILE             csci_telemetry output (with the type column) to
+//                    read (default stdin).
+//
+// Each range record is placed at the pose record sent just before
+// it; range records without one (e.g. sent while following the line)
+// are skipped.  The map is centered on the first pose.  Exits with 1
+// if any check fails.
+//
+//   csci_telemetry capture.bin | csci_grid --occupied 350,-50 --free 150,0
+
+#include <CSCIOccupancyGrid.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace csci;
+
+struct CellCheck
+{
+  OccupancyGrid::CellState expected;
+  float                    xMM;
+  float                    yMM;
+};
+
+static int usage(const char* program)
+{
+  fprintf(stderr, "Usage: %s [--cell MM] [--mount X,Y,ANGLE,SIGN] "
+                  "[--free X,Y]... [--occupied X,Y]... [FILE]\n", program);
+  return 1;
+}
+
+static bool parseCheck(const char* text, OccupancyGrid::CellState expected, std::vector<CellCheck>& checks)
+{
+  CellCheck check = { expected, 0.0, 0.0 };
+
+  if ( sscanf(text, "%f,%f", &check.xMM, &check.yMM) != 2 )
+  {
+    return false;
+  }
+
+  checks.push_back(check);
+  return true;
+}
+
+// Print the map, top (left of the first pose's heading) first.
+
+static void printGrid(const OccupancyGrid& grid, const Pose2D& first, const Pose2D& last)
+{
+  static const char Symbols[] = { ' ', '.', '+', '#' };
+
+  int16_t startX = grid.toCell(first.xMM);
+  int16_t startY = grid.toCell(first.yMM);
+  int16_t endX = grid.toCell(last.xMM);
+  int16_t endY = grid.toCell(last.yMM);
+
+  printf("x %.0f to %.0f mm, y %.0f to %.0f mm (S start, E end, . free, + maybe, # occupied)\n",
+         grid.getOriginX() * grid.getCellSizeMM(),
+         (grid.getOriginX() + OccupancyGrid::Dim) * grid.getCellSizeMM(),
+         grid.getOriginY() * grid.getCellSizeMM(),
+         (grid.getOriginY() + OccupancyGrid::Dim) * grid.getCellSizeMM());
+
+  for ( int16_t row = OccupancyGrid::Dim - 1; row >= 0; --row )
+  {
+    int16_t cellY = grid.getOriginY() + row;
+
+    putchar('|');
+
+    for ( int16_t column = 0; column < OccupancyGrid::Dim; ++column )
+    {
+      int16_t cellX = grid.getOriginX() + column;
+
+      if ( (cellX == endX) && (cellY == endY) )
+      {
+        putchar('E');
+      }
+      else if ( (cellX == startX) && (cellY == startY) )
+      {
+        putchar('S');
+      }
+      else
+      {
+        putchar(Symbols[grid.getCell(cellX, cellY)]);
+      }
+    }
+
+    printf("|\n");
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const char* path = NULL;
+  float cellSizeMM = 100.0;
+  SensorMount mount = { 140.0, 0.0, 90, 1 };
+  std::vector<CellCheck> checks;
+
+  for ( int arg = 1; arg < argc; ++arg )
+  {
+    bool hasValue = ( arg + 1 < argc );
+
+    if ( (strcmp(argv[arg], "--cell") == 0) && hasValue )
+    {
+      if ( (cellSizeMM = static_cast<float>(atof(argv[++arg]))) <= 0.0 )
+      {
+        return usage(argv[0]);
+      }
+    }
+    else if ( (strcmp(argv[arg], "--mount") == 0) && hasValue )
+    {
+      int angle;
+      int sign;
+
+      if ( (sscanf(argv[++arg], "%f,%f,%d,%d", &mount.offsetXMM, &mount.offsetYMM, &angle, &sign) != 4) ||
+           (angle < 0) || (angle > 180) || ((sign != 1) && (sign != -1)) )
+      {
+        return usage(argv[0]);
+      }
+
+      mount.centerAngle = static_cast<uint8_t>(angle);
+      mount.angleSign = static_cast<int8_t>(sign);
+    }
+    else if ( (strcmp(argv[arg], "--free") == 0) && hasValue )
+    {
+      if ( !parseCheck(argv[++arg], OccupancyGrid::csFree, checks) )
+      {
+        return usage(argv[0]);
+      }
+    }
+    else if ( (strcmp(argv[arg], "--occupied") == 0) && hasValue )
+    {
+      if ( !parseCheck(argv[++arg], OccupancyGrid::csOccupied, checks) )
+      {
+        return usage(argv[0]);
+      }
+    }
+    else if ( (path == NULL) && (argv[arg][0] != '-') )
+    {
+      path = argv[arg];
+    }
+    else
+    {
+      return usage(argv[0]);
+    }
+  }
+
+  FILE* in = ( path != NULL ) ? fopen(path, "r") : stdin;
+
+  if ( in == NULL )
+  {
+    fprintf(stderr, "Can't read %s\n", path);
+    return 1;
+  }
+
+  OccupancyGrid grid(cellSizeMM);
+  Pose2D first = { 0.0, 0.0, 0.0 };
+  Pose2D pose = first;
+  bool mapped = false;      // Grid centered on the first pose
+  bool posed = false;       // Pose record since the last range record
+  unsigned long poses = 0;
+  unsigned long ranges = 0;
+  unsigned long skipped = 0;
+  char line[256];
+
+  while ( fgets(line, sizeof(line), in) != NULL )
+  {
+    unsigned long timeMicros;
+    unsigned int angle;
+    unsigned int rangeCM;
+
+    if ( sscanf(line, "pose,%lu,%f,%f,%f", &timeMicros, &pose.xMM, &pose.yMM, &pose.headingRad) == 4 )
+    {
+      if ( !mapped )
+      {
+        grid.clear(pose.xMM, pose.yMM);
+        first = pose;
+        mapped = true;
+      }
+
+      posed = true;
+      ++poses;
+    }
+    else if ( sscanf(line, "range,%lu,%u,%u", &timeMicros, &angle, &rangeCM) == 3 )
+    {
+      if ( !posed || (angle > 180) )
+      {
+        ++skipped;
+        continue;
+      }
+
+      grid.recenter(pose.xMM, pose.yMM);
+      grid.integrateServoReading(pose, mount, static_cast<uint8_t>(angle), static_cast<uint16_t>(rangeCM));
+      posed = false;
+      ++ranges;
+    }
+  }
+
+  if ( in != stdin )
+  {
+    fclose(in);
+  }
+
+  printGrid(grid, first, pose);
+  fprintf(stderr, "%lu poses, %lu range readings mapped, %lu skipped\n", poses, ranges, skipped);
+
+  // Checks.  "Occupied" accepts a cell seen occupied only once.
+
+  static const char* const StateNames[] = { "unknown", "free", "maybe", "occupied" };
+
+  int failed = 0;
+
+  for ( size_t index = 0; index < checks.size(); ++index )
+  {
+    const CellCheck& check = checks[index];
+    OccupancyGrid::CellState state = grid.getCellAt(check.xMM, check.yMM);
+    bool passed = ( check.expected == OccupancyGrid::csFree ) ?
+                    (state == OccupancyGrid::csFree) : (state >= OccupancyGrid::csMaybe);
+
+    printf("%s: %.0f,%.0f is %s (expected %s)\n", passed ? "ok" : "FAILED",
+           check.xMM, check.yMM, StateNames[state], StateNames[check.expected]);
+
+    if ( !passed )
+    {
+      ++failed;
+    }
+  }
+
+  return ( failed > 0 ) ? 1 : 0;
+}
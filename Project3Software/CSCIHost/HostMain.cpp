@@ -0,0 +1,151 @@
+// Host (Linux) program entry point for running a sketch natively.
+//
+// Usage: <sketch> [--seconds N] [--quiet] [--eeprom FILE]
+//                 [--record-i2c FILE] [--replay-i2c FILE]
+//
+//   --seconds N        Stop after N seconds of virtual time (default 120).
+//   --quiet            Discard Serial output.
+//   --eeprom FILE      Load EEPROM from FILE (if it exists), save at exit.
+//   --record-i2c FILE  Record the I2C traffic to FILE.
+//   --replay-i2c FILE  Answer I2C from a recording instead of the
+//                      controller models, and report how the run
+//                      differed from it (see I2CReplay.h).
+
+#include "CSCIHost.h"
+#include "PRIZMDevices.h"
+#include "I2CReplay.h"
+#include <PRIZMProfiler.h>
+
+using namespace csci;
+
+static const char* EEPROMPath = NULL;
+static FILE* I2CRecordFile = NULL;
+static host::I2CReplay* Replay = NULL;
+
+static void atExit()
+{
+  if ( EEPROMPath != NULL )
+  {
+    host::saveEEPROM(EEPROMPath);
+  }
+
+  const host::I2CStats& i2c = host::getI2CStats();
+
+  fflush(stdout);
+  fprintf(stderr, "Ran %.3f s (virtual)\n", host::nowMicros() / 1000000.0);
+  fprintf(stderr, "I2C: %u transactions, %u bytes, %.3f s on the bus\n",
+          static_cast<unsigned>(i2c.transactions), static_cast<unsigned>(i2c.bytes),
+          i2c.busMicros / 1000000.0);
+
+  if ( I2CRecordFile != NULL )
+  {
+    host::setI2CRecord(NULL);
+    fclose(I2CRecordFile);
+  }
+
+  if ( Replay != NULL )
+  {
+    Replay->report(stderr);
+  }
+
+#ifdef CSCI_I2C_PROFILE
+  host::FilePrint errors(stderr);
+
+  I2CProfile.dump(errors);
+#endif
+}
+
+int main(int argc, char** argv)
+{
+  double seconds = 120.0;
+  const char* recordPath = NULL;
+  const char* replayPath = NULL;
+
+  for ( int arg = 1; arg < argc; ++arg )
+  {
+    if ( (strcmp(argv[arg], "--seconds") == 0) && (arg + 1 < argc) )
+    {
+      seconds = atof(argv[++arg]);
+    }
+    else if ( strcmp(argv[arg], "--quiet") == 0 )
+    {
+      host::setSerialOutput(NULL);
+    }
+    else if ( (strcmp(argv[arg], "--eeprom") == 0) && (arg + 1 < argc) )
+    {
+      EEPROMPath = argv[++arg];
+      host::loadEEPROM(EEPROMPath);
+    }
+    else if ( (strcmp(argv[arg], "--record-i2c") == 0) && (arg + 1 < argc) )
+    {
+      recordPath = argv[++arg];
+    }
+    else if ( (strcmp(argv[arg], "--replay-i2c") == 0) && (arg + 1 < argc) )
+    {
+      replayPath = argv[++arg];
+    }
+    else
+    {
+      fprintf(stderr, "Usage: %s [--seconds N] [--quiet] [--eeprom FILE]\n"
+                      "         [--record-i2c FILE] [--replay-i2c FILE]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  if ( recordPath != NULL )
+  {
+    I2CRecordFile = fopen(recordPath, "w");
+
+    if ( I2CRecordFile == NULL )
+    {
+      fprintf(stderr, "Can't write %s\n", recordPath);
+      return 1;
+    }
+
+    host::setI2CRecord(I2CRecordFile);
+  }
+
+  // PRIZM Start button is on pin 8.
+
+  static host::StartButton startButton;
+
+  host::attachPin(8, &startButton);
+
+  // PRIZM DC and servo chips, and the drive train's DC EXPANSION
+  // controller (address 1).
+
+  static host::DCMotorController prizmDC;
+  static host::ServoController prizmServo;
+  static host::DCMotorController expansionDC;
+
+  static host::I2CReplay replay;
+
+  if ( replayPath != NULL )
+  {
+    std::string error;
+
+    if ( !replay.load(replayPath, error) )
+    {
+      fprintf(stderr, "%s\n", error.c_str());
+      return 1;
+    }
+
+    Replay = &replay;
+    replay.attach();
+  }
+  else
+  {
+    host::attachPRIZM(&prizmDC, &prizmServo);
+    host::attachI2C(1, &expansionDC);
+  }
+  host::setTimeLimitMicros(static_cast<uint64_t>(seconds * 1000000.0));
+
+  atexit(atExit);
+
+  setup();
+
+  while ( true )
+  {
+    loop();
+  }
+}
@@ -0,0 +1,418 @@
+// Host (Linux) I2C record/replay implementation file.
+
+#include "I2CReplay.h"
+#include <string.h>
+
+namespace csci
+{
+namespace host
+{
+
+// endTransmission() status for an address that isn't acknowledged.
+
+static const uint8_t StatusNoAddress = 2;
+
+/************************** RESPONDER ******************************/
+// The stand-in device at one address.
+
+class I2CReplay::Responder : public I2CDevice
+{
+  public:
+  Responder(I2CReplay& replay, uint8_t address) : m_replay(replay), m_address(address) { }
+
+  uint8_t receive(const uint8_t* data, uint8_t length) override
+    { return m_replay.receive(m_address, data, length); }
+
+  uint8_t request(uint8_t* data, uint8_t length) override
+    { return m_replay.request(m_address, data, length); }
+
+  protected:
+  I2CReplay&  m_replay;
+  uint8_t     m_address;
+};
+
+/************************* I2C REPLAY ******************************/
+
+I2CReplay::I2CReplay()
+  : m_next(0),
+    m_matched(0),
+    m_missing(0),
+    m_extra(0),
+    m_replayed(0),
+    m_replayedMicros(0),
+    m_clockHz(100000)
+{
+  memset(m_lastCommand, 0, sizeof(m_lastCommand));
+}
+
+I2CReplay::~I2CReplay()
+{
+  for ( size_t index = 0; index < m_responders.size(); ++index )
+  {
+    delete m_responders[index];
+  }
+}
+
+// Parse hex bytes ("-" = none).  Returns "false" if malformed.
+
+static bool parseBytes(const char* text, std::vector<uint8_t>& data)
+{
+  data.clear();
+
+  if ( strcmp(text, "-") == 0 )
+  {
+    return true;
+  }
+
+  size_t length = strlen(text);
+
+  if ( (length == 0) || (length % 2 != 0) )
+  {
+    return false;
+  }
+
+  for ( size_t index = 0; index < length; index += 2 )
+  {
+    unsigned value;
+    char pair[3] = { text[index], text[index + 1], '\0' };
+
+    if ( (strspn(pair, "0123456789abcdefABCDEF") != 2) || (sscanf(pair, "%x", &value) != 1) )
+    {
+      return false;
+    }
+
+    data.push_back(static_cast<uint8_t>(value));
+  }
+
+  return true;
+}
+
+bool I2CReplay::load(const char* path, std::string& error)
+{
+  FILE* file = fopen(path, "r");
+
+  if ( file == NULL )
+  {
+    error = std::string("Can't read ") + path;
+    return false;
+  }
+
+  uint8_t lastCommand[128] = { 0 };
+  char line[512];
+  unsigned lineNumber = 0;
+
+  m_records.clear();
+  error.clear();
+
+  while ( fgets(line, sizeof(line), file) != NULL )
+  {
+    ++lineNumber;
+
+    // Robot traces may have other output before the tag.
+
+    const char* tag = strstr(line, "@i2c ");
+
+    if ( tag == NULL )
+    {
+      continue;
+    }
+
+    Record record;
+    char kind = '\0';
+    unsigned address = 0;
+    unsigned value = 0;
+    char bytes[256] = "";
+    bool valid = false;
+
+    if ( sscanf(tag, "@i2c %c %x", &kind, &address) == 2 )
+    {
+      if ( kind == 'W' )
+      {
+        valid = ( sscanf(tag, "@i2c W %x %255s %u", &address, bytes, &value) == 3 );
+        record.status = static_cast<uint8_t>(value);
+      }
+      else if ( kind == 'R' )
+      {
+        valid = ( sscanf(tag, "@i2c R %x %x %255s", &address, &value, bytes) == 3 );
+        record.requested = static_cast<uint8_t>(value);
+      }
+    }
+
+    if ( !valid || (address >= 128) || !parseBytes(bytes, record.data) )
+    {
+      error = std::string(path) + ":" + std::to_string(lineNumber) + ": bad transaction";
+      break;
+    }
+
+    record.write = ( kind == 'W' );
+    record.address = static_cast<uint8_t>(address);
+
+    if ( record.write )
+    {
+      record.requested = 0;
+
+      if ( !record.data.empty() )
+      {
+        lastCommand[address] = record.data[0];
+      }
+    }
+    else
+    {
+      record.status = 0;
+    }
+
+    record.command = lastCommand[address];
+    m_records.push_back(record);
+  }
+
+  fclose(file);
+
+  if ( error.empty() && m_records.empty() )
+  {
+    error = std::string(path) + ": no transactions";
+  }
+
+  return error.empty();
+}
+
+void I2CReplay::attach()
+{
+  bool attached[128] = { false };
+
+  for ( size_t index = 0; index < m_records.size(); ++index )
+  {
+    uint8_t address = m_records[index].address;
+
+    if ( !attached[address] )
+    {
+      m_responders.push_back(new Responder(*this, address));
+      attachI2C(address, m_responders.back());
+      attached[address] = true;
+    }
+  }
+}
+
+uint8_t I2CReplay::receive(uint8_t address, const uint8_t* data, uint8_t length)
+{
+  Record replayed;
+
+  replayed.write = true;
+  replayed.address = address;
+  replayed.command = ( length > 0 ) ? data[0] : m_lastCommand[address];
+  replayed.status = 0;
+  replayed.requested = 0;
+  replayed.data.assign(data, data + length);
+
+  if ( length > 0 )
+  {
+    m_lastCommand[address] = data[0];
+  }
+
+  ++m_replayed;
+
+  size_t index = findMatch(replayed);
+
+  if ( index == m_records.size() )
+  {
+    diverged("extra", replayed);
+    m_replayedMicros += busMicros(replayed);
+    return 0;
+  }
+
+  matched(index);
+  m_replayedMicros += busMicros(m_records[index]);
+
+  return m_records[index].status;
+}
+
+uint8_t I2CReplay::request(uint8_t address, uint8_t* data, uint8_t length)
+{
+  Record replayed;
+
+  replayed.write = false;
+  replayed.address = address;
+  replayed.command = m_lastCommand[address];
+  replayed.status = 0;
+  replayed.requested = length;
+
+  ++m_replayed;
+  m_replayedMicros += busMicros(replayed);
+
+  size_t index = findMatch(replayed);
+  const Record* reply = NULL;
+
+  if ( index < m_records.size() )
+  {
+    reply = &m_records[index];
+    matched(index);
+  }
+  else
+  {
+    diverged("extra", replayed);
+    reply = findReply(replayed);
+  }
+
+  if ( reply == NULL )
+  {
+    memset(data, 0, length);
+    return length;
+  }
+
+  uint8_t received = ( reply->data.size() < length ) ? static_cast<uint8_t>(reply->data.size()) :
+                                                       length;
+
+  memcpy(data, reply->data.data(), received);
+  return received;
+}
+
+size_t I2CReplay::findMatch(const Record& replayed) const
+{
+  size_t end = ( m_records.size() - m_next > LookAhead ) ? m_next + LookAhead : m_records.size();
+
+  for ( size_t index = m_next; index < end; ++index )
+  {
+    const Record& record = m_records[index];
+
+    if ( (record.write == replayed.write) && (record.address == replayed.address) &&
+         (record.command == replayed.command) )
+    {
+      if ( record.write ? (record.data == replayed.data) :
+                          (record.requested == replayed.requested) )
+      {
+        return index;
+      }
+    }
+  }
+
+  return m_records.size();
+}
+
+const I2CReplay::Record* I2CReplay::findReply(const Record& replayed) const
+{
+  // The next read of the command, or failing that the last one.
+
+  const Record* reply = NULL;
+
+  for ( size_t index = 0; index < m_records.size(); ++index )
+  {
+    const Record& record = m_records[index];
+
+    if ( !record.write && (record.address == replayed.address) &&
+         (record.command == replayed.command) )
+    {
+      reply = &record;
+
+      if ( index >= m_next )
+      {
+        break;
+      }
+    }
+  }
+
+  return reply;
+}
+
+void I2CReplay::matched(size_t index)
+{
+  // Anything skipped over wasn't replayed.
+
+  for ( ; m_next < index; ++m_next )
+  {
+    ++m_missing;
+    diverged("missing", m_records[m_next]);
+  }
+
+  ++m_matched;
+  ++m_next;
+}
+
+void I2CReplay::diverged(const char* kind, const Record& record)
+{
+  if ( strcmp(kind, "extra") == 0 )
+  {
+    ++m_extra;
+  }
+
+  if ( m_descriptions.size() < MaxDescriptions )
+  {
+    char prefix[64];
+
+    snprintf(prefix, sizeof(prefix), "replayed #%lu, recorded #%lu: %s ",
+             static_cast<unsigned long>(m_replayed), static_cast<unsigned long>(m_next + 1), kind);
+    m_descriptions.push_back(prefix + describe(record));
+  }
+}
+
+uint64_t I2CReplay::busMicros(const Record& record) const
+{
+  if ( record.write )
+  {
+    return i2cBusMicros(static_cast<uint8_t>(record.data.size()),
+                        record.status != StatusNoAddress, m_clockHz);
+  }
+
+  return i2cBusMicros(record.requested, true, m_clockHz);
+}
+
+std::string I2CReplay::describe(const Record& record)
+{
+  char text[16];
+
+  snprintf(text, sizeof(text), "%c %02X ", record.write ? 'W' : 'R', record.address);
+
+  std::string description(text);
+
+  if ( !record.write )
+  {
+    snprintf(text, sizeof(text), "%02X (after %02X)", record.requested, record.command);
+    return description + text;
+  }
+
+  if ( record.data.empty() )
+  {
+    return description + "-";
+  }
+
+  for ( size_t index = 0; index < record.data.size(); ++index )
+  {
+    snprintf(text, sizeof(text), "%02X", record.data[index]);
+    description += text;
+  }
+
+  return description;
+}
+
+void I2CReplay::report(FILE* out) const
+{
+  uint64_t recordedMicros = 0;
+
+  for ( size_t index = 0; index < m_records.size(); ++index )
+  {
+    recordedMicros += busMicros(m_records[index]);
+  }
+
+  fprintf(out, "I2C replay: %lu recorded, %lu replayed, %lu matched, %lu missing, %lu extra\n",
+          static_cast<unsigned long>(m_records.size()), static_cast<unsigned long>(m_replayed),
+          static_cast<unsigned long>(m_matched), static_cast<unsigned long>(getMissing()),
+          static_cast<unsigned long>(m_extra));
+
+  for ( size_t index = 0; index < m_descriptions.size(); ++index )
+  {
+    fprintf(out, "  %s\n", m_descriptions[index].c_str());
+  }
+
+  if ( getDivergences() > m_descriptions.size() )
+  {
+    fprintf(out, "  (%lu more)\n", static_cast<unsigned long>(getDivergences() - m_descriptions.size()));
+  }
+
+  double saved = ( recordedMicros > 0 ) ?
+                   100.0 * (static_cast<double>(recordedMicros) - m_replayedMicros) / recordedMicros :
+                   0.0;
+
+  fprintf(out, "I2C replay bus time: %.3f s recorded, %.3f s replayed (%.1f%% saved)\n",
+          recordedMicros / 1000000.0, m_replayedMicros / 1000000.0, saved);
+}
+
+}   // End namespace host
+}   // End namespace csci
@@ -0,0 +1,146 @@
+#ifndef INCLUDE_CSCI_HOST_I2C_REPLAY
+#define INCLUDE_CSCI_HOST_I2C_REPLAY
+
+// Host (Linux) I2C record/replay header file.
+//
+// A trace is the Wire traffic of a run, one transaction per line:
+//
+//   @i2c W 05 4914 0       Write to address 0x05 of bytes 0x49 0x14,
+//                          endTransmission() status 0
+//   @i2c R 05 04 000005A0  Read of 4 bytes from 0x05, and the bytes
+//                          received ("-" if none)
+//
+// Other lines are ignored, so a trace can be captured from a robot's
+// Serial output (I2CProfile.setRecorder(&Serial), with
+// CSCI_I2C_PROFILE on; see TETRIX_PRIZM/PRIZMProfiler.h) along with
+// anything else the sketch sends.  A host run records with
+// setI2CRecord() (--record-i2c).
+//
+// I2CReplay stands in for every device in a trace: it answers the
+// library's transactions from the recording instead of models, and
+// compares what the library sends with what was recorded.  A change
+// to PRIZM.cpp or the drive train that should be equivalent then
+// replays with no divergences, and the report shows how much bus time
+// it saves.  A change that sends different commands (batching them,
+// say) shows up as divergences, with where they start.
+//
+// Replayed transactions are matched against the recording in order.
+// When one doesn't match, the replay looks a little way ahead for it:
+// recorded transactions skipped over are "missing", and a replayed
+// one not found is "extra".  Reads that don't match are still
+// answered with what the same command read at that point in the
+// recording (or zeros if it never did), so the run carries on.
+//
+// Only the library's I2C traffic is replayed; other inputs (the color
+// sensor, sonar, Start button) must be the same as when recording
+// for the library to do the same thing.
+
+#include "CSCIHost.h"
+#include <string>
+#include <vector>
+
+namespace csci
+{
+namespace host
+{
+
+/************************* I2C REPLAY ******************************/
+
+class I2CReplay
+{
+  public:
+  // How far ahead to look for a transaction that doesn't match, and
+  // how many divergences to describe.
+
+  static const size_t LookAhead = 16;
+  static const size_t MaxDescriptions = 20;
+
+  I2CReplay();
+  ~I2CReplay();
+
+  // Load a trace.  Returns "false" and sets "error" if it can't be
+  // read or has no transactions.
+
+  bool load(const char* path, std::string& error);
+
+  // Attach a stand-in device at every address in the trace.
+
+  void attach();
+
+  // Set the bus clock used to time transactions (Wire's, 100 kHz by
+  // default).
+
+  void setClock(uint32_t clockHz) { m_clockHz = clockHz; }
+
+  // Results so far.  Recorded transactions not replayed by the end
+  // count as missing.
+
+  size_t getMatched() const { return m_matched; }
+  size_t getMissing() const { return m_missing + (m_records.size() - m_next); }
+  size_t getExtra() const { return m_extra; }
+  size_t getDivergences() const { return getMissing() + m_extra; }
+
+  // Print a summary: transaction counts, divergences (the first
+  // MaxDescriptions described) and recorded versus replayed bus time.
+
+  void report(FILE* out) const;
+
+  protected:
+  // One recorded transaction.
+
+  struct Record
+  {
+    bool                  write;
+    uint8_t               address;
+    uint8_t               command;    // First byte written (for reads, the last one written)
+    uint8_t               status;     // Writes: endTransmission() status
+    uint8_t               requested;  // Reads: bytes requested
+    std::vector<uint8_t>  data;       // Bytes written or received
+  };
+
+  class Responder;
+
+  // Called by the stand-in devices.
+
+  uint8_t receive(uint8_t address, const uint8_t* data, uint8_t length);
+  uint8_t request(uint8_t address, uint8_t* data, uint8_t length);
+
+  // Find the next recorded transaction "replayed" matches, within
+  // LookAhead.  Returns the index, or the record count if none.
+
+  size_t findMatch(const Record& replayed) const;
+
+  // Find a recorded read of the same command to answer an unmatched
+  // read with.  Returns NULL if there's none.
+
+  const Record* findReply(const Record& replayed) const;
+
+  // Count a transaction and note a divergence.
+
+  void matched(size_t index);
+  void diverged(const char* kind, const Record& record);
+
+  // Returns the bus time of a transaction (in microseconds).
+
+  uint64_t busMicros(const Record& record) const;
+
+  static std::string describe(const Record& record);
+
+  protected:
+  std::vector<Record>       m_records;
+  std::vector<Responder*>   m_responders;
+  std::vector<std::string>  m_descriptions;
+  uint8_t                   m_lastCommand[128];     // Per address
+  size_t                    m_next;                 // Next recorded transaction to match
+  size_t                    m_matched;
+  size_t                    m_missing;
+  size_t                    m_extra;
+  size_t                    m_replayed;
+  uint64_t                  m_replayedMicros;
+  uint32_t                  m_clockHz;
+};
+
+}   // End namespace host
+}   // End namespace csci
+
+#endif    // INCLUDE_CSCI_HOST_I2C_REPLAY
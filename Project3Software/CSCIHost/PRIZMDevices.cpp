@@ -0,0 +1,678 @@
+// Host (Linux) models of the Tetrix PRIZM and EXPANSION I2C
+// controllers implementation file.
+
+#include "PRIZMDevices.h"
+#include <math.h>
+
+namespace csci
+{
+namespace host
+{
+
+// Encoder counts per degree (1440 counts per revolution).
+
+static const double CountsPerDegree = 4.0;
+
+// Firmware control tick (in microseconds).
+
+static const uint64_t TickMicros = 1000;
+
+// Reply to a firmware version read.
+
+static const uint8_t FirmwareVersion = 1;
+
+// endTransmission() status when a command is malformed.  The real
+// controllers acknowledge everything, so this only flags bad
+// commands in a host run.
+
+static const uint8_t StatusBadCommand = 3;
+
+/********************* DC MOTOR CONTROLLER *************************/
+
+DCMotorController::DCMotorController()
+  : m_enabled(false),
+    m_accelDPSS(2400.0),
+    m_batteryCentivolts(1250),
+    m_replyLength(0),
+    m_lastTickMicros(0),
+    m_commandCount(0)
+{
+  m_motors[0].shaftDegrees = 0.0;
+  m_motors[1].shaftDegrees = 0.0;
+
+  reset();
+}
+
+uint8_t DCMotorController::receive(const uint8_t* data, uint8_t length)
+{
+  // An empty write is an address probe (EXPANSION::readExpID()).
+
+  if ( length == 0 )
+  {
+    return 0;
+  }
+
+  ++m_commandCount;
+
+  uint8_t command = data[0];
+  const uint8_t* args = data + 1;
+  uint8_t argLength = length - 1;
+
+  switch ( command )
+  {
+    case 0x23:    // Watchdog stop
+    case 0x27:    // Reset
+    {
+      reset();
+      return 0;
+    }
+
+    case 0x24:    // Change address
+    {
+      return 0;
+    }
+
+    case 0x25:    // Enable
+    {
+      m_enabled = true;
+      return 0;
+    }
+
+    case 0x26:    // Firmware version
+    {
+      reply(FirmwareVersion, 1);
+      return 0;
+    }
+
+    case 0x40:    // Power
+    case 0x41:
+    {
+      if ( argLength < 1 )
+      {
+        return StatusBadCommand;
+      }
+
+      // 0x40 is motor 1.
+
+      Motor& motor = m_motors[command - 0x40];
+
+      motor.mode = mmPower;
+      motor.power = static_cast<int8_t>(args[0]);
+      motor.busy = false;
+      return 0;
+    }
+
+    case 0x42:    // Both powers
+    {
+      if ( argLength < 2 )
+      {
+        return StatusBadCommand;
+      }
+
+      for ( uint8_t number = 0; number < NumMotors; ++number )
+      {
+        m_motors[number].mode = mmPower;
+        m_motors[number].power = static_cast<int8_t>(args[number]);
+        m_motors[number].busy = false;
+      }
+      return 0;
+    }
+
+    case 0x43:    // Speed
+    case 0x44:
+    {
+      if ( argLength < 2 )
+      {
+        return StatusBadCommand;
+      }
+
+      Motor& motor = m_motors[command - 0x43];
+
+      motor.mode = mmSpeed;
+      motor.speedDPS = readInt16(args);
+      motor.busy = false;
+      return 0;
+    }
+
+    case 0x45:    // Both speeds
+    {
+      if ( argLength < 4 )
+      {
+        return StatusBadCommand;
+      }
+
+      for ( uint8_t number = 0; number < NumMotors; ++number )
+      {
+        m_motors[number].mode = mmSpeed;
+        m_motors[number].speedDPS = readInt16(args + 2 * number);
+        m_motors[number].busy = false;
+      }
+      return 0;
+    }
+
+    case 0x46:    // Count target
+    case 0x47:
+    case 0x58:    // Degree target
+    case 0x59:
+    {
+      if ( argLength < 6 )
+      {
+        return StatusBadCommand;
+      }
+
+      Motor& motor = m_motors[( command == 0x46 || command == 0x58 ) ? 0 : 1];
+      double scale = ( command < 0x58 ) ? 1.0 / CountsPerDegree : 1.0;
+
+      motor.mode = mmTarget;
+      motor.speedDPS = readInt16(args);
+      motor.targetDegrees = readInt32(args + 2) * scale;
+      motor.busy = true;
+      return 0;
+    }
+
+    case 0x48:    // Both count targets
+    case 0x5A:    // Both degree targets
+    {
+      if ( argLength < 12 )
+      {
+        return StatusBadCommand;
+      }
+
+      double scale = ( command == 0x48 ) ? 1.0 / CountsPerDegree : 1.0;
+
+      for ( uint8_t number = 0; number < NumMotors; ++number )
+      {
+        const uint8_t* motorArgs = args + 6 * number;
+
+        m_motors[number].mode = mmTarget;
+        m_motors[number].speedDPS = readInt16(motorArgs);
+        m_motors[number].targetDegrees = readInt32(motorArgs + 2) * scale;
+        m_motors[number].busy = true;
+      }
+      return 0;
+    }
+
+    case 0x49:    // Encoder counts
+    case 0x4A:
+    {
+      reply(static_cast<uint32_t>(getEncoderCount(command - 0x48)), 4);
+      return 0;
+    }
+
+    case 0x5B:    // Encoder degrees
+    case 0x5C:
+    {
+      long degrees = getEncoderCount(command - 0x5A) / 4;
+
+      reply(static_cast<uint32_t>(degrees), 4);
+      return 0;
+    }
+
+    case 0x4C:    // Reset encoder
+    case 0x4D:
+    {
+      m_motors[command - 0x4C].degrees = 0.0;
+      return 0;
+    }
+
+    case 0x4E:    // Reset both encoders
+    {
+      m_motors[0].degrees = 0.0;
+      m_motors[1].degrees = 0.0;
+      return 0;
+    }
+
+    case 0x4F:    // Busy
+    case 0x50:
+    {
+      reply(m_motors[command - 0x4F].busy ? 1 : 0, 1);
+      return 0;
+    }
+
+    case 0x51:    // Invert
+    case 0x52:
+    {
+      if ( argLength < 1 )
+      {
+        return StatusBadCommand;
+      }
+
+      m_motors[command - 0x51].invert = ( args[0] != 0 );
+      return 0;
+    }
+
+    case 0x53:    // Battery
+    {
+      reply(m_batteryCentivolts, 2);
+      return 0;
+    }
+
+    case 0x54:    // Current
+    case 0x55:
+    {
+      const Motor& motor = m_motors[command - 0x54];
+      double current = 0.0;
+
+      // Rough TorqueNADO figures: draw rises with speed and with
+      // acceleration (torque).
+
+      if ( (motor.velocityDPS != 0.0) || (motor.accelDPSS != 0.0) )
+      {
+        current = 150.0 + 0.5 * fabs(motor.velocityDPS) + 0.2 * fabs(motor.accelDPSS);
+      }
+
+      reply(static_cast<uint32_t>(current + 0.5), 2);
+      return 0;
+    }
+
+    case 0x56:    // Speed PID
+    case 0x57:    // Target PID
+    {
+      // The model's loop doesn't use the gains.
+
+      return ( argLength < 6 ) ? StatusBadCommand : 0;
+    }
+
+    default:
+    {
+      return StatusBadCommand;
+    }
+  }
+}
+
+uint8_t DCMotorController::request(uint8_t* data, uint8_t length)
+{
+  // Bytes past the reply read as 0xFF (bus idles high).
+
+  for ( uint8_t count = 0; count < length; ++count )
+  {
+    data[count] = ( count < m_replyLength ) ? m_reply[count] : 0xFF;
+  }
+
+  m_replyLength = 0;
+
+  return length;
+}
+
+void DCMotorController::advance(uint64_t nowMicros)
+{
+  while ( nowMicros - m_lastTickMicros >= TickMicros )
+  {
+    m_lastTickMicros += TickMicros;
+
+    for ( uint8_t number = 0; number < NumMotors; ++number )
+    {
+      tick(m_motors[number], TickMicros / 1000000.0);
+    }
+  }
+}
+
+void DCMotorController::setAcceleration(double dpss)
+{
+  m_accelDPSS = dpss;
+}
+
+void DCMotorController::setBatteryVolts(double volts)
+{
+  m_batteryCentivolts = static_cast<uint16_t>(volts * 100.0 + 0.5);
+}
+
+bool DCMotorController::isEnabled() const
+{
+  return m_enabled;
+}
+
+double DCMotorController::getShaftDegrees(uint8_t motor) const
+{
+  return m_motors[motor - 1].shaftDegrees;
+}
+
+double DCMotorController::getVelocityDPS(uint8_t motor) const
+{
+  const Motor& state = m_motors[motor - 1];
+
+  return state.invert ? -state.velocityDPS : state.velocityDPS;
+}
+
+long DCMotorController::getEncoderCount(uint8_t motor) const
+{
+  return static_cast<long>(m_motors[motor - 1].degrees * CountsPerDegree);
+}
+
+bool DCMotorController::isBusy(uint8_t motor) const
+{
+  return m_motors[motor - 1].busy;
+}
+
+uint32_t DCMotorController::getCommandCount() const
+{
+  return m_commandCount;
+}
+
+void DCMotorController::reset()
+{
+  for ( uint8_t number = 0; number < NumMotors; ++number )
+  {
+    Motor& motor = m_motors[number];
+
+    motor.mode = mmPower;
+    motor.power = 0;
+    motor.speedDPS = 0;
+    motor.targetDegrees = 0.0;
+    motor.invert = false;
+    motor.busy = false;
+    motor.degrees = 0.0;
+    motor.velocityDPS = 0.0;
+    motor.accelDPSS = 0.0;
+
+    // The shaft keeps its physical position.
+  }
+
+  m_enabled = false;
+  m_replyLength = 0;
+}
+
+void DCMotorController::tick(Motor& motor, double seconds)
+{
+  double desired = 0.0;
+  double accel = m_accelDPSS;
+
+  if ( m_enabled )
+  {
+    switch ( motor.mode )
+    {
+      case mmPower:
+      {
+        if ( motor.power == 125 )
+        {
+          accel *= 2.0;     // Brake
+        }
+        else
+        {
+          int power = motor.power;
+
+          power = ( power > 100 ) ? 100 : ( power < -100 ) ? -100 : power;
+          desired = FreeSpeedDPS * power / 100.0;
+
+          // Coasting down is slower than driving.
+
+          if ( power == 0 )
+          {
+            accel *= 0.25;
+          }
+        }
+        break;
+      }
+
+      case mmSpeed:
+      {
+        int speed = motor.speedDPS;
+
+        desired = ( speed > MaxSpeedDPS ) ? MaxSpeedDPS :
+                  ( speed < -MaxSpeedDPS ) ? -MaxSpeedDPS : speed;
+        break;
+      }
+
+      case mmTarget:
+      {
+        double remaining = motor.targetDegrees - motor.degrees;
+        double speed = abs(motor.speedDPS);
+
+        if ( speed > MaxSpeedDPS )
+        {
+          speed = MaxSpeedDPS;
+        }
+
+        // Fastest speed that can still stop on the target.
+
+        double stopping = sqrt(2.0 * m_accelDPSS * fabs(remaining));
+
+        if ( stopping < speed )
+        {
+          speed = stopping;
+        }
+
+        desired = ( remaining < 0.0 ) ? -speed : speed;
+        break;
+      }
+    }
+  }
+  else
+  {
+    accel *= 0.25;          // Disabled motors coast
+  }
+
+  // Ramp velocity toward the desired speed.
+
+  double step = accel * seconds;
+  double velocity = motor.velocityDPS;
+
+  if ( desired > velocity + step )
+  {
+    velocity += step;
+  }
+  else if ( desired < velocity - step )
+  {
+    velocity -= step;
+  }
+  else
+  {
+    velocity = desired;
+  }
+
+  motor.accelDPSS = (velocity - motor.velocityDPS) / seconds;
+  motor.velocityDPS = velocity;
+
+  double before = motor.degrees;
+
+  motor.degrees += velocity * seconds;
+
+  // Target moves finish within a count of the target (or on passing
+  // it), then hold there.
+
+  if ( m_enabled && (motor.mode == mmTarget) && motor.busy )
+  {
+    double remaining = motor.targetDegrees - motor.degrees;
+    bool passed = ( (motor.targetDegrees - before) * remaining <= 0.0 );
+
+    if ( passed || (fabs(remaining) < 1.0 / CountsPerDegree) )
+    {
+      motor.degrees = motor.targetDegrees;
+      motor.velocityDPS = 0.0;
+      motor.busy = false;
+    }
+  }
+
+  double moved = motor.degrees - before;
+
+  motor.shaftDegrees += motor.invert ? -moved : moved;
+}
+
+void DCMotorController::reply(uint32_t value, uint8_t length)
+{
+  for ( uint8_t count = 0; count < length; ++count )
+  {
+    m_reply[count] = static_cast<uint8_t>(value >> (8 * (length - 1 - count)));
+  }
+
+  m_replyLength = length;
+}
+
+int16_t DCMotorController::readInt16(const uint8_t* data)
+{
+  return static_cast<int16_t>((data[0] << 8) | data[1]);
+}
+
+int32_t DCMotorController::readInt32(const uint8_t* data)
+{
+  return static_cast<int32_t>((static_cast<uint32_t>(data[0]) << 24) |
+                              (static_cast<uint32_t>(data[1]) << 16) |
+                              (static_cast<uint32_t>(data[2]) << 8) |
+                              data[3]);
+}
+
+/********************** SERVO CONTROLLER ***************************/
+
+ServoController::ServoController()
+  : m_reply(0),
+    m_hasReply(false),
+    m_lastMicros(0)
+{
+  for ( uint8_t servo = 0; servo < NumServos; ++servo )
+  {
+    m_position[servo] = 90.0;
+  }
+
+  reset();
+}
+
+uint8_t ServoController::receive(const uint8_t* data, uint8_t length)
+{
+  if ( length == 0 )
+  {
+    return 0;
+  }
+
+  uint8_t command = data[0];
+  const uint8_t* args = data + 1;
+  uint8_t argLength = length - 1;
+
+  if ( (command == 0x25) || (command == 0x23) )
+  {
+    return 0;
+  }
+
+  if ( command == 0x27 )
+  {
+    reset();
+    return 0;
+  }
+
+  if ( command == 0x26 )
+  {
+    m_reply = FirmwareVersion;
+    m_hasReply = true;
+    return 0;
+  }
+
+  if ( (command >= 0x28) && (command <= 0x2D) && (argLength >= 1) )
+  {
+    m_speed[command - 0x28] = args[0];
+    return 0;
+  }
+
+  if ( (command == 0x2E) && (argLength >= NumServos) )
+  {
+    for ( uint8_t servo = 0; servo < NumServos; ++servo )
+    {
+      m_speed[servo] = args[servo];
+    }
+    return 0;
+  }
+
+  if ( (command >= 0x2F) && (command <= 0x34) && (argLength >= 1) )
+  {
+    m_command[command - 0x2F] = args[0];
+    return 0;
+  }
+
+  if ( (command == 0x35) && (argLength >= NumServos) )
+  {
+    for ( uint8_t servo = 0; servo < NumServos; ++servo )
+    {
+      m_command[servo] = args[servo];
+    }
+    return 0;
+  }
+
+  if ( (command >= 0x36) && (command <= 0x37) && (argLength >= 1) )
+  {
+    m_crSpeed[command - 0x36] = static_cast<int8_t>(args[0]);
+    return 0;
+  }
+
+  if ( (command >= 0x38) && (command <= 0x3D) )
+  {
+    m_reply = static_cast<uint8_t>(m_position[command - 0x38] + 0.5);
+    m_hasReply = true;
+    return 0;
+  }
+
+  return StatusBadCommand;
+}
+
+uint8_t ServoController::request(uint8_t* data, uint8_t length)
+{
+  for ( uint8_t count = 0; count < length; ++count )
+  {
+    data[count] = ( (count == 0) && m_hasReply ) ? m_reply : 0xFF;
+  }
+
+  m_hasReply = false;
+
+  return length;
+}
+
+void ServoController::advance(uint64_t nowMicros)
+{
+  double seconds = (nowMicros - m_lastMicros) / 1000000.0;
+
+  m_lastMicros = nowMicros;
+
+  for ( uint8_t servo = 0; servo < NumServos; ++servo )
+  {
+    double target = ( m_command[servo] > 180 ) ? 180.0 : m_command[servo];
+    double step = MaxServoDPS * m_speed[servo] / 100.0 * seconds;
+    double error = target - m_position[servo];
+
+    if ( fabs(error) <= step )
+    {
+      m_position[servo] = target;
+    }
+    else
+    {
+      m_position[servo] += ( error > 0.0 ) ? step : -step;
+    }
+  }
+}
+
+double ServoController::getPosition(uint8_t servo) const
+{
+  return m_position[servo - 1];
+}
+
+int ServoController::getCommandedPosition(uint8_t servo) const
+{
+  return m_command[servo - 1];
+}
+
+int ServoController::getCRSpeed(uint8_t crServo) const
+{
+  return m_crSpeed[crServo - 1];
+}
+
+void ServoController::reset()
+{
+  // Servos hold where they are, at full speed.
+
+  for ( uint8_t servo = 0; servo < NumServos; ++servo )
+  {
+    m_command[servo] = static_cast<uint8_t>(m_position[servo] + 0.5);
+    m_speed[servo] = 100;
+  }
+
+  m_crSpeed[0] = 0;
+  m_crSpeed[1] = 0;
+  m_hasReply = false;
+}
+
+/*************************** PRIZM *********************************/
+
+void attachPRIZM(DCMotorController* dc, ServoController* servo)
+{
+  attachI2C(5, dc);
+  attachI2C(6, servo);
+}
+
+}   // End namespace host
+}   // End namespace csci
@@ -0,0 +1,223 @@
+#ifndef INCLUDE_CSCI_HOST_PRIZM_DEVICES
+#define INCLUDE_CSCI_HOST_PRIZM_DEVICES
+
+// Host (Linux) models of the Tetrix PRIZM and EXPANSION I2C
+// controllers header file.
+//
+// The models implement the command bytes the PRIZM library sends
+// (see TETRIX_PRIZM/PRIZM.cpp), so PRIZM, EXPANSION and everything
+// built on them (TMDriveTrain, TMSmartCar) run unchanged on the host.
+// Motors and servos move with the virtual clock.
+
+#include "CSCIHost.h"
+
+namespace csci
+{
+namespace host
+{
+
+/********************* DC MOTOR CONTROLLER *************************/
+// A DCMotorController models the PRIZM DC motor chip (address 5) or a
+// DC EXPANSION controller (addresses 1 - 4): two motors with 1440
+// count per revolution encoders.
+//
+//   Command         Bytes after command      Action
+//   -------         -------------------      ------
+//   0x23                                     Watchdog stop (as reset)
+//   0x24            new address              Ignored
+//   0x25                                     Enable motors
+//   0x26                                     Read firmware version (1)
+//   0x27                                     Reset (stop, disable)
+//   0x40 / 0x41     power                    Set motor 1 / 2 power
+//   0x42            power1, power2           Set both powers
+//   0x43 / 0x44     speed (2)                Set motor 1 / 2 speed
+//   0x45            speed1 (2), speed2 (2)   Set both speeds
+//   0x46 / 0x47     speed (2), counts (4)    Set motor 1 / 2 target
+//   0x48            speed, counts (x 2)      Set both targets
+//   0x49 / 0x4A                              Read motor 1 / 2 counts (4)
+//   0x4C / 0x4D                              Reset motor 1 / 2 encoder
+//   0x4E                                     Reset both encoders
+//   0x4F / 0x50                              Read motor 1 / 2 busy (1)
+//   0x51 / 0x52     invert                   Set motor 1 / 2 invert
+//   0x53                                     Read battery (2, 10 mV)
+//   0x54 / 0x55                              Read motor 1 / 2 current (2, mA)
+//   0x56 / 0x57     P, I, D (2 each)         Set speed / target PID
+//   0x58 / 0x59     speed (2), degrees (4)   Set motor 1 / 2 degree target
+//   0x5A            speed, degrees (x 2)     Set both degree targets
+//   0x5B / 0x5C                              Read motor 1 / 2 degrees (4)
+//
+// Multi-byte values are big-endian.  Powers are -100 to 100 (125 =
+// brake), speeds are degrees per second (-720 to 720).  Motors only
+// move once enabled.  An inverted motor turns the other way, and its
+// encoder counts the other way too, so targets still work.
+//
+// The firmware's PID loop is modelled as a 1 millisecond control
+// tick: each motor's speed ramps toward its command at a limited
+// acceleration, and target moves slow down to stop on the target.
+
+class DCMotorController : public I2CDevice
+{
+  public:
+  static const uint8_t NumMotors = 2;
+
+  // Fastest commanded speed and free running speed at full power
+  // (in degrees per second).
+
+  static const int MaxSpeedDPS = 720;
+  static const int FreeSpeedDPS = 900;
+
+  DCMotorController();
+
+  // I2CDevice
+
+  uint8_t receive(const uint8_t* data, uint8_t length) override;
+  uint8_t request(uint8_t* data, uint8_t length) override;
+
+  // Device
+
+  void advance(uint64_t nowMicros) override;
+
+  // Set the motor acceleration (in degrees per second per second).
+
+  void setAcceleration(double dpss);
+
+  // Set the battery voltage reported (in volts).
+
+  void setBatteryVolts(double volts);
+
+  // Returns "true" once enabled (0x25) and not reset since.
+
+  bool isEnabled() const;
+
+  // Motor state, "motor" = 1 or 2.  Shaft degrees and velocity are
+  // physical (inversion applied); the encoder is what's reported.
+
+  double getShaftDegrees(uint8_t motor) const;
+  double getVelocityDPS(uint8_t motor) const;
+  long   getEncoderCount(uint8_t motor) const;
+  bool   isBusy(uint8_t motor) const;
+
+  // Returns the number of commands received.
+
+  uint32_t getCommandCount() const;
+
+  protected:
+  // Motor control modes.
+
+  typedef enum
+  {
+    mmPower,      // Open loop power
+    mmSpeed,      // Speed PID
+    mmTarget      // Speed PID to an encoder target
+  } MotorMode;
+
+  struct Motor
+  {
+    MotorMode mode;
+    int       power;          // Power (mmPower)
+    int       speedDPS;       // Speed (mmSpeed, mmTarget)
+    double    targetDegrees;  // Target (mmTarget)
+    bool      invert;
+    bool      busy;
+    double    degrees;        // Encoder position
+    double    shaftDegrees;   // Physical position
+    double    velocityDPS;    // Encoder velocity
+    double    accelDPSS;      // Last acceleration (for current)
+  };
+
+  // Reset motors and disable.
+
+  void reset();
+
+  // Run one control tick of "seconds".
+
+  void tick(Motor& motor, double seconds);
+
+  // Queue a reply for the next request.
+
+  void reply(uint32_t value, uint8_t length);
+
+  static int16_t readInt16(const uint8_t* data);
+  static int32_t readInt32(const uint8_t* data);
+
+  protected:
+  Motor     m_motors[NumMotors];
+  bool      m_enabled;
+  double    m_accelDPSS;
+  uint16_t  m_batteryCentivolts;
+  uint8_t   m_reply[4];
+  uint8_t   m_replyLength;
+  uint64_t  m_lastTickMicros;
+  uint32_t  m_commandCount;
+};
+
+/********************** SERVO CONTROLLER ***************************/
+// A ServoController models the PRIZM servo chip (address 6) or a
+// servo EXPANSION controller: six servos and two continuous rotation
+// (CR) servos.
+//
+//   Command         Bytes after command      Action
+//   -------         -------------------      ------
+//   0x25 / 0x27                              Enable / reset
+//   0x26                                     Read firmware version (1)
+//   0x28 - 0x2D     speed                    Set servo 1 - 6 speed
+//   0x2E            speed (x 6)              Set all speeds
+//   0x2F - 0x34     position                 Set servo 1 - 6 position
+//   0x35            position (x 6)           Set all positions
+//   0x36 / 0x37     CR speed                 Set CR servo 1 / 2 speed
+//   0x38 - 0x3D                              Read servo 1 - 6 position (1)
+//
+// Positions are 0 - 180 degrees, speeds are 0 - 100 percent of the
+// servo's top speed and CR speeds are -100 to 100.  Servos sweep
+// toward their commanded position at their speed.
+
+class ServoController : public I2CDevice
+{
+  public:
+  static const uint8_t NumServos = 6;
+  static const uint8_t NumCRServos = 2;
+
+  // Top servo speed (in degrees per second; 60 degrees in 0.2 s).
+
+  static const int MaxServoDPS = 300;
+
+  ServoController();
+
+  // I2CDevice
+
+  uint8_t receive(const uint8_t* data, uint8_t length) override;
+  uint8_t request(uint8_t* data, uint8_t length) override;
+
+  // Device
+
+  void advance(uint64_t nowMicros) override;
+
+  // Servo state, "servo" = 1 - 6 and "crServo" = 1 or 2.
+
+  double getPosition(uint8_t servo) const;
+  int    getCommandedPosition(uint8_t servo) const;
+  int    getCRSpeed(uint8_t crServo) const;
+
+  protected:
+  void reset();
+
+  protected:
+  double    m_position[NumServos];
+  uint8_t   m_command[NumServos];
+  uint8_t   m_speed[NumServos];
+  int8_t    m_crSpeed[NumCRServos];
+  uint8_t   m_reply;
+  bool      m_hasReply;
+  uint64_t  m_lastMicros;
+};
+
+/*************************** PRIZM *********************************/
+
+// Attach models of the PRIZM DC and servo chips (addresses 5 and 6).
+
+void attachPRIZM(DCMotorController* dc, ServoController* servo);
+
+}   // End namespace host
+}   // End namespace csci
+
+#endif    // INCLUDE_CSCI_HOST_PRIZM_DEVICES
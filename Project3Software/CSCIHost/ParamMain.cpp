@@ -0,0 +1,304 @@
+// Parameter tuning client (csci_param): reads and changes a running
+// sketch's tunables over its serial port (see
+// CSCIUtils/CSCIParameters.h).
+//
+// Usage: csci_param --port DEVICE [--baud N] [--timeout SECONDS]
+//                   REQUEST...
+//
+//   --port DEVICE     Serial port (e.g. /dev/ttyUSB0).
+//   --baud N          Baud rate (default 38400).
+//   --timeout SECONDS Time to wait for each reply (default 15; the
+//                     sketch only answers between line width steps,
+//                     which take longer during a detour).
+//
+// Requests are sent in order, stopping at the first error:
+//
+//   list                  All tunables
+//   get ID|NAME           One tunable
+//   set ID|NAME VALUE     Stage a new value
+//   apply                 Apply the staged values together
+//   discard               Drop the staged values
+//   commit                Save the current values to EEPROM
+//
+//   csci_param --port /dev/ttyUSB0 set SpeedFraction 0.3 set LineWidth 0.8 apply commit
+//
+// Tunables are printed as CSV (id,name,value,min,max).
+//
+// Note: Opening the port resets an Arduino.  csci_param leaves the
+//       port set so that later opens don't, so run it once (say,
+//       "csci_param --port DEVICE list" before the Start button is
+//       pressed, which times out) before tuning a run.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/select.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+struct Verb
+{
+  const char* name;
+  int         numArgs;
+};
+
+static const Verb Verbs[] =
+{
+  { "list",    0 },
+  { "get",     1 },
+  { "set",     2 },
+  { "apply",   0 },
+  { "discard", 0 },
+  { "commit",  0 }
+};
+
+static const size_t NumVerbs = sizeof(Verbs) / sizeof(Verbs[0]);
+
+static int usage(const char* program)
+{
+  fprintf(stderr, "Usage: %s --port DEVICE [--baud N] [--timeout SECONDS] REQUEST...\n"
+                  "Requests: list, get NAME, set NAME VALUE, apply, discard, commit\n", program);
+  return 1;
+}
+
+static speed_t baudSpeed(long baud)
+{
+  switch ( baud )
+  {
+    case 9600:    return B9600;
+    case 19200:   return B19200;
+    case 38400:   return B38400;
+    case 57600:   return B57600;
+    case 115200:  return B115200;
+    default:      return B0;
+  }
+}
+
+// Open "device" raw at "speed".  Returns -1 (with a message) if it
+// can't.
+
+static int openPort(const char* device, speed_t speed)
+{
+  int port = open(device, O_RDWR | O_NOCTTY);
+
+  if ( port < 0 )
+  {
+    fprintf(stderr, "Can't open %s: %s\n", device, strerror(errno));
+    return -1;
+  }
+
+  struct termios settings;
+
+  if ( tcgetattr(port, &settings) != 0 )
+  {
+    fprintf(stderr, "%s isn't a serial port\n", device);
+    close(port);
+    return -1;
+  }
+
+  cfmakeraw(&settings);
+  cfsetispeed(&settings, speed);
+  cfsetospeed(&settings, speed);
+
+  settings.c_cflag |= CLOCAL | CREAD;
+  settings.c_cflag &= ~HUPCL;         // Don't drop DTR (reset) on close
+  settings.c_cc[VMIN] = 0;
+  settings.c_cc[VTIME] = 0;
+
+  tcsetattr(port, TCSANOW, &settings);
+  tcflush(port, TCIFLUSH);
+
+  return port;
+}
+
+static double nowSeconds()
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Read a line from "port" (without the line end), waiting until
+// "deadline".  Returns "false" if none arrived in time.
+
+static bool readLine(int port, std::string& line, double deadline)
+{
+  static std::string pending;
+
+  while ( true )
+  {
+    size_t end = pending.find_first_of("\r\n");
+
+    if ( end != std::string::npos )
+    {
+      line = pending.substr(0, end);
+      pending.erase(0, end + 1);
+      return true;
+    }
+
+    double remaining = deadline - nowSeconds();
+
+    if ( remaining <= 0.0 )
+    {
+      return false;
+    }
+
+    fd_set readable;
+    struct timeval wait;
+
+    FD_ZERO(&readable);
+    FD_SET(port, &readable);
+    wait.tv_sec = static_cast<long>(remaining);
+    wait.tv_usec = static_cast<long>((remaining - wait.tv_sec) * 1e6);
+
+    if ( select(port + 1, &readable, NULL, NULL, &wait) <= 0 )
+    {
+      continue;
+    }
+
+    char buffer[256];
+    ssize_t length = read(port, buffer, sizeof(buffer));
+
+    if ( length > 0 )
+    {
+      pending.append(buffer, static_cast<size_t>(length));
+    }
+  }
+}
+
+// Send "request" and print its reply.  Returns "false" if it failed
+// or no reply came.
+
+static bool run(int port, const std::string& request, double timeout)
+{
+  static bool headerPrinted = false;
+  std::string message = "pm " + request + "\n";
+
+  if ( write(port, message.c_str(), message.size()) != static_cast<ssize_t>(message.size()) )
+  {
+    fprintf(stderr, "%s: write failed\n", request.c_str());
+    return false;
+  }
+
+  // Other output (messages, telemetry) shares the port, so only "pm"
+  // lines count.
+
+  double deadline = nowSeconds() + timeout;
+  std::string line;
+
+  while ( readLine(port, line, deadline) )
+  {
+    if ( line.compare(0, 9, "pm_param,") == 0 )
+    {
+      if ( !headerPrinted )
+      {
+        printf("id,name,value,min,max\n");
+        headerPrinted = true;
+      }
+
+      printf("%s\n", line.c_str() + 9);
+    }
+    else if ( line == "pm,ok" )
+    {
+      return true;
+    }
+    else if ( line == "pm,error" )
+    {
+      fprintf(stderr, "%s: error\n", request.c_str());
+      return false;
+    }
+  }
+
+  fprintf(stderr, "%s: no reply\n", request.c_str());
+  return false;
+}
+
+int main(int argc, char** argv)
+{
+  const char* device = NULL;
+  long baud = 38400;
+  double timeout = 15.0;
+  int arg = 1;
+
+  for ( ; (arg < argc) && (argv[arg][0] == '-'); ++arg )
+  {
+    bool hasValue = ( arg + 1 < argc );
+
+    if ( (strcmp(argv[arg], "--port") == 0) && hasValue )
+    {
+      device = argv[++arg];
+    }
+    else if ( (strcmp(argv[arg], "--baud") == 0) && hasValue )
+    {
+      baud = atol(argv[++arg]);
+    }
+    else if ( (strcmp(argv[arg], "--timeout") == 0) && hasValue )
+    {
+      timeout = atof(argv[++arg]);
+    }
+    else
+    {
+      return usage(argv[0]);
+    }
+  }
+
+  if ( (device == NULL) || (arg >= argc) || (baudSpeed(baud) == B0) || (timeout <= 0.0) )
+  {
+    return usage(argv[0]);
+  }
+
+  // Check all the requests before sending any.
+
+  for ( int check = arg; check < argc; )
+  {
+    size_t verb = 0;
+
+    while ( (verb < NumVerbs) && (strcmp(Verbs[verb].name, argv[check]) != 0) )
+    {
+      ++verb;
+    }
+
+    if ( (verb == NumVerbs) || (check + Verbs[verb].numArgs >= argc) )
+    {
+      return usage(argv[0]);
+    }
+
+    check += 1 + Verbs[verb].numArgs;
+  }
+
+  int port = openPort(device, baudSpeed(baud));
+
+  if ( port < 0 )
+  {
+    return 1;
+  }
+
+  bool ok = true;
+
+  while ( ok && (arg < argc) )
+  {
+    std::string request = argv[arg++];
+
+    for ( size_t verb = 0; verb < NumVerbs; ++verb )
+    {
+      if ( request == Verbs[verb].name )
+      {
+        for ( int count = 0; count < Verbs[verb].numArgs; ++count )
+        {
+          request += ' ';
+          request += argv[arg++];
+        }
+      }
+    }
+
+    ok = run(port, request, timeout);
+  }
+
+  close(port);
+  return ok ? 0 : 1;
+}
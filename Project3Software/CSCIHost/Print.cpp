@@ -0,0 +1,278 @@
+// Host (Linux) String, Print and HardwareSerial implementation file.
+
+#include "CSCIHost.h"
+#include <deque>
+
+/*************************** STRING ********************************/
+
+static std::string formatUnsigned(unsigned long value, unsigned char base)
+{
+  if ( base < 2 )
+  {
+    base = 10;
+  }
+
+  char buffer[8 * sizeof(unsigned long) + 1];
+  char* digit = &buffer[sizeof(buffer) - 1];
+
+  *digit = '\0';
+
+  do
+  {
+    unsigned long remainder = value % base;
+    value /= base;
+    *--digit = ( remainder < 10 ) ? ( '0' + remainder ) : ( 'A' + remainder - 10 );
+  } while ( value > 0 );
+
+  return digit;
+}
+
+static std::string formatSigned(long value, unsigned char base)
+{
+  // Like Arduino, only base 10 shows a minus sign.
+
+  if ( (base == DEC) && (value < 0) )
+  {
+    return "-" + formatUnsigned(-static_cast<unsigned long>(value), base);
+  }
+
+  return formatUnsigned(static_cast<unsigned long>(value), base);
+}
+
+static std::string formatDouble(double value, uint8_t decimals)
+{
+  if ( isnan(value) ) return "nan";
+  if ( isinf(value) ) return "inf";
+  if ( value > 4294967040.0 ) return "ovf";
+  if ( value < -4294967040.0 ) return "ovf";
+
+  std::string text;
+
+  if ( value < 0.0 )
+  {
+    text = "-";
+    value = -value;
+  }
+
+  // Round to the number of decimals, as Arduino does.
+
+  double rounding = 0.5;
+
+  for ( uint8_t count = 0; count < decimals; ++count )
+  {
+    rounding /= 10.0;
+  }
+
+  value += rounding;
+
+  unsigned long integer = static_cast<unsigned long>(value);
+  double remainder = value - static_cast<double>(integer);
+
+  text += formatUnsigned(integer, DEC);
+
+  if ( decimals > 0 )
+  {
+    text += ".";
+  }
+
+  while ( decimals-- > 0 )
+  {
+    remainder *= 10.0;
+    unsigned int digit = static_cast<unsigned int>(remainder);
+    remainder -= digit;
+    text += static_cast<char>('0' + digit);
+  }
+
+  return text;
+}
+
+String::String(int value, unsigned char base) : m_text(formatSigned(value, base)) { }
+String::String(unsigned int value, unsigned char base) : m_text(formatUnsigned(value, base)) { }
+String::String(long value, unsigned char base) : m_text(formatSigned(value, base)) { }
+String::String(unsigned long value, unsigned char base) : m_text(formatUnsigned(value, base)) { }
+String::String(double value, unsigned char decimals) : m_text(formatDouble(value, decimals)) { }
+
+/*************************** PRINT *********************************/
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+  size_t count = 0;
+
+  while ( size-- > 0 )
+  {
+    count += write(*buffer++);
+  }
+
+  return count;
+}
+
+size_t Print::print(const __FlashStringHelper* text)
+{
+  return write(reinterpret_cast<const char*>(text));
+}
+
+size_t Print::print(const String& text)
+{
+  return write(text.c_str());
+}
+
+size_t Print::print(const char* text)
+{
+  return write(text);
+}
+
+size_t Print::print(char c)
+{
+  return write(static_cast<uint8_t>(c));
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+  return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(int value, int base)
+{
+  return print(static_cast<long>(value), base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+  return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(long value, int base)
+{
+  if ( base == 0 )
+  {
+    return write(static_cast<uint8_t>(value));
+  }
+
+  return write(formatSigned(value, base).c_str());
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+  if ( base == 0 )
+  {
+    return write(static_cast<uint8_t>(value));
+  }
+
+  return printNumber(value, base);
+}
+
+size_t Print::print(double value, int decimals)
+{
+  return printFloat(value, decimals);
+}
+
+size_t Print::println()
+{
+  return write("\r\n");
+}
+
+size_t Print::printNumber(unsigned long value, uint8_t base)
+{
+  return write(formatUnsigned(value, base).c_str());
+}
+
+size_t Print::printFloat(double value, uint8_t decimals)
+{
+  return write(formatDouble(value, decimals).c_str());
+}
+
+/********************** HARDWARE SERIAL ****************************/
+
+namespace csci
+{
+namespace host
+{
+
+struct SerialState
+{
+  FILE*               output = stdout;
+  std::deque<uint8_t> input;
+  uint32_t            bytesWritten = 0;
+};
+
+static SerialState& serialState()
+{
+  static SerialState state;
+
+  return state;
+}
+
+void setSerialOutput(FILE* file)
+{
+  serialState().output = file;
+}
+
+void serialInput(const uint8_t* data, size_t length)
+{
+  serialState().input.insert(serialState().input.end(), data, data + length);
+}
+
+uint32_t getSerialBytesWritten()
+{
+  return serialState().bytesWritten;
+}
+
+}   // End namespace host
+}   // End namespace csci
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t value)
+{
+  return write(&value, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size)
+{
+  csci::host::SerialState& state = csci::host::serialState();
+
+  if ( state.output != NULL )
+  {
+    fwrite(buffer, 1, size, state.output);
+  }
+
+  state.bytesWritten += size;
+
+  return size;
+}
+
+int HardwareSerial::availableForWrite()
+{
+  // Output is never held up on the host.
+
+  return 63;
+}
+
+int HardwareSerial::available()
+{
+  csci::host::chargeCall();
+
+  return static_cast<int>(csci::host::serialState().input.size());
+}
+
+int HardwareSerial::read()
+{
+  std::deque<uint8_t>& input = csci::host::serialState().input;
+
+  if ( input.empty() )
+  {
+    return -1;
+  }
+
+  uint8_t value = input.front();
+  input.pop_front();
+
+  return value;
+}
+
+int HardwareSerial::peek()
+{
+  std::deque<uint8_t>& input = csci::host::serialState().input;
+
+  return input.empty() ? -1 : input.front();
+}
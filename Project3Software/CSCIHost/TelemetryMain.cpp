@@ -0,0 +1,294 @@
+// Telemetry decoder (csci_telemetry): turns a capture of a sketch's
+// Serial output into CSV (see CSCIUtils/CSCITelemetry.h).
+//
+// Usage: csci_telemetry [--type NAME] [FILE]
+//
+//   --type NAME  Only records of one type (color, range, encoders,
+//                state, drive, battery, pose, or a number), without
+//                the type column.
+//   FILE         Capture to read (default stdin).
+//
+// Each record is a line starting with its type, and each type's
+// column names come before its first record:
+//
+//   type,time_us,state,move_state,line_color,value
+//   state,18234112,0,0,4,1
+//
+// Text and frames that fail their CRC are skipped and counted (on
+// stderr).
+
+#include <CSCITelemetry.h>
+#include <CSCIHost.h>
+#include <map>
+#include <string>
+
+using namespace csci;
+
+struct RecordFormat
+{
+  uint8_t     type;
+  const char* name;
+  const char* columns;
+  uint8_t     length;       // Payload length
+};
+
+static const RecordFormat Formats[] =
+{
+  { tlColor,    "color",    "clear,red,green,blue,tape",          9 },
+  { tlRange,    "range",    "angle,range_cm",                     3 },
+  { tlEncoders, "encoders", "count1,count2,count3,count4",       16 },
+  { tlState,    "state",    "state,move_state,line_color,value",  4 },
+  { tlDrive,    "drive",    "move_state,speed_fraction",          3 },
+  { tlBattery,  "battery",  "volts",                              2 },
+  { tlPose,     "pose",     "x_mm,y_mm,heading_rad",              6 }
+};
+
+static const size_t NumFormats = sizeof(Formats) / sizeof(Formats[0]);
+
+static const RecordFormat* findFormat(uint8_t type)
+{
+  for ( size_t index = 0; index < NumFormats; ++index )
+  {
+    if ( Formats[index].type == type )
+    {
+      return &Formats[index];
+    }
+  }
+
+  return NULL;
+}
+
+static uint16_t getUInt16(const uint8_t* data)
+{
+  return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+static uint32_t getUInt32(const uint8_t* data)
+{
+  return getUInt16(data) | (static_cast<uint32_t>(getUInt16(data + 2)) << 16);
+}
+
+// Print a record's payload columns.
+
+static void printPayload(FILE* out, uint8_t type, const uint8_t* payload, int length)
+{
+  switch ( type )
+  {
+    case tlColor:
+      fprintf(out, "%.4f,%.4f,%.4f,%.4f,%u",
+              getUInt16(payload) / 10000.0, getUInt16(payload + 2) / 10000.0,
+              getUInt16(payload + 4) / 10000.0, getUInt16(payload + 6) / 10000.0, payload[8]);
+      break;
+
+    case tlRange:
+      fprintf(out, "%u,%u", payload[0], getUInt16(payload + 1));
+      break;
+
+    case tlEncoders:
+      fprintf(out, "%ld,%ld,%ld,%ld",
+              static_cast<long>(static_cast<int32_t>(getUInt32(payload))),
+              static_cast<long>(static_cast<int32_t>(getUInt32(payload + 4))),
+              static_cast<long>(static_cast<int32_t>(getUInt32(payload + 8))),
+              static_cast<long>(static_cast<int32_t>(getUInt32(payload + 12))));
+      break;
+
+    case tlState:
+      fprintf(out, "%u,%u,%u,%u", payload[0], payload[1], payload[2], payload[3]);
+      break;
+
+    case tlDrive:
+      fprintf(out, "%u,%.4f", payload[0], getUInt16(payload + 1) / 10000.0);
+      break;
+
+    case tlBattery:
+      fprintf(out, "%.2f", getUInt16(payload) / 100.0);
+      break;
+
+    case tlPose:
+      fprintf(out, "%d,%d,%.3f",
+              static_cast<int16_t>(getUInt16(payload)), static_cast<int16_t>(getUInt16(payload + 2)),
+              static_cast<int16_t>(getUInt16(payload + 4)) / 1000.0);
+      break;
+
+    default:
+      // Sketch records: payload in hex.
+
+      for ( int index = 0; index < length; ++index )
+      {
+        fprintf(out, "%02X", payload[index]);
+      }
+      break;
+  }
+}
+
+static int usage(const char* program)
+{
+  fprintf(stderr, "Usage: %s [--type NAME] [FILE]\n", program);
+  return 1;
+}
+
+int main(int argc, char** argv)
+{
+  const char* path = NULL;
+  int onlyType = -1;
+
+  for ( int arg = 1; arg < argc; ++arg )
+  {
+    if ( (strcmp(argv[arg], "--type") == 0) && (arg + 1 < argc) )
+    {
+      const char* name = argv[++arg];
+
+      for ( size_t index = 0; index < NumFormats; ++index )
+      {
+        if ( strcmp(Formats[index].name, name) == 0 )
+        {
+          onlyType = Formats[index].type;
+        }
+      }
+
+      if ( (onlyType < 0) && ((onlyType = atoi(name)) <= 0) )
+      {
+        return usage(argv[0]);
+      }
+    }
+    else if ( (path == NULL) && (argv[arg][0] != '-') )
+    {
+      path = argv[arg];
+    }
+    else
+    {
+      return usage(argv[0]);
+    }
+  }
+
+  FILE* in = ( path != NULL ) ? fopen(path, "rb") : stdin;
+
+  if ( in == NULL )
+  {
+    fprintf(stderr, "Can't read %s\n", path);
+    return 1;
+  }
+
+  // Collect bytes between delimiters.  Anything too long for a frame
+  // is skipped to the next delimiter.
+
+  uint8_t frame[Telemetry::MaxFrame];
+  uint8_t record[Telemetry::MaxFrame];
+  size_t frameLength = 0;
+  bool overflow = false;
+  unsigned long bad = 0;
+  std::map<int, unsigned long> counts;
+  int value;
+
+  while ( (value = fgetc(in)) != EOF )
+  {
+    if ( value != 0 )
+    {
+      if ( frameLength < sizeof(frame) )
+      {
+        frame[frameLength++] = static_cast<uint8_t>(value);
+      }
+      else
+      {
+        overflow = true;
+      }
+
+      continue;
+    }
+
+    if ( (frameLength == 0) && !overflow )
+    {
+      continue;     // Empty frame (between delimiters)
+    }
+
+    int length = overflow ? -1 : Telemetry::cobsDecode(frame, static_cast<uint8_t>(frameLength), record);
+
+    frameLength = 0;
+    overflow = false;
+
+    // Type, timestamp and CRC at least, and the CRC must check.
+
+    if ( (length < 7) ||
+         (Telemetry::crc16(record, static_cast<uint8_t>(length - 2)) !=
+          ((record[length - 2] << 8) | record[length - 1])) )
+    {
+      ++bad;
+      continue;
+    }
+
+    uint8_t type = record[0];
+    const RecordFormat* format = findFormat(type);
+    int payloadLength = length - 7;
+
+    if ( (format != NULL) && (payloadLength != format->length) )
+    {
+      ++bad;
+      continue;
+    }
+
+    if ( (onlyType >= 0) && (type != onlyType) )
+    {
+      continue;
+    }
+
+    // Column names before the first record of a type.
+
+    if ( counts[type]++ == 0 )
+    {
+      const char* columns = ( format != NULL ) ? format->columns : "payload";
+
+      if ( onlyType >= 0 )
+      {
+        printf("time_us,%s\n", columns);
+      }
+      else
+      {
+        printf("type,time_us,%s\n", columns);
+      }
+    }
+
+    if ( onlyType < 0 )
+    {
+      if ( format != NULL )
+      {
+        printf("%s,", format->name);
+      }
+      else
+      {
+        printf("%u,", type);
+      }
+    }
+
+    printf("%lu,", static_cast<unsigned long>(getUInt32(record + 1)));
+    printPayload(stdout, type, record + 5, payloadLength);
+    printf("\n");
+  }
+
+  if ( in != stdin )
+  {
+    fclose(in);
+  }
+
+  // Summary.
+
+  unsigned long total = 0;
+
+  for ( std::map<int, unsigned long>::const_iterator count = counts.begin(); count != counts.end(); ++count )
+  {
+    const RecordFormat* format = findFormat(static_cast<uint8_t>(count->first));
+
+    if ( format != NULL )
+    {
+      fprintf(stderr, "%s: %lu\n", format->name, count->second);
+    }
+    else
+    {
+      fprintf(stderr, "%d: %lu\n", count->first, count->second);
+    }
+
+    total += count->second;
+  }
+
+  fprintf(stderr, "%lu records, %lu bad frames\n", total, bad);
+  return 0;
+}
@@ -0,0 +1,94 @@
+// Host (Linux) Wire (I2C master) implementation file.
+
+#include "CSCIHost.h"
+#include <Wire.h>
+
+TwoWire Wire;
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+  m_txAddress = address;
+  m_txLength = 0;
+  m_transmitting = true;
+}
+
+uint8_t TwoWire::endTransmission(uint8_t /* sendStop */)
+{
+  m_transmitting = false;
+
+  csci::host::I2CDevice* device = csci::host::findI2C(m_txAddress);
+
+  csci::host::chargeI2C(m_txAddress, m_txLength, device != NULL, m_clock);
+
+  uint8_t status = ( device != NULL ) ? device->receive(m_txBuffer, m_txLength) :
+                                        2;    // Address not acknowledged
+
+  csci::host::recordI2CWrite(m_txAddress, m_txBuffer, m_txLength, status);
+
+  return status;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t /* sendStop */)
+{
+  m_rxIndex = 0;
+  m_rxLength = 0;
+
+  if ( quantity > BUFFER_LENGTH )
+  {
+    quantity = BUFFER_LENGTH;
+  }
+
+  csci::host::I2CDevice* device = csci::host::findI2C(address);
+
+  // The master clocks in every byte it asked for.
+
+  csci::host::chargeI2C(address, quantity, device != NULL, m_clock);
+
+  if ( device != NULL )
+  {
+    m_rxLength = device->request(m_rxBuffer, quantity);
+  }
+
+  csci::host::recordI2CRead(address, quantity, m_rxBuffer, m_rxLength);
+
+  return m_rxLength;
+}
+
+size_t TwoWire::write(uint8_t value)
+{
+  if ( !m_transmitting || (m_txLength >= BUFFER_LENGTH) )
+  {
+    return 0;
+  }
+
+  m_txBuffer[m_txLength++] = value;
+
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t quantity)
+{
+  size_t count = 0;
+
+  while ( (count < quantity) && (write(data[count]) == 1) )
+  {
+    ++count;
+  }
+
+  return count;
+}
+
+int TwoWire::available()
+{
+  return m_rxLength - m_rxIndex;
+}
+
+int TwoWire::read()
+{
+  return ( m_rxIndex < m_rxLength ) ? m_rxBuffer[m_rxIndex++] : -1;
+}
+
+int TwoWire::peek()
+{
+  return ( m_rxIndex < m_rxLength ) ? m_rxBuffer[m_rxIndex] : -1;
+}
@@ -0,0 +1,57 @@
+#ifndef INCLUDE_CSCI_HOST_WIRE
+#define INCLUDE_CSCI_HOST_WIRE
+
+// Host (Linux) stand-in for the Arduino Wire (I2C master) library.
+// Transactions are delivered to the I2CDevice attached at the
+// address (see CSCIHost.h).  With no device attached, the address
+// is not acknowledged, as on a real bus.  Each transaction moves the
+// virtual clock by its time on the bus at the set clock rate.
+
+#include <Arduino.h>
+
+#define BUFFER_LENGTH 32
+
+class TwoWire : public Stream
+{
+  public:
+  void begin() { }
+  void end() { }
+  void setClock(uint32_t clock) { m_clock = clock; }
+
+  void    beginTransmission(uint8_t address);
+  void    beginTransmission(int address) { beginTransmission(static_cast<uint8_t>(address)); }
+  uint8_t endTransmission(uint8_t sendStop = true);
+
+  uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop = true);
+  uint8_t requestFrom(int address, int quantity)
+    { return requestFrom(static_cast<uint8_t>(address), static_cast<uint8_t>(quantity)); }
+  uint8_t requestFrom(int address, int quantity, int sendStop)
+    { return requestFrom(static_cast<uint8_t>(address), static_cast<uint8_t>(quantity),
+                         static_cast<uint8_t>(sendStop)); }
+
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t* data, size_t quantity) override;
+  using Print::write;
+
+  int available() override;
+  int read() override;
+  int peek() override;
+
+  // Returns the bus clock (in Hz).
+
+  uint32_t getClock() const { return m_clock; }
+
+  protected:
+  uint32_t  m_clock = 100000;
+  uint8_t   m_txAddress = 0;
+  uint8_t   m_txBuffer[BUFFER_LENGTH];
+  uint8_t   m_txLength = 0;
+  bool      m_transmitting = false;
+  uint8_t   m_rxBuffer[BUFFER_LENGTH];
+  uint8_t   m_rxLength = 0;
+  uint8_t   m_rxIndex = 0;
+};
+
+extern TwoWire Wire;
+
+#endif    // INCLUDE_CSCI_HOST_WIRE
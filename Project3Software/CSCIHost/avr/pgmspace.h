@@ -0,0 +1,23 @@
+#ifndef INCLUDE_CSCI_HOST_PGMSPACE
+#define INCLUDE_CSCI_HOST_PGMSPACE
+
+// Host (Linux) stand-in for <avr/pgmspace.h>.  There is only one
+// address space on the host, so program memory is ordinary memory.
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)               (s)
+
+#define pgm_read_byte(addr)   (*reinterpret_cast<const uint8_t*>(addr))
+#define pgm_read_word(addr)   (*reinterpret_cast<const uint16_t*>(addr))
+#define pgm_read_dword(addr)  (*reinterpret_cast<const uint32_t*>(addr))
+#define pgm_read_float(addr)  (*reinterpret_cast<const float*>(addr))
+#define pgm_read_ptr(addr)    (*reinterpret_cast<void* const*>(addr))
+
+#define memcpy_P              memcpy
+#define strlen_P              strlen
+#define strcpy_P              strcpy
+
+#endif    // INCLUDE_CSCI_HOST_PGMSPACE
@@ -0,0 +1,21 @@
+#ifndef INCLUDE_CSCI_HOST_WDT
+#define INCLUDE_CSCI_HOST_WDT
+
+// Host (Linux) stand-in for <avr/wdt.h>.  Enabling the watchdog is
+// how the PRIZM library resets the board (PrizmEnd()), so on the
+// host wdt_enable() ends the program.
+
+#define WDTO_15MS   0
+#define WDTO_30MS   1
+#define WDTO_60MS   2
+#define WDTO_120MS  3
+#define WDTO_250MS  4
+#define WDTO_500MS  5
+#define WDTO_1S     6
+#define WDTO_2S     7
+
+void wdt_enable(int timeout);
+void wdt_disable();
+void wdt_reset();
+
+#endif    // INCLUDE_CSCI_HOST_WDT
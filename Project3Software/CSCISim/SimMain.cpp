@@ -0,0 +1,272 @@
+// Simulator program entry point: runs a sketch against a world.
+//
+// Usage: <sketch>Sim --world FILE [--seed N] [--seconds N] [--slip X]
+//                    [--set KEY=VALUE] [--tune NAME=VALUE] [--trace FILE]
+//                    [--record-i2c FILE] [--quiet] [--eeprom FILE]
+//        <sketch>Sim --tunables
+//
+//   --world FILE    World to drive in (see World.h).
+//   --seed N        Noise seed (default 1).  Same seed, same run.
+//   --seconds N     Time limit in virtual seconds (default 300).
+//   --slip X        Random wheel slip (std deviation, fraction).
+//   --set KEY=VALUE Set a robot parameter (see Simulator.h).
+//   --tune NAME=VALUE
+//                   Set one of the sketch's tunables (see CSCITunable.h).
+//   --tunables      List the sketch's tunables and their defaults.
+//   --trace FILE    Write the robot's pose (CSV) every 50 ms.
+//   --record-i2c FILE
+//                   Record the I2C traffic (see I2CReplay.h).
+//   --quiet         Discard Serial output.
+//   --eeprom FILE   Load EEPROM from FILE (if it exists), save at exit.
+//
+// The run's metrics are written to stderr as one line of key=value
+// pairs, for scripts to collect:
+//
+//   result=finished seconds=84.212 lap=81.870 distance=6120.4 losses=2 x=... y=... heading=... seed=1
+
+#include "Simulator.h"
+#include <CSCITunable.h>
+#include <PRIZMProfiler.h>
+#include <string>
+
+using namespace csci;
+
+static sim::Simulator* Sim = NULL;
+static const char* EEPROMPath = NULL;
+static FILE* TraceFile = NULL;
+static FILE* I2CRecordFile = NULL;
+static uint64_t TimeLimitMicros = 0;
+static uint32_t Seed = 1;
+
+static void atExit()
+{
+  if ( EEPROMPath != NULL )
+  {
+    host::saveEEPROM(EEPROMPath);
+  }
+
+  fflush(stdout);
+
+  if ( Sim == NULL )
+  {
+    return;
+  }
+
+  Sim->end(host::nowMicros() >= TimeLimitMicros);
+
+  const sim::Simulator::Metrics& metrics = Sim->getMetrics();
+
+  fprintf(stderr, "result=%s seconds=%.3f lap=%.3f distance=%.1f losses=%u "
+                  "x=%.1f y=%.1f heading=%.1f seed=%u\n",
+          sim::Simulator::resultName(metrics.result),
+          metrics.seconds, metrics.lapSeconds, metrics.distance, metrics.lineLosses,
+          metrics.pose.x, metrics.pose.y, metrics.pose.heading,
+          static_cast<unsigned>(Seed));
+
+  if ( TraceFile != NULL )
+  {
+    fclose(TraceFile);
+  }
+
+  if ( I2CRecordFile != NULL )
+  {
+    host::setI2CRecord(NULL);
+    fclose(I2CRecordFile);
+  }
+
+#ifdef CSCI_I2C_PROFILE
+  host::FilePrint errors(stderr);
+
+  I2CProfile.dump(errors);
+#endif
+}
+
+static int usage(const char* program)
+{
+  fprintf(stderr, "Usage: %s --world FILE [--seed N] [--seconds N] [--slip X]\n"
+                  "         [--set KEY=VALUE] [--tune NAME=VALUE] [--trace FILE]\n"
+                  "         [--record-i2c FILE] [--quiet] [--eeprom FILE]\n"
+                  "       %s --tunables\n",
+          program, program);
+  return 1;
+}
+
+// Set a tunable from "NAME=VALUE".  Returns "false" if there's no
+// such tunable.
+
+static bool setTunable(const std::string& setting)
+{
+  size_t equals = setting.find('=');
+
+  if ( equals == std::string::npos )
+  {
+    return false;
+  }
+
+  Tunable* tunable = Tunable::find(setting.substr(0, equals).c_str());
+
+  if ( tunable == NULL )
+  {
+    return false;
+  }
+
+  *tunable = atof(setting.c_str() + equals + 1);
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  const char* worldPath = NULL;
+  const char* tracePath = NULL;
+  const char* recordPath = NULL;
+  double seconds = 300.0;
+  sim::RobotParams params;
+  std::vector<std::string> settings;
+
+  for ( int arg = 1; arg < argc; ++arg )
+  {
+    bool hasValue = ( arg + 1 < argc );
+
+    if ( (strcmp(argv[arg], "--world") == 0) && hasValue )
+    {
+      worldPath = argv[++arg];
+    }
+    else if ( (strcmp(argv[arg], "--seed") == 0) && hasValue )
+    {
+      Seed = static_cast<uint32_t>(strtoul(argv[++arg], NULL, 0));
+    }
+    else if ( (strcmp(argv[arg], "--seconds") == 0) && hasValue )
+    {
+      seconds = atof(argv[++arg]);
+    }
+    else if ( (strcmp(argv[arg], "--slip") == 0) && hasValue )
+    {
+      settings.push_back(std::string("slip=") + argv[++arg]);
+    }
+    else if ( (strcmp(argv[arg], "--set") == 0) && hasValue )
+    {
+      settings.push_back(argv[++arg]);
+    }
+    else if ( (strcmp(argv[arg], "--tune") == 0) && hasValue )
+    {
+      if ( !setTunable(argv[++arg]) )
+      {
+        fprintf(stderr, "Bad tunable: %s\n", argv[arg]);
+        return 1;
+      }
+    }
+    else if ( strcmp(argv[arg], "--tunables") == 0 )
+    {
+      for ( Tunable* tunable = Tunable::first(); tunable != NULL; tunable = tunable->next() )
+      {
+        printf("%s=%g\n", tunable->getName(), tunable->getDefault());
+      }
+
+      return 0;
+    }
+    else if ( (strcmp(argv[arg], "--trace") == 0) && hasValue )
+    {
+      tracePath = argv[++arg];
+    }
+    else if ( (strcmp(argv[arg], "--record-i2c") == 0) && hasValue )
+    {
+      recordPath = argv[++arg];
+    }
+    else if ( strcmp(argv[arg], "--quiet") == 0 )
+    {
+      host::setSerialOutput(NULL);
+    }
+    else if ( (strcmp(argv[arg], "--eeprom") == 0) && hasValue )
+    {
+      EEPROMPath = argv[++arg];
+      host::loadEEPROM(EEPROMPath);
+    }
+    else
+    {
+      return usage(argv[0]);
+    }
+  }
+
+  if ( worldPath == NULL )
+  {
+    return usage(argv[0]);
+  }
+
+  static sim::World world;
+  std::string error;
+
+  if ( !world.load(worldPath, error) )
+  {
+    fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+
+  // World file parameters first, then the command line.
+
+  std::map<std::string, double>::const_iterator param = world.getRobotParams().begin();
+
+  for ( ; param != world.getRobotParams().end(); ++param )
+  {
+    if ( !params.set(param->first, param->second) )
+    {
+      fprintf(stderr, "%s: unknown robot parameter %s\n", worldPath, param->first.c_str());
+      return 1;
+    }
+  }
+
+  for ( size_t index = 0; index < settings.size(); ++index )
+  {
+    size_t equals = settings[index].find('=');
+
+    if ( (equals == std::string::npos) ||
+         !params.set(settings[index].substr(0, equals),
+                     atof(settings[index].c_str() + equals + 1)) )
+    {
+      fprintf(stderr, "Bad robot parameter: %s\n", settings[index].c_str());
+      return 1;
+    }
+  }
+
+  static sim::Simulator simulator(world, params, Seed);
+
+  Sim = &simulator;
+  simulator.attach();
+
+  if ( tracePath != NULL )
+  {
+    TraceFile = fopen(tracePath, "w");
+
+    if ( TraceFile == NULL )
+    {
+      fprintf(stderr, "Can't write %s\n", tracePath);
+      return 1;
+    }
+
+    simulator.setTrace(TraceFile);
+  }
+
+  if ( recordPath != NULL )
+  {
+    I2CRecordFile = fopen(recordPath, "w");
+
+    if ( I2CRecordFile == NULL )
+    {
+      fprintf(stderr, "Can't write %s\n", recordPath);
+      return 1;
+    }
+
+    host::setI2CRecord(I2CRecordFile);
+  }
+
+  TimeLimitMicros = static_cast<uint64_t>(seconds * 1000000.0);
+  host::setTimeLimitMicros(TimeLimitMicros);
+
+  atexit(atExit);
+
+  setup();
+
+  while ( true )
+  {
+    loop();
+  }
+}
@@ -0,0 +1,424 @@
+// Whole robot simulator implementation file.
+
+#include "Simulator.h"
+#include <math.h>
+
+namespace csci
+{
+namespace sim
+{
+
+static const double Pi = 3.14159265358979323846;
+static const double DegreesToRadians = Pi / 180.0;
+
+// Kinematics tick (in microseconds).
+
+static const uint64_t TickMicros = 1000;
+
+// Spacing of the points checked along the robot's outline (mm).
+
+static const double OutlineStep = 20.0;
+
+/*********************** ROBOT PARAMETERS **************************/
+
+RobotParams::RobotParams()
+  : halfLength(165.0),
+    halfWidth(165.0),
+    wheelDiameter(98.0),
+    spinRadius(273.0),          // Matches TMDriveTrain spins
+    fbEfficiency(35.5 / 36.0),  // Matches CSCI_DTrain_Params.h
+    lrEfficiency(32.75 / 36.0),
+    slip(0.02),
+    slipMillis(100.0),
+    colorOffset(120.0),
+    colorNoise(0.02),
+    whiteClicks(2.0),           // PrizmBegin(), then white balance
+    sonarOffset(140.0),
+    sonarPin(5.0),              // TMSmartCar default range finder port
+    sonarServo(1.0),
+    sonarBeam(15.0),
+    sonarMaxCM(300.0),
+    sonarNoiseCM(0.5),
+    lineLossMillis(1000.0)
+{
+}
+
+bool RobotParams::set(const std::string& key, double value)
+{
+  struct Entry
+  {
+    const char* name;
+    double RobotParams::* member;
+  };
+
+  static const Entry Entries[] =
+  {
+    { "halfLength",     &RobotParams::halfLength },
+    { "halfWidth",      &RobotParams::halfWidth },
+    { "wheelDiameter",  &RobotParams::wheelDiameter },
+    { "spinRadius",     &RobotParams::spinRadius },
+    { "fbEfficiency",   &RobotParams::fbEfficiency },
+    { "lrEfficiency",   &RobotParams::lrEfficiency },
+    { "slip",           &RobotParams::slip },
+    { "slipMillis",     &RobotParams::slipMillis },
+    { "colorOffset",    &RobotParams::colorOffset },
+    { "colorNoise",     &RobotParams::colorNoise },
+    { "whiteClicks",    &RobotParams::whiteClicks },
+    { "sonarOffset",    &RobotParams::sonarOffset },
+    { "sonarPin",       &RobotParams::sonarPin },
+    { "sonarServo",     &RobotParams::sonarServo },
+    { "sonarBeam",      &RobotParams::sonarBeam },
+    { "sonarMaxCM",     &RobotParams::sonarMaxCM },
+    { "sonarNoiseCM",   &RobotParams::sonarNoiseCM },
+    { "lineLossMillis", &RobotParams::lineLossMillis }
+  };
+
+  for ( size_t index = 0; index < sizeof(Entries) / sizeof(Entries[0]); ++index )
+  {
+    if ( key == Entries[index].name )
+    {
+      this->*Entries[index].member = value;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/************************** SIMULATOR ******************************/
+
+Simulator::Simulator(const World& world, const RobotParams& params, uint32_t seed)
+  : m_World(world),
+    m_params(params),
+    m_random(seed),
+    m_colorSensor(*this),
+    m_rangeFinder(*this),
+    m_pose(world.getStart()),
+    m_lastTickMicros(0),
+    m_nextSlipMicros(0),
+    m_moveMicros(0),
+    m_offTapeMicros(0),
+    m_moved(false),
+    m_trace(NULL),
+    m_tracePeriodMicros(50000),
+    m_nextTraceMicros(0)
+{
+  m_metrics.result = srRunning;
+  m_metrics.seconds = 0.0;
+  m_metrics.lapSeconds = 0.0;
+  m_metrics.distance = 0.0;
+  m_metrics.lineLosses = 0;
+  m_metrics.pose = m_pose;
+
+  m_slip[0] = 1.0;
+  m_slip[1] = 1.0;
+  m_slip[2] = 1.0;
+}
+
+void Simulator::attach()
+{
+  // Controllers first, so motors move before the robot does.
+
+  host::attachPRIZM(&m_prizmDC, &m_prizmServo);
+  host::attachI2C(1, &m_expansionDC);
+  host::attachPin(8, &m_startButton);
+  host::attachPin(static_cast<uint8_t>(m_params.sonarPin), &m_rangeFinder);
+  host::attachColorSensor(&m_colorSensor);
+  host::addDevice(this);
+
+  // PRIZM battery input (A0) reads a charged 12.5 V battery.
+
+  host::setAnalogInput(0, 625);
+}
+
+void Simulator::setTrace(FILE* file, uint32_t periodMillis)
+{
+  m_trace = file;
+  m_tracePeriodMicros = static_cast<uint64_t>(periodMillis) * 1000;
+  m_nextTraceMicros = host::nowMicros();
+
+  if ( m_trace != NULL )
+  {
+    fprintf(m_trace, "seconds,x,y,heading,surface\n");
+  }
+}
+
+void Simulator::end(bool timedOut)
+{
+  if ( m_metrics.result == srRunning )
+  {
+    m_metrics.result = timedOut ? srTimeout : srFinished;
+  }
+
+  uint64_t now = host::nowMicros();
+
+  m_metrics.seconds = now / 1000000.0;
+  m_metrics.lapSeconds = m_moved ? (now - m_moveMicros) / 1000000.0 : 0.0;
+  m_metrics.pose = m_pose;
+}
+
+void Simulator::advance(uint64_t nowMicros)
+{
+  while ( nowMicros - m_lastTickMicros >= TickMicros )
+  {
+    m_lastTickMicros += TickMicros;
+
+    tick(TickMicros / 1000000.0);
+
+    if ( collides() )
+    {
+      m_metrics.result = srCollision;
+
+      // Ends the run (the exit handler reports it).
+
+      exit(0);
+    }
+  }
+
+  while ( (m_trace != NULL) && (nowMicros >= m_nextTraceMicros) )
+  {
+    double colorX = m_pose.x + m_params.colorOffset * cos(m_pose.heading * DegreesToRadians);
+    double colorY = m_pose.y + m_params.colorOffset * sin(m_pose.heading * DegreesToRadians);
+
+    fprintf(m_trace, "%.3f,%.1f,%.1f,%.1f,%s\n", m_nextTraceMicros / 1000000.0,
+            m_pose.x, m_pose.y, m_pose.heading,
+            m_World.surfaceAt(colorX, colorY).name.c_str());
+
+    m_nextTraceMicros += m_tracePeriodMicros;
+  }
+}
+
+const char* Simulator::resultName(Result result)
+{
+  switch ( result )
+  {
+    case srRunning:   return "running";
+    case srFinished:  return "finished";
+    case srCollision: return "collision";
+    case srTimeout:   return "timeout";
+  }
+
+  return "unknown";
+}
+
+void Simulator::tick(double seconds)
+{
+  double fl = wheelSpeed(m_prizmDC, 1, true);
+  double fr = wheelSpeed(m_prizmDC, 2, false);
+  double rl = wheelSpeed(m_expansionDC, 1, true);
+  double rr = wheelSpeed(m_expansionDC, 2, false);
+
+  if ( !m_moved && ((fl != 0.0) || (fr != 0.0) || (rl != 0.0) || (rr != 0.0)) )
+  {
+    m_moved = true;
+    m_moveMicros = m_lastTickMicros;
+  }
+
+  // New random slip every slipMillis.
+
+  if ( m_lastTickMicros >= m_nextSlipMicros )
+  {
+    for ( int axis = 0; axis < 3; ++axis )
+    {
+      m_slip[axis] = 1.0 + noise(m_params.slip);
+    }
+
+    m_nextSlipMicros = m_lastTickMicros + static_cast<uint64_t>(m_params.slipMillis * 1000.0);
+  }
+
+  // Mecanum kinematics (robot frame: x forward, y left).
+
+  double forward = m_params.fbEfficiency * m_slip[0] * (fl + fr + rl + rr) / 4.0;
+  double sideways = m_params.lrEfficiency * m_slip[1] * (-fl + fr + rl - rr) / 4.0;
+  double spin = m_slip[2] * (-fl + fr - rl + rr) / (4.0 * m_params.spinRadius);
+
+  double heading = m_pose.heading * DegreesToRadians;
+  double dx = (forward * cos(heading) - sideways * sin(heading)) * seconds;
+  double dy = (forward * sin(heading) + sideways * cos(heading)) * seconds;
+
+  m_pose.x += dx;
+  m_pose.y += dy;
+  m_pose.heading = fmod(m_pose.heading + spin * seconds / DegreesToRadians, 360.0);
+
+  if ( m_pose.heading < 0.0 )
+  {
+    m_pose.heading += 360.0;
+  }
+
+  m_metrics.distance += sqrt(dx * dx + dy * dy);
+
+  // Count each time the color sensor stays off the tape too long.
+
+  if ( m_moved )
+  {
+    const Surface& surface =
+      m_World.surfaceAt(m_pose.x + m_params.colorOffset * cos(m_pose.heading * DegreesToRadians),
+                        m_pose.y + m_params.colorOffset * sin(m_pose.heading * DegreesToRadians));
+    uint64_t lossMicros = static_cast<uint64_t>(m_params.lineLossMillis * 1000.0);
+
+    if ( &surface != &m_World.getFloor() )
+    {
+      m_offTapeMicros = 0;
+    }
+    else if ( m_offTapeMicros < lossMicros )
+    {
+      m_offTapeMicros += TickMicros;
+
+      if ( m_offTapeMicros >= lossMicros )
+      {
+        ++m_metrics.lineLosses;
+      }
+    }
+  }
+}
+
+bool Simulator::collides() const
+{
+  double heading = m_pose.heading * DegreesToRadians;
+  double cosine = cos(heading);
+  double sine = sin(heading);
+
+  // Walk the outline: corners and points between them.
+
+  const double corners[5][2] =
+  {
+    {  m_params.halfLength,  m_params.halfWidth },
+    { -m_params.halfLength,  m_params.halfWidth },
+    { -m_params.halfLength, -m_params.halfWidth },
+    {  m_params.halfLength, -m_params.halfWidth },
+    {  m_params.halfLength,  m_params.halfWidth }
+  };
+
+  for ( int side = 0; side < 4; ++side )
+  {
+    double sx = corners[side + 1][0] - corners[side][0];
+    double sy = corners[side + 1][1] - corners[side][1];
+    int steps = static_cast<int>(ceil(sqrt(sx * sx + sy * sy) / OutlineStep));
+
+    for ( int step = 0; step < steps; ++step )
+    {
+      double bx = corners[side][0] + sx * step / steps;
+      double by = corners[side][1] + sy * step / steps;
+
+      if ( m_World.isBlocked(m_pose.x + bx * cosine - by * sine,
+                             m_pose.y + bx * sine + by * cosine) )
+      {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+double Simulator::wheelSpeed(host::DCMotorController& controller, uint8_t motor, bool left) const
+{
+  double dps = controller.getVelocityDPS(motor);
+
+  return ( left ? -dps : dps ) * Pi * m_params.wheelDiameter / 360.0;
+}
+
+double Simulator::noise(double deviation)
+{
+  if ( deviation <= 0.0 )
+  {
+    return 0.0;
+  }
+
+  std::normal_distribution<double> distribution(0.0, deviation);
+
+  return distribution(m_random);
+}
+
+/************************ COLOR SENSOR *****************************/
+
+void Simulator::ColorSensor::getRawData(uint16_t& r, uint16_t& g, uint16_t& b, uint16_t& c)
+{
+  static const Surface White = { "white", 1000, 1000, 1000, 3000, 255, 255, 255 };
+
+  const Pose& pose = m_Sim.m_pose;
+  double heading = pose.heading * DegreesToRadians;
+
+  // The robot is held over white tape (for white balance) until the
+  // Start button has been clicked "whiteClicks" times.
+
+  bool held = ( m_Sim.m_startButton.getClickCount() < m_Sim.m_params.whiteClicks );
+
+  const Surface& surface = held ? White :
+    m_Sim.m_World.surfaceAt(pose.x + m_Sim.m_params.colorOffset * cos(heading),
+                            pose.y + m_Sim.m_params.colorOffset * sin(heading));
+
+  const uint16_t raw[4] = { surface.r, surface.g, surface.b, surface.c };
+  uint16_t* out[4] = { &r, &g, &b, &c };
+
+  for ( int channel = 0; channel < 4; ++channel )
+  {
+    double value = raw[channel] * (1.0 + m_Sim.noise(m_Sim.m_params.colorNoise));
+
+    *out[channel] = static_cast<uint16_t>( value < 0.0 ? 0.0 : value > 65535.0 ? 65535.0 : value );
+  }
+}
+
+/************************ RANGE FINDER *****************************/
+
+unsigned long Simulator::RangeFinder::pulseIn(uint8_t, uint8_t, unsigned long timeout,
+                                              unsigned long& elapsedMicros)
+{
+  const unsigned long NoEchoMicros = 18500;
+  const unsigned long EchoDelayMicros = 450;      // Trigger to echo start
+  const double MicrosPerCM = 58.0;                // Out and back
+
+  const RobotParams& params = m_Sim.m_params;
+  const Pose& pose = m_Sim.m_pose;
+  double heading = pose.heading * DegreesToRadians;
+  double x = pose.x + params.sonarOffset * cos(heading);
+  double y = pose.y + params.sonarOffset * sin(heading);
+
+  // Servo at 90 degrees points straight ahead; larger angles turn
+  // the range finder left.
+
+  double bearing = pose.heading;
+
+  if ( params.sonarServo >= 1.0 )
+  {
+    bearing += m_Sim.m_prizmServo.getPosition(static_cast<uint8_t>(params.sonarServo)) - 90.0;
+  }
+
+  // Nearest echo across the beam.
+
+  const int Rays = 5;
+  double maxRange = params.sonarMaxCM * 10.0;
+  double nearest = -1.0;
+
+  for ( int ray = 0; ray < Rays; ++ray )
+  {
+    double offset = params.sonarBeam * (ray / static_cast<double>(Rays - 1) - 0.5);
+    double range = m_Sim.m_World.raycast(x, y, bearing + offset, maxRange);
+
+    if ( (range >= 0.0) && ((nearest < 0.0) || (range < nearest)) )
+    {
+      nearest = range;
+    }
+  }
+
+  if ( nearest < 0.0 )
+  {
+    elapsedMicros = ( timeout < NoEchoMicros ) ? timeout : NoEchoMicros;
+    return 0;
+  }
+
+  double cm = nearest / 10.0 + m_Sim.noise(params.sonarNoiseCM);
+  unsigned long duration = static_cast<unsigned long>(( cm < 0.0 ? 0.0 : cm ) * MicrosPerCM);
+
+  if ( EchoDelayMicros + duration > timeout )
+  {
+    elapsedMicros = timeout;
+    return 0;
+  }
+
+  elapsedMicros = EchoDelayMicros + duration;
+  return duration;
+}
+
+}   // End namespace sim
+}   // End namespace csci
@@ -0,0 +1,187 @@
+#ifndef INCLUDE_CSCI_SIM_SIMULATOR
+#define INCLUDE_CSCI_SIM_SIMULATOR
+
+// Whole robot simulator header file.
+//
+// A Simulator puts a simulated Tetrix mecanum robot in a World and
+// connects it to the host platform, so a sketch built for the host
+// drives it:
+//
+//   - PRIZM DC and servo chips and the DC EXPANSION (address 1) are
+//     PRIZMDevices models.  Wheel speeds come from their motors.
+//   - The TCS34725 color sensor reads the surface under it.
+//   - The ultrasonic range finder (on a pin, optionally turned by a
+//     servo) measures the distance to obstacles and walls.
+//   - The Start button clicks itself (see host::StartButton).
+//
+// Everything runs on the virtual clock, and all noise comes from one
+// seeded generator, so a run is repeatable given its seed.
+//
+// Wheel motors (forward = the wheel driving the robot forward):
+//
+//   Front left   PRIZM motor 1       Rear left    EXPANSION motor 1
+//   Front right  PRIZM motor 2       Rear right   EXPANSION motor 2
+//
+// Left motors turn backwards (positive shaft = reverse) so the drive
+// train inverts them for forward, as on the real robot.
+
+#include "World.h"
+#include <CSCIHost.h>
+#include <PRIZMDevices.h>
+#include <random>
+
+namespace csci
+{
+namespace sim
+{
+
+/*********************** ROBOT PARAMETERS **************************/
+// Robot geometry, slip and sensor parameters.  Each can be set with
+// "robot KEY VALUE" in the world file; keys are the member names.
+
+struct RobotParams
+{
+  double halfLength;      // Body half length (mm)
+  double halfWidth;       // Body half width (mm)
+  double wheelDiameter;   // Wheel diameter (mm)
+  double spinRadius;      // Wheel travel per radian of spin (mm)
+  double fbEfficiency;    // Forward/back travel per wheel travel
+  double lrEfficiency;    // Sideways travel per wheel travel
+  double slip;            // Random slip (std deviation, fraction)
+  double slipMillis;      // Time each random slip lasts
+  double colorOffset;     // Color sensor ahead of center (mm)
+  double colorNoise;      // Color reading noise (std deviation, fraction)
+  double whiteClicks;     // Start button clicks the robot is held over
+                          // white tape for (calibration)
+  double sonarOffset;     // Range finder ahead of center (mm)
+  double sonarPin;        // Range finder pin
+  double sonarServo;      // Servo turning the range finder (0 = none)
+  double sonarBeam;       // Beam width (degrees)
+  double sonarMaxCM;      // Longest echo (cm)
+  double sonarNoiseCM;    // Range noise (std deviation, cm)
+  double lineLossMillis;  // Time off the tape counted as losing the line
+
+  RobotParams();
+
+  // Set a parameter by name.  Returns "false" if there's no such key.
+
+  bool set(const std::string& key, double value);
+};
+
+/************************** SIMULATOR ******************************/
+
+class Simulator : public host::Device
+{
+  public:
+  // How a run ended.
+
+  typedef enum
+  {
+    srRunning,      // Still running
+    srFinished,     // Sketch ended the run (exit or PRIZM reset)
+    srCollision,    // Robot hit an obstacle or wall
+    srTimeout       // Time limit reached
+  } Result;
+
+  // Run metrics.
+
+  struct Metrics
+  {
+    Result    result;
+    double    seconds;        // Virtual time
+    double    lapSeconds;     // Time since the robot first moved
+    double    distance;       // Distance the center travelled (mm)
+    unsigned  lineLosses;     // Times the color sensor was off the tape
+                              // (over the floor) for lineLossMillis
+    Pose      pose;           // Final pose
+  };
+
+  Simulator(const World& world, const RobotParams& params, uint32_t seed);
+
+  // Attach the robot's devices to the host platform.
+
+  void attach();
+
+  // Write the pose to "file" (CSV) every "periodMillis" (NULL = off).
+
+  void setTrace(FILE* file, uint32_t periodMillis = 50);
+
+  // End the run (called when the program exits): a run still going
+  // either timed out or was ended by the sketch.
+
+  void end(bool timedOut);
+
+  // Device
+
+  void advance(uint64_t nowMicros) override;
+
+  const Pose& getPose() const { return m_pose; }
+  const Metrics& getMetrics() const { return m_metrics; }
+
+  static const char* resultName(Result result);
+
+  protected:
+  // Color sensor under the robot.
+
+  class ColorSensor : public host::ColorDevice
+  {
+    public:
+    ColorSensor(Simulator& sim) : m_Sim(sim) { }
+    void getRawData(uint16_t& r, uint16_t& g, uint16_t& b, uint16_t& c) override;
+    Simulator& m_Sim;
+  };
+
+  // Ultrasonic range finder.
+
+  class RangeFinder : public host::PinDevice
+  {
+    public:
+    RangeFinder(Simulator& sim) : m_Sim(sim) { }
+    unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout,
+                          unsigned long& elapsedMicros) override;
+    Simulator& m_Sim;
+  };
+
+  // Move the robot one tick of "seconds".
+
+  void tick(double seconds);
+
+  // Returns "true" if the robot's outline touches an obstacle or wall.
+
+  bool collides() const;
+
+  // Returns a forward wheel speed (in mm per second).
+
+  double wheelSpeed(host::DCMotorController& controller, uint8_t motor, bool left) const;
+
+  // Returns a normally distributed random value.
+
+  double noise(double deviation);
+
+  protected:
+  const World&              m_World;
+  RobotParams               m_params;
+  std::mt19937              m_random;
+  host::DCMotorController   m_prizmDC;
+  host::ServoController     m_prizmServo;
+  host::DCMotorController   m_expansionDC;
+  host::StartButton         m_startButton;
+  ColorSensor               m_colorSensor;
+  RangeFinder               m_rangeFinder;
+  Pose                      m_pose;
+  Metrics                   m_metrics;
+  double                    m_slip[3];        // Forward, sideways, spin
+  uint64_t                  m_lastTickMicros;
+  uint64_t                  m_nextSlipMicros;
+  uint64_t                  m_moveMicros;     // When the robot first moved
+  uint64_t                  m_offTapeMicros;  // Time off the tape so far
+  bool                      m_moved;
+  FILE*                     m_trace;
+  uint64_t                  m_tracePeriodMicros;
+  uint64_t                  m_nextTraceMicros;
+};
+
+}   // End namespace sim
+}   // End namespace csci
+
+#endif    // INCLUDE_CSCI_SIM_SIMULATOR
@@ -0,0 +1,692 @@
+// Parameter sweep implementation file.
+
+#include "Sweep.h"
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <random>
+#include <thread>
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace csci
+{
+namespace sim
+{
+
+// Eigen decomposition of the symmetric n x n matrix "a" (row major,
+// destroyed) by Jacobi rotations.  Eigenvalues go to "values" and
+// eigenvectors to the columns of "vectors".
+
+static void symmetricEigen(std::vector<double>& a, size_t n,
+                           std::vector<double>& values, std::vector<double>& vectors)
+{
+  vectors.assign(n * n, 0.0);
+
+  for ( size_t i = 0; i < n; ++i )
+  {
+    vectors[i * n + i] = 1.0;
+  }
+
+  for ( int sweep = 0; sweep < 100; ++sweep )
+  {
+    double offDiagonal = 0.0;
+
+    for ( size_t p = 0; p < n; ++p )
+    {
+      for ( size_t q = p + 1; q < n; ++q )
+      {
+        offDiagonal += a[p * n + q] * a[p * n + q];
+      }
+    }
+
+    if ( offDiagonal < 1e-24 )
+    {
+      break;
+    }
+
+    for ( size_t p = 0; p < n; ++p )
+    {
+      for ( size_t q = p + 1; q < n; ++q )
+      {
+        double apq = a[p * n + q];
+
+        if ( fabs(apq) < 1e-300 )
+        {
+          continue;
+        }
+
+        double theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+        double t = ((theta >= 0.0) ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+        double c = 1.0 / sqrt(t * t + 1.0);
+        double s = t * c;
+
+        for ( size_t k = 0; k < n; ++k )
+        {
+          double akp = a[k * n + p];
+          double akq = a[k * n + q];
+
+          a[k * n + p] = c * akp - s * akq;
+          a[k * n + q] = s * akp + c * akq;
+        }
+
+        for ( size_t k = 0; k < n; ++k )
+        {
+          double apk = a[p * n + k];
+          double aqk = a[q * n + k];
+
+          a[p * n + k] = c * apk - s * aqk;
+          a[q * n + k] = s * apk + c * aqk;
+        }
+
+        for ( size_t k = 0; k < n; ++k )
+        {
+          double vkp = vectors[k * n + p];
+          double vkq = vectors[k * n + q];
+
+          vectors[k * n + p] = c * vkp - s * vkq;
+          vectors[k * n + q] = s * vkp + c * vkq;
+        }
+      }
+    }
+  }
+
+  values.resize(n);
+
+  for ( size_t i = 0; i < n; ++i )
+  {
+    values[i] = a[i * n + i];
+  }
+}
+
+static double clamp01(double value)
+{
+  return (value < 0.0) ? 0.0 : ((value > 1.0) ? 1.0 : value);
+}
+
+/***************************** SWEEP *******************************/
+
+Sweep::Sweep(const std::string& simPath, const std::vector<std::string>& simArgs)
+  : m_simPath(simPath),
+    m_simArgs(simArgs),
+    m_firstSeed(1),
+    m_seeds(3),
+    m_jobs(std::max(1u, std::thread::hardware_concurrency())),
+    m_timeLimit(300.0),
+    m_verbose(false)
+{
+}
+
+bool Sweep::checkRanges(std::vector<ParamRange>& ranges, std::string& error)
+{
+  std::string command = "'" + m_simPath + "' --tunables";
+  FILE* pipe = popen(command.c_str(), "r");
+
+  if ( pipe == NULL )
+  {
+    error = "Can't run " + m_simPath;
+    return false;
+  }
+
+  std::vector<std::pair<std::string, double> > tunables;
+  char line[256];
+
+  while ( fgets(line, sizeof(line), pipe) != NULL )
+  {
+    char* equals = strchr(line, '=');
+
+    if ( equals != NULL )
+    {
+      *equals = '\0';
+      tunables.push_back(std::make_pair(std::string(line), atof(equals + 1)));
+    }
+  }
+
+  if ( (pclose(pipe) != 0) || tunables.empty() )
+  {
+    error = m_simPath + " didn't list any tunables";
+    return false;
+  }
+
+  for ( size_t index = 0; index < ranges.size(); ++index )
+  {
+    size_t tunable = 0;
+
+    while ( (tunable < tunables.size()) && (tunables[tunable].first != ranges[index].name) )
+    {
+      ++tunable;
+    }
+
+    if ( tunable == tunables.size() )
+    {
+      error = ranges[index].name + " is not one of the sketch's tunables";
+      return false;
+    }
+
+    ranges[index].start = std::min(std::max(tunables[tunable].second, ranges[index].low),
+                                   ranges[index].high);
+  }
+
+  return true;
+}
+
+void Sweep::grid(const std::vector<ParamRange>& ranges, unsigned defaultPoints)
+{
+  std::vector<std::vector<double> > settings(1);
+
+  for ( size_t index = 0; index < ranges.size(); ++index )
+  {
+    const ParamRange& range = ranges[index];
+    unsigned points = ( range.points > 0 ) ? range.points : defaultPoints;
+    std::vector<std::vector<double> > expanded;
+
+    for ( size_t setting = 0; setting < settings.size(); ++setting )
+    {
+      for ( unsigned point = 0; point < points; ++point )
+      {
+        double value = ( points == 1 ) ? (range.low + range.high) / 2.0 :
+                       range.low + point * (range.high - range.low) / (points - 1);
+
+        expanded.push_back(settings[setting]);
+        expanded.back().push_back(value);
+      }
+    }
+
+    settings.swap(expanded);
+  }
+
+  evaluate(settings, ranges);
+}
+
+void Sweep::random(const std::vector<ParamRange>& ranges, unsigned samples, uint32_t rngSeed)
+{
+  std::mt19937 generator(rngSeed);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::vector<std::vector<double> > settings(samples);
+
+  for ( size_t setting = 0; setting < settings.size(); ++setting )
+  {
+    for ( size_t index = 0; index < ranges.size(); ++index )
+    {
+      settings[setting].push_back(ranges[index].low +
+                                  uniform(generator) * (ranges[index].high - ranges[index].low));
+    }
+  }
+
+  evaluate(settings, ranges);
+}
+
+// CMA-ES, following Hansen's "The CMA Evolution Strategy: A Tutorial".
+// It works in the unit cube (each range scaled to [0, 1]); samples
+// outside the cube are clamped for running but not for the update.
+
+void Sweep::cmaes(const std::vector<ParamRange>& ranges, unsigned generations,
+                  unsigned population, uint32_t rngSeed)
+{
+  const size_t n = ranges.size();
+  const size_t lambda = ( population > 1 ) ? population :
+                        4 + static_cast<size_t>(3.0 * log(static_cast<double>(n)));
+  const size_t mu = lambda / 2;
+
+  // Recombination weights.
+
+  std::vector<double> weights(mu);
+  double weightSum = 0.0;
+  double weightSquares = 0.0;
+
+  for ( size_t i = 0; i < mu; ++i )
+  {
+    weights[i] = log(mu + 0.5) - log(i + 1.0);
+    weightSum += weights[i];
+  }
+
+  for ( size_t i = 0; i < mu; ++i )
+  {
+    weights[i] /= weightSum;
+    weightSquares += weights[i] * weights[i];
+  }
+
+  const double muEff = 1.0 / weightSquares;
+  const double dims = static_cast<double>(n);
+
+  // Adaptation rates.
+
+  const double cc = (4.0 + muEff / dims) / (dims + 4.0 + 2.0 * muEff / dims);
+  const double cs = (muEff + 2.0) / (dims + muEff + 5.0);
+  const double c1 = 2.0 / ((dims + 1.3) * (dims + 1.3) + muEff);
+  const double cmu = std::min(1.0 - c1, 2.0 * (muEff - 2.0 + 1.0 / muEff) /
+                                        ((dims + 2.0) * (dims + 2.0) + muEff));
+  const double damps = 1.0 + 2.0 * std::max(0.0, sqrt((muEff - 1.0) / (dims + 1.0)) - 1.0) + cs;
+  const double chiN = sqrt(dims) * (1.0 - 1.0 / (4.0 * dims) + 1.0 / (21.0 * dims * dims));
+
+  // State: mean, step size, evolution paths, covariance C = B D^2 B'.
+
+  std::vector<double> mean(n);
+  double sigma = 0.3;
+  std::vector<double> pc(n, 0.0), ps(n, 0.0);
+  std::vector<double> C(n * n, 0.0), B(n * n, 0.0), D(n, 1.0);
+
+  for ( size_t i = 0; i < n; ++i )
+  {
+    double span = ranges[i].high - ranges[i].low;
+
+    mean[i] = ( span > 0.0 ) ? (ranges[i].start - ranges[i].low) / span : 0.5;
+    C[i * n + i] = 1.0;
+    B[i * n + i] = 1.0;
+  }
+
+  std::mt19937 generator(rngSeed);
+  std::normal_distribution<double> normal(0.0, 1.0);
+
+  for ( unsigned generation = 0; generation < generations; ++generation )
+  {
+    // Sample the population: y = B D z, x = mean + sigma y.
+
+    std::vector<std::vector<double> > y(lambda, std::vector<double>(n));
+    std::vector<std::vector<double> > settings(lambda, std::vector<double>(n));
+
+    for ( size_t k = 0; k < lambda; ++k )
+    {
+      std::vector<double> z(n);
+
+      for ( size_t i = 0; i < n; ++i )
+      {
+        z[i] = D[i] * normal(generator);
+      }
+
+      for ( size_t i = 0; i < n; ++i )
+      {
+        double sum = 0.0;
+
+        for ( size_t j = 0; j < n; ++j )
+        {
+          sum += B[i * n + j] * z[j];
+        }
+
+        y[k][i] = sum;
+        settings[k][i] = ranges[i].low + clamp01(mean[i] + sigma * sum) *
+                                         (ranges[i].high - ranges[i].low);
+      }
+    }
+
+    std::vector<SweepResult> results = evaluate(settings, ranges);
+
+    // Rank the population and move the mean.
+
+    std::vector<size_t> order(lambda);
+
+    for ( size_t k = 0; k < lambda; ++k )
+    {
+      order[k] = k;
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+                     [&results](size_t a, size_t b) { return results[a].cost < results[b].cost; });
+
+    std::vector<double> step(n, 0.0);   // Weighted mean of the best y's
+
+    for ( size_t i = 0; i < mu; ++i )
+    {
+      for ( size_t j = 0; j < n; ++j )
+      {
+        step[j] += weights[i] * y[order[i]][j];
+      }
+    }
+
+    for ( size_t j = 0; j < n; ++j )
+    {
+      mean[j] += sigma * step[j];
+    }
+
+    // Step size path: ps uses C^-1/2 step = B D^-1 B' step.
+
+    std::vector<double> whitened(n, 0.0);
+
+    for ( size_t j = 0; j < n; ++j )
+    {
+      double sum = 0.0;
+
+      for ( size_t i = 0; i < n; ++i )
+      {
+        sum += B[i * n + j] * step[i];
+      }
+
+      sum /= D[j];
+
+      for ( size_t i = 0; i < n; ++i )
+      {
+        whitened[i] += B[i * n + j] * sum;
+      }
+    }
+
+    double psNorm = 0.0;
+
+    for ( size_t i = 0; i < n; ++i )
+    {
+      ps[i] = (1.0 - cs) * ps[i] + sqrt(cs * (2.0 - cs) * muEff) * whitened[i];
+      psNorm += ps[i] * ps[i];
+    }
+
+    psNorm = sqrt(psNorm);
+
+    bool hsig = ( psNorm / sqrt(1.0 - pow(1.0 - cs, 2.0 * (generation + 1))) / chiN <
+                  1.4 + 2.0 / (dims + 1.0) );
+
+    for ( size_t i = 0; i < n; ++i )
+    {
+      pc[i] = (1.0 - cc) * pc[i] + (hsig ? sqrt(cc * (2.0 - cc) * muEff) * step[i] : 0.0);
+    }
+
+    // Covariance: rank one (pc) and rank mu (best y's) updates.
+
+    for ( size_t i = 0; i < n; ++i )
+    {
+      for ( size_t j = 0; j < n; ++j )
+      {
+        double rankMu = 0.0;
+
+        for ( size_t k = 0; k < mu; ++k )
+        {
+          rankMu += weights[k] * y[order[k]][i] * y[order[k]][j];
+        }
+
+        C[i * n + j] = (1.0 - c1 - cmu) * C[i * n + j] +
+                       c1 * (pc[i] * pc[j] + (hsig ? 0.0 : cc * (2.0 - cc) * C[i * n + j])) +
+                       cmu * rankMu;
+      }
+    }
+
+    sigma *= exp((cs / damps) * (psNorm / chiN - 1.0));
+
+    std::vector<double> work(C);
+    std::vector<double> values;
+
+    symmetricEigen(work, n, values, B);
+
+    for ( size_t i = 0; i < n; ++i )
+    {
+      D[i] = sqrt(std::max(values[i], 1e-20));
+    }
+
+    if ( m_verbose )
+    {
+      fprintf(stderr, "generation %u: best cost %.3f, sigma %.4f\n",
+              generation + 1, results[order[0]].cost, sigma);
+    }
+
+    if ( sigma * *std::max_element(D.begin(), D.end()) < 1e-4 )
+    {
+      break;    // Converged
+    }
+  }
+}
+
+std::vector<SweepResult> Sweep::ranked() const
+{
+  std::vector<SweepResult> results(m_results);
+
+  std::stable_sort(results.begin(), results.end(),
+                   [](const SweepResult& a, const SweepResult& b) { return a.cost < b.cost; });
+
+  return results;
+}
+
+void Sweep::printTable(FILE* file, const std::vector<ParamRange>& ranges, unsigned count) const
+{
+  std::vector<SweepResult> results = ranked();
+
+  fprintf(file, "%4s %9s %5s %5s %5s %9s %7s", "rank", "cost", "runs", "fin", "coll", "lap", "losses");
+
+  for ( size_t index = 0; index < ranges.size(); ++index )
+  {
+    fprintf(file, " %*s", static_cast<int>(std::max<size_t>(ranges[index].name.size(), 9)),
+            ranges[index].name.c_str());
+  }
+
+  fprintf(file, "\n");
+
+  for ( size_t rank = 0; (rank < results.size()) && (rank < count); ++rank )
+  {
+    const SweepResult& result = results[rank];
+
+    fprintf(file, "%4u %9.3f %5u %5u %5u %9.3f %7.2f", static_cast<unsigned>(rank + 1),
+            result.cost, result.runs, result.finished, result.collisions,
+            result.lapSeconds, result.lineLosses);
+
+    for ( size_t index = 0; index < ranges.size(); ++index )
+    {
+      fprintf(file, " %*.4g", static_cast<int>(std::max<size_t>(ranges[index].name.size(), 9)),
+              result.values[index]);
+    }
+
+    fprintf(file, "\n");
+  }
+}
+
+std::vector<SweepResult> Sweep::evaluate(const std::vector<std::vector<double> >& settings,
+                                         const std::vector<ParamRange>& ranges)
+{
+  // One job per (setting, seed), handed out to the workers in order.
+
+  size_t numJobs = settings.size() * m_seeds;
+  std::vector<RunMetrics> metrics(numJobs);
+  std::vector<char> reported(numJobs, 0);
+  std::atomic<size_t> nextJob(0);
+
+  auto worker = [&]()
+  {
+    for ( size_t job = nextJob++; job < numJobs; job = nextJob++ )
+    {
+      const std::vector<double>& setting = settings[job / m_seeds];
+      std::vector<std::string> args;
+      char value[64];
+
+      snprintf(value, sizeof(value), "%u", static_cast<unsigned>(m_firstSeed + job % m_seeds));
+      args.push_back("--seed");
+      args.push_back(value);
+
+      snprintf(value, sizeof(value), "%.17g", m_timeLimit);
+      args.push_back("--seconds");
+      args.push_back(value);
+
+      for ( size_t index = 0; index < ranges.size(); ++index )
+      {
+        snprintf(value, sizeof(value), "=%.17g", setting[index]);
+        args.push_back("--tune");
+        args.push_back(ranges[index].name + value);
+      }
+
+      reported[job] = runOne(args, metrics[job]) ? 1 : 0;
+    }
+  };
+
+  std::vector<std::thread> workers;
+
+  for ( unsigned count = 0; count < std::min<size_t>(m_jobs, numJobs); ++count )
+  {
+    workers.push_back(std::thread(worker));
+  }
+
+  for ( size_t index = 0; index < workers.size(); ++index )
+  {
+    workers[index].join();
+  }
+
+  // Combine each setting's runs.
+
+  std::vector<SweepResult> results(settings.size());
+
+  for ( size_t setting = 0; setting < settings.size(); ++setting )
+  {
+    SweepResult& result = results[setting];
+    double lapTotal = 0.0;
+    double costTotal = 0.0;
+    double lossTotal = 0.0;
+
+    result.values = settings[setting];
+    result.runs = m_seeds;
+    result.finished = 0;
+    result.collisions = 0;
+    result.failed = 0;
+
+    for ( unsigned seed = 0; seed < m_seeds; ++seed )
+    {
+      size_t job = setting * m_seeds + seed;
+      const RunMetrics& run = metrics[job];
+
+      if ( !reported[job] )
+      {
+        ++result.failed;
+        costTotal += 2.0 * m_timeLimit;
+        continue;
+      }
+
+      lossTotal += run.lineLosses;
+
+      if ( run.result == "finished" )
+      {
+        ++result.finished;
+        lapTotal += run.lapSeconds;
+        costTotal += run.lapSeconds;
+      }
+      else if ( run.result == "collision" )
+      {
+        ++result.collisions;
+        costTotal += 2.0 * m_timeLimit;
+      }
+      else
+      {
+        costTotal += m_timeLimit;
+      }
+    }
+
+    result.lapSeconds = ( result.finished > 0 ) ? lapTotal / result.finished : 0.0;
+    result.lineLosses = ( m_seeds > 0 ) ? lossTotal / m_seeds : 0.0;
+    result.cost = ( m_seeds > 0 ) ? costTotal / m_seeds : 0.0;
+  }
+
+  m_results.insert(m_results.end(), results.begin(), results.end());
+
+  if ( m_verbose )
+  {
+    fprintf(stderr, "%u settings run (%u simulations)\n",
+            static_cast<unsigned>(m_results.size()),
+            static_cast<unsigned>(m_results.size() * m_seeds));
+  }
+
+  return results;
+}
+
+bool Sweep::runOne(const std::vector<std::string>& args, RunMetrics& metrics) const
+{
+  // The simulator writes its metrics line to stderr; collect that
+  // through a pipe and throw stdout away.
+
+  int fds[2];
+
+  if ( pipe2(fds, O_CLOEXEC) != 0 )
+  {
+    return false;
+  }
+
+  std::vector<std::string> all;
+
+  all.push_back(m_simPath);
+  all.push_back("--quiet");
+  all.insert(all.end(), m_simArgs.begin(), m_simArgs.end());
+  all.insert(all.end(), args.begin(), args.end());
+
+  std::vector<char*> argv;
+
+  for ( size_t index = 0; index < all.size(); ++index )
+  {
+    argv.push_back(const_cast<char*>(all[index].c_str()));
+  }
+
+  argv.push_back(NULL);
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+  posix_spawn_file_actions_adddup2(&actions, fds[1], 2);
+
+  pid_t pid;
+  int status = posix_spawn(&pid, m_simPath.c_str(), &actions, NULL, &argv[0], environ);
+
+  posix_spawn_file_actions_destroy(&actions);
+  close(fds[1]);
+
+  if ( status != 0 )
+  {
+    close(fds[0]);
+    return false;
+  }
+
+  std::string output;
+  char buffer[512];
+  ssize_t length;
+
+  while ( (length = read(fds[0], buffer, sizeof(buffer))) > 0 )
+  {
+    output.append(buffer, length);
+  }
+
+  close(fds[0]);
+  waitpid(pid, &status, 0);
+
+  // Use the last metrics line.
+
+  size_t line = output.rfind("result=");
+
+  if ( (line == std::string::npos) || ((line > 0) && (output[line - 1] != '\n')) )
+  {
+    return false;
+  }
+
+  metrics.result.clear();
+  metrics.lapSeconds = 0.0;
+  metrics.lineLosses = 0.0;
+
+  size_t end = output.find('\n', line);
+  std::string fields = output.substr(line, end - line) + " ";
+  size_t start = 0;
+
+  for ( size_t space = fields.find(' '); space != std::string::npos;
+        start = space + 1, space = fields.find(' ', start) )
+  {
+    std::string field = fields.substr(start, space - start);
+    size_t equals = field.find('=');
+
+    if ( equals == std::string::npos )
+    {
+      continue;
+    }
+
+    std::string key = field.substr(0, equals);
+    std::string value = field.substr(equals + 1);
+
+    if ( key == "result" )
+    {
+      metrics.result = value;
+    }
+    else if ( key == "lap" )
+    {
+      metrics.lapSeconds = atof(value.c_str());
+    }
+    else if ( key == "losses" )
+    {
+      metrics.lineLosses = atof(value.c_str());
+    }
+  }
+
+  return !metrics.result.empty();
+}
+
+}   // End namespace sim
+}   // End namespace csci
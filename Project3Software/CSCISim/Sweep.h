@@ -0,0 +1,127 @@
+#ifndef INCLUDE_CSCI_SIM_SWEEP
+#define INCLUDE_CSCI_SIM_SWEEP
+
+// Parameter sweep header file.
+//
+// A Sweep searches a sketch's tunables (see CSCITunable.h) for the
+// fastest setting that still finishes the course.  Each candidate
+// setting is run in the simulator once per seed; runs are separate
+// <sketch>Sim processes (the sketch and host layer are global state),
+// spread over a pool of worker threads, one per core by default.
+//
+// Searches:
+//
+//   grid    Every combination of evenly spaced values.
+//   random  Uniformly random settings.
+//   cmaes   CMA-ES (covariance matrix adaptation evolution strategy),
+//           starting from the sketch's defaults.
+//
+// A setting's cost is its mean lap time over the seeds; a run that
+// doesn't finish costs the time limit, plus the time limit again for
+// a collision, so any setting that always finishes beats any that
+// doesn't.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace csci
+{
+namespace sim
+{
+
+/************************* PARAMETER RANGE *************************/
+
+struct ParamRange
+{
+  std::string name;         // Tunable name
+  double      low;
+  double      high;
+  unsigned    points;       // Grid values (0 = use the sweep's default)
+  double      start;        // CMA-ES starting value (the tunable's default)
+};
+
+/************************** SWEEP RESULT ***************************/
+
+struct SweepResult
+{
+  std::vector<double> values;     // One per ParamRange
+  unsigned  runs;
+  unsigned  finished;
+  unsigned  collisions;
+  unsigned  failed;               // Runs that didn't report metrics
+  double    lapSeconds;           // Mean over finished runs
+  double    lineLosses;           // Mean over all runs
+  double    cost;
+};
+
+/***************************** SWEEP *******************************/
+
+class Sweep
+{
+  public:
+  // "simArgs" are extra arguments for every simulator run (--world
+  // and so on).
+
+  Sweep(const std::string& simPath, const std::vector<std::string>& simArgs);
+
+  // Ask the simulator for the sketch's tunables and fill in each
+  // range's starting value.  Returns "false" (with a message in
+  // "error") if the simulator can't be run or a name isn't a tunable.
+
+  bool checkRanges(std::vector<ParamRange>& ranges, std::string& error);
+
+  void setSeeds(uint32_t firstSeed, unsigned count) { m_firstSeed = firstSeed; m_seeds = count; }
+  void setJobs(unsigned jobs) { m_jobs = jobs; }
+  void setTimeLimit(double seconds) { m_timeLimit = seconds; }
+  void setVerbose(bool verbose) { m_verbose = verbose; }
+
+  // Searches.  Every setting run is added to the results.
+
+  void grid(const std::vector<ParamRange>& ranges, unsigned defaultPoints);
+  void random(const std::vector<ParamRange>& ranges, unsigned samples, uint32_t rngSeed);
+  void cmaes(const std::vector<ParamRange>& ranges, unsigned generations,
+             unsigned population, uint32_t rngSeed);
+
+  // Results, best (lowest cost) first.
+
+  std::vector<SweepResult> ranked() const;
+
+  // Write the best "count" results as a table.
+
+  void printTable(FILE* file, const std::vector<ParamRange>& ranges, unsigned count) const;
+
+  protected:
+  // Run each setting on every seed and return the results (also
+  // added to m_results).
+
+  std::vector<SweepResult> evaluate(const std::vector<std::vector<double> >& settings,
+                                    const std::vector<ParamRange>& ranges);
+
+  // One simulator run.  Returns "false" if it didn't report metrics.
+
+  struct RunMetrics
+  {
+    std::string result;
+    double      lapSeconds;
+    double      lineLosses;
+  };
+
+  bool runOne(const std::vector<std::string>& args, RunMetrics& metrics) const;
+
+  protected:
+  std::string               m_simPath;
+  std::vector<std::string>  m_simArgs;
+  uint32_t                  m_firstSeed;
+  unsigned                  m_seeds;
+  unsigned                  m_jobs;
+  double                    m_timeLimit;
+  bool                      m_verbose;
+  std::vector<SweepResult>  m_results;
+};
+
+}   // End namespace sim
+}   // End namespace csci
+
+#endif    // INCLUDE_CSCI_SIM_SWEEP
@@ -0,0 +1,225 @@
+// Parameter sweep program entry point: searches a sketch's tunables
+// for the fastest setting that finishes the course (see Sweep.h).
+//
+// Usage: csci_sweep --sim PROGRAM --param NAME=LOW:HIGH[:POINTS] ...
+//                   [--search grid|random|cmaes] [--points N] [--samples N]
+//                   [--generations N] [--population N] [--seeds N]
+//                   [--first-seed N] [--seconds N] [--jobs N] [--top N]
+//                   [--rng-seed N] [--verbose] [-- SIMULATOR ARGUMENTS]
+//
+//   --sim PROGRAM   The sketch's simulator (<sketch>Sim).
+//   --param NAME=LOW:HIGH[:POINTS]
+//                   Tunable to search, its range and (for grid) how
+//                   many values to try.
+//   --search S      Search to run (default grid).
+//   --points N      Grid values per parameter (default 3).
+//   --samples N     Random settings to try (default 50).
+//   --generations N CMA-ES generations (default 20).
+//   --population N  CMA-ES settings per generation (default 4 + 3 ln n).
+//   --seeds N       Runs per setting, on seeds FIRST..FIRST+N-1 (default 3).
+//   --first-seed N  First seed (default 1).
+//   --seconds N     Time limit per run in virtual seconds (default 300).
+//   --jobs N        Simulations run at once (default: one per core).
+//   --top N         Settings in the ranked table (default 10).
+//   --rng-seed N    Seed for the random and CMA-ES searches (default 1).
+//   --verbose       Report progress on stderr.
+//
+// Everything after "--" is passed to every simulator run, e.g.
+//
+//   csci_sweep --sim ./Project3RobotSoftwareSim --search cmaes
+//              --param SpeedFraction=0.2:0.5 --param ObstacleCM=15:35
+//              -- --world Project3Course.world --slip 0.03
+
+#include "Sweep.h"
+#include <stdlib.h>
+#include <string.h>
+
+using namespace csci;
+
+static int usage(const char* program)
+{
+  fprintf(stderr, "Usage: %s --sim PROGRAM --param NAME=LOW:HIGH[:POINTS] ...\n"
+                  "         [--search grid|random|cmaes] [--points N] [--samples N]\n"
+                  "         [--generations N] [--population N] [--seeds N]\n"
+                  "         [--first-seed N] [--seconds N] [--jobs N] [--top N]\n"
+                  "         [--rng-seed N] [--verbose] [-- SIMULATOR ARGUMENTS]\n",
+          program);
+  return 1;
+}
+
+// Parse "NAME=LOW:HIGH[:POINTS]".  Returns "false" if it's malformed.
+
+static bool parseRange(const char* text, sim::ParamRange& range)
+{
+  const char* equals = strchr(text, '=');
+
+  if ( (equals == NULL) || (equals == text) )
+  {
+    return false;
+  }
+
+  range.name.assign(text, equals - text);
+  range.points = 0;
+
+  char* end;
+
+  range.low = strtod(equals + 1, &end);
+
+  if ( *end != ':' )
+  {
+    return false;
+  }
+
+  range.high = strtod(end + 1, &end);
+
+  if ( *end == ':' )
+  {
+    range.points = static_cast<unsigned>(strtoul(end + 1, &end, 10));
+  }
+
+  range.start = range.low;
+
+  return (*end == '\0') && (range.high >= range.low);
+}
+
+int main(int argc, char** argv)
+{
+  const char* simPath = NULL;
+  const char* search = "grid";
+  std::vector<sim::ParamRange> ranges;
+  std::vector<std::string> simArgs;
+  unsigned points = 3;
+  unsigned samples = 50;
+  unsigned generations = 20;
+  unsigned population = 0;
+  unsigned seeds = 3;
+  uint32_t firstSeed = 1;
+  double seconds = 300.0;
+  unsigned jobs = 0;
+  unsigned top = 10;
+  uint32_t rngSeed = 1;
+  bool verbose = false;
+
+  for ( int arg = 1; arg < argc; ++arg )
+  {
+    bool hasValue = ( arg + 1 < argc );
+
+    if ( strcmp(argv[arg], "--") == 0 )
+    {
+      simArgs.assign(argv + arg + 1, argv + argc);
+      break;
+    }
+    else if ( (strcmp(argv[arg], "--sim") == 0) && hasValue )
+    {
+      simPath = argv[++arg];
+    }
+    else if ( (strcmp(argv[arg], "--param") == 0) && hasValue )
+    {
+      sim::ParamRange range;
+
+      if ( !parseRange(argv[++arg], range) )
+      {
+        fprintf(stderr, "Bad parameter range: %s\n", argv[arg]);
+        return 1;
+      }
+
+      ranges.push_back(range);
+    }
+    else if ( (strcmp(argv[arg], "--search") == 0) && hasValue )
+    {
+      search = argv[++arg];
+    }
+    else if ( (strcmp(argv[arg], "--points") == 0) && hasValue )
+    {
+      points = static_cast<unsigned>(strtoul(argv[++arg], NULL, 0));
+    }
+    else if ( (strcmp(argv[arg], "--samples") == 0) && hasValue )
+    {
+      samples = static_cast<unsigned>(strtoul(argv[++arg], NULL, 0));
+    }
+    else if ( (strcmp(argv[arg], "--generations") == 0) && hasValue )
+    {
+      generations = static_cast<unsigned>(strtoul(argv[++arg], NULL, 0));
+    }
+    else if ( (strcmp(argv[arg], "--population") == 0) && hasValue )
+    {
+      population = static_cast<unsigned>(strtoul(argv[++arg], NULL, 0));
+    }
+    else if ( (strcmp(argv[arg], "--seeds") == 0) && hasValue )
+    {
+      seeds = static_cast<unsigned>(strtoul(argv[++arg], NULL, 0));
+    }
+    else if ( (strcmp(argv[arg], "--first-seed") == 0) && hasValue )
+    {
+      firstSeed = static_cast<uint32_t>(strtoul(argv[++arg], NULL, 0));
+    }
+    else if ( (strcmp(argv[arg], "--seconds") == 0) && hasValue )
+    {
+      seconds = atof(argv[++arg]);
+    }
+    else if ( (strcmp(argv[arg], "--jobs") == 0) && hasValue )
+    {
+      jobs = static_cast<unsigned>(strtoul(argv[++arg], NULL, 0));
+    }
+    else if ( (strcmp(argv[arg], "--top") == 0) && hasValue )
+    {
+      top = static_cast<unsigned>(strtoul(argv[++arg], NULL, 0));
+    }
+    else if ( (strcmp(argv[arg], "--rng-seed") == 0) && hasValue )
+    {
+      rngSeed = static_cast<uint32_t>(strtoul(argv[++arg], NULL, 0));
+    }
+    else if ( strcmp(argv[arg], "--verbose") == 0 )
+    {
+      verbose = true;
+    }
+    else
+    {
+      return usage(argv[0]);
+    }
+  }
+
+  if ( (simPath == NULL) || ranges.empty() || (seeds == 0) )
+  {
+    return usage(argv[0]);
+  }
+
+  sim::Sweep sweep(simPath, simArgs);
+  std::string error;
+
+  if ( !sweep.checkRanges(ranges, error) )
+  {
+    fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+
+  sweep.setSeeds(firstSeed, seeds);
+  sweep.setTimeLimit(seconds);
+  sweep.setVerbose(verbose);
+
+  if ( jobs > 0 )
+  {
+    sweep.setJobs(jobs);
+  }
+
+  if ( strcmp(search, "grid") == 0 )
+  {
+    sweep.grid(ranges, points);
+  }
+  else if ( strcmp(search, "random") == 0 )
+  {
+    sweep.random(ranges, samples, rngSeed);
+  }
+  else if ( strcmp(search, "cmaes") == 0 )
+  {
+    sweep.cmaes(ranges, generations, population, rngSeed);
+  }
+  else
+  {
+    return usage(argv[0]);
+  }
+
+  sweep.printTable(stdout, ranges, top);
+
+  return 0;
+}
@@ -0,0 +1,605 @@
+// Simulator world implementation file.
+
+#include "World.h"
+#include <math.h>
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+
+namespace csci
+{
+namespace sim
+{
+
+static const double DegreesToRadians = 3.14159265358979323846 / 180.0;
+
+// Predefined surfaces: raw readings under a white balance where white
+// tape reads 1000, 1000, 1000, 3000.  Each reads as the TapeColor of
+// the same name.
+
+static const Surface Predefined[] =
+{
+  { "white",  1000, 1000, 1000, 3000,  255, 255, 255 },
+  { "gray",    400,  400,  400, 1200,  128, 128, 128 },
+  { "black",    50,   50,   50,  150,    0,   0,   0 },
+  { "red",     450,   75,   75,  600,  255,   0,   0 },
+  { "green",   120,  240,  240,  600,    0, 255,   0 },
+  { "blue",     90,  180,  330,  600,    0,   0, 255 },
+  { "yellow", 1100, 1000,  300, 2400,  255, 255,   0 }
+};
+
+/*************************** WORLD *********************************/
+
+World::World()
+  : m_width(0.0),
+    m_height(0.0),
+    m_cellMM(5.0),
+    m_columns(0),
+    m_rows(0),
+    m_floor(1),
+    m_surfaces(Predefined, Predefined + sizeof(Predefined) / sizeof(Predefined[0]))
+{
+  m_start.x = 0.0;
+  m_start.y = 0.0;
+  m_start.heading = 0.0;
+
+  setSize(3000.0, 2000.0, m_cellMM);
+}
+
+bool World::load(const std::string& path, std::string& error)
+{
+  std::ifstream file(path.c_str());
+
+  if ( !file )
+  {
+    error = "can't open " + path;
+    return false;
+  }
+
+  std::string line;
+  int lineNumber = 0;
+
+  while ( std::getline(file, line) )
+  {
+    ++lineNumber;
+
+    size_t comment = line.find('#');
+
+    if ( comment != std::string::npos )
+    {
+      line.erase(comment);
+    }
+
+    std::istringstream words(line);
+    std::string directive;
+
+    if ( !(words >> directive) )
+    {
+      continue;
+    }
+
+    bool ok = false;
+
+    if ( directive == "size" )
+    {
+      double width = 0.0, height = 0.0;
+
+      ok = static_cast<bool>(words >> width >> height) && setSize(width, height, m_cellMM);
+    }
+    else if ( directive == "cell" )
+    {
+      double cellMM = 0.0;
+
+      ok = static_cast<bool>(words >> cellMM) && setSize(m_width, m_height, cellMM);
+    }
+    else if ( directive == "color" )
+    {
+      Surface surface;
+      unsigned int r, g, b, c;
+
+      ok = static_cast<bool>(words >> surface.name >> r >> g >> b >> c);
+
+      if ( ok )
+      {
+        unsigned int red = 128, green = 128, blue = 128;
+
+        words >> red >> green >> blue;
+
+        surface.r = r;
+        surface.g = g;
+        surface.b = b;
+        surface.c = c;
+        surface.red = red;
+        surface.green = green;
+        surface.blue = blue;
+
+        int index = findSurface(surface.name);
+
+        if ( index >= 0 )
+        {
+          m_surfaces[index] = surface;
+        }
+        else if ( m_surfaces.size() < 255 )
+        {
+          m_surfaces.push_back(surface);
+        }
+        else
+        {
+          ok = false;
+        }
+      }
+    }
+    else if ( directive == "floor" )
+    {
+      std::string name;
+
+      ok = static_cast<bool>(words >> name) && (findSurface(name) >= 0);
+
+      if ( ok )
+      {
+        m_floor = findSurface(name);
+        m_grid.assign(m_grid.size(), m_floor);
+      }
+    }
+    else if ( directive == "tape" )
+    {
+      std::string name;
+      double width = 0.0, value = 0.0;
+      std::vector<double> points;
+
+      ok = static_cast<bool>(words >> name >> width) && (findSurface(name) >= 0);
+
+      while ( ok && (words >> value) )
+      {
+        points.push_back(value);
+      }
+
+      ok = ok && (points.size() >= 4) && (points.size() % 2 == 0) &&
+           paintTape(findSurface(name), width, points);
+    }
+    else if ( directive == "patch" )
+    {
+      std::string name;
+      double x1, y1, x2, y2;
+
+      ok = static_cast<bool>(words >> name >> x1 >> y1 >> x2 >> y2) && (findSurface(name) >= 0) &&
+           paintRect(findSurface(name), x1, y1, x2, y2);
+    }
+    else if ( directive == "image" )
+    {
+      std::string imagePath;
+      double mmPerPixel = 0.0, x0 = 0.0, y0 = 0.0;
+
+      ok = static_cast<bool>(words >> imagePath >> mmPerPixel) && (mmPerPixel > 0.0);
+
+      if ( ok )
+      {
+        words >> x0 >> y0;
+
+        // Relative image paths are relative to the world file.
+
+        size_t slash = path.rfind('/');
+
+        if ( (imagePath[0] != '/') && (slash != std::string::npos) )
+        {
+          imagePath = path.substr(0, slash + 1) + imagePath;
+        }
+
+        if ( !paintImage(imagePath, mmPerPixel, x0, y0, error) )
+        {
+          return false;
+        }
+      }
+    }
+    else if ( directive == "box" )
+    {
+      Box box;
+
+      ok = static_cast<bool>(words >> box.x1 >> box.y1 >> box.x2 >> box.y2);
+
+      if ( ok )
+      {
+        if ( box.x1 > box.x2 ) { double swap = box.x1; box.x1 = box.x2; box.x2 = swap; }
+        if ( box.y1 > box.y2 ) { double swap = box.y1; box.y1 = box.y2; box.y2 = swap; }
+
+        m_boxes.push_back(box);
+      }
+    }
+    else if ( directive == "post" )
+    {
+      Post post;
+
+      ok = static_cast<bool>(words >> post.x >> post.y >> post.radius) && (post.radius > 0.0);
+
+      if ( ok )
+      {
+        m_posts.push_back(post);
+      }
+    }
+    else if ( directive == "start" )
+    {
+      ok = static_cast<bool>(words >> m_start.x >> m_start.y >> m_start.heading);
+    }
+    else if ( directive == "robot" )
+    {
+      std::string key;
+      double value = 0.0;
+
+      ok = static_cast<bool>(words >> key >> value);
+
+      if ( ok )
+      {
+        m_robotParams[key] = value;
+      }
+    }
+
+    if ( !ok )
+    {
+      std::ostringstream message;
+
+      message << path << ":" << lineNumber << ": bad line: " << line;
+      error = message.str();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+const Surface& World::surfaceAt(double x, double y) const
+{
+  long cell = cellAt(x, y);
+
+  return m_surfaces[( cell < 0 ) ? m_floor : m_grid[cell]];
+}
+
+double World::raycast(double x, double y, double heading, double maxRange) const
+{
+  double dx = cos(heading * DegreesToRadians);
+  double dy = sin(heading * DegreesToRadians);
+  double nearest = -1.0;
+
+  // Walls: the ray leaves the world box.
+
+  if ( contains(x, y) )
+  {
+    double exit = maxRange + 1.0;
+
+    if ( dx > 0.0 ) { exit = fmin(exit, (m_width - x) / dx); }
+    if ( dx < 0.0 ) { exit = fmin(exit, -x / dx); }
+    if ( dy > 0.0 ) { exit = fmin(exit, (m_height - y) / dy); }
+    if ( dy < 0.0 ) { exit = fmin(exit, -y / dy); }
+
+    if ( exit <= maxRange )
+    {
+      nearest = exit;
+    }
+  }
+
+  // Boxes (slab method).
+
+  for ( size_t index = 0; index < m_boxes.size(); ++index )
+  {
+    const Box& box = m_boxes[index];
+    double near = 0.0;
+    double far = maxRange;
+    bool hit = true;
+
+    const double origin[2] = { x, y };
+    const double direction[2] = { dx, dy };
+    const double low[2] = { box.x1, box.y1 };
+    const double high[2] = { box.x2, box.y2 };
+
+    for ( int axis = 0; (axis < 2) && hit; ++axis )
+    {
+      if ( fabs(direction[axis]) < 1e-12 )
+      {
+        hit = ( origin[axis] >= low[axis] ) && ( origin[axis] <= high[axis] );
+        continue;
+      }
+
+      double t1 = (low[axis] - origin[axis]) / direction[axis];
+      double t2 = (high[axis] - origin[axis]) / direction[axis];
+
+      near = fmax(near, fmin(t1, t2));
+      far = fmin(far, fmax(t1, t2));
+      hit = ( near <= far );
+    }
+
+    if ( hit && ((nearest < 0.0) || (near < nearest)) )
+    {
+      nearest = near;
+    }
+  }
+
+  // Posts.
+
+  for ( size_t index = 0; index < m_posts.size(); ++index )
+  {
+    const Post& post = m_posts[index];
+    double ox = x - post.x;
+    double oy = y - post.y;
+    double b = ox * dx + oy * dy;
+    double c = ox * ox + oy * oy - post.radius * post.radius;
+    double discriminant = b * b - c;
+
+    if ( discriminant < 0.0 )
+    {
+      continue;
+    }
+
+    double t = -b - sqrt(discriminant);
+
+    if ( t < 0.0 )
+    {
+      t = ( c <= 0.0 ) ? 0.0 : -1.0;    // Inside the post
+    }
+
+    if ( (t >= 0.0) && (t <= maxRange) && ((nearest < 0.0) || (t < nearest)) )
+    {
+      nearest = t;
+    }
+  }
+
+  return nearest;
+}
+
+bool World::isBlocked(double x, double y) const
+{
+  if ( !contains(x, y) )
+  {
+    return true;
+  }
+
+  for ( size_t index = 0; index < m_boxes.size(); ++index )
+  {
+    const Box& box = m_boxes[index];
+
+    if ( (x >= box.x1) && (x <= box.x2) && (y >= box.y1) && (y <= box.y2) )
+    {
+      return true;
+    }
+  }
+
+  for ( size_t index = 0; index < m_posts.size(); ++index )
+  {
+    const Post& post = m_posts[index];
+    double dx = x - post.x;
+    double dy = y - post.y;
+
+    if ( dx * dx + dy * dy <= post.radius * post.radius )
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool World::contains(double x, double y) const
+{
+  return ( x >= 0.0 ) && ( x <= m_width ) && ( y >= 0.0 ) && ( y <= m_height );
+}
+
+bool World::setSize(double width, double height, double cellMM)
+{
+  if ( (width <= 0.0) || (height <= 0.0) || (cellMM <= 0.0) )
+  {
+    return false;
+  }
+
+  // Resizing starts the course image over.
+
+  m_width = width;
+  m_height = height;
+  m_cellMM = cellMM;
+  m_columns = static_cast<long>(ceil(width / cellMM));
+  m_rows = static_cast<long>(ceil(height / cellMM));
+  m_grid.assign(m_columns * m_rows, m_floor);
+
+  return true;
+}
+
+bool World::paintRect(uint8_t surface, double x1, double y1, double x2, double y2)
+{
+  long column1 = static_cast<long>(floor(fmin(x1, x2) / m_cellMM));
+  long column2 = static_cast<long>(floor(fmax(x1, x2) / m_cellMM));
+  long row1 = static_cast<long>(floor(fmin(y1, y2) / m_cellMM));
+  long row2 = static_cast<long>(floor(fmax(y1, y2) / m_cellMM));
+
+  for ( long row = (row1 < 0 ? 0 : row1); (row <= row2) && (row < m_rows); ++row )
+  {
+    for ( long column = (column1 < 0 ? 0 : column1);
+          (column <= column2) && (column < m_columns); ++column )
+    {
+      m_grid[row * m_columns + column] = surface;
+    }
+  }
+
+  return true;
+}
+
+bool World::paintTape(uint8_t surface, double width, const std::vector<double>& points)
+{
+  if ( width <= 0.0 )
+  {
+    return false;
+  }
+
+  double halfWidth = width / 2.0;
+
+  for ( size_t point = 0; point + 3 < points.size(); point += 2 )
+  {
+    double x1 = points[point];
+    double y1 = points[point + 1];
+    double x2 = points[point + 2];
+    double y2 = points[point + 3];
+    double dx = x2 - x1;
+    double dy = y2 - y1;
+    double lengthSquared = dx * dx + dy * dy;
+
+    long column1 = static_cast<long>(floor((fmin(x1, x2) - halfWidth) / m_cellMM));
+    long column2 = static_cast<long>(floor((fmax(x1, x2) + halfWidth) / m_cellMM));
+    long row1 = static_cast<long>(floor((fmin(y1, y2) - halfWidth) / m_cellMM));
+    long row2 = static_cast<long>(floor((fmax(y1, y2) + halfWidth) / m_cellMM));
+
+    for ( long row = (row1 < 0 ? 0 : row1); (row <= row2) && (row < m_rows); ++row )
+    {
+      for ( long column = (column1 < 0 ? 0 : column1);
+            (column <= column2) && (column < m_columns); ++column )
+      {
+        // Distance from the cell center to the segment.
+
+        double cx = (column + 0.5) * m_cellMM;
+        double cy = (row + 0.5) * m_cellMM;
+        double t = 0.0;
+
+        if ( lengthSquared > 0.0 )
+        {
+          t = ((cx - x1) * dx + (cy - y1) * dy) / lengthSquared;
+          t = ( t < 0.0 ) ? 0.0 : ( t > 1.0 ) ? 1.0 : t;
+        }
+
+        double ex = cx - (x1 + t * dx);
+        double ey = cy - (y1 + t * dy);
+
+        if ( ex * ex + ey * ey <= halfWidth * halfWidth )
+        {
+          m_grid[row * m_columns + column] = surface;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+bool World::paintImage(const std::string& path, double mmPerPixel, double x0, double y0,
+                       std::string& error)
+{
+  std::ifstream file(path.c_str(), std::ios::binary);
+  std::string magic;
+  long width = 0, height = 0, maxValue = 0;
+
+  // Header: "P6", width, height, maximum value (comments allowed).
+
+  file >> magic;
+
+  long* fields[] = { &width, &height, &maxValue };
+
+  for ( int field = 0; file && (field < 3); ++field )
+  {
+    file >> std::ws;
+
+    while ( file.peek() == '#' )
+    {
+      std::string comment;
+
+      std::getline(file, comment);
+      file >> std::ws;
+    }
+
+    file >> *fields[field];
+  }
+
+  if ( !file || (magic != "P6") || (width <= 0) || (height <= 0) ||
+       (maxValue <= 0) || (maxValue > 255) )
+  {
+    error = "can't read PPM (P6) image " + path;
+    return false;
+  }
+
+  file.get();   // Single whitespace before the pixels
+
+  std::vector<uint8_t> pixels(width * height * 3);
+
+  if ( !file.read(reinterpret_cast<char*>(&pixels[0]), pixels.size()) )
+  {
+    error = "short PPM image " + path;
+    return false;
+  }
+
+  // Map each distinct pixel color to the nearest surface color.
+
+  std::map<uint32_t, uint8_t> nearest;
+
+  for ( long row = 0; row < m_rows; ++row )
+  {
+    for ( long column = 0; column < m_columns; ++column )
+    {
+      // Image rows run top to bottom.
+
+      long px = static_cast<long>(floor(((column + 0.5) * m_cellMM - x0) / mmPerPixel));
+      long py = height - 1 - static_cast<long>(floor(((row + 0.5) * m_cellMM - y0) / mmPerPixel));
+
+      if ( (px < 0) || (px >= width) || (py < 0) || (py >= height) )
+      {
+        continue;
+      }
+
+      const uint8_t* pixel = &pixels[(py * width + px) * 3];
+      uint32_t key = (pixel[0] << 16) | (pixel[1] << 8) | pixel[2];
+      std::map<uint32_t, uint8_t>::const_iterator found = nearest.find(key);
+
+      if ( found == nearest.end() )
+      {
+        long best = -1;
+        uint8_t bestSurface = m_floor;
+
+        for ( size_t surface = 0; surface < m_surfaces.size(); ++surface )
+        {
+          long dr = m_surfaces[surface].red - pixel[0] * 255 / maxValue;
+          long dg = m_surfaces[surface].green - pixel[1] * 255 / maxValue;
+          long db = m_surfaces[surface].blue - pixel[2] * 255 / maxValue;
+          long distance = dr * dr + dg * dg + db * db;
+
+          if ( (best < 0) || (distance < best) )
+          {
+            best = distance;
+            bestSurface = static_cast<uint8_t>(surface);
+          }
+        }
+
+        found = nearest.insert(std::make_pair(key, bestSurface)).first;
+      }
+
+      m_grid[row * m_columns + column] = found->second;
+    }
+  }
+
+  return true;
+}
+
+int World::findSurface(const std::string& name) const
+{
+  for ( size_t index = 0; index < m_surfaces.size(); ++index )
+  {
+    if ( m_surfaces[index].name == name )
+    {
+      return static_cast<int>(index);
+    }
+  }
+
+  return -1;
+}
+
+long World::cellAt(double x, double y) const
+{
+  if ( (x < 0.0) || (y < 0.0) )
+  {
+    return -1;
+  }
+
+  long column = static_cast<long>(x / m_cellMM);
+  long row = static_cast<long>(y / m_cellMM);
+
+  if ( (column >= m_columns) || (row >= m_rows) )
+  {
+    return -1;
+  }
+
+  return row * m_columns + column;
+}
+
+}   // End namespace sim
+}   // End namespace csci
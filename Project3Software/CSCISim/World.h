@@ -0,0 +1,158 @@
+#ifndef INCLUDE_CSCI_SIM_WORLD
+#define INCLUDE_CSCI_SIM_WORLD
+
+// Simulator world header file.
+//
+// A World is the 2D floor a simulated robot drives on: a course
+// image (the floor and tape lines, as a grid of surfaces) plus
+// obstacles and walls for the range finder.  Units are millimeters
+// and degrees; x is to the right, y is up and headings are counter
+// clockwise from the x axis.
+//
+// Worlds are loaded from text files, one directive per line ("#"
+// starts a comment):
+//
+//   size W H                     World is W x H mm, walled all round
+//   cell MM                      Course image resolution (default 5)
+//   color NAME R G B C [r g b]   Define a surface: TCS34725 raw readings
+//                                (white reads 1000 1000 1000 3000) and,
+//                                optionally, its color in course images
+//   floor NAME                   Fill the floor with a surface
+//   tape NAME WIDTH X1 Y1 X2 Y2 ...
+//                                Lay tape along a polyline
+//   patch NAME X1 Y1 X2 Y2       Fill a rectangle with a surface
+//   image FILE MM [X Y]          Paint a binary PPM (P6) course image,
+//                                MM per pixel, lower left corner at X Y;
+//                                pixels take the nearest surface color
+//   box X1 Y1 X2 Y2              Rectangular obstacle
+//   post X Y RADIUS              Round obstacle
+//   start X Y HEADING            Robot start pose
+//   robot KEY VALUE              Robot parameter (see Simulator.h)
+//
+// Surfaces white, gray, black, red, green, blue and yellow are
+// predefined (they read as the matching TapeColor) and the floor
+// starts gray.
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace csci
+{
+namespace sim
+{
+
+/************************** SURFACE ********************************/
+// A Surface is what the color sensor sees.
+
+struct Surface
+{
+  std::string name;
+  uint16_t    r, g, b, c;         // TCS34725 raw readings
+  uint8_t     red, green, blue;   // Color in course images
+};
+
+/*************************** POSE **********************************/
+
+struct Pose
+{
+  double x;
+  double y;
+  double heading;                 // Degrees
+};
+
+/*************************** WORLD *********************************/
+
+class World
+{
+  public:
+  World();
+
+  // Load a world file.  Returns "false" (with a message in "error")
+  // if it can't be read or has a bad line.
+
+  bool load(const std::string& path, std::string& error);
+
+  // Returns the world size (in mm).
+
+  double getWidth() const { return m_width; }
+  double getHeight() const { return m_height; }
+
+  // Returns the surface at a point (the floor outside the world).
+
+  const Surface& surfaceAt(double x, double y) const;
+
+  // Returns the floor surface.
+
+  const Surface& getFloor() const { return m_surfaces[m_floor]; }
+
+  // Returns the distance (in mm) from a point along "heading" to the
+  // nearest obstacle or wall, or a negative value if there's nothing
+  // within "maxRange".
+
+  double raycast(double x, double y, double heading, double maxRange) const;
+
+  // Returns "true" if a point is inside an obstacle or outside the
+  // walls.
+
+  bool isBlocked(double x, double y) const;
+
+  // Returns "true" if a point is inside the walls.
+
+  bool contains(double x, double y) const;
+
+  // Start pose.
+
+  const Pose& getStart() const { return m_start; }
+
+  // Robot parameters set by the world file.
+
+  const std::map<std::string, double>& getRobotParams() const { return m_robotParams; }
+
+  protected:
+  struct Box
+  {
+    double x1, y1, x2, y2;
+  };
+
+  struct Post
+  {
+    double x, y, radius;
+  };
+
+  // Directive handlers.  Each returns "false" on a bad line.
+
+  bool setSize(double width, double height, double cellMM);
+  bool paintRect(uint8_t surface, double x1, double y1, double x2, double y2);
+  bool paintTape(uint8_t surface, double width, const std::vector<double>& points);
+  bool paintImage(const std::string& path, double mmPerPixel, double x0, double y0,
+                  std::string& error);
+
+  // Returns the index of a named surface (-1 if none).
+
+  int findSurface(const std::string& name) const;
+
+  // Returns the grid cell holding a point (-1 if outside).
+
+  long cellAt(double x, double y) const;
+
+  protected:
+  double                          m_width;
+  double                          m_height;
+  double                          m_cellMM;
+  long                            m_columns;
+  long                            m_rows;
+  uint8_t                         m_floor;
+  std::vector<Surface>            m_surfaces;
+  std::vector<uint8_t>            m_grid;       // Surface index per cell
+  std::vector<Box>                m_boxes;
+  std::vector<Post>               m_posts;
+  Pose                            m_start;
+  std::map<std::string, double>   m_robotParams;
+};
+
+}   // End namespace sim
+}   // End namespace csci
+
+#endif    // INCLUDE_CSCI_SIM_WORLD
@@ -1,6 +1,7 @@
 // Utility Library analog pin classes implementation file.
 
 #include "CSCIAnalogPin.h"
+#include "CSCIAnalogSampler.h"
 #include "CSCITimer.h"
 
 namespace csci
@@ -88,6 +89,174 @@ void PWMAnalogOutput::outputRawPortValue(int value)
   analogWrite(m_pinNumber, value);
 }
 
+/******************** TIMER 1 ANALOG OUTPUT ************************/
+
+// Timer 1 clock and its prescalers (CS12:0 = index + 1).
+
+#if defined(F_CPU)
+static const uint32_t ClockHz = F_CPU;
+#else
+static const uint32_t ClockHz = 16000000UL;    // The PRIZM's
+#endif
+
+static const uint16_t Prescalers[] = { 1, 8, 64, 256, 1024 };
+static const uint8_t NumPrescalers = sizeof(Prescalers) / sizeof(Prescalers[0]);
+
+// Largest TOP (AnalogOutput's values are ints).
+
+static const uint32_t MaxTop = 32767;
+
+// Returns the prescaler (index) for "frequencyHz" with "steps" (0 =
+// the finest the frequency allows).
+
+static uint8_t timer1Prescale(uint32_t frequencyHz, uint16_t steps)
+{
+  frequencyHz = ( frequencyHz > 0 ) ? frequencyHz : 1;
+
+  uint8_t best = NumPrescalers - 1;
+  uint32_t bestError = 0xFFFFFFFFUL;
+
+  for ( uint8_t index = 0; index < NumPrescalers; ++index )
+  {
+    uint32_t ticks = ClockHz / Prescalers[index] / frequencyHz;
+
+    if ( steps == 0 )
+    {
+      // The fastest clock whose period fits.
+
+      if ( ticks <= MaxTop + 1 )
+      {
+        return index;
+      }
+    }
+    else
+    {
+      // The clock giving the nearest frequency with "steps".
+
+      uint32_t period = ( (steps <= MaxTop) ? steps : MaxTop ) + 1;
+      uint32_t error = ( ticks > period ) ? ticks - period : period - ticks;
+
+      if ( error < bestError )
+      {
+        best = index;
+        bestError = error;
+      }
+    }
+  }
+
+  return best;
+}
+
+// Returns TOP (the maximum port value) for "frequencyHz" with "steps".
+
+static int timer1Top(uint32_t frequencyHz, uint16_t steps)
+{
+  if ( steps != 0 )
+  {
+    return static_cast<int>( (steps <= MaxTop) ? steps : MaxTop );
+  }
+
+  frequencyHz = ( frequencyHz > 0 ) ? frequencyHz : 1;
+
+  uint32_t ticks = ClockHz / Prescalers[timer1Prescale(frequencyHz, 0)] / frequencyHz;
+
+  if ( ticks < 2 )
+  {
+    return 1;
+  }
+
+  return static_cast<int>( (ticks - 1 <= MaxTop) ? ticks - 1 : MaxTop );
+}
+
+Timer1AnalogOutput::Timer1AnalogOutput(int pinNumber, uint32_t frequencyHz, uint16_t steps)
+  : AnalogOutput(0, timer1Top(frequencyHz, steps)),
+    m_pinNumber(pinNumber),
+    m_prescale(timer1Prescale(frequencyHz, steps))
+    { }
+
+void Timer1AnalogOutput::setup()
+{
+  pinMode(m_pinNumber, OUTPUT);
+
+#if defined(__AVR_ATmega328P__)
+  if ( (m_pinNumber == 9) || (m_pinNumber == 10) )
+  {
+    // Fast PWM with TOP = ICR1 (mode 14), which double buffers OCR1x.
+    // The other pin's output is left as it was.
+
+    uint8_t oldSREG = SREG;
+
+    cli();
+    TCCR1B = 0;
+    TCCR1A = (TCCR1A & (bit(COM1A1) | bit(COM1B1))) | bit(WGM11);
+    TCNT1 = 0;
+    ICR1 = getMaxOutputValue();
+    TCCR1B = bit(WGM13) | bit(WGM12) | (m_prescale + 1);
+    SREG = oldSREG;
+  }
+#endif
+
+  output(0.0);  // Init to minimum output
+}
+
+void Timer1AnalogOutput::outputPulse(uint32_t activeMicros)
+{
+  uint32_t ticks = activeMicros * (ClockHz / 1000000UL) / Prescalers[m_prescale];
+  uint32_t top = static_cast<uint32_t>(getMaxOutputValue());
+
+  outputPortValue(static_cast<int>( (ticks < top) ? ticks : top ));
+}
+
+uint32_t Timer1AnalogOutput::getPeriodMicros() const
+{
+  return (static_cast<uint32_t>(getMaxOutputValue()) + 1) * Prescalers[m_prescale] / (ClockHz / 1000000UL);
+}
+
+void Timer1AnalogOutput::outputRawPortValue(int value)
+{
+  value = ( value > 0 ) ? value : 0;
+
+#if defined(__AVR_ATmega328P__)
+  if ( (m_pinNumber == 9) || (m_pinNumber == 10) )
+  {
+    uint8_t connect = ( m_pinNumber == 9 ) ? bit(COM1A1) : bit(COM1B1);
+
+    // (OCR1x = 0 would still give a one tick pulse, so 0 disconnects
+    // the pin and holds it low.)
+
+    uint8_t oldSREG = SREG;
+
+    cli();
+
+    if ( value <= 0 )
+    {
+      TCCR1A &= ~connect;
+      digitalWrite(m_pinNumber, LOW);
+    }
+    else
+    {
+      if ( m_pinNumber == 9 )
+      {
+        OCR1A = value;
+      }
+      else
+      {
+        OCR1B = value;
+      }
+
+      TCCR1A |= connect;
+    }
+
+    SREG = oldSREG;
+    return;
+  }
+#endif
+
+  // Elsewhere, scale to analogWrite()'s 0 - 255.
+
+  analogWrite(m_pinNumber, static_cast<int>(static_cast<uint32_t>(value) * 255 / getMaxOutputValue()));
+}
+
 /*********************** ANALOG INPUT ******************************/
 
 AnalogInput::AnalogInput(int pinNumber, int minInput, int maxInput)
@@ -114,7 +283,17 @@ double AnalogInput::input() const
 
 int AnalogInput::inputPortValue() const
 {
-  return analogRead(m_pinNumber);
+  AnalogSampler* sampler = AnalogSampler::running();
+  int value = ( sampler != NULL ) ? sampler->read(m_pinNumber) : -1;
+
+  return ( value >= 0 ) ? value : AnalogSampler::convert(m_pinNumber);
+}
+
+uint32_t AnalogInput::getSampleAge() const
+{
+  AnalogSampler* sampler = AnalogSampler::running();
+
+  return ( sampler != NULL ) ? sampler->getAge(m_pinNumber) : 0;
 }
 
 int AnalogInput::getMaxInputValue() const
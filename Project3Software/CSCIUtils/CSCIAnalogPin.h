@@ -31,7 +31,8 @@ class AnalogOutput
   int getMinOutputValue() const;  // Returns value which produces minimum output voltage
   int getMaxOutputValue() const;  // Returns value which produces maximum output voltage
 
-  // Cycle pin active/inactive for the specified time.  
+  // Cycle pin active/inactive for the specified time.  (This waits;
+  // see Timer1AnalogOutput for cycling in hardware.)
   void cycleActiveInactive(uint32_t activeTimeMicros, uint32_t inactiveTimeMicros);
   
   protected:
@@ -67,6 +68,63 @@ class PWMAnalogOutput : public AnalogOutput
   int m_pinNumber;    // Pin number of hardware PWM output port.
 };
 
+/******************** TIMER 1 ANALOG OUTPUT ************************/
+// A Timer1AnalogOutput drives pin 9 or 10 from the ATmega328P's 16
+// bit Timer 1 directly, at a chosen frequency (1 Hz up) and
+// resolution (up to 32767 steps), rather than analogWrite()'s fixed
+// 490 Hz and 256 steps.  Port values run from 0 to getMaxOutputValue() (timer
+// ticks); duty changes are double buffered by the timer, so each
+// takes effect at the end of a period, with no glitches.
+//
+// A slow frequency makes the timer itself blink or pulse the pin, so
+// no waiting is needed (as cycleActiveInactive() does):
+//
+//   csci::Timer1AnalogOutput blinker(9, 2);   // 2 Hz
+//   csci::Timer1AnalogOutput servo(10, 50);   // 50 Hz servo pulses
+//   ...
+//   blinker.setup();                          // In setup()
+//   blinker.output(0.25);                     // 125 ms on, 375 off
+//   servo.setup();
+//   servo.outputPulse(1500);                  // Centered
+//
+// The timer is programmed by setup(), not the ctor: Arduino's init()
+// (which runs after global ctors) sets Timer 1 up for analogWrite().
+// Both pins share the timer, so they share the frequency; the last
+// set up sets it for both.  Timer 1 is also used by the Servo
+// library.  On other pins and boards this falls back to analogWrite().
+
+class Timer1AnalogOutput : public AnalogOutput
+{
+  public:
+  // "steps" is the maximum port value (0 = as many as the frequency
+  // allows).  With steps given, the frequency is the nearest the
+  // timer can manage.
+
+  Timer1AnalogOutput(int pinNumber, uint32_t frequencyHz, uint16_t steps = 0);
+
+  // Call from Arduino's main "setup" routine, before any output.
+
+  void setup();
+
+  // Set the time the output is active in each period (in
+  // microseconds).
+
+  void outputPulse(uint32_t activeMicros);
+
+  // Returns the time of one period (in microseconds).
+
+  uint32_t getPeriodMicros() const;
+
+  protected:
+  // Output raw port value (timer ticks) passed with no special
+  // processing.
+  void outputRawPortValue(int value) override;
+
+  private:
+  int       m_pinNumber;    // Pin number (9 or 10).
+  uint8_t   m_prescale;     // Timer clock prescaler (index)
+};
+
 /*********************** ANALOG INPUT ******************************/
 // An AnalogInput is associated with an input port and can take on
 // integer values from minInput to maxInput.  minInput represents
@@ -84,8 +142,14 @@ class AnalogInput
   // 1.0 = maximum voltage
   double input() const;
   
-  // Get the value corresponding to the input port voltage.
+  // Get the value corresponding to the input port voltage.  If a
+  // running AnalogSampler samples the port, this is its latest value
+  // (no waiting); otherwise the port is converted now.
   int inputPortValue() const;
+
+  // Get the age (in milliseconds) of the sampler's value (0 if the
+  // port isn't sampled).
+  uint32_t getSampleAge() const;
   
   int getMinInputValue() const;   // Returns value corresponding to minimum input voltage
   int getMaxInputValue() const;   // Returns value corresponding to maximum input voltage
@@ -0,0 +1,225 @@
+// AnalogSampler class implementation file.
+
+#include "CSCIAnalogSampler.h"
+
+namespace csci
+{
+
+// The ATmega328P can chain conversions from the ADC interrupt (see
+// CSCIAnalogSamplerISR.h); other boards (and the host) convert in
+// update().
+
+#if defined(__AVR_ATmega328P__)
+#define CSCI_ADC_INTERRUPTS 1
+#else
+#define CSCI_ADC_INTERRUPTS 0
+#endif
+
+// Returns the ADC channel of analog "pin" (as analogRead() does).
+
+static uint8_t channelNumber(uint8_t pin)
+{
+#if defined(PIN_A0)
+  if ( pin >= PIN_A0 )
+  {
+    pin -= PIN_A0;
+  }
+#endif
+
+  return pin;
+}
+
+/*********************** ANALOG SAMPLER ****************************/
+
+AnalogSampler* volatile AnalogSampler::s_running = NULL;
+bool AnalogSampler::s_interrupts = false;
+
+AnalogSampler::AnalogSampler(uint8_t shift)
+  : m_count(0),
+    m_shift(( shift <= 6 ) ? shift : 6),
+    m_current(0)
+{
+}
+
+bool AnalogSampler::add(uint8_t pin)
+{
+  if ( (m_count >= MaxChannels) || (s_running == this) )
+  {
+    return false;
+  }
+
+  Channel& channel = m_channels[m_count++];
+
+  channel.number = channelNumber(pin);
+  channel.sum = 0;
+  channel.count = 0;
+  channel.value = 0;
+  channel.valueMillis = 0;
+  channel.valid = false;
+
+  return true;
+}
+
+bool AnalogSampler::start()
+{
+  if ( ((s_running != NULL) && (s_running != this)) || (m_count == 0) )
+  {
+    return false;
+  }
+
+  if ( s_running == this )
+  {
+    return true;
+  }
+
+  s_running = this;
+
+#if CSCI_ADC_INTERRUPTS
+  if ( s_interrupts )
+  {
+    // (Writing ADCSRA clears a completed conversion's flag, so a
+    // stale result can't interrupt.)
+
+    ADCSRA |= bit(ADIE);
+    startConversion();
+  }
+#endif
+
+  return true;
+}
+
+void AnalogSampler::stop()
+{
+  if ( s_running != this )
+  {
+    return;
+  }
+
+#if CSCI_ADC_INTERRUPTS
+  if ( s_interrupts )
+  {
+    // Let a conversion under way finish, so analogRead() gets the
+    // ADC.
+
+    ADCSRA &= ~bit(ADIE);
+
+    while ( ADCSRA & bit(ADSC) )
+    { }
+  }
+#endif
+
+  s_running = NULL;
+}
+
+void AnalogSampler::update()
+{
+  if ( !s_interrupts && (s_running == this) )
+  {
+    converted(analogRead(m_channels[m_current].number));
+  }
+}
+
+int AnalogSampler::read(uint8_t pin) const
+{
+  const Channel* channel = find(pin);
+
+  if ( (channel == NULL) || !channel->valid )
+  {
+    return -1;
+  }
+
+  noInterrupts();
+  uint16_t value = channel->value;
+  interrupts();
+
+  return value;
+}
+
+uint32_t AnalogSampler::getAge(uint8_t pin) const
+{
+  const Channel* channel = find(pin);
+
+  if ( (channel == NULL) || !channel->valid )
+  {
+    return 0;
+  }
+
+  noInterrupts();
+  uint32_t valueMillis = channel->valueMillis;
+  interrupts();
+
+  return millis() - valueMillis;
+}
+
+int AnalogSampler::convert(uint8_t pin)
+{
+  AnalogSampler* sampler = s_running;
+
+  if ( sampler != NULL )
+  {
+    sampler->stop();
+  }
+
+  int value = analogRead(pin);
+
+  if ( sampler != NULL )
+  {
+    sampler->start();
+  }
+
+  return value;
+}
+
+void AnalogSampler::converted(uint16_t value)
+{
+  Channel& channel = m_channels[m_current];
+
+  channel.sum += value;
+
+  // A channel's whole group is converted before moving on.
+
+  if ( ++channel.count >= (1 << m_shift) )
+  {
+    channel.value = (channel.sum + ((1 << m_shift) >> 1)) >> m_shift;
+    channel.valueMillis = millis();
+    channel.valid = true;
+    channel.sum = 0;
+    channel.count = 0;
+
+    m_current = (m_current + 1) % m_count;
+  }
+
+#if CSCI_ADC_INTERRUPTS
+  if ( s_interrupts )
+  {
+    startConversion();
+  }
+#endif
+}
+
+const AnalogSampler::Channel* AnalogSampler::find(uint8_t pin) const
+{
+  uint8_t number = channelNumber(pin);
+
+  for ( uint8_t index = 0; index < m_count; ++index )
+  {
+    if ( m_channels[index].number == number )
+    {
+      return &m_channels[index];
+    }
+  }
+
+  return NULL;
+}
+
+void AnalogSampler::startConversion()
+{
+#if CSCI_ADC_INTERRUPTS
+  // AVcc reference (analogReference(DEFAULT)), as analogRead() uses.
+
+  ADMUX = bit(REFS0) | m_channels[m_current].number;
+  ADCSRA |= bit(ADSC);
+#endif
+}
+
+}   // End namespace
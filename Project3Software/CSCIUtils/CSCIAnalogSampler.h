@@ -0,0 +1,134 @@
+#ifndef INCLUDE_CSCI_ANALOG_SAMPLER
+#define INCLUDE_CSCI_ANALOG_SAMPLER
+
+// AnalogSampler class header file for background analog conversions.
+
+#include "CSCICore.h"
+
+namespace csci
+{
+
+/*********************** ANALOG SAMPLER ****************************/
+// An AnalogSampler keeps the ADC converting a list of analog channels
+// in the background, so reading one never waits the ~110
+// microseconds an analogRead() takes.  Each channel's conversions
+// are averaged in groups of 2^shift (oversampled, which also filters
+// noise), and read() returns the latest average with no waiting;
+// getAge() says how old it is.
+//
+// update(), called from loop(), takes one conversion per call.  On
+// the ATmega328P the ADC interrupt can chain the conversions instead
+// (see enableInterrupts()): each one completing starts the next,
+// moving round the channels.  (Free running mode isn't used, as a
+// channel change there only takes effect a conversion late.)
+//
+//   csci::AnalogSampler Analog;
+//   ...
+//   Analog.add(0);          // In setup()
+//   Analog.start();
+//   ...
+//   int value = Analog.read(0);
+//
+// Only one sampler runs at a time.  While it runs, analogRead() would
+// fight it for the ADC, so use convert() for a channel it isn't
+// sampling.  AnalogInput and TMSmartCar::getBatteryVoltage() read
+// the running sampler's values when it samples their channel.
+//
+// Note: The ADC interrupt handler is defined by
+//       CSCIAnalogSamplerISR.h, not by the library, so a sketch that
+//       doesn't include it leaves the ADC interrupt free.
+
+class AnalogSampler
+{
+  public:
+  static const uint8_t MaxChannels = 4;
+
+  // Average 2^"shift" conversions (0 - 6) for each value.
+
+  AnalogSampler(uint8_t shift = 4);
+
+  // Sample analog "pin" (channel number or A0...) too.  Returns
+  // "false" if the list is full or the sampler is running.
+
+  bool add(uint8_t pin);
+
+  // Start sampling.  Returns "false" if another sampler is running
+  // or there are no channels.
+
+  bool start();
+
+  // Stop sampling (the values read stay as they were).
+
+  void stop();
+
+  // Take the next conversion (does nothing once the ADC interrupt
+  // is converting).
+
+  void update();
+
+  // Convert with the ADC interrupt from now on (the ATmega328P;
+  // elsewhere update() carries on converting).  This is defined,
+  // along with the interrupt handler, in CSCIAnalogSamplerISR.h:
+  // include that in one file of the sketch to use it.
+
+  static void enableInterrupts();
+
+  // Returns the latest value (0 - 1023) for "pin", or -1 if it isn't
+  // sampled or has no value yet.
+
+  int read(uint8_t pin) const;
+
+  // Returns the age (in milliseconds) of read()'s value for "pin"
+  // (0 if there's none).
+
+  uint32_t getAge(uint8_t pin) const;
+
+  // Returns the running sampler (NULL if none).
+
+  static AnalogSampler* running() { return s_running; }
+
+  // Returns a conversion of "pin" right now (waiting for it), pausing
+  // the running sampler if there is one.
+
+  static int convert(uint8_t pin);
+
+  // Called by the ADC interrupt with each conversion.
+
+  void converted(uint16_t value);
+
+  private:
+  AnalogSampler(const AnalogSampler&);              // No copying
+  AnalogSampler& operator=(const AnalogSampler&);
+
+  protected:
+  struct Channel
+  {
+    uint8_t           number;       // ADC channel (0 - 7)
+    uint16_t          sum;          // Conversions so far this group
+    uint8_t           count;
+    volatile uint16_t value;        // Latest average
+    volatile uint32_t valueMillis;  // Time of the latest average
+    volatile bool     valid;
+  };
+
+  // Returns the channel sampling "pin" (NULL if none).
+
+  const Channel* find(uint8_t pin) const;
+
+  // Start converting the current channel.
+
+  void startConversion();
+
+  protected:
+  Channel           m_channels[MaxChannels];
+  uint8_t           m_count;
+  uint8_t           m_shift;
+  volatile uint8_t  m_current;      // Channel being converted
+
+  static AnalogSampler* volatile s_running;
+  static bool s_interrupts;           // Conversions chained by the interrupt
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_ANALOG_SAMPLER
@@ -0,0 +1,57 @@
+#ifndef INCLUDE_CSCI_ANALOG_SAMPLER_ISR
+#define INCLUDE_CSCI_ANALOG_SAMPLER_ISR
+
+// AnalogSampler ADC interrupt handler (see CSCIAnalogSampler.h).
+//
+// NOTE: Include this in ONE file of a sketch that calls
+//       AnalogSampler::enableInterrupts().  On the ATmega328P it
+//       defines the ADC interrupt handler, so it can't be used with
+//       other libraries that do.  Sketches that don't include it
+//       convert in AnalogSampler::update(), and the handler stays
+//       free.
+
+#include "CSCIAnalogSampler.h"
+
+#if defined(__AVR_ATmega328P__)
+
+ISR(ADC_vect)
+{
+  csci::AnalogSampler* sampler = csci::AnalogSampler::running();
+
+  if ( sampler != NULL )
+  {
+    sampler->converted(ADC);
+  }
+}
+
+void csci::AnalogSampler::enableInterrupts()
+{
+  // A running sampler is restarted, so the interrupt picks up its
+  // conversions.
+
+  AnalogSampler* sampler = s_running;
+
+  if ( sampler != NULL )
+  {
+    sampler->stop();
+  }
+
+  s_interrupts = true;
+
+  if ( sampler != NULL )
+  {
+    sampler->start();
+  }
+}
+
+#else
+
+// No ADC interrupt: update() carries on converting.
+
+void csci::AnalogSampler::enableInterrupts()
+{
+}
+
+#endif
+
+#endif    // INCLUDE_CSCI_ANALOG_SAMPLER_ISR
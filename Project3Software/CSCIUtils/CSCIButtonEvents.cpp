@@ -0,0 +1,166 @@
+// ButtonEvents class implementation file.
+
+#include "CSCIButtonEvents.h"
+
+namespace csci
+{
+
+/************************ BUTTON EVENTS *****************************/
+
+ButtonEvents* ButtonEvents::s_first = NULL;
+
+ButtonEvents::ButtonEvents(uint8_t pinNumber, int closedState, bool activateInternalPullUp)
+  : m_pin(pinNumber, closedState, activateInternalPullUp),
+    m_pinNumber(pinNumber),
+    m_port(0),
+    m_interrupts(false),
+    m_closed(false),
+    m_sampled(false),
+    m_bouncing(false),
+    m_edgeMillis(0),
+    m_pressMillis(0),
+    m_clickMillis(0),
+    m_clickPending(false),
+    m_longSent(false),
+    m_head(0),
+    m_count(0),
+    m_dropped(0),
+    m_next(s_first)
+{
+  s_first = this;
+}
+
+void ButtonEvents::pinChanged(uint8_t port)
+{
+  // Any change on the port restarts the debounce of its buttons; poll()
+  // reads the pin once it has settled.
+
+  uint32_t now = millis();
+
+  for ( ButtonEvents* button = s_first; button != NULL; button = button->m_next )
+  {
+    if ( button->m_port == port )
+    {
+      button->m_edgeMillis = now;
+      button->m_bouncing = true;
+    }
+  }
+}
+
+void ButtonEvents::poll()
+{
+  uint32_t now = millis();
+
+  if ( !m_interrupts )
+  {
+    bool sample = m_pin.active();
+
+    if ( sample != m_sampled )
+    {
+      m_sampled = sample;
+      m_edgeMillis = now;
+      m_bouncing = true;
+    }
+  }
+
+  // Has the pin stayed put for DebounceTime since its latest edge?
+
+  bool settled = false;
+
+  noInterrupts();
+
+  if ( m_bouncing && (now - m_edgeMillis >= DebounceTime) )
+  {
+    m_bouncing = false;
+    settled = true;
+  }
+
+  interrupts();
+
+  if ( settled )
+  {
+    bool closed = m_interrupts ? m_pin.active() : m_sampled;
+
+    if ( closed && !m_closed )
+    {
+      // A press too late to be a double click ends the waiting click.
+
+      if ( m_clickPending && (now - m_clickMillis > DoubleClickTime) )
+      {
+        queue(evClick);
+        m_clickPending = false;
+      }
+
+      m_pressMillis = now;
+      m_longSent = false;
+    }
+    else if ( !closed && m_closed && !m_longSent )
+    {
+      if ( m_clickPending )
+      {
+        queue(evDoubleClick);
+        m_clickPending = false;
+      }
+      else
+      {
+        m_clickMillis = now;
+        m_clickPending = true;
+      }
+    }
+
+    m_closed = closed;
+  }
+
+  if ( m_closed && !m_longSent && (now - m_pressMillis >= LongPressTime) )
+  {
+    if ( m_clickPending )
+    {
+      queue(evClick);
+      m_clickPending = false;
+    }
+
+    queue(evLongPress);
+    m_longSent = true;
+  }
+
+  if ( m_clickPending && !m_closed && (now - m_clickMillis > DoubleClickTime) )
+  {
+    queue(evClick);
+    m_clickPending = false;
+  }
+}
+
+bool ButtonEvents::getEvent(Event& event)
+{
+  if ( m_count == 0 )
+  {
+    return false;
+  }
+
+  event = m_events[m_head];
+  m_head = (m_head + 1) % MaxEvents;
+  --m_count;
+
+  return true;
+}
+
+void ButtonEvents::clear()
+{
+  m_head = 0;
+  m_count = 0;
+  m_clickPending = false;
+}
+
+void ButtonEvents::queue(Event event)
+{
+  if ( m_count >= MaxEvents )
+  {
+    ++m_dropped;
+    return;
+  }
+
+  m_events[(m_head + m_count) % MaxEvents] = event;
+  ++m_count;
+}
+
+}   // End namespace
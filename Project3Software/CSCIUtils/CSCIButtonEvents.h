@@ -0,0 +1,127 @@
+#ifndef INCLUDE_CSCI_BUTTON_EVENTS
+#define INCLUDE_CSCI_BUTTON_EVENTS
+
+// ButtonEvents class header file for non-blocking, debounced push
+// button clicks.
+
+#include "CSCIGPIO.h"
+
+namespace csci
+{
+
+/************************ BUTTON EVENTS *****************************/
+// A ButtonEvents watches a push button without blocking, turning its
+// presses into click, double click and long press events that the
+// sketch takes from a small queue when it's ready.  Unlike
+// PushButton::waitForClick(), nothing waits, so a button can abort or
+// switch modes while the robot runs.
+//
+// poll(), called from loop(), samples the pin, debounces its edges
+// and queues the events.  On the ATmega328P a pin change interrupt
+// can timestamp every edge instead (see enableInterrupts()), so a
+// poll() while the button is idle only checks a few flags.
+//
+//   csci::ButtonEvents StartEvents(8);    // PRIZM Start button
+//   ...
+//   StartEvents.poll();
+//
+//   csci::ButtonEvents::Event event;
+//
+//   while ( StartEvents.getEvent(event) )
+//   {
+//     if ( event == csci::ButtonEvents::evLongPress ) ...
+//   }
+//
+// ButtonEvents must be globals: each links itself into a list, which
+// the interrupts walk.
+//
+// Note: The pin change interrupt handlers are defined by
+//       CSCIButtonEventsISR.h, not by the library, so a sketch that
+//       doesn't include it leaves them free for other libraries
+//       (e.g., SoftwareSerial).
+
+class ButtonEvents
+{
+  public:
+  enum Event
+  {
+    evClick,          // Pressed and released
+    evDoubleClick,    // Clicked twice within DoubleClickTime
+    evLongPress       // Held for LongPressTime (sent while still held)
+  };
+
+  static const uint16_t DebounceTime = 50;        // Milliseconds
+  static const uint16_t DoubleClickTime = 400;    // Milliseconds
+  static const uint16_t LongPressTime = 1000;     // Milliseconds
+  static const uint8_t MaxEvents = 4;             // Events queued
+
+  // closedState = LOW means the button is pressed when the pin is LOW.
+
+  ButtonEvents(uint8_t pinNumber, int closedState = LOW, bool activateInternalPullUp = NoInternalPullUp);
+
+  // Timestamp the pin's edges with its pin change interrupt from now
+  // on (the ATmega328P; elsewhere poll() carries on sampling).  This
+  // is defined, along with the interrupt handlers, in
+  // CSCIButtonEventsISR.h: include that in one file of the sketch to
+  // use it.
+
+  void enableInterrupts();
+
+  // Debounce the edges since the last call and queue any events.  Call
+  // often (every 100 milliseconds or so at least).
+
+  void poll();
+
+  // Take the oldest queued event.  Returns "false" if there's none.
+
+  bool getEvent(Event& event);
+
+  // Drop any queued events (and a click waiting for its double).
+
+  void clear();
+
+  // Returns "true" if the button is pressed (debounced, as of the last
+  // poll()).
+
+  bool closed() const { return m_closed; }
+
+  // Returns the number of events dropped because the queue was full.
+
+  uint16_t getDroppedCount() const { return m_dropped; }
+
+  // Called by the pin change interrupt for "port" (0 - 2).
+
+  static void pinChanged(uint8_t port);
+
+  private:
+  ButtonEvents(const ButtonEvents&);              // No copying
+  ButtonEvents& operator=(const ButtonEvents&);
+
+  protected:
+  void queue(Event event);
+
+  protected:
+  GPIOInputPin      m_pin;
+  uint8_t           m_pinNumber;
+  uint8_t           m_port;           // Pin change interrupt port
+  bool              m_interrupts;     // Edges timestamped by the interrupt
+  bool              m_closed;         // Debounced state
+  bool              m_sampled;        // Last sampled state (no interrupts)
+  volatile bool     m_bouncing;       // Edge seen, not yet debounced
+  volatile uint32_t m_edgeMillis;     // Time of the latest edge
+  uint32_t          m_pressMillis;    // Time of the latest press
+  uint32_t          m_clickMillis;    // Time of a click awaiting its double
+  bool              m_clickPending;
+  bool              m_longSent;       // Long press sent for this press
+  Event             m_events[MaxEvents];
+  uint8_t           m_head;
+  uint8_t           m_count;
+  uint16_t          m_dropped;
+  ButtonEvents*     m_next;
+
+  static ButtonEvents* s_first;
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_BUTTON_EVENTS
@@ -0,0 +1,59 @@
+#ifndef INCLUDE_CSCI_BUTTON_EVENTS_ISR
+#define INCLUDE_CSCI_BUTTON_EVENTS_ISR
+
+// ButtonEvents pin change interrupt handlers (see CSCIButtonEvents.h).
+//
+// NOTE: Include this in ONE file of a sketch that calls
+//       ButtonEvents::enableInterrupts().  On the ATmega328P it
+//       defines the three pin change interrupt handlers, so it can't
+//       be used with other libraries that do (e.g., SoftwareSerial).
+//       Sketches that don't include it poll their buttons, and the
+//       handlers stay free.
+
+#include "CSCIButtonEvents.h"
+
+#if defined(__AVR_ATmega328P__)
+
+ISR(PCINT0_vect)
+{
+  csci::ButtonEvents::pinChanged(0);
+}
+
+ISR(PCINT1_vect)
+{
+  csci::ButtonEvents::pinChanged(1);
+}
+
+ISR(PCINT2_vect)
+{
+  csci::ButtonEvents::pinChanged(2);
+}
+
+void csci::ButtonEvents::enableInterrupts()
+{
+  // Enable the pin's change interrupt.  poll() reads the pin once the
+  // first debounce time has passed.
+
+  uint8_t oldSREG = SREG;
+
+  cli();
+  m_port = digitalPinToPCICRbit(m_pinNumber);
+  m_interrupts = true;
+  m_edgeMillis = millis();
+  m_bouncing = true;
+  *digitalPinToPCMSK(m_pinNumber) |= bit(digitalPinToPCMSKbit(m_pinNumber));
+  PCICR |= bit(m_port);
+  SREG = oldSREG;
+}
+
+#else
+
+// No pin change interrupts: poll() carries on sampling the pin.
+
+void csci::ButtonEvents::enableInterrupts()
+{
+}
+
+#endif
+
+#endif    // INCLUDE_CSCI_BUTTON_EVENTS_ISR
@@ -1,6 +1,7 @@
 // Utility Library switch classes implementation file.
 
 #include "CSCIColorSensor.h"
+#include "CSCITelemetryRegistry.h"
 
 namespace csci
 {
@@ -224,6 +225,12 @@ void ColorSensor::getColorRatios(ColorRatios& ratios)
     
   m_tcs.getRawData(&raw_r, &raw_g, &raw_b, &raw_c);
   
+  getColorRatios(raw_r, raw_g, raw_b, raw_c, ratios);
+}
+
+void ColorSensor::getColorRatios(uint16_t raw_r, uint16_t raw_g, uint16_t raw_b,
+                                 uint16_t raw_c, ColorRatios& ratios)
+{
   // Calculate color ratios
   
   double clear = static_cast<double>(raw_c);
@@ -353,4 +360,20 @@ void ColorSensor::displayScalingFactors(csci::SerialMonitor& smonitor)
   smonitor.sendNewline();  
 }
 
+
+// Telemetry channel sampler.
+
+static bool sampleColor(void* context, Telemetry& telemetry)
+{
+  ColorRatios ratios;
+
+  static_cast<ColorSensor*>(context)->getColorRatios(ratios);
+  return telemetry.sendColor(ratios, ratios.getTapeColor());
+}
+
+void ColorSensor::addTelemetry(TelemetryRegistry& registry)
+{
+  registry.add("color", 9, sampleColor, this, 10);
+}
+
 }   // End namespace
@@ -10,6 +10,8 @@
 namespace csci
 {
 
+class TelemetryRegistry;    // (See CSCITelemetryRegistry.h)
+
 /*********************** TAPE COLOR *********************************/
 // Recognized tape color.  (Standard colored electrical tape.)
 
@@ -158,6 +160,12 @@ class ColorSensor
   
   void getColorRatios(ColorRatios& colorRatios);
   
+  // Calculate color ratios from raw sensor readings, using the
+  // current white balance.  (Takes no sample.)
+  
+  void getColorRatios(uint16_t rawR, uint16_t rawG, uint16_t rawB,
+                      uint16_t rawC, ColorRatios& colorRatios);
+  
   // Calibrate sensor "white balance" parameters.
   // Sensor should be positioned over standard white reference material.
   // Returns calculated calibration scaling factors.
@@ -180,6 +188,11 @@ class ColorSensor
   // Display color balance scaling factors.
   
   void displayScalingFactors(csci::SerialMonitor& smonitor);
+
+  // Register the "color" telemetry channel (ratios and tape color,
+  // 10 Hz) with "registry".  Each record takes a color sample.
+
+  void addTelemetry(TelemetryRegistry& registry);
   
   private:
   // Associated Adafruit TCS34725 object and control params.
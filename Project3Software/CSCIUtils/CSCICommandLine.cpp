@@ -0,0 +1,83 @@
+// CommandLine class implementation file.
+
+#include "CSCICommandLine.h"
+
+namespace csci
+{
+
+/************************* COMMAND LINE ****************************/
+
+const char CommandLine::TooLong[] = "";
+
+CommandLine::CommandLine()
+  : m_length(0)
+{
+}
+
+const char* CommandLine::read(Stream& in)
+{
+  while ( in.available() > 0 )
+  {
+    char value = static_cast<char>(in.read());
+
+    if ( (value != '\n') && (value != '\r') )
+    {
+      // One past MaxLength marks the line as too long.
+
+      if ( m_length <= MaxLength )
+      {
+        m_line[m_length++] = value;
+      }
+
+      continue;
+    }
+
+    if ( m_length == 0 )
+    {
+      continue;
+    }
+
+    uint8_t length = m_length;
+
+    m_length = 0;
+
+    if ( length > MaxLength )
+    {
+      return TooLong;
+    }
+
+    m_line[length] = '\0';
+    return m_line;
+  }
+
+  return NULL;
+}
+
+char* CommandLine::nextWord(char*& text)
+{
+  while ( *text == ' ' )
+  {
+    ++text;
+  }
+
+  if ( *text == '\0' )
+  {
+    return NULL;
+  }
+
+  char* word = text;
+
+  while ( (*text != ' ') && (*text != '\0') )
+  {
+    ++text;
+  }
+
+  if ( *text != '\0' )
+  {
+    *text++ = '\0';
+  }
+
+  return word;
+}
+
+}   // End namespace
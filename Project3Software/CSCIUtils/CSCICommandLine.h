@@ -0,0 +1,56 @@
+#ifndef INCLUDE_CSCI_COMMAND_LINE
+#define INCLUDE_CSCI_COMMAND_LINE
+
+// CommandLine class header file for text commands read over a serial
+// link.
+
+#include "CSCICore.h"
+
+namespace csci
+{
+
+/************************* COMMAND LINE ****************************/
+// A CommandLine collects characters from a stream (e.g. Serial) into
+// lines, without waiting, so several command handlers can share one
+// link:
+//
+//   const char* line;
+//
+//   while ( (line = Commands.read(Serial)) != NULL )
+//   {
+//     Channels.command(line, SMonitor) || Params.command(line, SMonitor);
+//   }
+//
+// Lines end with a newline or carriage return; empty lines are
+// skipped.  A line longer than MaxLength is returned as TooLong so
+// the handler can report it.
+
+class CommandLine
+{
+  public:
+  static const uint8_t MaxLength = 40;
+
+  // Returned (instead of the line) for a line that was too long.
+
+  static const char TooLong[];
+
+  CommandLine();
+
+  // Read available characters from "in".  Returns the next complete
+  // line (valid until the next call), or NULL if there's none yet.
+
+  const char* read(Stream& in);
+
+  // Split the next space separated word off "text" (which is
+  // modified).  Returns NULL if there are no more.
+
+  static char* nextWord(char*& text);
+
+  protected:
+  char      m_line[MaxLength + 1];
+  uint8_t   m_length;
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_COMMAND_LINE
@@ -0,0 +1,670 @@
+// DetourPlanner class implementation file.
+
+#include "CSCIDetourPlanner.h"
+
+namespace csci
+{
+
+// Neighbor directions (column step, row step) and the movement state
+// that drives the car in that direction.  Columns increase forward
+// along the line, rows increase to the left.
+
+static const int8_t DirColumn[8] = { 1, -1, 0,  0, 1,  1, -1, -1 };
+static const int8_t DirRow[8]    = { 0,  0, 1, -1, 1, -1,  1, -1 };
+
+static const MoveState DirMoveState[8] =
+{
+  MoveState::msForward,
+  MoveState::msReverse,
+  MoveState::msLeft,
+  MoveState::msRight,
+  MoveState::msDiagFL,
+  MoveState::msDiagFR,
+  MoveState::msDiagRL,
+  MoveState::msDiagRR
+};
+
+/************************ DETOUR PLANNER ***************************/
+
+DetourPlanner::DetourPlanner(float cellSizeMM, float clearanceMM, float depthMM)
+  : m_sampleRow(0),
+    m_cellSizeMM(cellSizeMM),
+    m_clearanceMM(clearanceMM),
+    m_depthMM(depthMM),
+    m_cosHeading(1.0),
+    m_sinHeading(0.0),
+    m_start(cellIndex(StartColumn, LineRow)),
+    m_lastStart(cellIndex(StartColumn, LineRow)),
+    m_goal(cellIndex(Dim - 1, LineRow)),
+    m_keyOffset(0),
+    m_status(psIdle)
+{
+  m_anchor.xMM = 0.0;
+  m_anchor.yMM = 0.0;
+  m_anchor.headingRad = 0.0;
+
+  for ( uint8_t index = 0; index < sizeof(m_blocked); ++index )
+  {
+    m_blocked[index] = 0;
+    m_occupied[index] = 0;
+    m_open[index] = 0;
+  }
+}
+
+void DetourPlanner::begin(const Pose2D& pose)
+{
+  m_anchor = pose;
+  m_cosHeading = cos(pose.headingRad);
+  m_sinHeading = sin(pose.headingRad);
+
+  for ( uint8_t index = 0; index < sizeof(m_blocked); ++index )
+  {
+    m_blocked[index] = 0;
+    m_occupied[index] = 0;
+  }
+
+  m_sampleRow = 0;
+  m_start = cellIndex(StartColumn, LineRow);
+  m_lastStart = m_start;
+
+  chooseGoal();
+  resetSearch();
+}
+
+void DetourPlanner::setPose(const Pose2D& pose)
+{
+  if ( m_status == psIdle )
+  {
+    return;
+  }
+
+  uint8_t start = worldToCell(pose);
+
+  if ( start == m_start )
+  {
+    return;
+  }
+
+  // Moving the start changes every key by (at most) the heuristic
+  // distance moved, so offset future keys rather than re-keying.
+
+  m_start = start;
+  m_keyOffset += heuristic(m_lastStart, m_start);
+  m_lastStart = m_start;
+
+  // The car's own cell is never treated as blocked.
+
+  if ( getBit(m_blocked, m_start) )
+  {
+    setBit(m_blocked, m_start, false);
+    updateAround(m_start);
+  }
+
+  m_status = psPlanning;
+}
+
+bool DetourPlanner::updateObstacles(const OccupancyGrid& grid, uint8_t maxRows)
+{
+  if ( m_status == psIdle )
+  {
+    return false;
+  }
+
+  // Mark planner cells (in the next rows) that contain any blocked
+  // occupancy grid cell.  The far side of an obstacle can't be seen
+  // from in front of it, so unknown cells up to the assumed depth
+  // beyond a blocked cell (further along the line) are taken to be
+  // part of the obstacle; a cell seen free ends the shadow.
+
+  float gridCellMM = grid.getCellSizeMM();
+  uint8_t samples = static_cast<uint8_t>(ceil(m_cellSizeMM / gridCellMM));
+
+  if ( samples == 0 )
+  {
+    samples = 1;
+  }
+
+  float sampleStep = m_cellSizeMM / samples;
+
+  uint8_t depthCells = static_cast<uint8_t>(ceil(m_depthMM / m_cellSizeMM));
+
+  maxRows = ( maxRows > 0 ) ? maxRows : 1;
+
+  for ( ; (m_sampleRow < Dim) && (maxRows > 0); ++m_sampleRow, --maxRows )
+  {
+    uint8_t row = m_sampleRow;
+    uint8_t shadow = 0;       // Unknown cells still in shadow
+
+    for ( uint8_t column = 0; column < Dim; ++column )
+    {
+      bool blocked = false;
+      bool unknown = true;
+
+      for ( uint8_t sx = 0; (sx < samples) && !blocked; ++sx )
+      {
+        for ( uint8_t sy = 0; (sy < samples) && !blocked; ++sy )
+        {
+          // Sample offset from the cell center (in planner frame).
+
+          float localX = (column - StartColumn) * m_cellSizeMM +
+                         (sx + 0.5) * sampleStep - m_cellSizeMM / 2.0;
+          float localY = (row - LineRow) * m_cellSizeMM +
+                         (sy + 0.5) * sampleStep - m_cellSizeMM / 2.0;
+
+          float xMM = m_anchor.xMM + localX * m_cosHeading - localY * m_sinHeading;
+          float yMM = m_anchor.yMM + localX * m_sinHeading + localY * m_cosHeading;
+
+          OccupancyGrid::CellState state = grid.getCellAt(xMM, yMM);
+
+          blocked = ( state >= OccupancyGrid::csMaybe );
+          unknown = unknown && ( state == OccupancyGrid::csUnknown );
+        }
+      }
+
+      if ( blocked )
+      {
+        shadow = depthCells;
+      }
+      else if ( unknown && (shadow > 0) )
+      {
+        blocked = true;
+        --shadow;
+      }
+      else
+      {
+        shadow = 0;
+      }
+
+      setBit(m_occupied, cellIndex(column, row), blocked);
+    }
+  }
+
+  if ( m_sampleRow < Dim )
+  {
+    return false;   // More rows to sample
+  }
+
+  m_sampleRow = 0;
+
+  // Grow obstacles by the clearance distance, in a square: the car
+  // only moves straight or diagonally (it never rotates on a detour),
+  // so its square body clears an obstacle by as much at the corners
+  // as at the sides.
+
+  uint8_t blocked[sizeof(m_blocked)];
+
+  for ( uint8_t index = 0; index < sizeof(blocked); ++index )
+  {
+    blocked[index] = 0;
+  }
+
+  int8_t radius = static_cast<int8_t>(ceil(m_clearanceMM / m_cellSizeMM));
+
+  for ( uint16_t cell = 0; cell < NumCells; ++cell )
+  {
+    if ( !getBit(m_occupied, cell) )
+    {
+      continue;
+    }
+
+    int8_t column = cellColumn(cell);
+    int8_t row = cellRow(cell);
+
+    for ( int8_t dy = -radius; dy <= radius; ++dy )
+    {
+      for ( int8_t dx = -radius; dx <= radius; ++dx )
+      {
+        int8_t c = column + dx;
+        int8_t r = row + dy;
+
+        if ( (c >= 0) && (c < Dim) && (r >= 0) && (r < Dim) )
+        {
+          setBit(blocked, cellIndex(c, r), true);
+        }
+      }
+    }
+  }
+
+  // The car's own cell is never treated as blocked.
+
+  setBit(blocked, m_start, false);
+
+  // Install the new obstacles, remembering which cells changed.
+
+  uint8_t changed[sizeof(m_blocked)];
+
+  for ( uint8_t index = 0; index < sizeof(m_blocked); ++index )
+  {
+    changed[index] = m_blocked[index] ^ blocked[index];
+    m_blocked[index] = blocked[index];
+  }
+
+  // A new goal means a new search, otherwise re-plan around changes.
+
+  if ( chooseGoal() )
+  {
+    resetSearch();
+    return true;
+  }
+
+  for ( uint16_t cell = 0; cell < NumCells; ++cell )
+  {
+    if ( getBit(changed, cell) )
+    {
+      updateAround(cell);
+      m_status = psPlanning;
+    }
+  }
+
+  return true;
+}
+
+DetourPlanner::PlanStatus DetourPlanner::plan(uint16_t maxExpansions)
+{
+  if ( (m_status == psIdle) || (m_status == psFound) || (m_status == psNoPath) )
+  {
+    return m_status;
+  }
+
+  // D* Lite "ComputeShortestPath", bounded to maxExpansions cells.
+
+  for ( uint16_t expansion = 0; expansion < maxExpansions; ++expansion )
+  {
+    uint8_t cell;
+    uint16_t key1, startKey1;
+    uint8_t key2, startKey2;
+
+    bool haveOpen = topOpenCell(cell, key1, key2);
+
+    calculateKey(m_start, startKey1, startKey2);
+
+    bool topBeforeStart = haveOpen &&
+                          ( (key1 < startKey1) ||
+                            ((key1 == startKey1) && (key2 < startKey2)) );
+
+    if ( !haveOpen ||
+         (!topBeforeStart && (m_rhs[m_start] == m_g[m_start])) )
+    {
+      m_status = ( m_g[m_start] == Infinite ) ? psNoPath : psFound;
+      return m_status;
+    }
+
+    if ( m_g[cell] > m_rhs[cell] )
+    {
+      // Over-consistent: cost to goal improved.
+
+      m_g[cell] = m_rhs[cell];
+      setBit(m_open, cell, false);
+    }
+    else
+    {
+      // Under-consistent: cost to goal got worse.
+
+      m_g[cell] = Infinite;
+      updateCell(cell);
+    }
+
+    for ( uint8_t direction = 0; direction < 8; ++direction )
+    {
+      uint8_t next;
+
+      if ( neighbor(cell, direction, next) )
+      {
+        updateCell(next);
+      }
+    }
+  }
+
+  return m_status;
+}
+
+DetourPlanner::PlanStatus DetourPlanner::getStatus() const
+{
+  return m_status;
+}
+
+uint8_t DetourPlanner::getSegments(DetourSegment* segments,
+                                   uint8_t maxSegments) const
+{
+  if ( (m_status != psFound) || (maxSegments == 0) )
+  {
+    return 0;
+  }
+
+  const float SQRT_2 = 1.41421356237;
+
+  uint8_t numSegments = 0;
+  uint8_t cell = m_start;
+
+  // Follow the cheapest neighbor until the goal is reached.  The
+  // step limit guards against a path still being re-planned.
+
+  for ( uint16_t step = 0; (step < NumCells) && (cell != m_goal); ++step )
+  {
+    uint8_t bestDirection = 0;
+    uint8_t bestNext = cell;
+    uint16_t bestCost = Infinite;
+
+    for ( uint8_t direction = 0; direction < 8; ++direction )
+    {
+      uint8_t next;
+
+      if ( !neighbor(cell, direction, next) )
+      {
+        continue;
+      }
+
+      uint8_t cost = edgeCost(cell, direction, next);
+
+      if ( (cost == Infinite) || (m_g[next] == Infinite) )
+      {
+        continue;
+      }
+
+      if ( cost + m_g[next] < bestCost )
+      {
+        bestCost = cost + m_g[next];
+        bestDirection = direction;
+        bestNext = next;
+      }
+    }
+
+    if ( bestNext == cell )
+    {
+      break;    // Dead end (shouldn't happen with a found path).
+    }
+
+    float stepMM = ( bestDirection >= 4 ) ? ( m_cellSizeMM * SQRT_2 )
+                                          : m_cellSizeMM;
+
+    // Extend the current segment, or start a new one.
+
+    if ( (numSegments > 0) &&
+         (segments[numSegments - 1].moveState == DirMoveState[bestDirection]) )
+    {
+      segments[numSegments - 1].millimeters += stepMM;
+    }
+    else
+    {
+      if ( numSegments == maxSegments )
+      {
+        break;
+      }
+
+      segments[numSegments].moveState = DirMoveState[bestDirection];
+      segments[numSegments].millimeters = stepMM;
+      ++numSegments;
+    }
+
+    cell = bestNext;
+  }
+
+  return numSegments;
+}
+
+bool DetourPlanner::isBlocked(uint8_t column, uint8_t row) const
+{
+  if ( (column >= Dim) || (row >= Dim) )
+  {
+    return true;
+  }
+
+  return getBit(m_blocked, cellIndex(column, row));
+}
+
+bool DetourPlanner::neighbor(uint8_t cell, uint8_t direction, uint8_t& next)
+{
+  int8_t column = cellColumn(cell) + DirColumn[direction];
+  int8_t row = cellRow(cell) + DirRow[direction];
+
+  if ( (column < 0) || (column >= Dim) || (row < 0) || (row >= Dim) )
+  {
+    return false;
+  }
+
+  next = cellIndex(column, row);
+
+  return true;
+}
+
+uint8_t DetourPlanner::edgeCost(uint8_t from, uint8_t direction, uint8_t to) const
+{
+  if ( getBit(m_blocked, from) || getBit(m_blocked, to) )
+  {
+    return Infinite;
+  }
+
+  if ( direction < 4 )
+  {
+    return StraightCost;
+  }
+
+  // Diagonal moves may not cut the corner of a blocked cell.
+
+  uint8_t column = cellColumn(from);
+  uint8_t row = cellRow(from);
+
+  if ( getBit(m_blocked, cellIndex(column + DirColumn[direction], row)) ||
+       getBit(m_blocked, cellIndex(column, row + DirRow[direction])) )
+  {
+    return Infinite;
+  }
+
+  return DiagonalCost;
+}
+
+uint8_t DetourPlanner::heuristic(uint8_t from, uint8_t to)
+{
+  // Octile distance: diagonal steps first, then straight steps.
+
+  uint8_t dx = ( cellColumn(from) > cellColumn(to) ) ?
+                 ( cellColumn(from) - cellColumn(to) ) :
+                 ( cellColumn(to) - cellColumn(from) );
+  uint8_t dy = ( cellRow(from) > cellRow(to) ) ?
+                 ( cellRow(from) - cellRow(to) ) :
+                 ( cellRow(to) - cellRow(from) );
+
+  uint8_t diagonal = ( dx < dy ) ? dx : dy;
+  uint8_t straight = ( dx < dy ) ? ( dy - dx ) : ( dx - dy );
+
+  return diagonal * DiagonalCost + straight * StraightCost;
+}
+
+void DetourPlanner::calculateKey(uint8_t cell, uint16_t& key1, uint8_t& key2) const
+{
+  uint8_t cost = ( m_g[cell] < m_rhs[cell] ) ? m_g[cell] : m_rhs[cell];
+
+  key2 = cost;
+
+  if ( cost == Infinite )
+  {
+    key1 = 0xFFFF;
+    return;
+  }
+
+  key1 = cost + heuristic(m_start, cell) + m_keyOffset;
+}
+
+void DetourPlanner::updateCell(uint8_t cell)
+{
+  if ( cell != m_goal )
+  {
+    uint16_t best = Infinite;
+
+    for ( uint8_t direction = 0; direction < 8; ++direction )
+    {
+      uint8_t next;
+
+      if ( !neighbor(cell, direction, next) )
+      {
+        continue;
+      }
+
+      uint8_t cost = edgeCost(cell, direction, next);
+
+      if ( (cost != Infinite) && (m_g[next] != Infinite) &&
+           (cost + m_g[next] < best) )
+      {
+        best = cost + m_g[next];
+      }
+    }
+
+    // Costs that don't fit in 8 bits are unreachable.
+
+    m_rhs[cell] = ( best >= Infinite ) ? Infinite : best;
+  }
+
+  setBit(m_open, cell, m_g[cell] != m_rhs[cell]);
+}
+
+void DetourPlanner::updateAround(uint8_t cell)
+{
+  updateCell(cell);
+
+  for ( uint8_t direction = 0; direction < 8; ++direction )
+  {
+    uint8_t next;
+
+    if ( neighbor(cell, direction, next) )
+    {
+      updateCell(next);
+    }
+  }
+}
+
+bool DetourPlanner::topOpenCell(uint8_t& cell, uint16_t& key1, uint8_t& key2) const
+{
+  bool found = false;
+
+  for ( uint8_t index = 0; index < sizeof(m_open); ++index )
+  {
+    // Skip eight closed cells at a time.
+
+    if ( m_open[index] == 0 )
+    {
+      continue;
+    }
+
+    for ( uint8_t bit = 0; bit < 8; ++bit )
+    {
+      if ( !(m_open[index] & (1 << bit)) )
+      {
+        continue;
+      }
+
+      uint8_t candidate = index * 8 + bit;
+      uint16_t candidateKey1;
+      uint8_t candidateKey2;
+
+      calculateKey(candidate, candidateKey1, candidateKey2);
+
+      if ( !found || (candidateKey1 < key1) ||
+           ((candidateKey1 == key1) && (candidateKey2 < key2)) )
+      {
+        found = true;
+        cell = candidate;
+        key1 = candidateKey1;
+        key2 = candidateKey2;
+      }
+    }
+  }
+
+  return found;
+}
+
+void DetourPlanner::resetSearch()
+{
+  for ( uint16_t cell = 0; cell < NumCells; ++cell )
+  {
+    m_g[cell] = Infinite;
+    m_rhs[cell] = Infinite;
+  }
+
+  for ( uint8_t index = 0; index < sizeof(m_open); ++index )
+  {
+    m_open[index] = 0;
+  }
+
+  m_keyOffset = 0;
+  m_lastStart = m_start;
+
+  // Search runs backward from the goal.
+
+  m_rhs[m_goal] = 0;
+  setBit(m_open, m_goal, true);
+
+  m_status = psPlanning;
+}
+
+bool DetourPlanner::chooseGoal()
+{
+  // Goal is just past the last blocked cell on the line.  If nothing
+  // blocks the line, it's the far end of the line.
+
+  uint8_t goalColumn = Dim - 1;
+
+  for ( uint8_t column = Dim - 1; column > StartColumn; --column )
+  {
+    if ( getBit(m_blocked, cellIndex(column, LineRow)) )
+    {
+      goalColumn = ( column + 1 < Dim ) ? ( column + 1 ) : column;
+      break;
+    }
+  }
+
+  uint8_t goal = cellIndex(goalColumn, LineRow);
+
+  if ( goal == m_goal )
+  {
+    return false;
+  }
+
+  m_goal = goal;
+
+  return true;
+}
+
+void DetourPlanner::cellToWorld(uint8_t column, uint8_t row,
+                                float& xMM, float& yMM) const
+{
+  float localX = (static_cast<int8_t>(column) - StartColumn) * m_cellSizeMM;
+  float localY = (static_cast<int8_t>(row) - LineRow) * m_cellSizeMM;
+
+  xMM = m_anchor.xMM + localX * m_cosHeading - localY * m_sinHeading;
+  yMM = m_anchor.yMM + localX * m_sinHeading + localY * m_cosHeading;
+}
+
+uint8_t DetourPlanner::worldToCell(const Pose2D& pose) const
+{
+  float dx = pose.xMM - m_anchor.xMM;
+  float dy = pose.yMM - m_anchor.yMM;
+
+  // Rotate into the planner frame, then round to the nearest cell.
+
+  float localX =  dx * m_cosHeading + dy * m_sinHeading;
+  float localY = -dx * m_sinHeading + dy * m_cosHeading;
+
+  int16_t column = static_cast<int16_t>(floor(localX / m_cellSizeMM + 0.5)) + StartColumn;
+  int16_t row = static_cast<int16_t>(floor(localY / m_cellSizeMM + 0.5)) + LineRow;
+
+  if ( column < 0 ) column = 0;
+  if ( column >= Dim ) column = Dim - 1;
+  if ( row < 0 ) row = 0;
+  if ( row >= Dim ) row = Dim - 1;
+
+  return cellIndex(column, row);
+}
+
+void DetourPlanner::setBit(uint8_t* bits, uint8_t cell, bool value)
+{
+  if ( value )
+  {
+    bits[cell >> 3] |= ( 1 << (cell & 0x07) );
+  }
+  else
+  {
+    bits[cell >> 3] &= ~( 1 << (cell & 0x07) );
+  }
+}
+
+}   // End namespace
@@ -0,0 +1,209 @@
+#ifndef INCLUDE_CSCI_DETOUR_PLANNER
+#define INCLUDE_CSCI_DETOUR_PLANNER
+
+// DetourPlanner class header file for planning obstacle detours.
+
+#include "CSCICore.h"
+#include "CSCIDriveTrain.h"       // MoveState
+#include "CSCIOccupancyGrid.h"    // Pose2D, OccupancyGrid
+
+namespace csci
+{
+
+/*********************** DETOUR SEGMENT ****************************/
+// A DetourSegment is one straight line drive train movement.
+// Pass it to TMDriveTrain::moveMM(...) to drive it.
+
+struct DetourSegment
+{
+  MoveState moveState;      // Direction of movement (never a rotation)
+  float     millimeters;    // Distance to move
+};
+
+/************************ DETOUR PLANNER ***************************/
+// A DetourPlanner finds the shortest collision free path around an
+// obstacle that rejoins the tape line, and keeps it up to date as
+// new range readings arrive (D* Lite incremental search).
+//
+// The planner works in a small Dim x Dim grid of its own, anchored
+// at the pose passed to begin().  The line is assumed to continue
+// straight ahead along that pose's heading.  The car starts in
+// column 1 of the center row, and the goal is the first cell on the
+// line beyond the obstacle.
+//
+// Since a mecanum drive train can move in eight directions without
+// rotating, the path is 8-connected (straight = 2, diagonal = 3,
+// no cutting corners) and is emitted as straight movements.
+//
+// Obstacles are copied from an OccupancyGrid and grown by the
+// clearance distance (about half the car's width) in x and y, so the
+// path is planned for the center of the (square, unrotated) car.
+// The far side of an obstacle can't be seen from in front, so until
+// it has been seen the obstacle is assumed to reach the given depth
+// along the line.  Only cells whose obstacle state changed are
+// re-planned.  Each call to updateObstacles() samples only a few rows
+// of the planner grid, so the (floating point) sampling is spread
+// over several passes; the obstacles are grown and installed once
+// all Dim rows have been sampled.
+//
+// Memory: The planner uses about 640 bytes, independent of the
+//         obstacle.  Path costs are 8 bits, so paths costing more
+//         than 254 (more than about 100 cells) are treated as "no
+//         path".  The open list is a bit set whose minimum is found
+//         by scanning, which trades some speed for bounded memory.
+//
+// Usage: When an obstacle is detected, call begin() with the current
+//        pose.  Then, every pass through the control loop:
+//
+//          1. setPose() with the latest odometry pose.
+//          2. updateObstacles() with the occupancy grid (and a
+//             bound on the rows to sample this pass).
+//          3. plan() with a bound on the work to do this pass.
+//
+//        Once plan() returns psFound, getSegments() returns the
+//        movements that make up the detour from the current pose.
+
+class DetourPlanner
+{
+  public:
+  // Planner grid dimension (in cells).
+
+  static const uint8_t Dim = 16;
+
+  // Planning status.
+
+  typedef enum
+  {
+    psIdle,       // begin() not called
+    psPlanning,   // Search not finished (call plan() again)
+    psFound,      // Path found
+    psNoPath      // No path exists (with what is currently known)
+  } PlanStatus;
+
+  // Construct using planner cell size, obstacle clearance and
+  // assumed obstacle depth (all in millimeters).
+
+  DetourPlanner(float cellSizeMM = 100.0, float clearanceMM = 200.0, float depthMM = 300.0);
+
+  // Start planning a new detour from the pose.  The tape line is
+  // assumed to continue along the pose's heading.
+
+  void begin(const Pose2D& pose);
+
+  // Move the start of the path to the car's current pose.
+
+  void setPose(const Pose2D& pose);
+
+  // Sample the next "maxRows" rows of the planner grid from an
+  // occupancy grid.  Once every row has been sampled, the obstacles
+  // are installed, cells that changed are re-planned on the next call
+  // to plan(), and "true" is returned.  (Each row costs Dim cells
+  // times (cellSizeMM / the grid's cell size)^2 grid samples.)
+
+  bool updateObstacles(const OccupancyGrid& grid, uint8_t maxRows = 2);
+
+  // Continue planning, expanding at most maxExpansions cells.
+
+  PlanStatus plan(uint16_t maxExpansions = 256);
+
+  // Returns the current planning status.
+
+  PlanStatus getStatus() const;
+
+  // Fill "segments" (up to maxSegments) with the movements making up
+  // the planned path from the current pose.  Returns the number of
+  // segments, 0 if there is no path (or the car is at the goal).
+
+  uint8_t getSegments(DetourSegment* segments, uint8_t maxSegments) const;
+
+  // Returns "true" if planner cell (column, row) is blocked.
+
+  bool isBlocked(uint8_t column, uint8_t row) const;
+
+  protected:
+  static const uint8_t  Infinite = 255;       // Unreachable path cost
+  static const uint8_t  StraightCost = 2;     // Cost of a straight step
+  static const uint8_t  DiagonalCost = 3;     // Cost of a diagonal step
+  static const uint8_t  StartColumn = 1;      // Car's initial column
+  static const uint8_t  LineRow = Dim / 2;    // Row the tape line is on
+  static const uint16_t NumCells = Dim * Dim;
+
+  // Cell index helpers.
+
+  static uint8_t  cellIndex(uint8_t column, uint8_t row) { return row * Dim + column; }
+  static uint8_t  cellColumn(uint8_t cell) { return cell % Dim; }
+  static uint8_t  cellRow(uint8_t cell) { return cell / Dim; }
+
+  // Returns the neighbor of "cell" in direction (0 - 7).  Returns
+  // "false" if the neighbor is outside the planner grid.
+
+  static bool neighbor(uint8_t cell, uint8_t direction, uint8_t& next);
+
+  // Cost to move between neighboring cells (Infinite if blocked).
+
+  uint8_t edgeCost(uint8_t from, uint8_t direction, uint8_t to) const;
+
+  // Heuristic cost between two cells.
+
+  static uint8_t heuristic(uint8_t from, uint8_t to);
+
+  // D* Lite priority of a cell.
+
+  void calculateKey(uint8_t cell, uint16_t& key1, uint8_t& key2) const;
+
+  // Recompute a cell's one step lookahead cost and open list membership.
+
+  void updateCell(uint8_t cell);
+
+  // Update a cell and all its neighbors.
+
+  void updateAround(uint8_t cell);
+
+  // Find the open cell with the smallest key.  Returns "false" if
+  // the open list is empty.
+
+  bool topOpenCell(uint8_t& cell, uint16_t& key1, uint8_t& key2) const;
+
+  // Reset the search to the current goal.
+
+  void resetSearch();
+
+  // Choose the goal (first free cell on the line past the obstacle).
+  // Returns "true" if the goal changed.
+
+  bool chooseGoal();
+
+  // Convert planner cell to/from world coordinates.
+
+  void cellToWorld(uint8_t column, uint8_t row, float& xMM, float& yMM) const;
+  uint8_t worldToCell(const Pose2D& pose) const;
+
+  // Bit set helpers.
+
+  static bool getBit(const uint8_t* bits, uint8_t cell)
+    { return ( bits[cell >> 3] >> (cell & 0x07) ) & 0x01; }
+  static void setBit(uint8_t* bits, uint8_t cell, bool value);
+
+  protected:
+  uint8_t     m_g[NumCells];          // Cost to goal
+  uint8_t     m_rhs[NumCells];        // One step lookahead cost to goal
+  uint8_t     m_open[NumCells / 8];   // Open list (bit set)
+  uint8_t     m_blocked[NumCells / 8];// Blocked cells (bit set)
+  uint8_t     m_occupied[NumCells / 8];// Sampled obstacles (bit set)
+  uint8_t     m_sampleRow;            // Next row to sample
+  float       m_cellSizeMM;           // Planner cell size
+  float       m_clearanceMM;          // Obstacle clearance
+  float       m_depthMM;              // Assumed obstacle depth
+  Pose2D      m_anchor;               // Pose of planner frame origin
+  float       m_cosHeading;           // Planner frame orientation
+  float       m_sinHeading;
+  uint8_t     m_start;                // Start (car) cell
+  uint8_t     m_lastStart;            // Start cell at last key offset change
+  uint8_t     m_goal;                 // Goal cell
+  uint16_t    m_keyOffset;            // D* Lite "km"
+  PlanStatus  m_status;               // Planning status
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_DETOUR_PLANNER
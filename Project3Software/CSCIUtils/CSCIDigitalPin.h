@@ -5,6 +5,7 @@
 
 #include "CSCICore.h"
 #include "CSCIGPIO.h"
+#include "CSCITimer.h"
 
 namespace csci
 {
@@ -12,58 +13,130 @@ namespace csci
 //********************** DIGITAL OUTPUT *****************************/
 // A DigitalOutput is associated with a HIGH/LOW output pin and can
 // only be in one of two states: "active" or "inactive".
+//
+// The output classes (DigitalOutput, DigitalLed, ActiveBuzzer) are
+// templates on the pin class underneath: GPIOOutputPin, whose pin is
+// chosen at run time, or FastOutputPin, whose pin is fixed at compile
+// time (see CSCIGPIO.h).  The usual names use GPIOOutputPin; the Fast
+// versions (FastDigitalOutput, FastDigitalLed, FastActiveBuzzer) take
+// the pin number and active state as template arguments:
+//
+//   csci::DigitalLed led(13);
+//   csci::FastDigitalLed<13> fastLed;
 
-class DigitalOutput
+template <class OutputPin>
+class BasicDigitalOutput
 {
   protected:
   // activeState = HIGH means device is active if port is HIGH
   // activeState = LOW  means device is active if port is LOW  
-  DigitalOutput(int pinNumber, int activeState);
+  BasicDigitalOutput(int pinNumber, int activeState)
+  : m_gpioPin(pinNumber, activeState) { }
+
+  // Use an already set up (fast) pin.
+
+  explicit BasicDigitalOutput(const OutputPin& gpioPin)
+  : m_gpioPin(gpioPin) { }
   
   public:
   void active()   { m_gpioPin.active(); }   // Set output port to active state
   void inactive() { m_gpioPin.inactive(); } // Set output port to inactive state
   
   // Set/get which state (HIGH or LOW) is considered the active state
+  // (Fast pins' active states can't be set.)
   void setActiveState(int state) { m_gpioPin.setActiveState(state); }
   int  getActiveState() const { return m_gpioPin.getActiveState(); }
   
   // Pulse output state for the specified duration.
   
-  void pulseActive(uint32_t microSeconds);
-  void pulseInactive(uint32_t microSeconds);
+  void pulseActive(uint32_t microSeconds)
+  {
+    active();
+    WaitMicros(microSeconds);
+    inactive();
+  }
+
+  void pulseInactive(uint32_t microSeconds)
+  {
+    inactive();
+    WaitMicros(microSeconds);
+    active();
+  }
   
   // Cycle output state for the specified durations.
 
-  void cycleActive(uint32_t microsActive, uint32_t microsInactive);
-  void cycleInactive(uint32_t microsInactive, uint32_t microsActive);
+  void cycleActive(uint32_t microsActive, uint32_t microsInactive)
+  {
+    pulseActive(microsActive);
+    pulseInactive(microsInactive);
+  }
+
+  void cycleInactive(uint32_t microsInactive, uint32_t microsActive)
+  {
+    pulseInactive(microsInactive);
+    pulseActive(microsActive);
+  }
   
   private:
-  GPIOOutputPin m_gpioPin;  // GPIO output pin object is connected to.
+  OutputPin m_gpioPin;  // GPIO output pin object is connected to.
+};
+
+typedef BasicDigitalOutput<GPIOOutputPin> DigitalOutput;
+
+template <uint8_t Pin, uint8_t ActiveState = HIGH>
+class FastDigitalOutput : public BasicDigitalOutput< FastOutputPin<Pin, ActiveState> >
+{
+  protected:
+  FastDigitalOutput()
+  : BasicDigitalOutput< FastOutputPin<Pin, ActiveState> >(FastOutputPin<Pin, ActiveState>()) { }
 };
 
 /********************** DIGITAL INPUT ******************************/
 // A DigitalInput is associated with a HIGH/LOW input pin and can only
 // be active or inactive.
+//
+// Like the outputs, the input classes (DigitalInput, DigitalSwitch,
+// PushButton) are templates on the pin class (GPIOInputPin or
+// FastInputPin), with Fast versions (FastDigitalInput,
+// FastDigitalSwitch, FastPushButton).
 
-class DigitalInput
+template <class InputPin>
+class BasicDigitalInput
 {
   protected:
   // activeState = HIGH means input is active if port is HIGH
   // activeState = LOW  means input is active if port is LOW
   // activateInternalPullUp = "true" if internal pull-up resistor is to be activated
-  DigitalInput(int pinNumber, int activeState, bool activateInternalPullUp);  
+  BasicDigitalInput(int pinNumber, int activeState, bool activateInternalPullUp)
+  : m_gpioPin(pinNumber, activeState, activateInternalPullUp) { }
+
+  // Use an already set up (fast) pin.
+
+  explicit BasicDigitalInput(const InputPin& gpioPin)
+  : m_gpioPin(gpioPin) { }
   
   public:
   bool active() const   { return m_gpioPin.active(); }    // Returns "true" if active, "false" if inactive
   bool inactive() const { return m_gpioPin.inactive(); }  // Returns "true" if inactive, "false" if active
   
   // Set/get which state (HIGH or LOW) is considered the active state
+  // (Fast pins' active states can't be set.)
   void setActiveState(int state) { m_gpioPin.setActiveState(state); }  
   int  getActiveState() const { return m_gpioPin.getActiveState(); }
   
   private:
-  GPIOInputPin  m_gpioPin;  // GPIO input pin port is connected to.
+  InputPin  m_gpioPin;  // GPIO input pin port is connected to.
+};
+
+typedef BasicDigitalInput<GPIOInputPin> DigitalInput;
+
+template <uint8_t Pin, uint8_t ActiveState = HIGH>
+class FastDigitalInput : public BasicDigitalInput< FastInputPin<Pin, ActiveState> >
+{
+  protected:
+  FastDigitalInput(bool activateInternalPullUp = NoInternalPullUp)
+  : BasicDigitalInput< FastInputPin<Pin, ActiveState> >
+      (FastInputPin<Pin, ActiveState>(activateInternalPullUp)) { }
 };
 
 }   // End namespace
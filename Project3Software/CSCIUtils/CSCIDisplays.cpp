@@ -1,13 +1,140 @@
 // Displays classes implementation file for Arduino sensors/devices
 
 #include "CSCIDisplays.h"
+#include <math.h>
+#include <string.h>
 
 namespace csci
 {
 
 // ---------------------------------------------------------
 
+uint8_t formatUnsigned(char* buffer, uint32_t value)
+{
+  // Digits backwards, then reverse.  32 bit division is slow on the
+  // AVR, so switch to 16 bit division as soon as the value fits.
+
+  uint8_t length = 0;
+
+  while ( value > 0xFFFF )
+  {
+    buffer[length++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+
+  uint16_t small = static_cast<uint16_t>(value);
+
+  do
+  {
+    buffer[length++] = static_cast<char>('0' + small % 10);
+    small /= 10;
+  } while ( small > 0 );
+
+  for ( uint8_t front = 0, back = length - 1; front < back; ++front, --back )
+  {
+    char digit = buffer[front];
+
+    buffer[front] = buffer[back];
+    buffer[back] = digit;
+  }
+
+  buffer[length] = '\0';
+  return length;
+}
+
+uint8_t formatLong(char* buffer, long value)
+{
+  if ( value >= 0 )
+  {
+    return formatUnsigned(buffer, static_cast<uint32_t>(value));
+  }
+
+  buffer[0] = '-';
+  return 1 + formatUnsigned(buffer + 1, 0UL - static_cast<uint32_t>(value));
+}
+
+uint8_t formatFixed(char* buffer, double value, uint8_t decimals)
+{
+  static const uint32_t Powers[] =
+    { 1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL,
+      100000000UL, 1000000000UL };
+
+  const char* special = NULL;
+
+  if ( isnan(value) )
+  {
+    special = "nan";
+  }
+  else if ( isinf(value) )
+  {
+    special = ( value < 0.0 ) ? "-inf" : "inf";
+  }
+  else if ( (value > 4294967040.0) || (value < -4294967040.0) )
+  {
+    special = "ovf";    // As Print does
+  }
+
+  if ( special != NULL )
+  {
+    strcpy(buffer, special);
+    return static_cast<uint8_t>(strlen(special));
+  }
+
+  if ( decimals > 9 )
+  {
+    decimals = 9;
+  }
+
+  uint8_t length = 0;
+
+  if ( value < 0.0 )
+  {
+    buffer[length++] = '-';
+    value = -value;
+  }
+
+  // Whole and (rounded) fraction parts as integers.
+
+  uint32_t scale = Powers[decimals];
+  uint32_t whole = static_cast<uint32_t>(value);
+  uint32_t fraction = static_cast<uint32_t>((value - whole) * scale + 0.5);
+
+  if ( fraction >= scale )
+  {
+    ++whole;
+    fraction -= scale;
+  }
+
+  length += formatUnsigned(buffer + length, whole);
+
+  if ( decimals > 0 )
+  {
+    buffer[length++] = '.';
+
+    // Leading zeros of the fraction.
+
+    for ( uint32_t limit = scale / 10; (limit > 1) && (fraction < limit); limit /= 10 )
+    {
+      buffer[length++] = '0';
+    }
+
+    length += formatUnsigned(buffer + length, fraction);
+  }
+
+  buffer[length] = '\0';
+  return length;
+}
+
+// ---------------------------------------------------------
+
 SerialMonitor::SerialMonitor(uint32_t dataRate)
+  : m_buffer(NULL),
+    m_size(0),
+    m_head(0),
+    m_count(0),
+    m_highWater(0),
+    m_dropped(0),
+    m_policy(opDropNewest)
 {
   m_dataRate = dataRate;
 }
@@ -17,24 +144,142 @@ void SerialMonitor::setup()
   Serial.begin(m_dataRate);
 }
 
+void SerialMonitor::setBuffer(uint8_t* buffer, uint16_t size, OverflowPolicy policy)
+{
+  flush();    // Anything in the old buffer goes first
+
+  m_buffer = ( size > 0 ) ? buffer : NULL;
+  m_size = size;
+  m_head = 0;
+  m_count = 0;
+  m_highWater = 0;
+  m_policy = policy;
+}
+
+void SerialMonitor::update()
+{
+  // Only as much as Serial's transmit buffer has room for, so
+  // Serial.write() never waits.
+
+  int room = Serial.availableForWrite();
+
+  while ( (m_count > 0) && (room > 0) )
+  {
+    Serial.write(m_buffer[m_head]);
+    m_head = (m_head + 1 < m_size) ? m_head + 1 : 0;
+    --m_count;
+    --room;
+  }
+}
+
+void SerialMonitor::flush()
+{
+  while ( m_count > 0 )
+  {
+    update();
+  }
+}
+
+size_t SerialMonitor::write(uint8_t value)
+{
+  if ( m_buffer == NULL )
+  {
+    return Serial.write(value);
+  }
+
+  update();
+
+  if ( m_count == m_size )
+  {
+    if ( m_policy == opDropNewest )
+    {
+      ++m_dropped;
+      return 0;
+    }
+
+    if ( m_policy == opDropOldest )
+    {
+      m_head = (m_head + 1 < m_size) ? m_head + 1 : 0;
+      --m_count;
+      ++m_dropped;
+    }
+    else
+    {
+      flush();
+    }
+  }
+
+  uint16_t tail = m_head + m_count;
+
+  m_buffer[(tail < m_size) ? tail : tail - m_size] = value;
+
+  if ( ++m_count > m_highWater )
+  {
+    m_highWater = m_count;
+  }
+
+  return 1;
+}
+
+size_t SerialMonitor::write(const uint8_t* buffer, size_t size)
+{
+  // Offer every byte, so every dropped byte is counted.
+
+  size_t count = 0;
+
+  for ( size_t index = 0; index < size; ++index )
+  {
+    count += write(buffer[index]);
+  }
+
+  return count;
+}
+
+int SerialMonitor::availableForWrite()
+{
+  if ( m_buffer == NULL )
+  {
+    return Serial.availableForWrite();
+  }
+
+  update();
+  return m_size - m_count;
+}
+
 void SerialMonitor::sendIntegerValue(int value, int base)
 {
-  Serial.print(value, base);
+  sendLongValue(value, base);
 }
 
-void SerialMonitor::sendUnsignedIntegerValue(unsigned int value, int base)
+void SerialMonitor::sendUnsignedIntegerValue(uint16_t value, int base)
 {
-  Serial.print(value, base);
+  sendUnsignedLongValue(value, base);
 }
 
 void SerialMonitor::sendLongValue(long value, int base)
 {
-  Serial.print(value, base);
+  if ( base != DEC )
+  {
+    print(value, base);
+    return;
+  }
+
+  char buffer[FormatBufferSize];
+
+  write(reinterpret_cast<const uint8_t*>(buffer), formatLong(buffer, value));
 }
 
 void SerialMonitor::sendUnsignedLongValue(uint32_t value, int base)
 {
-  Serial.print(value, base);
+  if ( base != DEC )
+  {
+    print(value, base);
+    return;
+  }
+
+  char buffer[FormatBufferSize];
+
+  write(reinterpret_cast<const uint8_t*>(buffer), formatUnsigned(buffer, value));
 }
 
 void SerialMonitor::sendBooleanValue(bool value)
@@ -51,7 +296,10 @@ void SerialMonitor::sendBooleanValue(bool value)
 
 void SerialMonitor::sendDoubleValue(double value, int decimals)
 {
-  Serial.print(value, decimals);
+  char buffer[FormatBufferSize];
+  uint8_t places = ( decimals < 0 ) ? 0 : static_cast<uint8_t>(decimals);
+
+  write(reinterpret_cast<const uint8_t*>(buffer), formatFixed(buffer, value, places));
 }
 
 void SerialMonitor::sendDigitalLogicValue(int value)
@@ -75,14 +323,24 @@ void SerialMonitor::sendDigitalLogicValue(int value)
   }  
 }
 
+void SerialMonitor::sendText(const __FlashStringHelper* text)
+{
+  print(text);
+}
+
+void SerialMonitor::sendText(const char* text)
+{
+  print(text);
+}
+
 void SerialMonitor::sendText(const String& text)
 {
-  Serial.print(text);
+  print(text);
 }
 
 void SerialMonitor::sendNewline()
 {
-  Serial.println();
+  println();
 }
 
 }   // End namespace
@@ -8,19 +8,82 @@
 namespace csci
 {
 
+/********************** NUMBER FORMATTING **************************/
+// Decimal formatting into a caller's buffer (no heap).  Values are
+// formatted as Print does them (rounded, "nan", "inf", "ovf"), but
+// with integer arithmetic: much faster than Print's float printing
+// on the AVR, which has no floating point hardware.
+
+// Buffer size that holds any formatted value (and the NUL).
+
+const uint8_t FormatBufferSize = 24;
+
+// Format a value.  Returns the length (not counting the NUL).
+
+uint8_t formatUnsigned(char* buffer, uint32_t value);
+uint8_t formatLong(char* buffer, long value);
+
+// "decimals" is 0 - 9 (more are taken as 9).
+
+uint8_t formatFixed(char* buffer, double value, uint8_t decimals);
+
 /********************* SERIAL MONITOR ******************************/
 // A SerialMonitor uses the serial communications line between the
 // Arduino and the IDE to send text and numbers.  The IDE will display
 // output from the serial monitor in a separate window.
+//
+// Serial.print() waits whenever Serial's 64 byte transmit buffer is
+// full, which can hold up the control loop for tens of milliseconds.
+// Give a SerialMonitor a larger buffer (setBuffer()) and output goes
+// there instead; it is moved on to Serial only as fast as Serial can
+// take it without waiting (Serial's transmit interrupt sends it from
+// there).  Call update() every pass through the loop to keep it
+// moving.  When the buffer is full, the overflow policy either drops
+// the new bytes, drops the oldest bytes, or waits (as Serial does).
+// Dropped bytes are counted.
+//
+// A SerialMonitor is also a Print, so anything that prints (or
+// writes binary, e.g. Telemetry) can go through the buffer.
 
-class SerialMonitor
+class SerialMonitor : public Print
 {
   public:
+  // What to do when the buffer is full
+  typedef enum
+  {
+    opDropNewest,   // Drop the bytes being sent
+    opDropOldest,   // Drop the oldest bytes buffered
+    opBlock         // Wait for room
+  } OverflowPolicy;
+
   // Pass ctor the serial data rate (in bits per second)
   SerialMonitor(uint32_t dataRate = 9600);
 
   // Call from Arduino's main "setup" routine
   void setup();
+
+  // Buffer output in "buffer" (of "size" bytes), or send straight to
+  // Serial if "buffer" is NULL (the default)
+  void setBuffer(uint8_t* buffer, uint16_t size, OverflowPolicy policy = opDropNewest);
+  void setOverflowPolicy(OverflowPolicy policy) { m_policy = policy; }
+
+  // Move buffered output to Serial (as much as fits without waiting)
+  void update();
+
+  // Wait until all buffered output has been sent
+  void flush() override;
+
+  // Bytes buffered, most ever buffered, and bytes dropped
+  uint16_t getBufferedCount() const { return m_count; }
+  uint16_t getHighWaterCount() const { return m_highWater; }
+  uint32_t getDroppedCount() const { return m_dropped; }
+  void resetCounts() { m_highWater = m_count; m_dropped = 0; }
+
+  // Print overrides
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  int availableForWrite() override;
+  using Print::write;
   
   // Send text representation of values of various types (does NOT advance to a new line)
   // "base" can be one of DEC, HEX, OCT, BIN or BYTE.  Default is DEC.
@@ -32,14 +95,25 @@ class SerialMonitor
   void sendDoubleValue(double value, int decimals = 3); // decimals = number of decimal places
   void sendDigitalLogicValue(int value);  // Pass in the value representing a HIGH or a LOW
   
-  // Send some text (does NOT advance to a new line)
+  // Send some text (does NOT advance to a new line).  Flash (F())
+  // strings and string constants are sent as is; the String version
+  // is only needed for String objects (building one uses the heap).
+  void sendText(const __FlashStringHelper* text);
+  void sendText(const char* text);
   void sendText(const String& text);
   
   // Send a "newline" sequence to advance to the beginning of a new line
   void sendNewline();
   
   private:
-  uint32_t  m_dataRate;   // Holds serial data rate (in bits per second)
+  uint32_t        m_dataRate;   // Holds serial data rate (in bits per second)
+  uint8_t*        m_buffer;     // Output ring buffer (NULL = none)
+  uint16_t        m_size;       // Ring buffer size
+  uint16_t        m_head;       // Next byte to send
+  uint16_t        m_count;      // Bytes buffered
+  uint16_t        m_highWater;  // Most bytes buffered
+  uint32_t        m_dropped;    // Bytes dropped
+  OverflowPolicy  m_policy;     // What to do when full
 };
 
 }   // End namespace
@@ -1,183 +1,34 @@
 // DriveTrain classes implementation file
 
 #include "CSCIDriveTrain.h"
+#include "CSCITelemetryRegistry.h"
 
 namespace csci
 {
 
-/*********************** DRIVE TRAIN ******************************/
-
-DriveTrain::DriveTrain(double fbMultiplier, double lrMultiplier,
-                       double diagMultiplier, double spinMultiplier,
-                       double speedFraction)
-  : m_fbMultiplier(fbMultiplier),
-    m_lrMultiplier(lrMultiplier),
-    m_diagMultiplier(diagMultiplier),
-    m_spinMultiplier(spinMultiplier),
-    m_speedFraction(speedFraction),
-    m_moveState(MoveState::msStop)
-  { }
-
-double DriveTrain::adjustDistance(MoveState moveState, double distance)
-{
-  const double SQRT_2 = 1.41421356237;
-  
-  // Depending on move state, adjust distance by appropriate multiplier.
-  
-  switch ( moveState )
-  {
-    case MoveState::msForward:
-    case MoveState::msReverse:
-    {
-      distance *= m_fbMultiplier;
-      break;
-    }
-
-    case MoveState::msLeft:
-    case MoveState::msRight:
-    {
-      distance *= m_lrMultiplier;
-      break;
-    }    
-    
-    case MoveState::msDiagFL:
-    case MoveState::msDiagFR:
-    case MoveState::msDiagRL:
-    case MoveState::msDiagRR:    
-    {
-      // Since we're moving along a 45-degree diagonal, we must actually
-      // move sqrt(2) times further to achieve desired distance.
-      
-      distance *= ( m_diagMultiplier * SQRT_2 );
-      break;
-    }
-    
-    case MoveState::msRotateCW:
-    case MoveState::msRotateCCW:
-    {
-      // Since we're moving along the circumference of a circle, we must
-      // actually move sqrt(2) times further to achieve desired distance.
-            
-      distance *= ( m_spinMultiplier * SQRT_2 );
-      break;
-    }
-    
-    case MoveState::msStop:
-    {
-      distance = 0.0;
-      break;
-    }
-  }
-  
-  return distance;
-}
-
-double DriveTrain::inchesToMM(double inches)
-{
-  return inches * 25.4;
-}
-
 /***************** TETRIX MECANUM DRIVE TRAIN *********************/
 
-TMDriveTrain::TMDriveTrain(PRIZM& prizm, EXPANSION& exc,
-                           double fbMultiplier,
-                           double lrMultiplier,
-                           double diagMultiplier,
-                           double spinMultiplier,
-                           double speedFraction)
-  : DriveTrain(fbMultiplier, lrMultiplier, diagMultiplier,
-               spinMultiplier, speedFraction),
+StaticTMDriveTrain::StaticTMDriveTrain(PRIZM& prizm, EXPANSION& exc,
+                                       double fbMultiplier,
+                                       double lrMultiplier,
+                                       double diagMultiplier,
+                                       double spinMultiplier,
+                                       double speedFraction)
+  : BasicDriveTrain<StaticTMDriveTrain>(fbMultiplier, lrMultiplier, diagMultiplier,
+                                        spinMultiplier, speedFraction),
     m_Prizm(prizm),
     m_Exc(exc)
 {
   setSpeedFraction(speedFraction);
-
-  // Tetrix mecanum wheel diameter = 98 millimeters.
-  // Calculate linear millimeter to rotational degree conversion.
-  
-  m_MMToDegrees =  360.0 / (98.0 * PI);
 }
 
-void TMDriveTrain::setup()
+void StaticTMDriveTrain::setup()
 {
   m_Prizm.PrizmBegin();         // Initialize Tetrix controllers.
   halt();  
 }
 
-void TMDriveTrain::setSpeedFraction(double speedFraction)
-{
-  m_speedFraction = speedFraction;
-  
-  // Top rotational speed of Tetrix motor controllers is
-  // 720 deegrees per second.
-  
-  m_speedDPS = static_cast<int>( 720.0 * speedFraction + 0.5 );
-}
-
-double TMDriveTrain::getSpeedFraction( ) const
-{
-  return m_speedFraction;
-}
-
-uint32_t TMDriveTrain::getInchesTravelTime
-           (MoveState moveState, double inches)
-{
-  return getMMTravelTime(moveState, inchesToMM(inches));
-}
-
-uint32_t TMDriveTrain::getMMTravelTime
-           (MoveState moveState, double millimeters)
-{  
-  millimeters = adjustDistance(moveState, millimeters);
-  
-  return getDegreesTravelTime(moveState, mmToDegrees(millimeters));
-}
-
-uint32_t TMDriveTrain::getDegreesTravelTime
-           (MoveState moveState, double degrees)
-{
-  // Return the time (in milliseconds) to rotate wheel the
-  // required number of degrees at current speed.
-  
-  double timeInSeconds = degrees / static_cast<double>(m_speedDPS);
-  
-  return static_cast<uint32_t>(timeInSeconds * 1000.0 + 0.5); 
-}
-
-uint32_t TMDriveTrain::getSpinCWTravelTime(double spinDegrees)
-{
-  double spinMM = spinDegreesToMM(spinDegrees);
-  
-  return getMMTravelTime(MoveState::msRotateCW, spinMM);
-}
-
-uint32_t TMDriveTrain::getSpinCCWTravelTime(double spinDegrees)
-{
-  double spinMM = spinDegreesToMM(spinDegrees);
-  
-  return getMMTravelTime(MoveState::msRotateCCW, spinMM);
-}
-
-double TMDriveTrain::mmToDegrees(double millimeters)
-{
-  return millimeters * m_MMToDegrees;
-}
-
-double TMDriveTrain::spinDegreesToMM(double degrees)
-{
-  // Typical Tetrix wheel base diagonal distance is 15 inches.
-  // The circumference of the circle spun is 15 * PI (inches).
-  // This is the distance to move the wheels to spin 360 degrees.
-  
-  return ( ( inchesToMM(15.0) * PI ) / 360.0 ) * degrees; 
-}
-
-void TMDriveTrain::move(MoveState moveState)
-{
-  moveDegrees(moveState, 0);  // Zero means no specific target.
-}
-
-void TMDriveTrain::moveDegrees(MoveState moveState, double degrees)
+void StaticTMDriveTrain::moveDegrees(MoveState moveState, double degrees)
 {
   // Round to nearest integer number of degrees.
   
@@ -256,38 +107,7 @@ void TMDriveTrain::moveDegrees(MoveState moveState, double degrees)
   }
 }
 
-void TMDriveTrain::moveInches(MoveState moveState, double inches)
-{
-  moveMM(moveState, inchesToMM(inches));
-}
-
-void TMDriveTrain::moveMM(MoveState moveState, double millimeters)
-{  
-  millimeters = adjustDistance(moveState, millimeters);
-  
-  moveDegrees(moveState, mmToDegrees(millimeters));
-}
-
-void TMDriveTrain::spinCW(double spinDegrees)
-{
-  double spinMM = spinDegreesToMM(spinDegrees);  
-  
-  moveMM(MoveState::msRotateCW, spinMM);
-}
-
-void TMDriveTrain::spinCCW(double spinDegrees)
-{
-  double spinMM = spinDegreesToMM(spinDegrees);  
-  
-  moveMM(MoveState::msRotateCCW, spinMM);
-}
-
-void TMDriveTrain::stop()
-{
-  halt();
-}
-
-void TMDriveTrain::forward(uint32_t degrees)
+void StaticTMDriveTrain::forward(uint32_t degrees)
 {
   // Invert left side motors. Make sure right side motors are not inverted.
   
@@ -302,7 +122,7 @@ void TMDriveTrain::forward(uint32_t degrees)
   m_moveState = MoveState::msForward;
 }
 
-void TMDriveTrain::reverse(uint32_t degrees)
+void StaticTMDriveTrain::reverse(uint32_t degrees)
 {
   // Invert right side motors. Make sure left side motors are not inverted.
 
@@ -317,7 +137,7 @@ void TMDriveTrain::reverse(uint32_t degrees)
   m_moveState = MoveState::msReverse;
 }
 
-void TMDriveTrain::left(uint32_t degrees)
+void StaticTMDriveTrain::left(uint32_t degrees)
 {
   // Invert rear motors. Make sure front motors are not inverted.
   
@@ -332,7 +152,7 @@ void TMDriveTrain::left(uint32_t degrees)
   m_moveState = MoveState::msLeft;
 }
 
-void TMDriveTrain::right(uint32_t degrees)
+void StaticTMDriveTrain::right(uint32_t degrees)
 {
   // Invert front motors. Make sure rear motors are not inverted.
   
@@ -347,7 +167,7 @@ void TMDriveTrain::right(uint32_t degrees)
   m_moveState = MoveState::msRight;
 }
 
-void TMDriveTrain::diagFL(uint32_t degrees)
+void StaticTMDriveTrain::diagFL(uint32_t degrees)
 {
   // Invert rear left motor. Make sure front right motor is not inverted.
   // Other motors don't matter.
@@ -365,7 +185,7 @@ void TMDriveTrain::diagFL(uint32_t degrees)
   m_moveState = MoveState::msDiagFL;
 }
 
-void TMDriveTrain::diagFR(uint32_t degrees)
+void StaticTMDriveTrain::diagFR(uint32_t degrees)
 {
   // Invert front left motor. Make sure rear right motor is not inverted.
   // Other motors don't matter.
@@ -383,7 +203,7 @@ void TMDriveTrain::diagFR(uint32_t degrees)
   m_moveState = MoveState::msDiagFR;
 }
 
-void TMDriveTrain::diagRL(uint32_t degrees)
+void StaticTMDriveTrain::diagRL(uint32_t degrees)
 {
   // Invert rear right motor. Make sure front left motor is not inverted.
   // Other motors don't matter.
@@ -401,7 +221,7 @@ void TMDriveTrain::diagRL(uint32_t degrees)
   m_moveState = MoveState::msDiagRL;
 }
 
-void TMDriveTrain::diagRR(uint32_t degrees)
+void StaticTMDriveTrain::diagRR(uint32_t degrees)
 {
   // Invert front right motor. Make sure rear left motor is not inverted.
   // Other motors don't matter.
@@ -419,7 +239,7 @@ void TMDriveTrain::diagRR(uint32_t degrees)
   m_moveState = MoveState::msDiagRR;
 }
 
-void TMDriveTrain::rotateCW(uint32_t degrees)
+void StaticTMDriveTrain::rotateCW(uint32_t degrees)
 {
   // Invert all motors
   
@@ -434,7 +254,7 @@ void TMDriveTrain::rotateCW(uint32_t degrees)
   m_moveState = MoveState::msRotateCW;
 }
 
-void TMDriveTrain::rotateCCW(uint32_t degrees)
+void StaticTMDriveTrain::rotateCCW(uint32_t degrees)
 {
   // Invert no motors
   
@@ -449,7 +269,7 @@ void TMDriveTrain::rotateCCW(uint32_t degrees)
   m_moveState = MoveState::msRotateCCW;
 }
 
-void TMDriveTrain::halt()
+void StaticTMDriveTrain::halt()
 {
   // Setting speed to zero stops all movement in progress.
   
@@ -464,7 +284,7 @@ void TMDriveTrain::halt()
   m_moveState = MoveState::msStop;
 }
 
-void TMDriveTrain::setAllMotorsMoving(uint32_t degrees)
+void StaticTMDriveTrain::setAllMotorsMoving(uint32_t degrees)
 {
   if ( degrees == 0 )
   {
@@ -480,7 +300,7 @@ void TMDriveTrain::setAllMotorsMoving(uint32_t degrees)
   }
 }
 
-void TMDriveTrain::setFR_RL_MotorsMoving(uint32_t degrees)
+void StaticTMDriveTrain::setFR_RL_MotorsMoving(uint32_t degrees)
 {
   // If we're currently in motion, stop motors we won't be using
   // in this move.  Otherwise, they'll keep running.
@@ -507,7 +327,7 @@ void TMDriveTrain::setFR_RL_MotorsMoving(uint32_t degrees)
   }
 }
 
-void TMDriveTrain::setFL_RR_MotorsMoving(uint32_t degrees)
+void StaticTMDriveTrain::setFL_RR_MotorsMoving(uint32_t degrees)
 {
   // If we're currently in motion, stop motors we won't be using
   // in this move.  Otherwise, they'll keep running.
@@ -534,12 +354,7 @@ void TMDriveTrain::setFL_RR_MotorsMoving(uint32_t degrees)
   }
 }
 
-MoveState TMDriveTrain::getMoveState()
-{
-  return m_moveState;
-}
-
-bool TMDriveTrain::isBusy()
+bool StaticTMDriveTrain::isBusy()
 {
   // Depending on the current movement state...
   
@@ -580,4 +395,80 @@ bool TMDriveTrain::isBusy()
   return false;
 }
 
+double StaticTMDriveTrain::readWheelDegrees()
+{
+  // Read an encoder on one of the motors driven in this state.
+  // (The PRIZM left motor is idle in the FR/RL diagonal states.)
+  
+  int motor = rightMotor;
+  
+  if ( (m_moveState == MoveState::msDiagFR) ||
+       (m_moveState == MoveState::msDiagRL) )
+  {
+    motor = leftMotor;
+  }
+  
+  long degrees = m_Prizm.readEncoderDegrees(motor);
+  
+  // Direction depends on motor inversion, so ignore the sign.
+  
+  return static_cast<double>( degrees < 0 ? -degrees : degrees );
+}
+
+void StaticTMDriveTrain::readEncoderCounts(long counts[4])
+{
+  counts[0] = m_Prizm.readEncoderCount(leftMotor);
+  counts[1] = m_Prizm.readEncoderCount(rightMotor);
+  counts[2] = m_Exc.readEncoderCount(1, leftMotor);
+  counts[3] = m_Exc.readEncoderCount(1, rightMotor);
+}
+
+double StaticTMDriveTrain::wheelDegreesToDistance
+         (MoveState moveState, double degrees)
+{
+  // Undo the movement adjustment applied when moving.
+  
+  double adjustment = adjustDistance(moveState, 1.0);
+  
+  if ( adjustment == 0.0 )
+  {
+    return 0.0;   // msStop
+  }
+  
+  Millimeters millimeters = Kinematics::toMillimeters(WheelDegrees(degrees)) / adjustment;
+  
+  if ( (moveState == MoveState::msRotateCW) ||
+       (moveState == MoveState::msRotateCCW) )
+  {
+    return Kinematics::toSpinDegrees(millimeters).value();
+  }
+  
+  return millimeters.value();
+}
+
+
+// Telemetry channel samplers.
+
+static bool sampleDrive(void* context, Telemetry& telemetry)
+{
+  StaticTMDriveTrain* driveTrain = static_cast<StaticTMDriveTrain*>(context);
+
+  return telemetry.sendDrive(static_cast<uint8_t>(driveTrain->getMoveState()),
+                             driveTrain->getSpeedFraction());
+}
+
+static bool sampleEncoders(void* context, Telemetry& telemetry)
+{
+  long counts[4];
+
+  static_cast<StaticTMDriveTrain*>(context)->readEncoderCounts(counts);
+  return telemetry.sendEncoders(counts[0], counts[1], counts[2], counts[3]);
+}
+
+void StaticTMDriveTrain::addTelemetry(TelemetryRegistry& registry)
+{
+  registry.add("drive", 3, sampleDrive, this, 10);
+  registry.add("encoders", 16, sampleEncoders, this, 2, false);
+}
+
 }   // End namespace
@@ -4,11 +4,14 @@
 // DriveTrain classes header file for Arduino sensors/devices.
 
 #include "CSCICore.h"
+#include "CSCIUnits.h"
 #include <PRIZM.h>    // Tetrix PRIZM and EXPANSION controller library
 
 namespace csci
 {
 
+class TelemetryRegistry;    // (See CSCITelemetryRegistry.h)
+
 // Enum defining movement states.
   
 enum MoveState
@@ -28,7 +31,8 @@ enum MoveState
   
 /*********************** DRIVE TRAIN ******************************/
 // DriveTrain is the virtual base class from which all drive train
-// classes are derived.
+// classes are derived.  (Each is a thin adapter over a statically
+// dispatched drive train; see BasicDriveTrain below.)
 //
 // NOTE: Without additional sensors (such as accelerometers and
 //       gyroscopes), it's not possible to drive at precise speeds
@@ -48,14 +52,16 @@ enum MoveState
 class DriveTrain
 {
   public:
-  DriveTrain(double fbMultiplier, double lrMultiplier,
-             double diagMultiplier, double spinMultiplier,
-             double speedFraction);
-
   // Set/get drive train speed fraction (0.0 = none, 1.0 = max speed)
   
   virtual void    setSpeedFraction(double speedFraction) = 0;
   virtual double  getSpeedFraction() const = 0;
+
+  // Replace the movement adjustment multipliers (see above), e.g.
+  // while tuning.  Takes effect with the next movement.
+
+  virtual void setMultipliers(double fbMultiplier, double lrMultiplier,
+                              double diagMultiplier, double spinMultiplier) = 0;
              
   // Perform additonal setup.  MUST be called after construction,
   // but before any other methods are called.
@@ -110,29 +116,235 @@ class DriveTrain
   // Returns "true" if drive train is busy performing last action.
   
   virtual bool isBusy() = 0;
-  
+};
+
+/******************** BASIC DRIVE TRAIN ****************************/
+// BasicDriveTrain is the statically dispatched (CRTP) base of drive
+// trains.  "Derived", the drive train class itself, supplies the
+// drive train specific parts:
+//
+//   typedef ... Kinematics;   // Its Kinematics (see CSCIUnits.h)
+//   void     setSpeedFraction(double speedFraction);
+//   double   mmToDegrees(double millimeters);
+//   double   spinDegreesToMM(double spinDegrees);
+//   uint32_t getDegreesTravelTime(MoveState moveState, double degrees);
+//   void     moveDegrees(MoveState moveState, double degrees);
+//   void     halt();
+//
+// and BasicDriveTrain builds the rest of DriveTrain's methods on
+// them.  Nothing is virtual, so a chain such as getMMTravelTime()
+// (adjustDistance() -> mmToDegrees() -> getDegreesTravelTime()) is
+// inlined, and folded down where the movement state is a constant.
+//
+// getTravelTime() and moveBy() take distances with their units (see
+// CSCIUnits.h), so passing inches as millimeters won't compile:
+//
+//   Drive.moveBy(csci::msForward, csci::Inches(12.0));
+//   Drive.moveBy(csci::msRotateCW, csci::SpinDegrees(90.0));
+
+template <class Derived>
+class BasicDriveTrain
+{
+  public:
+  double getSpeedFraction() const { return m_speedFraction; }
+
+  // See DriveTrain::setMultipliers().
+
+  void setMultipliers(double fbMultiplier, double lrMultiplier,
+                      double diagMultiplier, double spinMultiplier)
+  {
+    m_fbMultiplier = fbMultiplier;
+    m_lrMultiplier = lrMultiplier;
+    m_diagMultiplier = diagMultiplier * Derived::Kinematics::MecanumFactor;
+    m_spinMultiplier = spinMultiplier * Derived::Kinematics::MecanumFactor;
+  }
+
+  uint32_t getInchesTravelTime(MoveState moveState, double inches)
+  {
+    return getMMTravelTime(moveState, inchesToMM(inches));
+  }
+
+  uint32_t getMMTravelTime(MoveState moveState, double millimeters)
+  {
+    millimeters = adjustDistance(moveState, millimeters);
+
+    return derived().getDegreesTravelTime(moveState, derived().mmToDegrees(millimeters));
+  }
+
+  uint32_t getSpinCWTravelTime(double spinDegrees)
+  {
+    return getMMTravelTime(MoveState::msRotateCW, derived().spinDegreesToMM(spinDegrees));
+  }
+
+  uint32_t getSpinCCWTravelTime(double spinDegrees)
+  {
+    return getMMTravelTime(MoveState::msRotateCCW, derived().spinDegreesToMM(spinDegrees));
+  }
+
+  void move(MoveState moveState)
+  {
+    derived().moveDegrees(moveState, 0);  // Zero means no specific target.
+  }
+
+  void moveInches(MoveState moveState, double inches)
+  {
+    moveMM(moveState, inchesToMM(inches));
+  }
+
+  void moveMM(MoveState moveState, double millimeters)
+  {
+    millimeters = adjustDistance(moveState, millimeters);
+
+    derived().moveDegrees(moveState, derived().mmToDegrees(millimeters));
+  }
+
+  void spinCW(double spinDegrees)
+  {
+    moveMM(MoveState::msRotateCW, derived().spinDegreesToMM(spinDegrees));
+  }
+
+  void spinCCW(double spinDegrees)
+  {
+    moveMM(MoveState::msRotateCCW, derived().spinDegreesToMM(spinDegrees));
+  }
+
+  // Returns the time (in milliseconds) to travel "distance" in the
+  // specified direction at the currently set speed fraction.  Spin
+  // degrees go with msRotateCW and msRotateCCW.
+
+  uint32_t getTravelTime(MoveState moveState, Millimeters distance)
+  {
+    return getMMTravelTime(moveState, distance.value());
+  }
+
+  uint32_t getTravelTime(MoveState moveState, Inches distance)
+  {
+    return getMMTravelTime(moveState, csci::toMillimeters(distance).value());
+  }
+
+  uint32_t getTravelTime(MoveState moveState, WheelDegrees distance)
+  {
+    return derived().getDegreesTravelTime(moveState, distance.value());
+  }
+
+  uint32_t getTravelTime(MoveState moveState, SpinDegrees distance)
+  {
+    return getMMTravelTime(moveState, derived().spinDegreesToMM(distance.value()));
+  }
+
+  // Move "distance" in the specified direction (see getTravelTime()).
+
+  void moveBy(MoveState moveState, Millimeters distance)
+  {
+    moveMM(moveState, distance.value());
+  }
+
+  void moveBy(MoveState moveState, Inches distance)
+  {
+    moveMM(moveState, csci::toMillimeters(distance).value());
+  }
+
+  void moveBy(MoveState moveState, WheelDegrees distance)
+  {
+    derived().moveDegrees(moveState, distance.value());
+  }
+
+  void moveBy(MoveState moveState, SpinDegrees distance)
+  {
+    moveMM(moveState, derived().spinDegreesToMM(distance.value()));
+  }
+
+  void stop() { derived().halt(); }
+
+  MoveState getMoveState() const { return m_moveState; }
+
   protected:
-  
+  // See DriveTrain's note concerning movement adjustment multipliers.
+
+  BasicDriveTrain(double fbMultiplier, double lrMultiplier,
+                  double diagMultiplier, double spinMultiplier,
+                  double speedFraction)
+  : m_moveState(MoveState::msStop),
+    m_speedFraction(speedFraction),
+    m_fbMultiplier(fbMultiplier),
+    m_lrMultiplier(lrMultiplier),
+    m_diagMultiplier(diagMultiplier * Derived::Kinematics::MecanumFactor),
+    m_spinMultiplier(spinMultiplier * Derived::Kinematics::MecanumFactor) { }
+
+  Derived& derived() { return static_cast<Derived&>(*this); }
+
   // Apply heuristic distance adjustments to compensate for non-ideal
   // and surface-specific movement mechanics.
   
-  double adjustDistance(MoveState moveState, double distance);
+  double adjustDistance(MoveState moveState, double distance) const
+  {
+    // Depending on move state, adjust distance by appropriate multiplier.
+  
+    switch ( moveState )
+    {
+      case MoveState::msForward:
+      case MoveState::msReverse:
+      {
+        distance *= m_fbMultiplier;
+        break;
+      }
+
+      case MoveState::msLeft:
+      case MoveState::msRight:
+      {
+        distance *= m_lrMultiplier;
+        break;
+      }    
+    
+      case MoveState::msDiagFL:
+      case MoveState::msDiagFR:
+      case MoveState::msDiagRL:
+      case MoveState::msDiagRR:    
+      {
+        // Since we're moving along a 45-degree diagonal, we must actually
+        // move sqrt(2) times further to achieve desired distance.  (The
+        // multiplier includes it.)
+      
+        distance *= m_diagMultiplier;
+        break;
+      }
+    
+      case MoveState::msRotateCW:
+      case MoveState::msRotateCCW:
+      {
+        // Since we're moving along the circumference of a circle, we must
+        // actually move sqrt(2) times further to achieve desired distance.
+        // (The multiplier includes it.)
+            
+        distance *= m_spinMultiplier;
+        break;
+      }
+    
+      case MoveState::msStop:
+      {
+        distance = 0.0;
+        break;
+      }
+    }
+  
+    return distance;
+  }
   
   // Convert inches to millimeters.
   
-  double inchesToMM(double inches);
+  static double inchesToMM(double inches) { return csci::toMillimeters(Inches(inches)).value(); }
   
   protected:
   MoveState   m_moveState;      // Current movement state.
   double      m_speedFraction;  // Speed fraction (0.0 = none, 1.0 = max speed)
   double      m_fbMultiplier;   // Front-Back movement multiplier
   double      m_lrMultiplier;   // Left-Right movement multiplier
-  double      m_diagMultiplier; // Diagonal movement multiplier
-  double      m_spinMultiplier; // Rotational movement multiplier
+  double      m_diagMultiplier; // Diagonal movement multiplier (* sqrt(2))
+  double      m_spinMultiplier; // Rotational movement multiplier (* sqrt(2))
 };
 
 /***************** TETRIX MECANUM DRIVE TRAIN *********************/
-// A TMDriveTrain consists of:
+// A Tetrix mecanum drive train consists of:
 //
 // 4 TorqueNADO motors with encoders.
 // 4 Tetrix mechanum wheels.
@@ -142,10 +354,27 @@ class DriveTrain
 // 1 EXPANSION controller for the rear motors (1 = left, 2 = right)
 //     Rear left wheel is Tetrix Mecanum type "B".
 //     Rear right wheel is Tetrix Mecanum type "A".
+//
+// StaticTMDriveTrain is the statically dispatched one; its distance
+// and time conversions are inline.  TMDriveTrain is the DriveTrain
+// adapter over it.
+
+// Tetrix mecanum drive train geometry (see Kinematics in CSCIUnits.h).
+
+struct TMGeometry
+{
+  static constexpr double WheelDiameterMM = 98.0;                   // Tetrix mecanum wheel
+  static constexpr double WheelbaseDiagonalMM = 15.0 * MMPerInch;   // Typical Tetrix wheel base
+  static constexpr double CountsPerRevolution = 1440.0;             // TorqueNADO encoder
+};
 
-class TMDriveTrain : public DriveTrain
+class StaticTMDriveTrain : public BasicDriveTrain<StaticTMDriveTrain>
 {
+  friend class BasicDriveTrain<StaticTMDriveTrain>;
+
   public:
+  typedef csci::Kinematics<TMGeometry> Kinematics;
+
   // Construct from references to Tetrix PRIZM and EXPANSION controller
   // objects, movement adjustment multipliers, and an initial speed
   // factor (set low for safety).
@@ -153,48 +382,74 @@ class TMDriveTrain : public DriveTrain
   // See note (in DriveTrain ctor comments) concerning movement
   // adjustment multipliers.  
   
-  TMDriveTrain(PRIZM& prizm, EXPANSION& exc,
-               double fbMultiplier,
-               double lrMultiplier,
-               double diagMultiplier,
-               double spinMultiplier,
-               double speedFraction = 0.1);
+  StaticTMDriveTrain(PRIZM& prizm, EXPANSION& exc,
+                     double fbMultiplier,
+                     double lrMultiplier,
+                     double diagMultiplier,
+                     double spinMultiplier,
+                     double speedFraction = 0.1);
   
-  // Base class overrides
+  void setup();
+  
+  void setSpeedFraction(double speedFraction)
+  {
+    m_speedFraction = speedFraction;
+  
+    // Top rotational speed of Tetrix motor controllers is
+    // 720 deegrees per second.
+  
+    m_speedDPS = static_cast<int>( 720.0 * speedFraction + 0.5 );
+  }
+  
+  uint32_t getDegreesTravelTime(MoveState /* moveState */, double degrees) const
+  {
+    // Return the time (in milliseconds) to rotate wheel the
+    // required number of degrees at current speed.
   
-  void setup() override;
+    double timeInSeconds = degrees / static_cast<double>(m_speedDPS);
   
-  void    setSpeedFraction(double speedFraction) override;
-  double  getSpeedFraction() const override;  
+    return static_cast<uint32_t>(timeInSeconds * 1000.0 + 0.5); 
+  }
   
-  uint32_t getInchesTravelTime(MoveState moveState, double inches) override;
-  uint32_t getMMTravelTime(MoveState moveState, double millimeters) override;
-  uint32_t getDegreesTravelTime(MoveState moveState, double degrees) override;
+  void moveDegrees(MoveState moveState, double degrees);
   
-  uint32_t getSpinCWTravelTime(double spinDegrees);
-  uint32_t getSpinCCWTravelTime(double spinDegrees); 
+  bool isBusy();
   
-  void move(MoveState moveState) override;
+  // Returns the number of degrees the driven wheels have turned in
+  // the current movement (since the encoders were last reset).
+  //
+  // Note: This reads one wheel encoder, which costs an I2C transaction
+  //       (plus 20 milliseconds of delays in the PRIZM library).
   
-  void moveDegrees(MoveState moveState, double degrees) override;
-  void moveInches(MoveState moveState, double inches) override;
-  void moveMM(MoveState moveState, double millimeters) override;
+  double readWheelDegrees();
   
-  void spinCW(double spinDegrees) override;
-  void spinCCW(double spinDegrees) override;
+  // Read the four wheel encoder counts: PRIZM left and right, then
+  // EXPANSION left and right.
+  //
+  // Note: This costs four I2C transactions (plus 80 milliseconds of
+  //       delays in the PRIZM library).
   
-  void stop() override;
+  void readEncoderCounts(long counts[4]);
   
-  MoveState getMoveState() override;
+  // Convert wheel rotation degrees turned in the specified movement
+  // state to the linear distance moved (in millimeters).  For
+  // msRotateCW and msRotateCCW, returns the spin degrees turned.
+  // Movement adjustment multipliers are taken into account.
   
-  bool isBusy() override;
+  double wheelDegreesToDistance(MoveState moveState, double degrees);
+
+  // Register the drive train's telemetry channels with "registry":
+  // "drive" (movement and speed, 10 Hz) and "encoders" (see
+  // readEncoderCounts(), 2 Hz, disabled until turned on).
+
+  void addTelemetry(TelemetryRegistry& registry);
   
   protected:
   
   // Tetrix left/right side motor numbers.
   
-  const int leftMotor = 1;
-  const int rightMotor = 2;  
+  static const int leftMotor = 1;
+  static const int rightMotor = 2;  
   
   // Drive train movement routines.
   // Speed is controlled by the m_speedFraction value.
@@ -229,19 +484,94 @@ class TMDriveTrain : public DriveTrain
   
   // Convert millimeters to wheel rotation degrees.
   
-  double mmToDegrees(double millimeters); 
+  static double mmToDegrees(double millimeters)
+  {
+    return Kinematics::toWheelDegrees(Millimeters(millimeters)).value();
+  }
   
   // Convert spin degrees to Tetrix rotation distance (in millimeters).
   
-  double spinDegreesToMM(double degrees);  
+  static double spinDegreesToMM(double degrees)
+  {
+    return Kinematics::toMillimeters(SpinDegrees(degrees)).value();
+  }
   
   protected:
   PRIZM&      m_Prizm;        // Associated Tetrix PRIZM controller.
   EXPANSION&  m_Exc;          // Associated Tetrix EXPANSION controller.
-  double      m_MMToDegrees;  // Linear mm to wheel rotation degrees.
   int         m_speedDPS;     // Speed in degrees per second. 
 };
 
+// TMDriveTrain is the DriveTrain adapter over StaticTMDriveTrain: each
+// virtual method calls the static one.
+
+class TMDriveTrain : public DriveTrain, protected StaticTMDriveTrain
+{
+  public:
+  // See StaticTMDriveTrain.
+  
+  TMDriveTrain(PRIZM& prizm, EXPANSION& exc,
+               double fbMultiplier,
+               double lrMultiplier,
+               double diagMultiplier,
+               double spinMultiplier,
+               double speedFraction = 0.1)
+  : StaticTMDriveTrain(prizm, exc, fbMultiplier, lrMultiplier,
+                       diagMultiplier, spinMultiplier, speedFraction) { }
+  
+  // Base class overrides
+  
+  void setup() override { StaticTMDriveTrain::setup(); }
+  
+  void    setSpeedFraction(double speedFraction) override { StaticTMDriveTrain::setSpeedFraction(speedFraction); }
+  double  getSpeedFraction() const override { return StaticTMDriveTrain::getSpeedFraction(); }
+
+  void setMultipliers(double fbMultiplier, double lrMultiplier,
+                      double diagMultiplier, double spinMultiplier) override
+  {
+    StaticTMDriveTrain::setMultipliers(fbMultiplier, lrMultiplier, diagMultiplier, spinMultiplier);
+  }
+  
+  uint32_t getInchesTravelTime(MoveState moveState, double inches) override
+    { return StaticTMDriveTrain::getInchesTravelTime(moveState, inches); }
+  uint32_t getMMTravelTime(MoveState moveState, double millimeters) override
+    { return StaticTMDriveTrain::getMMTravelTime(moveState, millimeters); }
+  uint32_t getDegreesTravelTime(MoveState moveState, double degrees) override
+    { return StaticTMDriveTrain::getDegreesTravelTime(moveState, degrees); }
+  
+  uint32_t getSpinCWTravelTime(double spinDegrees) override
+    { return StaticTMDriveTrain::getSpinCWTravelTime(spinDegrees); }
+  uint32_t getSpinCCWTravelTime(double spinDegrees) override
+    { return StaticTMDriveTrain::getSpinCCWTravelTime(spinDegrees); }
+  
+  void move(MoveState moveState) override { StaticTMDriveTrain::move(moveState); }
+  
+  void moveDegrees(MoveState moveState, double degrees) override
+    { StaticTMDriveTrain::moveDegrees(moveState, degrees); }
+  void moveInches(MoveState moveState, double inches) override
+    { StaticTMDriveTrain::moveInches(moveState, inches); }
+  void moveMM(MoveState moveState, double millimeters) override
+    { StaticTMDriveTrain::moveMM(moveState, millimeters); }
+  
+  void spinCW(double spinDegrees) override { StaticTMDriveTrain::spinCW(spinDegrees); }
+  void spinCCW(double spinDegrees) override { StaticTMDriveTrain::spinCCW(spinDegrees); }
+  
+  void stop() override { StaticTMDriveTrain::stop(); }
+  
+  MoveState getMoveState() override { return StaticTMDriveTrain::getMoveState(); }
+  
+  bool isBusy() override { return StaticTMDriveTrain::isBusy(); }
+
+  // Tetrix specific (see StaticTMDriveTrain).
+
+  using StaticTMDriveTrain::getTravelTime;
+  using StaticTMDriveTrain::moveBy;
+  using StaticTMDriveTrain::readWheelDegrees;
+  using StaticTMDriveTrain::readEncoderCounts;
+  using StaticTMDriveTrain::wheelDegreesToDistance;
+  using StaticTMDriveTrain::addTelemetry;
+};
+
 }   // End namespace
 
 #endif    // INCLUDE_CSCI_DRIVE_TRAIN
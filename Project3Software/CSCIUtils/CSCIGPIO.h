@@ -65,6 +65,104 @@ class GPIOInputPin
   int           m_activeState;      // Port state (HIGH/LOW) which means input is active
 };
 
+/*********************** FAST GPIO PINS ****************************/
+// FastOutputPin and FastInputPin are GPIOOutputPin and GPIOInputPin
+// with the pin number and active state fixed at compile time.  On the
+// ATmega328P (PRIZM, Uno) the pin's port register and bit are known
+// to the compiler, so setting or reading the pin is a single
+// instruction instead of a digitalWrite()/digitalRead() call (which
+// looks the pin up in tables and checks for PWM each time: about 50
+// cycles).  Elsewhere (including the host build) they fall back to
+// digitalWrite()/digitalRead().
+//
+// Use the runtime pin classes when the pin number isn't known until
+// run time.  The active state can't be changed, and a fast output pin
+// doesn't turn off PWM, so don't use one on a pin driven by
+// analogWrite().
+//
+//   csci::FastOutputPin<13, HIGH> led;
+//   led.active();
+
+#if defined(__AVR_ATmega328P__)
+
+// ATmega328P pin to port mapping: pins 0 - 7 are port D, 8 - 13 are
+// port B, 14 - 19 (A0 - A5) are port C.
+
+template <uint8_t Pin>
+struct FastPinPort
+{
+  static_assert(Pin < 20, "Not an ATmega328P digital pin");
+
+  static const uint8_t Mask = 1 << (( Pin < 8 ) ? Pin : ( Pin < 14 ) ? Pin - 8 : Pin - 14);
+
+  static volatile uint8_t& output() { return ( Pin < 8 ) ? PORTD : ( Pin < 14 ) ? PORTB : PORTC; }
+  static volatile uint8_t& input()  { return ( Pin < 8 ) ? PIND : ( Pin < 14 ) ? PINB : PINC; }
+};
+
+#endif
+
+template <uint8_t Pin, uint8_t ActiveState = HIGH>
+class FastOutputPin
+{
+  public:
+  FastOutputPin()
+  {
+    pinMode(Pin, OUTPUT);         // Init as an output port
+    inactive();                   // Init to be inactive
+  }
+
+  void active()   { write(ActiveState == HIGH); }   // Set output pin to active state
+  void inactive() { write(ActiveState != HIGH); }   // Set output pin to inactive state
+
+  int  getActiveState() const { return ActiveState; }
+
+  protected:
+  static void write(bool high)
+  {
+#if defined(__AVR_ATmega328P__)
+    // (Single bit set/clear instructions, so interrupts can't
+    // corrupt the port's other pins.)
+
+    if ( high )
+    {
+      FastPinPort<Pin>::output() |= FastPinPort<Pin>::Mask;
+    }
+    else
+    {
+      FastPinPort<Pin>::output() &= static_cast<uint8_t>(~FastPinPort<Pin>::Mask);
+    }
+#else
+    digitalWrite(Pin, high ? HIGH : LOW);
+#endif
+  }
+};
+
+template <uint8_t Pin, uint8_t ActiveState = HIGH>
+class FastInputPin
+{
+  public:
+  // activateInternalPullUp = "true" if internal pull-up resistor is to be activated
+  FastInputPin(bool activateInternalPullUp = NoInternalPullUp)
+  {
+    pinMode(Pin, activateInternalPullUp ? INPUT_PULLUP : INPUT);
+  }
+
+  bool active() const   { return high() == (ActiveState == HIGH); }  // Returns "true" if active
+  bool inactive() const { return !active(); }                         // Returns "true" if inactive
+
+  int  getActiveState() const { return ActiveState; }
+
+  protected:
+  static bool high()
+  {
+#if defined(__AVR_ATmega328P__)
+    return ( FastPinPort<Pin>::input() & FastPinPort<Pin>::Mask ) != 0;
+#else
+    return digitalRead(Pin) == HIGH;
+#endif
+  }
+};
+
 }   // End namespace
 
 #endif    // INCLUDE_CSCI_GPIO
@@ -1,19 +1,11 @@
 // LED classes implementation.
 
-#include <CSCILED.h>
+#include <CSCILed.h>
 #include <CSCITimer.h>
 
 namespace csci
 {
 
-/************************ DIGITAL LED ******************************/
-
-void DigitalLed::blink(uint32_t onTimeMillis, uint32_t offTimeMillis)
-{
-  cycleActive(onTimeMillis * MICROS_PER_MILLIS,
-              offTimeMillis * MICROS_PER_MILLIS);
-}
-
 /************************* ANALOG LED ******************************/
 
 AnalogLed::AnalogLed(AnalogOutput& analogOutput)
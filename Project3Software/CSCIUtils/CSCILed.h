@@ -11,20 +11,40 @@ namespace csci
 
 /************************ DIGITAL LED ******************************/
 // A DigtialLed is associated with a HIGH/LOW output pin and is either
-// on (active) or off (inactive).
+// on (active) or off (inactive).  (FastDigitalLed is one on a pin
+// fixed at compile time; see CSCIDigitalPin.h.)
 
-class DigitalLed : public DigitalOutput
+template <class OutputPin>
+class BasicDigitalLed : public BasicDigitalOutput<OutputPin>
 {
   public:
-  DigitalLed(int pinNumber, int onState = HIGH)
-  : DigitalOutput(pinNumber, onState) { }
+  BasicDigitalLed(int pinNumber, int onState = HIGH)
+  : BasicDigitalOutput<OutputPin>(pinNumber, onState) { }
+
+  explicit BasicDigitalLed(const OutputPin& gpioPin)
+  : BasicDigitalOutput<OutputPin>(gpioPin) { }
   
-  void on()   { active(); }
-  void off()  { inactive(); }
+  void on()   { this->active(); }
+  void off()  { this->inactive(); }
   
   // Blink LED on and off for specified duration (in milliseconds).
+  // (This waits; a PatternPlayer blinks without waiting.)
   
-  void blink(uint32_t onTimeMillis, uint32_t offTimeMillis);
+  void blink(uint32_t onTimeMillis, uint32_t offTimeMillis)
+  {
+    this->cycleActive(onTimeMillis * MICROS_PER_MILLIS,
+                      offTimeMillis * MICROS_PER_MILLIS);
+  }
+};
+
+typedef BasicDigitalLed<GPIOOutputPin> DigitalLed;
+
+template <uint8_t Pin, uint8_t OnState = HIGH>
+class FastDigitalLed : public BasicDigitalLed< FastOutputPin<Pin, OnState> >
+{
+  public:
+  FastDigitalLed()
+  : BasicDigitalLed< FastOutputPin<Pin, OnState> >(FastOutputPin<Pin, OnState>()) { }
 };
 
 /************************* ANALOG LED ******************************/
@@ -36,6 +56,9 @@ class AnalogLed
   AnalogLed(AnalogOutput& analogOutput);
 
   void intensity(double fraction) { m_analogOutput.output(fraction); }
+
+  void on()   { intensity(1.0); }
+  void off()  { intensity(0.0); }
   
   void outputPortValue(int value) { m_analogOutput.outputPortValue(value); }
   
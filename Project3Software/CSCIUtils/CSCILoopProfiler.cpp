@@ -0,0 +1,370 @@
+// LoopProfiler class implementation file.
+
+#include "CSCILoopProfiler.h"
+
+namespace csci
+{
+
+/********************** LATENCY HISTOGRAM **************************/
+
+// Limit of bucket 0 is 2^FirstBucketShift microseconds.
+
+static const uint8_t FirstBucketShift = 8;
+
+void LatencyHistogram::reset()
+{
+  m_count = 0;
+  m_totalMicros = 0;
+  m_minMicros = 0xFFFFFFFFUL;
+  m_maxMicros = 0;
+
+  for ( uint8_t bucket = 0; bucket < NumBuckets; ++bucket )
+  {
+    m_buckets[bucket] = 0;
+  }
+}
+
+void LatencyHistogram::add(uint32_t micros)
+{
+  ++m_count;
+  m_totalMicros += micros;
+
+  if ( micros < m_minMicros )
+  {
+    m_minMicros = micros;
+  }
+
+  if ( micros > m_maxMicros )
+  {
+    m_maxMicros = micros;
+  }
+
+  // Bucket: number of doublings past the first limit.
+
+  uint8_t bucket = 0;
+  uint32_t limit = micros >> FirstBucketShift;
+
+  while ( (limit != 0) && (bucket < NumBuckets - 1) )
+  {
+    limit >>= 1;
+    ++bucket;
+  }
+
+  if ( m_buckets[bucket] < 0xFFFF )
+  {
+    ++m_buckets[bucket];
+  }
+}
+
+uint32_t LatencyHistogram::getAverageMicros() const
+{
+  return ( m_count > 0 ) ? m_totalMicros / m_count : 0;
+}
+
+uint32_t LatencyHistogram::getPercentileMicros(uint8_t percent) const
+{
+  uint32_t total = 0;
+
+  for ( uint8_t bucket = 0; bucket < NumBuckets; ++bucket )
+  {
+    total += m_buckets[bucket];
+  }
+
+  // Smallest bucket holding "percent" of the durations (rounded up).
+
+  uint32_t wanted = (total * percent + 99) / 100;
+  uint32_t seen = 0;
+
+  for ( uint8_t bucket = 0; (bucket < NumBuckets) && (total > 0); ++bucket )
+  {
+    seen += m_buckets[bucket];
+
+    if ( seen >= wanted )
+    {
+      uint32_t limit = getBucketLimit(bucket);
+
+      return ( limit < m_maxMicros ) ? limit : m_maxMicros;
+    }
+  }
+
+  return m_maxMicros;
+}
+
+uint32_t LatencyHistogram::getBucketLimit(uint8_t bucket)
+{
+  return ( bucket < NumBuckets - 1 ) ? (1UL << (FirstBucketShift + bucket)) : 0xFFFFFFFFUL;
+}
+
+/************************ LOOP PROFILER ****************************/
+
+LoopProfiler::LoopProfiler(const char* const* phaseNames, uint8_t numPhases,
+                           LatencyHistogram* phases)
+  : m_phaseNames(phaseNames),
+    m_numPhases(numPhases),
+    m_phases(phases),
+    m_enabled(false),
+    m_inLoop(false),
+    m_phase(NoPhase),
+    m_loopMicros(0),
+    m_phaseMicros(0),
+    m_publishMillis(5000),
+    m_lastPublished(0),
+    m_nextField(0)
+{
+}
+
+void LoopProfiler::beginLoop()
+{
+  if ( !m_enabled )
+  {
+    return;
+  }
+
+  if ( m_inLoop )
+  {
+    endLoop();
+  }
+
+  m_inLoop = true;
+  m_loopMicros = micros();
+}
+
+void LoopProfiler::endLoop()
+{
+  if ( !m_enabled || !m_inLoop )
+  {
+    return;
+  }
+
+  endPhase();
+
+  m_loop.add(micros() - m_loopMicros);
+  m_inLoop = false;
+}
+
+void LoopProfiler::beginPhase(uint8_t phase)
+{
+  if ( !m_enabled || (phase >= m_numPhases) )
+  {
+    return;
+  }
+
+  // One clock read ends the last phase and starts this one.
+
+  uint32_t now = micros();
+
+  if ( m_phase != NoPhase )
+  {
+    m_phases[m_phase].add(now - m_phaseMicros);
+  }
+
+  m_phase = phase;
+  m_phaseMicros = now;
+}
+
+void LoopProfiler::endPhase()
+{
+  if ( !m_enabled || (m_phase == NoPhase) )
+  {
+    return;
+  }
+
+  m_phases[m_phase].add(micros() - m_phaseMicros);
+  m_phase = NoPhase;
+}
+
+bool LoopProfiler::update(Print& out)
+{
+  if ( !m_enabled )
+  {
+    return false;
+  }
+
+  if ( m_nextField == 0 )
+  {
+    if ( millis() - m_lastPublished < m_publishMillis )
+    {
+      return false;
+    }
+
+    m_nextField = 1;
+    m_lastPublished = millis();
+  }
+
+  // As many fields as fit.
+
+  uint16_t firstField = m_nextField;
+
+  while ( publishField(out, m_nextField) )
+  {
+    if ( ++m_nextField > getNumFields() )
+    {
+      m_nextField = 0;
+      break;
+    }
+  }
+
+  return ( m_nextField != firstField );
+}
+
+void LoopProfiler::publish(Print& out)
+{
+  out.println(F("loop_profile,phase,count,min_us,avg_us,p99_us,max_us"));
+
+  publish(out, "loop", m_loop);
+
+  for ( uint8_t phase = 0; phase < m_numPhases; ++phase )
+  {
+    publish(out, m_phaseNames[phase], m_phases[phase]);
+  }
+
+  reset();
+}
+
+void LoopProfiler::reset()
+{
+  m_loop.reset();
+
+  for ( uint8_t phase = 0; phase < m_numPhases; ++phase )
+  {
+    m_phases[phase].reset();
+  }
+
+  m_lastPublished = millis();
+  m_nextField = 0;
+}
+
+void LoopProfiler::publish(Print& out, const char* name, const LatencyHistogram& histogram)
+{
+  out.print(F("loop_profile,"));
+  out.print(name);
+  out.print(',');
+  out.print(histogram.getCount());
+  out.print(',');
+  out.print(histogram.getMinMicros());
+  out.print(',');
+  out.print(histogram.getAverageMicros());
+  out.print(',');
+  out.print(histogram.getPercentileMicros(99));
+  out.print(',');
+  out.println(histogram.getMaxMicros());
+
+  out.print(F("loop_hist,"));
+  out.print(name);
+
+  for ( uint8_t bucket = 0; bucket < LatencyHistogram::NumBuckets; ++bucket )
+  {
+    out.print(',');
+    out.print(histogram.getBucketCount(bucket));
+  }
+
+  out.println();
+}
+
+// Digits in a decimal number.
+
+static uint8_t decimalDigits(uint32_t value)
+{
+  uint8_t digits = 1;
+
+  while ( value >= 10 )
+  {
+    value /= 10;
+    ++digits;
+  }
+
+  return digits;
+}
+
+// Line starts and column names (in flash).
+
+static const char Columns[] PROGMEM = "loop_profile,phase,count,min_us,avg_us,p99_us,max_us";
+static const char ProfilePrefix[] PROGMEM = "loop_profile,";
+static const char HistogramPrefix[] PROGMEM = "loop_hist,";
+
+static const __FlashStringHelper* flashText(const char* text)
+{
+  return reinterpret_cast<const __FlashStringHelper*>(text);
+}
+
+bool LoopProfiler::publishField(Print& out, uint16_t field)
+{
+  int room = out.availableForWrite();
+
+  if ( field == 1 )
+  {
+    if ( room < static_cast<int>(sizeof(Columns) - 1 + 2) )
+    {
+      return false;
+    }
+
+    out.println(flashText(Columns));
+    return true;
+  }
+
+  // Which histogram, and which of its fields.
+
+  uint8_t index = (field - 2) / FieldsPerHistogram;
+  uint8_t part = (field - 2) % FieldsPerHistogram;
+  const char* name = ( index == 0 ) ? "loop" : m_phaseNames[index - 1];
+  LatencyHistogram& histogram = ( index == 0 ) ? m_loop : m_phases[index - 1];
+  uint32_t value = 0;
+
+  switch ( part )
+  {
+    case 0:
+    case 6:
+    {
+      const char* prefix = ( part == 0 ) ? ProfilePrefix : HistogramPrefix;
+      int length = ( part == 0 ) ? sizeof(ProfilePrefix) - 1 : sizeof(HistogramPrefix) - 1;
+
+      if ( room < length + static_cast<int>(strlen(name)) )
+      {
+        return false;
+      }
+
+      out.print(flashText(prefix));
+      out.print(name);
+      return true;
+    }
+
+    case 1: value = histogram.getCount(); break;
+    case 2: value = histogram.getMinMicros(); break;
+    case 3: value = histogram.getAverageMicros(); break;
+    case 4: value = histogram.getPercentileMicros(99); break;
+    case 5: value = histogram.getMaxMicros(); break;
+    default: value = histogram.getBucketCount(part - 7); break;
+  }
+
+  // A number, and the end of the line after the max and the last
+  // bucket.
+
+  bool lineEnd = ( part == 5 ) || ( part == FieldsPerHistogram - 1 );
+
+  if ( room < 1 + decimalDigits(value) + (lineEnd ? 2 : 0) )
+  {
+    return false;
+  }
+
+  out.print(',');
+
+  if ( lineEnd )
+  {
+    out.println(value);
+  }
+  else
+  {
+    out.print(value);
+  }
+
+  // The histogram starts over once it has been sent.
+
+  if ( part == FieldsPerHistogram - 1 )
+  {
+    histogram.reset();
+  }
+
+  return true;
+}
+
+}   // End namespace
@@ -0,0 +1,201 @@
+#ifndef INCLUDE_CSCI_LOOP_PROFILER
+#define INCLUDE_CSCI_LOOP_PROFILER
+
+// LoopProfiler class header file for control loop latency statistics.
+
+#include "CSCICore.h"
+
+namespace csci
+{
+
+/********************** LATENCY HISTOGRAM **************************/
+// A LatencyHistogram collects durations (in microseconds): count,
+// min, average and max exactly, plus counts in fixed power-of-two
+// buckets for percentiles.  Bucket 0 is under 256 us, each bucket
+// after that doubles the limit, and the last bucket is everything
+// over 262 ms.  Percentiles are a bucket's limit (at most max).
+
+class LatencyHistogram
+{
+  public:
+  static const uint8_t NumBuckets = 12;
+
+  LatencyHistogram() { reset(); }
+
+  void reset();
+
+  // Add one duration.
+
+  void add(uint32_t micros);
+
+  uint32_t getCount() const { return m_count; }
+  uint32_t getMinMicros() const { return ( m_count > 0 ) ? m_minMicros : 0; }
+  uint32_t getMaxMicros() const { return m_maxMicros; }
+  uint32_t getAverageMicros() const;
+
+  // Returns the duration "percent" (1 - 100) of the durations are
+  // within (0 if there are none).
+
+  uint32_t getPercentileMicros(uint8_t percent) const;
+
+  // Bucket counts (they stop at 65535).
+
+  uint16_t getBucketCount(uint8_t bucket) const { return m_buckets[bucket]; }
+
+  // Returns the upper limit of a bucket (in microseconds), 0xFFFFFFFF
+  // for the last one.
+
+  static uint32_t getBucketLimit(uint8_t bucket);
+
+  protected:
+  uint32_t  m_count;
+  uint32_t  m_totalMicros;
+  uint32_t  m_minMicros;
+  uint32_t  m_maxMicros;
+  uint16_t  m_buckets[NumBuckets];
+};
+
+/************************ LOOP PROFILER ****************************/
+// LoopProfiler times the phases of a control loop (sensing, deciding,
+// acting...) and the whole loop, so stalls can be traced to the phase
+// causing them.  Each phase and the loop get a LatencyHistogram, and
+// every publish period the statistics are sent as CSV lines and
+// started over:
+//
+//   loop_profile,phase,count,min_us,avg_us,p99_us,max_us
+//   loop_profile,loop,212,4110,23580,262144,301736
+//   loop_profile,sense-color,430,2480,2511,4096,2604
+//   loop_hist,sense-color,0,0,0,0,430,0,0,0,0,0,0,0
+//
+// A phase is timed from beginPhase() to the next beginPhase(),
+// endPhase() or endLoop(); a phase run several times in a loop gets
+// one duration per run.  Phases are numbered from 0 (use an enum) and
+// named by a table of string constants.
+//
+// The profiler starts disabled.  While disabled every call returns
+// at once, without reading the clock, so it can be left in a sketch.
+// Storage is supplied by the derived class (see FixedLoopProfiler).
+//
+// update() never waits for the port: it sends only as much of the
+// statistics as the port has room for (see Print::availableForWrite()),
+// a field at a time, and carries on from there on the next call.
+// Each histogram starts over as soon as it has been sent.  Send to a
+// buffered SerialMonitor to keep the loop from ever waiting on Serial.
+//
+// Usage:
+//
+//   enum LoopPhase { phSense, phDecide, phAct, NumLoopPhases };
+//   const char* const PhaseNames[] = { "sense", "decide", "act" };
+//   csci::FixedLoopProfiler<NumLoopPhases> LoopProfile(PhaseNames);
+//   ...
+//   LoopProfile.beginLoop();
+//   LoopProfile.beginPhase(phSense);
+//   ...
+//   LoopProfile.endLoop();
+//   LoopProfile.update(SMonitor);
+
+class LoopProfiler
+{
+  public:
+  // Turn profiling on or off (statistics are kept).
+
+  void setEnabled(bool enabled) { m_enabled = enabled; }
+  bool isEnabled() const { return m_enabled; }
+
+  // Set how often update() publishes (in milliseconds, default 5000).
+
+  void setPublishPeriod(uint32_t millis) { m_publishMillis = millis; }
+
+  // Start and end a loop iteration.  beginLoop() ends an iteration
+  // still open.
+
+  void beginLoop();
+  void endLoop();
+
+  // Start timing "phase" (ending any phase being timed), or end the
+  // phase being timed.
+
+  void beginPhase(uint8_t phase);
+  void endPhase();
+
+  // Publish if the publish period has passed, as much as "out" has
+  // room for (the rest on later calls).  Call between iterations
+  // (the time publishing takes isn't part of any loop).  Returns
+  // "true" if it sent anything.
+
+  bool update(Print& out);
+
+  // Send all the statistics (waiting for "out" if need be) and start
+  // them over.
+
+  void publish(Print& out);
+
+  // Start the statistics over.
+
+  void reset();
+
+  // Statistics so far.
+
+  uint8_t getNumPhases() const { return m_numPhases; }
+  const char* getPhaseName(uint8_t phase) const { return m_phaseNames[phase]; }
+  const LatencyHistogram& getPhase(uint8_t phase) const { return m_phases[phase]; }
+  const LatencyHistogram& getLoop() const { return m_loop; }
+
+  protected:
+  // Construct using the phase names and storage for their
+  // histograms.
+
+  LoopProfiler(const char* const* phaseNames, uint8_t numPhases,
+               LatencyHistogram* phases);
+
+  static void publish(Print& out, const char* name, const LatencyHistogram& histogram);
+
+  // Send field "field" of the statistics (see update()), if "out" has
+  // room for all of it.  Returns "false" if it hadn't.
+
+  bool publishField(Print& out, uint16_t field);
+
+  // Fields (numbered from 1): the column names, then for each
+  // histogram (the loop's, then each phase's) the profile line's
+  // name and five numbers, and the histogram line's name and one
+  // number per bucket.
+
+  static const uint8_t FieldsPerHistogram = 7 + LatencyHistogram::NumBuckets;
+
+  uint16_t getNumFields() const { return 1 + (m_numPhases + 1) * FieldsPerHistogram; }
+
+  protected:
+  const char* const*  m_phaseNames;
+  uint8_t             m_numPhases;
+  LatencyHistogram*   m_phases;
+  LatencyHistogram    m_loop;
+  bool                m_enabled;
+  bool                m_inLoop;         // "true" between beginLoop() and endLoop()
+  uint8_t             m_phase;          // Phase being timed (NoPhase = none)
+  uint32_t            m_loopMicros;     // When the loop began
+  uint32_t            m_phaseMicros;    // When the phase began
+  uint32_t            m_publishMillis;  // Publish period
+  uint32_t            m_lastPublished;  // When last published (millis())
+  uint16_t            m_nextField;      // Next field update() sends (0 = none)
+
+  static const uint8_t NoPhase = 0xFF;
+};
+
+/********************* FIXED LOOP PROFILER *************************/
+// FixedLoopProfiler is a LoopProfiler that owns histograms for
+// NumPhases phases.  "phaseNames" must have NumPhases entries.
+
+template <uint8_t NumPhases>
+class FixedLoopProfiler : public LoopProfiler
+{
+  public:
+  FixedLoopProfiler(const char* const* phaseNames)
+    : LoopProfiler(phaseNames, NumPhases, m_phaseStorage) { }
+
+  protected:
+  LatencyHistogram m_phaseStorage[NumPhases];
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_LOOP_PROFILER
@@ -0,0 +1,596 @@
+// Mission class implementation file.
+
+#include "CSCIMission.h"
+#include <EEPROM.h>
+
+namespace csci
+{
+
+// Script image header bytes.
+
+static const uint8_t ImageMagic1 = 'M';
+static const uint8_t ImageMagic2 = 'S';
+
+/**************************** MISSION ******************************/
+
+Mission::Mission(TMSmartCar& car)
+  : m_Car(car),
+    m_length(0),
+    m_tag(0),
+    m_pc(0),
+    m_status(rsIdle),
+    m_waitType(wtNone),
+    m_waitValue(0),
+    m_waitTimed(false),
+    m_timedOut(false),
+    m_timer(),
+    m_rxState(rxMagic1),
+    m_rxTag(0),
+    m_rxLength(0),
+    m_rxCount(0)
+{
+}
+
+bool Mission::load(const uint8_t* script, uint8_t length, uint8_t tag)
+{
+  if ( !validate(script, length) )
+  {
+    return false;
+  }
+
+  stop();
+
+  for ( uint8_t index = 0; index < length; ++index )
+  {
+    m_script[index] = script[index];
+  }
+
+  m_length = length;
+  m_tag = tag;
+  m_status = rsIdle;
+
+  return true;
+}
+
+bool Mission::loadFromEEPROM(int address)
+{
+  if ( (EEPROM.read(address) != ImageMagic1) ||
+       (EEPROM.read(address + 1) != ImageMagic2) )
+  {
+    return false;
+  }
+
+  uint8_t tag = EEPROM.read(address + 2);
+  uint8_t length = EEPROM.read(address + 3);
+
+  if ( (length == 0) || (length > MaxScript) )
+  {
+    return false;
+  }
+
+  uint8_t sum = tag + EEPROM.read(address + 4 + length);
+
+  for ( uint8_t index = 0; index < length; ++index )
+  {
+    sum += EEPROM.read(address + 4 + index);
+  }
+
+  if ( sum != 0 )
+  {
+    return false;
+  }
+
+  // Image is good, so read the script in place (saves a buffer).
+
+  stop();
+
+  for ( uint8_t index = 0; index < length; ++index )
+  {
+    m_script[index] = EEPROM.read(address + 4 + index);
+  }
+
+  m_length = validate(m_script, length) ? length : 0;
+  m_tag = tag;
+  m_status = rsIdle;
+
+  return ( m_length > 0 );
+}
+
+void Mission::saveToEEPROM(int address) const
+{
+  EEPROM.update(address, ImageMagic1);
+  EEPROM.update(address + 1, ImageMagic2);
+  EEPROM.update(address + 2, m_tag);
+  EEPROM.update(address + 3, m_length);
+
+  for ( uint8_t index = 0; index < m_length; ++index )
+  {
+    EEPROM.update(address + 4 + index, m_script[index]);
+  }
+
+  EEPROM.update(address + 4 + m_length,
+                static_cast<uint8_t>(-(m_tag + checksum(m_script, m_length))));
+}
+
+bool Mission::receive(Stream& stream)
+{
+  while ( stream.available() > 0 )
+  {
+    uint8_t value = static_cast<uint8_t>(stream.read());
+
+    switch ( m_rxState )
+    {
+      case rxMagic1:
+      {
+        if ( value == ImageMagic1 )
+        {
+          m_rxState = rxMagic2;
+        }
+        break;
+      }
+
+      case rxMagic2:
+      {
+        m_rxState = ( value == ImageMagic2 ) ? rxTag : rxMagic1;
+        break;
+      }
+
+      case rxTag:
+      {
+        m_rxTag = value;
+        m_rxState = rxLength;
+        break;
+      }
+
+      case rxLength:
+      {
+        if ( (value == 0) || (value > MaxScript) )
+        {
+          m_rxState = rxMagic1;
+          break;
+        }
+
+        // Script is received in place, so stop the current one.
+
+        stop();
+
+        m_length = 0;
+        m_status = rsIdle;
+        m_rxLength = value;
+        m_rxCount = 0;
+        m_rxState = rxScript;
+        break;
+      }
+
+      case rxScript:
+      {
+        m_script[m_rxCount++] = value;
+
+        if ( m_rxCount == m_rxLength )
+        {
+          m_rxState = rxChecksum;
+        }
+        break;
+      }
+
+      case rxChecksum:
+      {
+        m_rxState = rxMagic1;
+
+        if ( (static_cast<uint8_t>(m_rxTag + checksum(m_script, m_rxLength) + value) == 0) &&
+             validate(m_script, m_rxLength) )
+        {
+          m_length = m_rxLength;
+          m_tag = m_rxTag;
+          return true;
+        }
+        break;
+      }
+    }
+  }
+
+  return false;
+}
+
+void Mission::start()
+{
+  if ( m_length == 0 )
+  {
+    return;
+  }
+
+  m_pc = 0;
+  m_waitType = wtNone;
+  m_timedOut = false;
+  m_timer.stop();
+  m_status = rsRunning;
+}
+
+void Mission::stop()
+{
+  if ( m_status == rsRunning )
+  {
+    m_Car.stop();
+    m_status = rsDone;
+  }
+
+  m_waitType = wtNone;
+  m_timer.stop();
+}
+
+Mission::RunStatus Mission::update()
+{
+  if ( m_status != rsRunning )
+  {
+    return m_status;
+  }
+
+  if ( (m_waitType != wtNone) && !waitDone() )
+  {
+    return m_status;
+  }
+
+  for ( uint8_t count = 0; count < MaxStepsPerUpdate; ++count )
+  {
+    if ( !step() )
+    {
+      break;
+    }
+  }
+
+  return m_status;
+}
+
+Mission::RunStatus Mission::getStatus() const
+{
+  return m_status;
+}
+
+uint8_t Mission::getProgramCounter() const
+{
+  return m_pc;
+}
+
+uint8_t Mission::getLength() const
+{
+  return m_length;
+}
+
+uint8_t Mission::getTag() const
+{
+  return m_tag;
+}
+
+uint8_t Mission::instructionLength(uint8_t opcode)
+{
+  switch ( opcode )
+  {
+    case opEnd:
+    case opStop:
+      return 1;
+
+    case opGo:
+    case opSetSpeed:
+      return 2;
+
+    case opSpin:
+    case opWait:
+    case opBranchTimeout:
+    case opJump:
+      return 3;
+
+    case opMove:
+    case opAwaitColor:
+    case opAwaitRangeLT:
+    case opBranchColor:
+      return 4;
+
+    default:
+      return 0;
+  }
+}
+
+bool Mission::validate(const uint8_t* script, uint8_t length)
+{
+  if ( (length == 0) || (length > MaxScript) )
+  {
+    return false;
+  }
+
+  // First pass: check operands and mark instruction starts.
+
+  uint8_t starts[MaxScript / 8];
+
+  for ( uint8_t index = 0; index < sizeof(starts); ++index )
+  {
+    starts[index] = 0;
+  }
+
+  uint8_t pc = 0;
+
+  while ( pc < length )
+  {
+    uint8_t opcode = script[pc];
+    uint8_t size = instructionLength(opcode);
+
+    if ( (size == 0) || (pc + size > length) )
+    {
+      return false;
+    }
+
+    starts[pc >> 3] |= ( 1 << (pc & 0x07) );
+
+    switch ( opcode )
+    {
+      case opMove:
+      {
+        if ( script[pc + 1] >= MoveState::msStop )
+        {
+          return false;
+        }
+        break;
+      }
+
+      case opGo:
+      {
+        if ( script[pc + 1] > MoveState::msStop )
+        {
+          return false;
+        }
+        break;
+      }
+
+      case opSetSpeed:
+      {
+        if ( (script[pc + 1] == 0) || (script[pc + 1] > 100) )
+        {
+          return false;
+        }
+        break;
+      }
+
+      case opAwaitColor:
+      case opBranchColor:
+      {
+        if ( script[pc + 1] > TapeColor::yellow )
+        {
+          return false;
+        }
+        break;
+      }
+
+      default:
+        break;
+    }
+
+    pc += size;
+  }
+
+  // Second pass: branches must land on an instruction.
+
+  pc = 0;
+
+  while ( pc < length )
+  {
+    uint8_t opcode = script[pc];
+    bool branch = true;
+    uint16_t target = 0;
+
+    if ( (opcode == opBranchTimeout) || (opcode == opJump) )
+    {
+      target = script[pc + 1] | ( script[pc + 2] << 8 );
+    }
+    else if ( opcode == opBranchColor )
+    {
+      target = script[pc + 2] | ( script[pc + 3] << 8 );
+    }
+    else
+    {
+      branch = false;
+    }
+
+    if ( branch &&
+         ( (target >= length) || !(starts[target >> 3] & (1 << (target & 0x07))) ) )
+    {
+      return false;
+    }
+
+    pc += instructionLength(opcode);
+  }
+
+  return true;
+}
+
+uint8_t Mission::checksum(const uint8_t* script, uint8_t length)
+{
+  uint8_t sum = 0;
+
+  for ( uint8_t index = 0; index < length; ++index )
+  {
+    sum += script[index];
+  }
+
+  return sum;
+}
+
+uint16_t Mission::readU16(uint8_t offset) const
+{
+  return m_script[offset] | ( static_cast<uint16_t>(m_script[offset + 1]) << 8 );
+}
+
+bool Mission::step()
+{
+  // Running off the end of the script is the same as opEnd.
+
+  if ( m_pc >= m_length )
+  {
+    m_Car.stop();
+    m_status = rsDone;
+    return false;
+  }
+
+  uint8_t pc = m_pc;
+
+  m_pc += instructionLength(m_script[pc]);
+
+  switch ( m_script[pc] )
+  {
+    case opEnd:
+    {
+      m_Car.stop();
+      m_status = rsDone;
+      return false;
+    }
+
+    case opMove:
+    {
+      MoveState moveState = static_cast<MoveState>(m_script[pc + 1]);
+      uint16_t millimeters = readU16(pc + 2);
+
+      m_Car.moveMM(moveState, millimeters);
+      m_timer.start(m_Car.getMMTravelTime(moveState, millimeters));
+      m_waitType = wtTime;
+      return false;
+    }
+
+    case opSpin:
+    {
+      int16_t degrees = static_cast<int16_t>(readU16(pc + 1));
+
+      if ( degrees >= 0 )
+      {
+        m_Car.spinCW(degrees);
+        m_timer.start(m_Car.getSpinCWTravelTime(degrees));
+      }
+      else
+      {
+        m_Car.spinCCW(-degrees);
+        m_timer.start(m_Car.getSpinCCWTravelTime(-degrees));
+      }
+
+      m_waitType = wtTime;
+      return false;
+    }
+
+    case opGo:
+    {
+      m_Car.move(static_cast<MoveState>(m_script[pc + 1]));
+      return true;
+    }
+
+    case opStop:
+    {
+      m_Car.stop();
+      return true;
+    }
+
+    case opWait:
+    {
+      m_timer.start(readU16(pc + 1));
+      m_waitType = wtTime;
+      return false;
+    }
+
+    case opSetSpeed:
+    {
+      m_Car.setSpeedFraction(m_script[pc + 1] / 100.0);
+      return true;
+    }
+
+    case opAwaitColor:
+    case opAwaitRangeLT:
+    {
+      uint16_t timeout = readU16(pc + 2);
+
+      m_waitType = ( m_script[pc] == opAwaitColor ) ? wtColor : wtRange;
+      m_waitValue = m_script[pc + 1];
+      m_waitTimed = ( timeout > 0 );
+      m_timedOut = false;
+
+      if ( m_waitTimed )
+      {
+        m_timer.start(timeout);
+      }
+
+      // Check right away; no need to wait if already there.
+
+      return waitDone();
+    }
+
+    case opBranchColor:
+    {
+      if ( m_Car.getTapeColor() == m_script[pc + 1] )
+      {
+        m_pc = readU16(pc + 2);
+      }
+      return true;
+    }
+
+    case opBranchTimeout:
+    {
+      if ( m_timedOut )
+      {
+        m_pc = readU16(pc + 1);
+      }
+      return true;
+    }
+
+    case opJump:
+    {
+      m_pc = readU16(pc + 1);
+      return true;
+    }
+  }
+
+  return true;
+}
+
+bool Mission::waitDone()
+{
+  bool done = false;
+
+  switch ( m_waitType )
+  {
+    case wtNone:
+    {
+      return true;
+    }
+
+    case wtTime:
+    {
+      done = m_timer.done();
+      break;
+    }
+
+    case wtColor:
+    {
+      done = ( m_Car.getTapeColor() == m_waitValue );
+      break;
+    }
+
+    case wtRange:
+    {
+      double rangeCM = m_Car.getRangeSensorDistanceCM();
+
+      done = ( (rangeCM > 0.0) && (rangeCM < m_waitValue) );
+      break;
+    }
+  }
+
+  // Awaits give up when their timeout expires.
+
+  if ( !done && (m_waitType != wtTime) && m_waitTimed && m_timer.done() )
+  {
+    m_timedOut = true;
+    done = true;
+  }
+
+  if ( done )
+  {
+    m_waitType = wtNone;
+  }
+
+  return done;
+}
+
+}   // End namespace
@@ -0,0 +1,230 @@
+#ifndef INCLUDE_CSCI_MISSION
+#define INCLUDE_CSCI_MISSION
+
+// Mission class header file for running course scripts.
+
+#include "CSCICore.h"
+#include "CSCITimer.h"
+#include "CSCISmartCar.h"
+
+namespace csci
+{
+
+/************************ MISSION OPCODES **************************/
+// A mission script is a sequence of instructions, each an opcode
+// byte followed by its operands.  Multi-byte operands are
+// little-endian.  Branch targets are byte offsets from the start of
+// the script.
+//
+//   Opcode           Operands                Action
+//   ------           --------                ------
+//   opEnd                                    Stop the car, mission done
+//   opMove           state, mm (u16)         moveMM(state, mm), wait until done
+//   opSpin           degrees (i16)           Spin (+ = CW, - = CCW), wait until done
+//   opGo             state                   move(state) (keeps moving)
+//   opStop                                   Stop the car
+//   opWait           ms (u16)                Wait
+//   opSetSpeed       percent                 Set speed fraction (percent / 100)
+//   opAwaitColor     color, ms (u16)         Wait for tape color (ms = 0: forever)
+//   opAwaitRangeLT   cm, ms (u16)            Wait for range < cm (ms = 0: forever)
+//   opBranchColor    color, target (u16)     Jump if tape color is "color"
+//   opBranchTimeout  target (u16)            Jump if the last await timed out
+//   opJump           target (u16)            Jump
+//
+// Example (follow a red line until blue tape, then spin around):
+//
+//   opGo, msForward,
+//   opAwaitColor, blue, 0x00, 0x00,
+//   opSpin, 0xB4, 0x00,                 // 180 degrees CW
+//   opEnd
+
+typedef enum
+{
+  opEnd = 0,
+  opMove,
+  opSpin,
+  opGo,
+  opStop,
+  opWait,
+  opSetSpeed,
+  opAwaitColor,
+  opAwaitRangeLT,
+  opBranchColor,
+  opBranchTimeout,
+  opJump,
+  NumMissionOpcodes
+} MissionOpcode;
+
+/**************************** MISSION ******************************/
+// A Mission runs a script on a TMSmartCar.  Scripts are checked when
+// loaded (opcodes, operands and branch targets), so the interpreter
+// does no checking at run time.
+//
+// update() never blocks: it runs instructions until one has to wait
+// (a move, a wait or an await), then returns.  Moves are timed with
+// the drive train's travel time, so no motor controller reads are
+// needed while moving.  At most MaxStepsPerUpdate instructions are
+// run per call, so a script that loops without waiting can't stall
+// the control loop.
+//
+// Scripts are loaded from RAM, EEPROM or a serial stream.  EEPROM
+// and serial use the same image:
+//
+//   'M', 'S', tag, length, script bytes (length), checksum
+//
+// where the tag is a byte for the sketch's use (what the script is
+// for, e.g. the tape color of the line it detours from), and the
+// checksum makes the 8 bit sum of the tag, the script bytes and the
+// checksum zero.
+
+class Mission
+{
+  public:
+  // Maximum script length (in bytes).
+
+  static const uint8_t MaxScript = 128;
+
+  // Maximum image size (in bytes), for laying out EEPROM.
+
+  static const uint8_t MaxImage = MaxScript + 5;
+
+  // Maximum instructions run per call to update().
+
+  static const uint8_t MaxStepsPerUpdate = 8;
+
+  // Mission status.
+
+  typedef enum
+  {
+    rsIdle,       // No script started
+    rsRunning,    // Script running
+    rsDone        // Script ended (opEnd) or stopped
+  } RunStatus;
+
+  // Construct from reference to the car to run scripts on.
+
+  Mission(TMSmartCar& car);
+
+  // Load a script (with its tag) from RAM.  Returns "false" if the
+  // script is invalid (the current script is then unchanged).
+
+  bool load(const uint8_t* script, uint8_t length, uint8_t tag = 0);
+
+  // Load a script from an EEPROM image at "address".  Returns
+  // "false" if there is no valid image there.  (Like receive(), a
+  // script that passes the checksum is read in place.)
+
+  bool loadFromEEPROM(int address);
+
+  // Save the current script as an EEPROM image at "address".
+  // Only bytes that differ are written.
+
+  void saveToEEPROM(int address) const;
+
+  // Receive a script image from a serial stream.  Reads only the
+  // bytes already available, so it never blocks.  Returns "true"
+  // when a complete, valid script has been received and loaded.
+  //
+  // NOTE: To save RAM the script is received in place, so once an
+  //       image starts arriving the mission is stopped and the
+  //       current script is lost (even if the image turns out bad).
+
+  bool receive(Stream& stream);
+
+  // Start (or restart) running the script from the beginning.
+
+  void start();
+
+  // Stop running the script (and the car).
+
+  void stop();
+
+  // Run the script until it must wait.  Returns the run status.
+
+  RunStatus update();
+
+  // Returns the run status.
+
+  RunStatus getStatus() const;
+
+  // Returns the offset of the next instruction to run.
+
+  uint8_t getProgramCounter() const;
+
+  // Returns the script length.
+
+  uint8_t getLength() const;
+
+  // Returns the script's tag.
+
+  uint8_t getTag() const;
+
+  protected:
+  // Returns the length of an instruction given its opcode (0 if the
+  // opcode is invalid).
+
+  static uint8_t instructionLength(uint8_t opcode);
+
+  // Check a script.  Returns "true" if it can be run safely.
+
+  static bool validate(const uint8_t* script, uint8_t length);
+
+  // Returns the 8 bit checksum of the script bytes.
+
+  static uint8_t checksum(const uint8_t* script, uint8_t length);
+
+  // Read operands.
+
+  uint16_t readU16(uint8_t offset) const;
+
+  // Run one instruction.  Returns "false" if the mission must wait.
+
+  bool step();
+
+  // Returns "true" once the current wait is over.
+
+  bool waitDone();
+
+  protected:
+  // What the mission is waiting for.
+
+  typedef enum
+  {
+    wtNone,       // Not waiting
+    wtTime,       // Timer to expire
+    wtColor,      // Tape color (or timer)
+    wtRange       // Range below limit (or timer)
+  } WaitType;
+
+  // Serial receiver states.
+
+  typedef enum
+  {
+    rxMagic1,
+    rxMagic2,
+    rxTag,
+    rxLength,
+    rxScript,
+    rxChecksum
+  } ReceiveState;
+
+  TMSmartCar&   m_Car;                  // Car running the script
+  uint8_t       m_script[MaxScript];    // Script
+  uint8_t       m_length;               // Script length
+  uint8_t       m_tag;                  // Script tag
+  uint8_t       m_pc;                   // Program counter
+  RunStatus     m_status;               // Run status
+  WaitType      m_waitType;             // Current wait
+  uint8_t       m_waitValue;            // Color or range being waited for
+  bool          m_waitTimed;            // "true" if the await has a timeout
+  bool          m_timedOut;             // "true" if last await timed out
+  TimerMillis   m_timer;                // Move/wait/await timer
+  ReceiveState  m_rxState;              // Serial receiver state
+  uint8_t       m_rxTag;                // Tag of the image being received
+  uint8_t       m_rxLength;             // Script length being received
+  uint8_t       m_rxCount;              // Script bytes received
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_MISSION
@@ -0,0 +1,278 @@
+// OccupancyGrid class implementation file.
+
+#include "CSCIOccupancyGrid.h"
+
+namespace csci
+{
+
+/*********************** OCCUPANCY GRID ****************************/
+
+OccupancyGrid::OccupancyGrid(float cellSizeMM, float maxFreeRangeMM)
+  : m_cellSizeMM(cellSizeMM),
+    m_maxFreeRangeMM(maxFreeRangeMM),
+    m_originX(0),
+    m_originY(0)
+{
+  clear();
+}
+
+void OccupancyGrid::clear(float xMM, float yMM)
+{
+  for ( uint16_t index = 0; index < sizeof(m_cells); ++index )
+  {
+    m_cells[index] = 0;   // Every cell "csUnknown"
+  }
+
+  m_originX = toCell(xMM) - (Dim / 2);
+  m_originY = toCell(yMM) - (Dim / 2);
+}
+
+bool OccupancyGrid::recenter(float xMM, float yMM)
+{
+  const int16_t margin = Dim / 4;
+
+  int16_t cellX = toCell(xMM);
+  int16_t cellY = toCell(yMM);
+
+  int16_t originX = m_originX;
+  int16_t originY = m_originY;
+
+  // If too close to either edge, center the window on the position.
+
+  if ( (cellX - originX < margin) || (cellX - originX >= Dim - margin) )
+  {
+    originX = cellX - (Dim / 2);
+  }
+
+  if ( (cellY - originY < margin) || (cellY - originY >= Dim - margin) )
+  {
+    originY = cellY - (Dim / 2);
+  }
+
+  if ( (originX == m_originX) && (originY == m_originY) )
+  {
+    return false;
+  }
+
+  shiftTo(originX, originY);
+
+  return true;
+}
+
+void OccupancyGrid::integrateRange(float sensorXMM, float sensorYMM,
+                                   float bearingRad, float rangeMM)
+{
+  bool echo = ( rangeMM > 0.0 );
+
+  float beamMM = echo ? rangeMM : m_maxFreeRangeMM;
+
+  // Beam start and end cells.
+
+  int16_t x0 = toCell(sensorXMM);
+  int16_t y0 = toCell(sensorYMM);
+  int16_t x1 = toCell(sensorXMM + beamMM * cos(bearingRad));
+  int16_t y1 = toCell(sensorYMM + beamMM * sin(bearingRad));
+
+  // Walk the beam (Bresenham's line algorithm), marking cells free,
+  // until the end cell is reached or the beam leaves the window.
+
+  int16_t dx = ( x1 > x0 ) ? ( x1 - x0 ) : ( x0 - x1 );
+  int16_t dy = ( y1 > y0 ) ? -( y1 - y0 ) : -( y0 - y1 );
+  int8_t  sx = ( x0 < x1 ) ? 1 : -1;
+  int8_t  sy = ( y0 < y1 ) ? 1 : -1;
+  int16_t error = dx + dy;
+
+  while ( inWindow(x0, y0) )
+  {
+    if ( (x0 == x1) && (y0 == y1) )
+    {
+      // End of beam.  Occupied only if something echoed.
+
+      if ( echo )
+      {
+        markOccupied(x0, y0);
+      }
+      else
+      {
+        markFree(x0, y0);
+      }
+
+      break;
+    }
+
+    markFree(x0, y0);
+
+    int16_t error2 = 2 * error;
+
+    if ( error2 >= dy )
+    {
+      error += dy;
+      x0 += sx;
+    }
+
+    if ( error2 <= dx )
+    {
+      error += dx;
+      y0 += sy;
+    }
+  }
+}
+
+void OccupancyGrid::integrateServoReading(const Pose2D& pose,
+                                          const SensorMount& mount,
+                                          uint8_t servoAngle,
+                                          uint16_t rangeCM)
+{
+  const float DegreesToRadians = 3.14159265 / 180.0;
+
+  float cosHeading = cos(pose.headingRad);
+  float sinHeading = sin(pose.headingRad);
+
+  // Sensor position in world coordinates.
+
+  float sensorXMM = pose.xMM + mount.offsetXMM * cosHeading
+                             - mount.offsetYMM * sinHeading;
+  float sensorYMM = pose.yMM + mount.offsetXMM * sinHeading
+                             + mount.offsetYMM * cosHeading;
+
+  // Sensor bearing in world coordinates.
+
+  int16_t servoOffset = static_cast<int16_t>(servoAngle) - mount.centerAngle;
+
+  float bearingRad = pose.headingRad +
+                     mount.angleSign * servoOffset * DegreesToRadians;
+
+  integrateRange(sensorXMM, sensorYMM, bearingRad, rangeCM * 10.0);
+}
+
+OccupancyGrid::CellState OccupancyGrid::getCellAt(float xMM, float yMM) const
+{
+  return getCell(toCell(xMM), toCell(yMM));
+}
+
+OccupancyGrid::CellState OccupancyGrid::getCell(int16_t cellX, int16_t cellY) const
+{
+  if ( !inWindow(cellX, cellY) )
+  {
+    return csUnknown;
+  }
+
+  return static_cast<CellState>(readCell(cellX, cellY));
+}
+
+bool OccupancyGrid::isBlocked(int16_t cellX, int16_t cellY) const
+{
+  return ( getCell(cellX, cellY) >= csMaybe );
+}
+
+int16_t OccupancyGrid::toCell(float mm) const
+{
+  return static_cast<int16_t>(floor(mm / m_cellSizeMM));
+}
+
+float OccupancyGrid::cellCenterMM(int16_t cell) const
+{
+  return ( cell + 0.5 ) * m_cellSizeMM;
+}
+
+bool OccupancyGrid::inWindow(int16_t cellX, int16_t cellY) const
+{
+  return ( (cellX >= m_originX) && (cellX < m_originX + Dim) &&
+           (cellY >= m_originY) && (cellY < m_originY + Dim) );
+}
+
+uint8_t OccupancyGrid::readCell(int16_t cellX, int16_t cellY) const
+{
+  uint8_t column = static_cast<uint8_t>(cellX) & Mask;
+  uint8_t row = static_cast<uint8_t>(cellY) & Mask;
+
+  uint8_t shift = (column & 0x03) * 2;
+
+  return ( m_cells[row * BytesPerRow + (column >> 2)] >> shift ) & 0x03;
+}
+
+void OccupancyGrid::writeCell(int16_t cellX, int16_t cellY, uint8_t state)
+{
+  uint8_t column = static_cast<uint8_t>(cellX) & Mask;
+  uint8_t row = static_cast<uint8_t>(cellY) & Mask;
+
+  uint8_t shift = (column & 0x03) * 2;
+  uint8_t& cells = m_cells[row * BytesPerRow + (column >> 2)];
+
+  cells = ( cells & ~(0x03 << shift) ) | ( (state & 0x03) << shift );
+}
+
+void OccupancyGrid::markFree(int16_t cellX, int16_t cellY)
+{
+  // An occupied cell takes two "free" observations to clear.
+
+  uint8_t state = readCell(cellX, cellY);
+
+  writeCell(cellX, cellY, ( state == csOccupied ) ? csMaybe : csFree);
+}
+
+void OccupancyGrid::markOccupied(int16_t cellX, int16_t cellY)
+{
+  // A cell takes two "occupied" observations to be confirmed.
+
+  uint8_t state = readCell(cellX, cellY);
+
+  writeCell(cellX, cellY, ( state >= csMaybe ) ? csOccupied : csMaybe);
+}
+
+void OccupancyGrid::shiftTo(int16_t originX, int16_t originY)
+{
+  int16_t shiftX = originX - m_originX;
+  int16_t shiftY = originY - m_originY;
+
+  // Clear the columns entering the window.  Their storage is shared
+  // with the columns leaving it.
+
+  if ( (shiftX >= Dim) || (shiftX <= -Dim) )
+  {
+    shiftX = Dim;   // Everything leaves.
+  }
+
+  for ( int16_t count = 0; count < ( shiftX < 0 ? -shiftX : shiftX ); ++count )
+  {
+    clearColumn(( shiftX > 0 ) ? ( m_originX + Dim + count ) : ( originX + count ));
+  }
+
+  // Likewise for rows.
+
+  if ( (shiftY >= Dim) || (shiftY <= -Dim) )
+  {
+    shiftY = Dim;
+  }
+
+  for ( int16_t count = 0; count < ( shiftY < 0 ? -shiftY : shiftY ); ++count )
+  {
+    clearRow(( shiftY > 0 ) ? ( m_originY + Dim + count ) : ( originY + count ));
+  }
+
+  m_originX = originX;
+  m_originY = originY;
+}
+
+void OccupancyGrid::clearColumn(int16_t cellX)
+{
+  uint8_t column = static_cast<uint8_t>(cellX) & Mask;
+  uint8_t shift = (column & 0x03) * 2;
+
+  for ( uint8_t row = 0; row < Dim; ++row )
+  {
+    m_cells[row * BytesPerRow + (column >> 2)] &= ~(0x03 << shift);
+  }
+}
+
+void OccupancyGrid::clearRow(int16_t cellY)
+{
+  uint8_t row = static_cast<uint8_t>(cellY) & Mask;
+
+  for ( uint8_t index = 0; index < BytesPerRow; ++index )
+  {
+    m_cells[row * BytesPerRow + index] = 0;
+  }
+}
+
+}   // End namespace
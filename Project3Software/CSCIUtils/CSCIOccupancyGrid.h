@@ -0,0 +1,178 @@
+#ifndef INCLUDE_CSCI_OCCUPANCY_GRID
+#define INCLUDE_CSCI_OCCUPANCY_GRID
+
+// OccupancyGrid class header file.
+//
+// NOTE: This file deliberately depends only on the standard C headers
+//       (no Arduino or PRIZM declarations), so the grid can also be
+//       compiled on a Linux host and fed recorded scans.
+
+#include <stdint.h>
+#include <math.h>
+
+namespace csci
+{
+
+/**************************** POSE *********************************/
+// A Pose2D is a position and heading in world coordinates.
+//
+// Convention: x is "forward" and y is "left" of the car's heading
+// at the time the world frame was established.  Heading is measured
+// counter-clockwise from the x axis (in radians).
+
+struct Pose2D
+{
+  float xMM;          // X position (in millimeters)
+  float yMM;          // Y position (in millimeters)
+  float headingRad;   // Heading (in radians, counter-clockwise)
+};
+
+/************************ SENSOR MOUNT *****************************/
+// A SensorMount describes where a servo swept range finder is
+// mounted on the car, relative to the center of the car.
+
+struct SensorMount
+{
+  float   offsetXMM;      // Distance forward of car center
+  float   offsetYMM;      // Distance left of car center
+  uint8_t centerAngle;    // Servo angle that points straight ahead
+  int8_t  angleSign;      // +1 if larger servo angles point left, else -1
+};
+
+/*********************** OCCUPANCY GRID ****************************/
+// An OccupancyGrid is a small, fixed size map of the area around the
+// car, made up of Dim x Dim square cells.  Each cell takes 2 bits,
+// so the whole map takes (Dim * Dim) / 4 bytes (256 bytes).
+//
+// Each cell is in one of four states:
+//
+//   csUnknown   - never observed
+//   csFree      - last seen empty
+//   csMaybe     - seen occupied once (or cleared once after csOccupied)
+//   csOccupied  - seen occupied at least twice in a row
+//
+// A range reading marks the cells along the beam free and the cell
+// at the end of the beam occupied.  Cells are updated along a single
+// ray (the sonar cone width is ignored), so an update is
+// O(beam length in cells).
+//
+// The map is a window, in world coordinates, that follows the car.
+// Cells are stored at (world cell mod Dim), so when the window is
+// shifted only the rows/columns entering the window are cleared;
+// nothing else is moved.
+
+class OccupancyGrid
+{
+  public:
+  // Map dimension (in cells).  MUST be a power of 2.
+
+  static const uint8_t Dim = 32;
+
+  // Cell states.
+
+  typedef enum
+  {
+    csUnknown = 0,
+    csFree = 1,
+    csMaybe = 2,
+    csOccupied = 3
+  } CellState;
+
+  // Construct using cell size (in millimeters) and maximum distance
+  // (in millimeters) a beam without an echo is assumed to be free.
+
+  OccupancyGrid(float cellSizeMM = 50.0, float maxFreeRangeMM = 1000.0);
+
+  // Mark every cell unknown, and center the window on (xMM, yMM).
+
+  void clear(float xMM = 0.0, float yMM = 0.0);
+
+  // Shift the window (if needed) so the position is not within a
+  // quarter of the map of any edge.  Returns "true" if it shifted.
+
+  bool recenter(float xMM, float yMM);
+
+  // Integrate a range reading taken from "sensorX,sensorY" (in world
+  // millimeters) looking along world bearing "bearingRad".
+  // rangeMM <= 0 means there was no echo.
+
+  void integrateRange(float sensorXMM, float sensorYMM,
+                      float bearingRad, float rangeMM);
+
+  // Integrate a servo swept range finder reading taken at "pose".
+  // servoAngle is in degrees and rangeCM == 0 means no echo.
+
+  void integrateServoReading(const Pose2D& pose, const SensorMount& mount,
+                             uint8_t servoAngle, uint16_t rangeCM);
+
+  // Returns the state of the cell containing a world position.
+  // Positions outside the window are csUnknown.
+
+  CellState getCellAt(float xMM, float yMM) const;
+
+  // Returns the state of a cell given its world cell coordinates.
+  // Cells outside the window are csUnknown.
+
+  CellState getCell(int16_t cellX, int16_t cellY) const;
+
+  // Returns "true" if a world cell is csMaybe or csOccupied.
+
+  bool isBlocked(int16_t cellX, int16_t cellY) const;
+
+  // Convert a world coordinate (in millimeters) to a cell coordinate.
+
+  int16_t toCell(float mm) const;
+
+  // Returns the world position (in millimeters) of a cell center.
+
+  float cellCenterMM(int16_t cell) const;
+
+  // Returns the world cell coordinates of the window's lower left.
+
+  int16_t getOriginX() const { return m_originX; }
+  int16_t getOriginY() const { return m_originY; }
+
+  // Returns cell size (in millimeters).
+
+  float getCellSizeMM() const { return m_cellSizeMM; }
+
+  protected:
+
+  // Returns "true" if world cell is in the current window.
+
+  bool inWindow(int16_t cellX, int16_t cellY) const;
+
+  // Raw storage access (cell must be in the window).
+
+  uint8_t readCell(int16_t cellX, int16_t cellY) const;
+  void    writeCell(int16_t cellX, int16_t cellY, uint8_t state);
+
+  // Apply a "free" or "occupied" observation to a cell.
+
+  void markFree(int16_t cellX, int16_t cellY);
+  void markOccupied(int16_t cellX, int16_t cellY);
+
+  // Shift the window so its origin moves to (originX, originY),
+  // clearing the rows and columns that enter the window.
+
+  void shiftTo(int16_t originX, int16_t originY);
+
+  // Clear one column (or row) of storage.
+
+  void clearColumn(int16_t cellX);
+  void clearRow(int16_t cellY);
+
+  protected:
+  static const uint8_t Mask = Dim - 1;
+  static const uint8_t BytesPerRow = Dim / 4;
+
+  uint8_t   m_cells[Dim * BytesPerRow];   // 2 bits per cell
+  float     m_cellSizeMM;                 // Cell size (in millimeters)
+  float     m_maxFreeRangeMM;             // Free distance if no echo
+  int16_t   m_originX;                    // World cell of window left
+  int16_t   m_originY;                    // World cell of window bottom
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_OCCUPANCY_GRID
@@ -0,0 +1,103 @@
+// Odometry class implementation file.
+
+#include "CSCIOdometry.h"
+
+namespace csci
+{
+
+/********************* TETRIX MECANUM ODOMETRY *********************/
+
+TMOdometry::TMOdometry(TMDriveTrain& driveTrain)
+  : m_DTrain(driveTrain),
+    m_lastDegrees(0.0)
+{
+  m_pose.xMM = 0.0;
+  m_pose.yMM = 0.0;
+  m_pose.headingRad = 0.0;
+}
+
+void TMOdometry::reset(const Pose2D& pose)
+{
+  m_pose = pose;
+
+  // Travel so far in the current movement isn't part of the new pose.
+
+  m_lastDegrees = ( m_DTrain.getMoveState() == MoveState::msStop ) ?
+                    0.0 : m_DTrain.readWheelDegrees();
+}
+
+void TMOdometry::update()
+{
+  MoveState moveState = m_DTrain.getMoveState();
+
+  // Stopping resets the encoders, so the next movement starts at zero.
+
+  if ( moveState == MoveState::msStop )
+  {
+    m_lastDegrees = 0.0;
+    return;
+  }
+
+  double degrees = m_DTrain.readWheelDegrees();
+  double deltaDegrees = degrees - m_lastDegrees;
+
+  // If the encoder count went down, the encoders were reset.
+
+  if ( deltaDegrees < 0.0 )
+  {
+    deltaDegrees = degrees;
+  }
+
+  m_lastDegrees = degrees;
+
+  double distance = m_DTrain.wheelDegreesToDistance(moveState, deltaDegrees);
+
+  // Direction of travel relative to the car (x forward, y left).
+
+  const double DIAG = 0.70710678;   // sqrt(2) / 2
+
+  double dirX = 0.0;
+  double dirY = 0.0;
+
+  switch ( moveState )
+  {
+    case MoveState::msForward:  dirX =  1.0;                break;
+    case MoveState::msReverse:  dirX = -1.0;                break;
+    case MoveState::msLeft:     dirY =  1.0;                break;
+    case MoveState::msRight:    dirY = -1.0;                break;
+    case MoveState::msDiagFL:   dirX =  DIAG; dirY =  DIAG; break;
+    case MoveState::msDiagFR:   dirX =  DIAG; dirY = -DIAG; break;
+    case MoveState::msDiagRL:   dirX = -DIAG; dirY =  DIAG; break;
+    case MoveState::msDiagRR:   dirX = -DIAG; dirY = -DIAG; break;
+
+    case MoveState::msRotateCW:
+    {
+      m_pose.headingRad -= distance * ( PI / 180.0 );
+      return;
+    }
+
+    case MoveState::msRotateCCW:
+    {
+      m_pose.headingRad += distance * ( PI / 180.0 );
+      return;
+    }
+
+    default:
+      return;
+  }
+
+  // Rotate travel direction into world coordinates.
+
+  double cosHeading = cos(m_pose.headingRad);
+  double sinHeading = sin(m_pose.headingRad);
+
+  m_pose.xMM += distance * ( dirX * cosHeading - dirY * sinHeading );
+  m_pose.yMM += distance * ( dirX * sinHeading + dirY * cosHeading );
+}
+
+const Pose2D& TMOdometry::getPose() const
+{
+  return m_pose;
+}
+
+}   // End namespace
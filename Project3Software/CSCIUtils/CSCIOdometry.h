@@ -0,0 +1,58 @@
+#ifndef INCLUDE_CSCI_ODOMETRY
+#define INCLUDE_CSCI_ODOMETRY
+
+// Odometry class header file for dead reckoning a drive train's pose.
+
+#include "CSCIDriveTrain.h"
+#include "CSCIOccupancyGrid.h"    // Pose2D
+
+namespace csci
+{
+
+/********************* TETRIX MECANUM ODOMETRY *********************/
+// TMOdometry dead reckons the pose of a TMDriveTrain from its wheel
+// encoders.  Since a mecanum drive train moves in only one of a few
+// fixed directions at a time (see MoveState), the distance turned by
+// one driven wheel, together with the current movement state, is
+// enough to update the pose.
+//
+// NOTE: Call update() periodically while moving.  Each call reads one
+//       encoder (see TMDriveTrain::readWheelDegrees), so don't call
+//       it every pass through a tight control loop.
+//
+//       When the movement state changes without a stop in between,
+//       the encoders are not reset, and any travel between the last
+//       update() and the change is credited to the new state.  Calling
+//       update() just before changing movement (or stopping between
+//       movements) avoids this error.
+
+class TMOdometry
+{
+  public:
+  // Construct using a reference to an already instantiated drive train.
+  // The pose starts at the origin, heading along the x axis.
+
+  TMOdometry(TMDriveTrain& driveTrain);
+
+  // Reset the pose.  If the drive train is moving, this reads an
+  // encoder (see update()), so travel before the reset isn't counted.
+
+  void reset(const Pose2D& pose);
+
+  // Update pose from the wheel encoders.
+
+  void update();
+
+  // Returns the current pose estimate.
+
+  const Pose2D& getPose() const;
+
+  protected:
+  TMDriveTrain& m_DTrain;       // Associated drive train
+  Pose2D        m_pose;         // Current pose estimate
+  double        m_lastDegrees;  // Wheel degrees at last update
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_ODOMETRY
@@ -0,0 +1,326 @@
+// ParameterServer class implementation file.
+
+#include "CSCIParameters.h"
+#include <EEPROM.h>
+
+namespace csci
+{
+
+// EEPROM image header bytes.
+
+static const uint8_t ImageMagic1 = 'P';
+static const uint8_t ImageMagic2 = 'M';
+
+// 16 bit hash of a tunable's name (FNV-1a, folded), which identifies
+// its value in the EEPROM image.
+
+static uint16_t nameHash(const char* name)
+{
+  uint32_t hash = 2166136261UL;
+
+  for ( ; *name != '\0'; ++name )
+  {
+    hash ^= static_cast<uint8_t>(*name);
+    hash *= 16777619UL;
+  }
+
+  return static_cast<uint16_t>((hash >> 16) ^ hash);
+}
+
+/*********************** PARAMETER SERVER **************************/
+
+ParameterServer::ParameterServer(int eepromAddress)
+  : m_address(eepromAddress),
+    m_pendingCount(0),
+    m_applyRequested(false),
+    m_input()
+{
+}
+
+bool ParameterServer::command(const char* line, Print& reply)
+{
+  char text[CommandLine::MaxLength + 1];
+
+  strncpy(text, line, CommandLine::MaxLength);
+  text[CommandLine::MaxLength] = '\0';
+
+  char* rest = text;
+  const char* word = CommandLine::nextWord(rest);
+
+  if ( (word == NULL) || (strcmp(word, "pm") != 0) )
+  {
+    return false;
+  }
+
+  const char* verb = CommandLine::nextWord(rest);
+  const char* name = CommandLine::nextWord(rest);
+  const char* value = CommandLine::nextWord(rest);
+  Tunable* tunable = ( name != NULL ) ? lookup(name) : NULL;
+  bool ok = false;
+
+  if ( verb == NULL )
+  {
+    ok = false;
+  }
+  else if ( strcmp(verb, "list") == 0 )
+  {
+    for ( tunable = Tunable::first(); tunable != NULL; tunable = tunable->next() )
+    {
+      report(*tunable, reply);
+    }
+
+    ok = true;
+  }
+  else if ( (strcmp(verb, "get") == 0) && (tunable != NULL) )
+  {
+    report(*tunable, reply);
+    ok = true;
+  }
+  else if ( (strcmp(verb, "set") == 0) && (tunable != NULL) && (value != NULL) )
+  {
+    char* end;
+    double number = strtod(value, &end);
+
+    ok = ( (end != value) && (*end == '\0') && stage(*tunable, number) );
+  }
+  else if ( strcmp(verb, "apply") == 0 )
+  {
+    m_applyRequested = true;
+    ok = true;
+  }
+  else if ( strcmp(verb, "discard") == 0 )
+  {
+    discard();
+    ok = true;
+  }
+  else if ( strcmp(verb, "commit") == 0 )
+  {
+    ok = save();
+  }
+
+  reply.println(ok ? F("pm,ok") : F("pm,error"));
+  return true;
+}
+
+void ParameterServer::receive(Stream& in, Print& reply)
+{
+  const char* line;
+
+  while ( (line = m_input.read(in)) != NULL )
+  {
+    if ( !command(line, reply) )
+    {
+      reply.println(F("pm,error"));
+    }
+  }
+}
+
+bool ParameterServer::stage(Tunable& tunable, double value)
+{
+  if ( !tunable.isValid(value) )
+  {
+    return false;
+  }
+
+  // A second value for the same tunable replaces the first.
+
+  for ( uint8_t index = 0; index < m_pendingCount; ++index )
+  {
+    if ( m_pending[index].tunable == &tunable )
+    {
+      m_pending[index].value = value;
+      return true;
+    }
+  }
+
+  if ( m_pendingCount >= MaxPending )
+  {
+    return false;
+  }
+
+  m_pending[m_pendingCount].tunable = &tunable;
+  m_pending[m_pendingCount].value = value;
+  ++m_pendingCount;
+
+  return true;
+}
+
+bool ParameterServer::update()
+{
+  if ( !m_applyRequested )
+  {
+    return false;
+  }
+
+  bool changed = false;
+
+  for ( uint8_t index = 0; index < m_pendingCount; ++index )
+  {
+    Tunable& tunable = *m_pending[index].tunable;
+
+    if ( static_cast<double>(tunable) != m_pending[index].value )
+    {
+      tunable = m_pending[index].value;
+      changed = true;
+    }
+  }
+
+  discard();
+  return changed;
+}
+
+bool ParameterServer::save() const
+{
+  uint8_t count = 0;
+
+  for ( Tunable* tunable = Tunable::first(); tunable != NULL; tunable = tunable->next() )
+  {
+    ++count;
+  }
+
+  if ( m_address + getImageSize(count) > static_cast<int>(EEPROM.length()) )
+  {
+    return false;
+  }
+
+  // Header, then name hash and value (little-endian) of each, then a
+  // checksum making the bytes after the header sum to zero.
+  // (EEPROM.update() skips bytes that haven't changed.)
+
+  EEPROM.update(m_address, ImageMagic1);
+  EEPROM.update(m_address + 1, ImageMagic2);
+  EEPROM.update(m_address + 2, count);
+
+  int address = m_address + 3;
+  uint8_t sum = count;
+
+  for ( Tunable* tunable = Tunable::first(); tunable != NULL; tunable = tunable->next() )
+  {
+    uint8_t entry[6];
+    uint16_t hash = nameHash(tunable->getName());
+    float value = static_cast<float>(static_cast<double>(*tunable));
+
+    entry[0] = static_cast<uint8_t>(hash);
+    entry[1] = static_cast<uint8_t>(hash >> 8);
+    memcpy(entry + 2, &value, sizeof(value));
+
+    for ( uint8_t index = 0; index < sizeof(entry); ++index )
+    {
+      EEPROM.update(address++, entry[index]);
+      sum += entry[index];
+    }
+  }
+
+  EEPROM.update(address, static_cast<uint8_t>(-sum));
+  return true;
+}
+
+uint8_t ParameterServer::load()
+{
+  if ( (EEPROM.read(m_address) != ImageMagic1) ||
+       (EEPROM.read(m_address + 1) != ImageMagic2) )
+  {
+    return 0;
+  }
+
+  uint8_t count = EEPROM.read(m_address + 2);
+
+  if ( m_address + getImageSize(count) > static_cast<int>(EEPROM.length()) )
+  {
+    return 0;
+  }
+
+  uint8_t sum = count;
+
+  for ( int index = 0; index <= 6 * count; ++index )
+  {
+    sum += EEPROM.read(m_address + 3 + index);
+  }
+
+  if ( sum != 0 )
+  {
+    return 0;
+  }
+
+  // Apply each saved value whose tunable still exists and whose value
+  // is still within its bounds.
+
+  uint8_t applied = 0;
+
+  for ( uint8_t entry = 0; entry < count; ++entry )
+  {
+    int address = m_address + 3 + 6 * entry;
+    uint16_t hash = EEPROM.read(address) | (EEPROM.read(address + 1) << 8);
+    uint8_t bytes[4];
+    float value;
+
+    for ( uint8_t index = 0; index < sizeof(bytes); ++index )
+    {
+      bytes[index] = EEPROM.read(address + 2 + index);
+    }
+
+    memcpy(&value, bytes, sizeof(value));
+
+    for ( Tunable* tunable = Tunable::first(); tunable != NULL; tunable = tunable->next() )
+    {
+      if ( (nameHash(tunable->getName()) == hash) && tunable->isValid(value) )
+      {
+        *tunable = value;
+        ++applied;
+        break;
+      }
+    }
+  }
+
+  return applied;
+}
+
+Tunable* ParameterServer::lookup(const char* text)
+{
+  // All digits is an ID.
+
+  const char* digit = text;
+
+  while ( (*digit >= '0') && (*digit <= '9') )
+  {
+    ++digit;
+  }
+
+  if ( (*digit == '\0') && (digit != text) && (digit - text <= 3) )
+  {
+    int id = atoi(text);
+
+    return ( id <= 0xFF ) ? Tunable::findId(static_cast<uint8_t>(id)) : NULL;
+  }
+
+  return Tunable::find(text);
+}
+
+void ParameterServer::report(Tunable& tunable, Print& reply)
+{
+  reply.print(F("pm_param,"));
+  reply.print(tunable.getId());
+  reply.print(',');
+  reply.print(tunable.getName());
+  reply.print(',');
+  reply.print(static_cast<double>(tunable), 6);
+  reply.print(',');
+
+  // (Print shows both infinities as "inf", so unbounded is empty.)
+
+  if ( !isinf(tunable.getMinimum()) )
+  {
+    reply.print(tunable.getMinimum(), 6);
+  }
+
+  reply.print(',');
+
+  if ( !isinf(tunable.getMaximum()) )
+  {
+    reply.print(tunable.getMaximum(), 6);
+  }
+
+  reply.println();
+}
+
+}   // End namespace
@@ -0,0 +1,114 @@
+#ifndef INCLUDE_CSCI_PARAMETERS
+#define INCLUDE_CSCI_PARAMETERS
+
+// ParameterServer class header file for tuning a sketch's tunables
+// over a serial link.
+
+#include "CSCITunable.h"
+#include "CSCICommandLine.h"
+
+namespace csci
+{
+
+/*********************** PARAMETER SERVER **************************/
+// A ParameterServer lets a host read and change a sketch's tunables
+// (see CSCITunable.h) while it runs, and keep the changes in EEPROM,
+// so tuning doesn't mean editing and reflashing the sketch.
+//
+// Requests are text lines (see CommandLine); each gets its reply
+// lines, then "pm,ok" or "pm,error":
+//
+//   pm list                 All tunables: pm_param,ID,NAME,VALUE,MIN,MAX
+//                           (MIN and MAX are empty if unbounded)
+//   pm get ID|NAME          One tunable's pm_param line
+//   pm set ID|NAME VALUE    Stage a new value (checked against bounds)
+//   pm apply                Apply the staged values (at update())
+//   pm discard              Drop the staged values
+//   pm commit               Save the current values to EEPROM
+//
+// New values are staged, then applied together by update(), which the
+// sketch calls at a loop boundary, so a loop never sees half a set of
+// changes.  update() returns "true" when values changed, so the sketch
+// can recompute anything derived from them.
+//
+// The EEPROM image holds each tunable's name hash and value (as a
+// float, the robot's double), so it survives tunables being added or
+// reordered.  load() (in setup()) applies any saved values.
+// csci_param (CSCIHost/ParamMain.cpp) is the host side.
+
+class ParameterServer
+{
+  public:
+  // Most values staged at once.
+
+  static const uint8_t MaxPending = 8;
+
+  // Returns the EEPROM bytes needed for "count" tunables.
+
+  static int getImageSize(uint8_t count) { return 4 + 6 * count; }
+
+  // Keep the EEPROM image at "eepromAddress".
+
+  ParameterServer(int eepromAddress);
+
+  // Run a request line.  Replies go to "reply".  Returns "false" if
+  // it isn't a "pm" request.
+
+  bool command(const char* line, Print& reply);
+
+  // Read request characters from "in", running each complete line.
+  // (When other commands share the link, read lines with a
+  // CommandLine and pass them to command() instead.)
+
+  void receive(Stream& in, Print& reply);
+
+  // Stage a new value.  Returns "false" if it's out of bounds or too
+  // many values are staged.
+
+  bool stage(Tunable& tunable, double value);
+
+  // Drop the staged values.
+
+  void discard() { m_pendingCount = 0; m_applyRequested = false; }
+
+  // Apply the staged values if a "pm apply" was received.  Returns
+  // "true" if any tunable changed.
+
+  bool update();
+
+  // Save the current values to EEPROM.  Returns "false" if the image
+  // won't fit.
+
+  bool save() const;
+
+  // Apply the values saved in EEPROM.  Returns the number applied (0
+  // if there's no valid image).
+
+  uint8_t load();
+
+  protected:
+  struct Pending
+  {
+    Tunable*  tunable;
+    double    value;
+  };
+
+  // Returns the tunable named or numbered by "text" (NULL if none).
+
+  static Tunable* lookup(const char* text);
+
+  // Send a tunable's pm_param line.
+
+  static void report(Tunable& tunable, Print& reply);
+
+  protected:
+  int           m_address;
+  Pending       m_pending[MaxPending];
+  uint8_t       m_pendingCount;
+  bool          m_applyRequested;
+  CommandLine   m_input;
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_PARAMETERS
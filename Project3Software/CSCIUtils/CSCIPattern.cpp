@@ -0,0 +1,81 @@
+// Pattern player classes implementation file.
+
+#include "CSCIPattern.h"
+
+namespace csci
+{
+
+/************************** PATTERNS *******************************/
+
+const uint8_t HeartbeatPattern[] PROGMEM = { 5, 95, 0 };
+const uint8_t AlertPattern[] PROGMEM = { 20, 20, 0 };
+const uint8_t FastBlinkPattern[] PROGMEM = { 10, 10, 0 };
+
+/********************** PATTERN SEQUENCER **************************/
+
+PatternSequencer::PatternSequencer()
+  : m_pattern(NULL),
+    m_index(0),
+    m_repeat(false),
+    m_on(false),
+    m_stepMillis(0)
+{
+}
+
+bool PatternSequencer::begin(const uint8_t* pattern, bool repeat)
+{
+  if ( (pattern == NULL) || (pgm_read_byte(pattern) == 0) )
+  {
+    end();
+    return false;
+  }
+
+  m_pattern = pattern;
+  m_index = 0;
+  m_repeat = repeat;
+  m_on = true;
+  m_stepMillis = millis();
+
+  return true;
+}
+
+bool PatternSequencer::advance()
+{
+  uint32_t now = millis();
+  bool wasOn = m_on;
+
+  // (Catches up on any times a late update() missed.)
+
+  while ( m_pattern != NULL )
+  {
+    uint32_t time = static_cast<uint32_t>(pgm_read_byte(m_pattern + m_index)) * PatternTick;
+
+    if ( now - m_stepMillis < time )
+    {
+      break;
+    }
+
+    // Times are kept from when each should have started, so a late
+    // update() doesn't stretch the pattern.
+
+    m_stepMillis += time;
+    ++m_index;
+
+    if ( pgm_read_byte(m_pattern + m_index) == 0 )
+    {
+      if ( !m_repeat )
+      {
+        end();
+        break;
+      }
+
+      m_index = 0;
+    }
+
+    m_on = ( (m_index & 1) == 0 );
+  }
+
+  return ( m_on != wasOn );
+}
+
+}   // End namespace
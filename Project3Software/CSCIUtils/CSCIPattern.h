@@ -0,0 +1,133 @@
+#ifndef INCLUDE_CSCI_PATTERN
+#define INCLUDE_CSCI_PATTERN
+
+// Pattern player classes header file for non-blocking LED and buzzer
+// sequences.
+
+#include "CSCICore.h"
+
+namespace csci
+{
+
+/************************** PATTERNS *******************************/
+// A pattern is a PROGMEM table of on and off times, alternating and
+// starting with on, in PatternTick units (10 milliseconds), ending
+// with 0.  Times run up to 255 (2.55 seconds).  A repeated pattern
+// needs an even number of times, to end with off.
+//
+//   const uint8_t TwoBlinks[] PROGMEM = { 15, 15, 15, 100, 0 };
+
+static const uint16_t PatternTick = 10;     // Milliseconds
+
+extern const uint8_t HeartbeatPattern[] PROGMEM;    // Short blink each second
+extern const uint8_t AlertPattern[] PROGMEM;        // As ActiveBuzzer::alert()
+extern const uint8_t FastBlinkPattern[] PROGMEM;    // 5 blinks a second
+
+/********************** PATTERN SEQUENCER **************************/
+// A PatternSequencer steps through a pattern as time passes; it's the
+// timing part of a PatternPlayer.
+
+class PatternSequencer
+{
+  public:
+  // Returns "true" while a pattern is playing.
+
+  bool isPlaying() const { return ( m_pattern != NULL ); }
+
+  // Returns "true" if the pattern's current state is on.
+
+  bool isOn() const { return m_on; }
+
+  protected:
+  PatternSequencer();
+
+  // Start "pattern" (in PROGMEM), once or over and over.  Returns
+  // "false" if it's empty.
+
+  bool begin(const uint8_t* pattern, bool repeat);
+
+  // Stop playing.
+
+  void end() { m_pattern = NULL; m_on = false; }
+
+  // Move on to the state for the current time.  Returns "true" if
+  // it changed.
+
+  bool advance();
+
+  protected:
+  const uint8_t*  m_pattern;      // NULL when not playing
+  uint8_t         m_index;        // Current time in the pattern
+  bool            m_repeat;
+  bool            m_on;
+  uint32_t        m_stepMillis;   // Time the current state started
+};
+
+/*********************** PATTERN PLAYER ****************************/
+// A PatternPlayer plays patterns on a "Device" with on() and off()
+// (DigitalLed, AnalogLed, ActiveBuzzer, their Fast versions...)
+// without waiting: update(), called from loop(), turns the device on
+// and off as the pattern's times pass, and does almost nothing in
+// between.
+//
+//   csci::DigitalLed StatusLed(7);
+//   csci::PatternPlayer<csci::DigitalLed> Status(StatusLed);
+//   ...
+//   Status.play(csci::HeartbeatPattern, true);
+//   ...
+//   Status.update();    // In loop()
+//
+// The device must not be used directly while a pattern plays.
+
+template <class Device>
+class PatternPlayer : public PatternSequencer
+{
+  public:
+  explicit PatternPlayer(Device& device)
+  : m_device(device) { }
+
+  // Play "pattern" (in PROGMEM) from its start, once or over and over
+  // (until stop() or another play()).
+
+  void play(const uint8_t* pattern, bool repeat = false)
+  {
+    begin(pattern, repeat);
+    output();
+  }
+
+  // Stop playing (the device is turned off).
+
+  void stop()
+  {
+    end();
+    m_device.off();
+  }
+
+  void update()
+  {
+    if ( isPlaying() && advance() )
+    {
+      output();
+    }
+  }
+
+  protected:
+  void output()
+  {
+    if ( m_on )
+    {
+      m_device.on();
+    }
+    else
+    {
+      m_device.off();
+    }
+  }
+
+  protected:
+  Device& m_device;
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_PATTERN
@@ -0,0 +1,329 @@
+// Scanner class implementation file.
+
+#include "CSCIScanner.h"
+
+namespace csci
+{
+
+/************************** SCANNER ********************************/
+
+Scanner::Scanner(PRIZM& prizm, TMSmartCar& car, int servoChannel)
+  : m_Prizm(prizm),
+    m_Car(car),
+    m_servoChannel(servoChannel),
+    m_numAngles(1),
+    m_slot(0),
+    m_direction(1),
+    m_latestSlot(0),
+    m_servoAngle(90),   // PRIZM assumes servos start centered
+    m_msPerDegree(10),
+    m_minDwellMillis(30),
+    m_sweepCount(0),
+    m_running(false),
+    m_settleTimer()
+{
+  // Default schedule is a single angle, straight ahead.
+
+  m_angles[0] = 90;
+
+  for ( uint8_t slot = 0; slot < MaxAngles; ++slot )
+  {
+    m_readings[slot].angle = 0;
+    m_readings[slot].rangeCM = 0;
+    m_readings[slot].timeMillis = 0;
+  }
+}
+
+bool Scanner::setSchedule(const uint8_t* angles, uint8_t numAngles)
+{
+  if ( (numAngles == 0) || (numAngles > MaxAngles) )
+  {
+    return false;
+  }
+
+  for ( uint8_t slot = 0; slot < numAngles; ++slot )
+  {
+    m_angles[slot] = angles[slot];
+  }
+
+  m_numAngles = numAngles;
+
+  // A new schedule invalidates the map, so restart if running.
+
+  if ( m_running )
+  {
+    start();
+  }
+
+  return true;
+}
+
+bool Scanner::setSweep(uint8_t firstAngle, uint8_t lastAngle, uint8_t stepAngle)
+{
+  if ( stepAngle == 0 )
+  {
+    return false;
+  }
+
+  uint8_t angles[MaxAngles];
+  uint8_t numAngles = 0;
+
+  int angle = firstAngle;
+  int step = ( lastAngle >= firstAngle ) ? stepAngle : -stepAngle;
+
+  while ( true )
+  {
+    if ( numAngles >= MaxAngles )
+    {
+      return false;
+    }
+
+    angles[numAngles++] = static_cast<uint8_t>(angle);
+
+    // Stop once the last angle has been reached (or passed).
+
+    if ( ( step > 0 ) ? ( angle >= lastAngle ) : ( angle <= lastAngle ) )
+    {
+      break;
+    }
+
+    angle += step;
+
+    if ( ( step > 0 ) ? ( angle > lastAngle ) : ( angle < lastAngle ) )
+    {
+      angle = lastAngle;
+    }
+  }
+
+  return setSchedule(angles, numAngles);
+}
+
+void Scanner::setServoSpeed(int servoSpeed)
+{
+  m_Prizm.setServoSpeed(m_servoChannel, servoSpeed);
+}
+
+void Scanner::setSettleTime(uint16_t msPerDegree, uint16_t minDwellMillis)
+{
+  m_msPerDegree = msPerDegree;
+  m_minDwellMillis = minDwellMillis;
+}
+
+void Scanner::start()
+{
+  for ( uint8_t slot = 0; slot < MaxAngles; ++slot )
+  {
+    m_readings[slot].angle = m_angles[slot < m_numAngles ? slot : 0];
+    m_readings[slot].rangeCM = 0;
+    m_readings[slot].timeMillis = 0;
+  }
+
+  m_slot = 0;
+  m_direction = 1;
+  m_latestSlot = 0;
+  m_sweepCount = 0;
+  m_running = true;
+
+  commandServo();
+}
+
+void Scanner::stop()
+{
+  m_running = false;
+  m_settleTimer.stop();
+}
+
+bool Scanner::isRunning() const
+{
+  return m_running;
+}
+
+bool Scanner::update()
+{
+  // Nothing to do until the servo has settled at the current angle.
+
+  if ( !m_running || !m_settleTimer.done() )
+  {
+    return false;
+  }
+
+  // Sample the range at the current angle.
+
+  ScanReading& reading = m_readings[m_slot];
+
+  double rangeCM = m_Car.getRangeSensorDistanceCM();
+
+  reading.angle = m_angles[m_slot];
+  reading.rangeCM = ( rangeCM > 0.0 ) ? static_cast<uint16_t>(rangeCM) : 0;
+  reading.timeMillis = millis();
+
+  m_latestSlot = m_slot;
+
+  // Move on to the next angle.
+
+  advanceSlot();
+  commandServo();
+
+  return true;
+}
+
+const ScanReading& Scanner::getLatestReading() const
+{
+  return m_readings[m_latestSlot];
+}
+
+uint8_t Scanner::getNumAngles() const
+{
+  return m_numAngles;
+}
+
+const ScanReading& Scanner::getReading(uint8_t slot) const
+{
+  if ( slot >= m_numAngles )
+  {
+    slot = m_numAngles - 1;
+  }
+
+  return m_readings[slot];
+}
+
+uint32_t Scanner::getSweepCount() const
+{
+  return m_sweepCount;
+}
+
+uint16_t Scanner::getMinRange(uint8_t& angle) const
+{
+  uint16_t minRange = 0;
+
+  for ( uint8_t slot = 0; slot < m_numAngles; ++slot )
+  {
+    const ScanReading& reading = m_readings[slot];
+
+    // Skip slots never sampled or without an echo.
+
+    if ( (reading.timeMillis == 0) || (reading.rangeCM == 0) )
+    {
+      continue;
+    }
+
+    if ( (minRange == 0) || (reading.rangeCM < minRange) )
+    {
+      minRange = reading.rangeCM;
+      angle = reading.angle;
+    }
+  }
+
+  return minRange;
+}
+
+bool Scanner::getObstacleExtent(uint16_t thresholdCM,
+                                uint8_t& minAngle, uint8_t& maxAngle) const
+{
+  // Locate the closest reading under the threshold.
+
+  uint8_t closest = MaxAngles;
+
+  for ( uint8_t slot = 0; slot < m_numAngles; ++slot )
+  {
+    if ( slotIsClose(slot, thresholdCM) &&
+         ( (closest == MaxAngles) ||
+           (m_readings[slot].rangeCM < m_readings[closest].rangeCM) ) )
+    {
+      closest = slot;
+    }
+  }
+
+  if ( closest == MaxAngles )
+  {
+    return false;
+  }
+
+  // Grow the obstacle over adjacent close slots.
+
+  uint8_t first = closest;
+  uint8_t last = closest;
+
+  while ( (first > 0) && slotIsClose(first - 1, thresholdCM) )
+  {
+    --first;
+  }
+
+  while ( (last + 1 < m_numAngles) && slotIsClose(last + 1, thresholdCM) )
+  {
+    ++last;
+  }
+
+  // Schedule may run in either angular direction.
+
+  minAngle = m_angles[first];
+  maxAngle = m_angles[last];
+
+  if ( minAngle > maxAngle )
+  {
+    uint8_t angle = minAngle;
+    minAngle = maxAngle;
+    maxAngle = angle;
+  }
+
+  return true;
+}
+
+void Scanner::commandServo()
+{
+  uint8_t angle = m_angles[m_slot];
+
+  // Estimate how long the servo needs to get there.
+
+  uint8_t moved = ( angle > m_servoAngle ) ? ( angle - m_servoAngle )
+                                           : ( m_servoAngle - angle );
+
+  uint32_t settleMillis = static_cast<uint32_t>(moved) * m_msPerDegree;
+
+  if ( settleMillis < m_minDwellMillis )
+  {
+    settleMillis = m_minDwellMillis;
+  }
+
+  // PRIZM only transmits if the position changed.
+
+  m_Prizm.setServoPosition(m_servoChannel, angle);
+  m_servoAngle = angle;
+
+  m_settleTimer.start(settleMillis);
+}
+
+void Scanner::advanceSlot()
+{
+  if ( m_numAngles == 1 )
+  {
+    ++m_sweepCount;
+    return;
+  }
+
+  // Reverse direction at either end of the schedule.
+
+  if ( (m_direction > 0) && (m_slot + 1 >= m_numAngles) )
+  {
+    m_direction = -1;
+    ++m_sweepCount;
+  }
+  else if ( (m_direction < 0) && (m_slot == 0) )
+  {
+    m_direction = 1;
+    ++m_sweepCount;
+  }
+
+  m_slot += m_direction;
+}
+
+bool Scanner::slotIsClose(uint8_t slot, uint16_t thresholdCM) const
+{
+  const ScanReading& reading = m_readings[slot];
+
+  return ( (reading.timeMillis != 0) &&
+           (reading.rangeCM > 0) &&
+           (reading.rangeCM < thresholdCM) );
+}
+
+}   // End namespace
@@ -0,0 +1,166 @@
+#ifndef INCLUDE_CSCI_SCANNER
+#define INCLUDE_CSCI_SCANNER
+
+// Scanner class header file for a servo swept ultrasonic range finder.
+
+#include "CSCICore.h"
+#include "CSCITimer.h"
+#include "CSCISmartCar.h"
+#include <PRIZM.h>            // Tetrix PRIZM controller library
+
+namespace csci
+{
+
+/************************ SCAN READING *****************************/
+// A ScanReading is a single range finder sample, tagged with the
+// servo angle that was commanded when it was taken and the time
+// (uptime in milliseconds) it was taken.
+
+struct ScanReading
+{
+  uint8_t   angle;        // Commanded servo angle (in degrees)
+  uint16_t  rangeCM;      // Measured range (in cm), 0 = no echo
+  uint32_t  timeMillis;   // Uptime (in milliseconds) of the sample
+};
+
+/************************** SCANNER ********************************/
+// A Scanner sweeps the range finder servo through a schedule of
+// angles and keeps the most recent reading taken at each angle
+// (a rolling polar range map).
+//
+// The servo is commanded once per schedule step (one I2C write) and
+// the range is sampled only after the servo has had time to settle,
+// so nothing blocks waiting on the servo.  The schedule is swept
+// back and forth (first -> last -> first ...).
+//
+// Usage: Configure the schedule, call start(), then call update()
+//        every pass through the control loop.  update() returns
+//        "true" whenever a new reading was taken.
+//
+// NOTE: The settle time is only an estimate, since the PRIZM cannot
+//       report the actual servo position.  It's computed from the
+//       angle moved (msPerDegree) plus a minimum dwell time, both of
+//       which should be tuned for the servo speed in use.
+
+class Scanner
+{
+  public:
+  // Maximum number of angles in a schedule.
+
+  static const uint8_t MaxAngles = 19;
+
+  // Construct using references to an already instantiated PRIZM
+  // and smart car (whose range finder is swept), and the PRIZM
+  // servo channel (1-6) the range finder is mounted on.
+
+  Scanner(PRIZM& prizm, TMSmartCar& car, int servoChannel = 1);
+
+  // Set the angle schedule (in degrees).  Angles are copied.
+  // Returns "false" (and leaves the schedule unchanged) if there
+  // are no angles or more than MaxAngles angles.
+
+  bool setSchedule(const uint8_t* angles, uint8_t numAngles);
+
+  // Set an evenly spaced schedule from firstAngle to lastAngle.
+  // Returns "false" if the schedule would exceed MaxAngles angles.
+
+  bool setSweep(uint8_t firstAngle, uint8_t lastAngle, uint8_t stepAngle);
+
+  // Set the PRIZM servo speed (0 - 100 percent).
+
+  void setServoSpeed(int servoSpeed);
+
+  // Set settle time estimate parameters.
+  // msPerDegree = milliseconds for the servo to move one degree.
+  // minDwellMillis = minimum time to wait at each angle.
+
+  void setSettleTime(uint16_t msPerDegree, uint16_t minDwellMillis);
+
+  // Start sweeping at the beginning of the schedule.
+  // All previous readings are discarded.
+
+  void start();
+
+  // Stop sweeping.  The servo is left where it is.
+
+  void stop();
+
+  // Returns "true" if scanner is sweeping.
+
+  bool isRunning() const;
+
+  // Advance the sweep.  Call every pass through the control loop.
+  // Returns "true" if a new reading was taken.
+
+  bool update();
+
+  // Returns the most recent reading.  (All zero until the first
+  // reading has been taken.)
+
+  const ScanReading& getLatestReading() const;
+
+  // Returns the number of angles in the schedule.
+
+  uint8_t getNumAngles() const;
+
+  // Returns the most recent reading for a schedule slot (0 to
+  // getNumAngles() - 1).  Slots never sampled have timeMillis == 0.
+
+  const ScanReading& getReading(uint8_t slot) const;
+
+  // Returns the number of completed sweeps (one direction).
+
+  uint32_t getSweepCount() const;
+
+  // Returns the closest range (in cm) in the map, setting "angle" to
+  // the angle it was seen at.  Returns 0 if nothing echoed.
+
+  uint16_t getMinRange(uint8_t& angle) const;
+
+  // Find the obstacle closer than "thresholdCM".  Starting at the
+  // closest reading, the obstacle is grown over adjacent slots that
+  // are also closer than the threshold.  Returns "false" if nothing
+  // is closer than the threshold, otherwise returns "true" and sets
+  // "minAngle" and "maxAngle" to the obstacle's angular extent.
+  //
+  // Note: If minAngle (or maxAngle) is the first (or last) angle in
+  //       the schedule, the obstacle may extend beyond it.
+
+  bool getObstacleExtent(uint16_t thresholdCM,
+                         uint8_t& minAngle, uint8_t& maxAngle) const;
+
+  protected:
+
+  // Command servo to the current slot's angle and start settle timer.
+
+  void commandServo();
+
+  // Step to the next schedule slot (back and forth).
+
+  void advanceSlot();
+
+  // Returns "true" if a slot holds a reading closer than threshold.
+
+  bool slotIsClose(uint8_t slot, uint16_t thresholdCM) const;
+
+  protected:
+  PRIZM&        m_Prizm;                // Associated Tetrix PRIZM controller
+  TMSmartCar&   m_Car;                  // Associated smart car (range finder)
+  int           m_servoChannel;         // PRIZM servo channel (1-6)
+  uint8_t       m_angles[MaxAngles];    // Angle schedule (degrees)
+  ScanReading   m_readings[MaxAngles];  // Rolling polar range map
+  uint8_t       m_numAngles;            // Number of angles in schedule
+  uint8_t       m_slot;                 // Current schedule slot
+  int8_t        m_direction;            // Sweep direction (+1 or -1)
+  uint8_t       m_latestSlot;           // Slot of most recent reading
+  uint8_t       m_servoAngle;           // Last commanded servo angle
+  uint16_t      m_msPerDegree;          // Settle time per degree moved
+  uint16_t      m_minDwellMillis;       // Minimum settle time
+  uint32_t      m_sweepCount;           // Number of completed sweeps
+  bool          m_running;              // "true" if sweeping
+  TimerMillis   m_settleTimer;          // Servo settle timer
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_SCANNER
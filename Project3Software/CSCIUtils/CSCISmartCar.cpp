@@ -2,6 +2,8 @@
 
 #include "CSCISmartCar.h"
 #include "CSCITimer.h"
+#include "CSCIAnalogSampler.h"
+#include "CSCITelemetryRegistry.h"
 
 namespace csci
 {
@@ -52,7 +54,25 @@ TapeColor TMSmartCar::getTapeColor()
   
 double TMSmartCar::getBatteryVoltage()
 {
-  return static_cast<double>(m_Prizm.readBatteryVoltage()) / 100.0;
+  // Converted as PRIZM::readBatteryVoltage() does (in hundredths of a
+  // volt), but without fighting a running sampler for the ADC.
+
+  AnalogSampler* sampler = AnalogSampler::running();
+  int value = ( sampler != NULL ) ? sampler->read(BatteryChannel) : -1;
+
+  if ( value < 0 )
+  {
+    value = AnalogSampler::convert(BatteryChannel);
+  }
+
+  return static_cast<double>(value * 2) / 100.0;
+}
+
+uint32_t TMSmartCar::getBatteryVoltageAge() const
+{
+  AnalogSampler* sampler = AnalogSampler::running();
+
+  return ( sampler != NULL ) ? sampler->getAge(BatteryChannel) : 0;
 }
   
 bool TMSmartCar::startButtonPressed()
@@ -83,4 +103,31 @@ void TMSmartCar::setGreenLEDState(bool state)
   m_Prizm.setGreenLED(state ? 1 : 0);
 }
 
+
+// Telemetry channel samplers.
+
+static bool sampleRange(void* context, Telemetry& telemetry)
+{
+  ScanReading reading;
+
+  reading.angle = 0;
+  reading.timeMillis = millis();
+  reading.rangeCM = static_cast<uint16_t>(static_cast<TMSmartCar*>(context)->getRangeSensorDistanceCM());
+
+  return telemetry.sendRange(reading);
+}
+
+static bool sampleBattery(void* context, Telemetry& telemetry)
+{
+  return telemetry.sendBattery(static_cast<TMSmartCar*>(context)->getBatteryVoltage());
+}
+
+void TMSmartCar::addTelemetry(TelemetryRegistry& registry)
+{
+  TMDriveTrain::addTelemetry(registry);
+
+  registry.add("range", 3, sampleRange, this, 5, false);
+  registry.add("battery", 2, sampleBattery, this, 1);
+}
+
 }   // End namespace
@@ -11,6 +11,8 @@
 namespace csci
 {
 
+class TelemetryRegistry;    // (See CSCITelemetryRegistry.h)
+
 /****************** TETRIX MECANUM SMART CAR ***********************/
 // TMSmartCar is a Tetrix mechanum drive train (TMDTrain) with the
 // following attached:
@@ -60,9 +62,19 @@ class TMSmartCar : public TMDriveTrain
   
   TapeColor getTapeColor();
   
-  // Get the battery voltage
+  // Analog channel the PRIZM reads (half) the battery voltage on.
+
+  static const uint8_t BatteryChannel = 0;
+
+  // Get the battery voltage.  If a running AnalogSampler samples
+  // BatteryChannel, this is its latest value (no waiting).
   
   double getBatteryVoltage();
+
+  // Get the age (in milliseconds) of the sampled battery voltage (0
+  // if it isn't sampled).
+
+  uint32_t getBatteryVoltageAge() const;
   
   // Returns "true" if Tetrix (green) Start button is pressed.
   
@@ -79,6 +91,13 @@ class TMSmartCar : public TMDriveTrain
   void setRedLEDState(bool state);
   void setGreenLEDState(bool state);
   
+  // Register the car's telemetry channels with "registry": the drive
+  // train's (see TMDriveTrain::addTelemetry()), "range" (range finder
+  // straight ahead, 5 Hz, disabled until turned on, as each reading
+  // waits for the echo) and "battery" (1 Hz).
+  
+  void addTelemetry(TelemetryRegistry& registry);
+  
   protected:
   PRIZM&        m_Prizm;      // Associated Tetrix PRIZM controller.
   EXPANSION&    m_Exc;        // Associated Tetrix EXPANSION controller.
@@ -10,19 +10,41 @@ namespace csci
 
 /*********************** ACTIVE BUZZER *****************************/
 // An ActiveBuzzer is associated with a HIGH/LOW output port and is
-// either on (active) or off (inactive).
+// either on (active) or off (inactive).  (FastActiveBuzzer is one on
+// a pin fixed at compile time; see CSCIDigitalPin.h.)
 
-class ActiveBuzzer : public DigitalOutput
+template <class OutputPin>
+class BasicActiveBuzzer : public BasicDigitalOutput<OutputPin>
 {
   public:
-  ActiveBuzzer(int pinNumber, int onState = HIGH);
+  BasicActiveBuzzer(int pinNumber, int onState = HIGH)
+  : BasicDigitalOutput<OutputPin>(pinNumber, onState) { }
+
+  explicit BasicActiveBuzzer(const OutputPin& gpioPin)
+  : BasicDigitalOutput<OutputPin>(gpioPin) { }
   
-  void on()   { active(); }
-  void off()  { inactive(); }
+  void on()   { this->active(); }
+  void off()  { this->inactive(); }
   
-  void alert();   // Generate one special "alert" beep cycle.
+  // Generate one special "alert" beep cycle.  (These wait; a
+  // PatternPlayer plays AlertPattern without waiting.)
+
+  void alert() { this->cycleActive(200000, 200000); }
   
-  void beep(uint32_t durationMilliSeconds);
+  void beep(uint32_t durationMilliSeconds)
+  {
+    this->pulseActive(durationMilliSeconds * MICROS_PER_MILLIS);
+  }
+};
+
+typedef BasicActiveBuzzer<GPIOOutputPin> ActiveBuzzer;
+
+template <uint8_t Pin, uint8_t OnState = HIGH>
+class FastActiveBuzzer : public BasicActiveBuzzer< FastOutputPin<Pin, OnState> >
+{
+  public:
+  FastActiveBuzzer()
+  : BasicActiveBuzzer< FastOutputPin<Pin, OnState> >(FastOutputPin<Pin, OnState>()) { }
 };
 
 }   // End namespace
@@ -0,0 +1,251 @@
+// StateMachine class implementation file.
+
+#include "CSCIStateMachine.h"
+
+namespace csci
+{
+
+/*********************** STATE MACHINE *****************************/
+
+StateMachine::StateMachine(const FSMDefinition& definition, void* context,
+                           uint8_t* dispatchIndex, uint16_t dispatchSize)
+  : m_def(definition),
+    m_context(context),
+    m_dispatch(dispatchIndex),
+    m_dispatchSize(dispatchSize),
+    m_state(FSM_NONE),
+    m_enteredMillis(0),
+    m_stateTimer(),
+    m_dispatching(false),
+    m_callback(NULL),
+    m_logNext(0),
+    m_logCount(0)
+{
+}
+
+bool StateMachine::begin(uint8_t initialState)
+{
+  uint16_t indexSize = static_cast<uint16_t>(m_def.numStates) * m_def.numEvents;
+
+  if ( (indexSize > m_dispatchSize) || (initialState >= m_def.numStates) ||
+       (m_def.numTransitions >= FSM_NONE) )
+  {
+    return false;
+  }
+
+  for ( uint16_t index = 0; index < indexSize; ++index )
+  {
+    m_dispatch[index] = FSM_NONE;
+  }
+
+  // Index the first transition of each (state, event) group.
+
+  FSMTransition transition;
+  uint8_t lastState = FSM_NONE;
+  uint8_t lastEvent = FSM_NONE;
+
+  for ( uint8_t index = 0; index < m_def.numTransitions; ++index )
+  {
+    readTransition(index, transition);
+
+    if ( (transition.state >= m_def.numStates) ||
+         (transition.event >= m_def.numEvents) ||
+         ( (transition.nextState != FSM_NONE) &&
+           (transition.nextState >= m_def.numStates) ) )
+    {
+      return false;
+    }
+
+    if ( (transition.state == lastState) && (transition.event == lastEvent) )
+    {
+      continue;   // Same group as the previous transition.
+    }
+
+    uint8_t& first = m_dispatch[transition.state * m_def.numEvents + transition.event];
+
+    if ( first != FSM_NONE )
+    {
+      return false;   // Group is split up in the table.
+    }
+
+    first = index;
+    lastState = transition.state;
+    lastEvent = transition.event;
+  }
+
+  m_logNext = 0;
+  m_logCount = 0;
+
+  enterState(initialState);
+
+  return true;
+}
+
+bool StateMachine::dispatch(uint8_t event)
+{
+  if ( m_dispatching || (m_state == FSM_NONE) || (event >= m_def.numEvents) )
+  {
+    return false;
+  }
+
+  uint8_t index = m_dispatch[m_state * m_def.numEvents + event];
+
+  if ( index == FSM_NONE )
+  {
+    return false;   // Event ignored in this state.
+  }
+
+  m_dispatching = true;
+
+  // Try each alternative for (state, event) in table order.
+
+  FSMTransition transition;
+  bool taken = false;
+
+  for ( ; index < m_def.numTransitions; ++index )
+  {
+    readTransition(index, transition);
+
+    if ( (transition.state != m_state) || (transition.event != event) )
+    {
+      break;
+    }
+
+    if ( (transition.guard == FSM_NONE) || callGuard(transition.guard) )
+    {
+      taken = true;
+      break;
+    }
+  }
+
+  if ( taken )
+  {
+    uint8_t fromState = m_state;
+
+    callAction(transition.action);
+
+    if ( transition.nextState != FSM_NONE )
+    {
+      enterState(transition.nextState);
+    }
+
+    logTransition(fromState, event, m_state);
+  }
+
+  m_dispatching = false;
+
+  return taken;
+}
+
+bool StateMachine::update()
+{
+  if ( !m_stateTimer.done() )
+  {
+    return false;
+  }
+
+  return dispatch(m_def.timeoutEvent);
+}
+
+uint8_t StateMachine::getState() const
+{
+  return m_state;
+}
+
+uint32_t StateMachine::getStateMillis() const
+{
+  return millis() - m_enteredMillis;
+}
+
+void StateMachine::setTransitionCallback(TransitionCallback callback)
+{
+  m_callback = callback;
+}
+
+uint8_t StateMachine::getLogCount() const
+{
+  return m_logCount;
+}
+
+const FSMLogEntry& StateMachine::getLogEntry(uint8_t age) const
+{
+  if ( age >= m_logCount )
+  {
+    age = ( m_logCount > 0 ) ? ( m_logCount - 1 ) : 0;
+  }
+
+  return m_log[(m_logNext + LogSize - 1 - age) % LogSize];
+}
+
+void StateMachine::readTransition(uint8_t index, FSMTransition& transition) const
+{
+  memcpy_P(&transition, &m_def.transitions[index], sizeof(transition));
+}
+
+bool StateMachine::callGuard(uint8_t guard)
+{
+  FSMGuard routine;
+
+  memcpy_P(&routine, &m_def.guards[guard], sizeof(routine));
+
+  return routine(m_context);
+}
+
+void StateMachine::callAction(uint8_t action)
+{
+  if ( action == FSM_NONE )
+  {
+    return;
+  }
+
+  FSMAction routine;
+
+  memcpy_P(&routine, &m_def.actions[action], sizeof(routine));
+
+  routine(m_context);
+}
+
+void StateMachine::enterState(uint8_t state)
+{
+  FSMState info;
+
+  memcpy_P(&info, &m_def.states[state], sizeof(info));
+
+  m_state = state;
+  m_enteredMillis = millis();
+
+  if ( info.timeoutMillis > 0 )
+  {
+    m_stateTimer.start(info.timeoutMillis);
+  }
+  else
+  {
+    m_stateTimer.stop();
+  }
+
+  callAction(info.entryAction);
+}
+
+void StateMachine::logTransition(uint8_t fromState, uint8_t event, uint8_t toState)
+{
+  FSMLogEntry& entry = m_log[m_logNext];
+
+  entry.timeMillis = millis();
+  entry.fromState = fromState;
+  entry.event = event;
+  entry.toState = toState;
+
+  m_logNext = (m_logNext + 1) % LogSize;
+
+  if ( m_logCount < LogSize )
+  {
+    ++m_logCount;
+  }
+
+  if ( m_callback != NULL )
+  {
+    m_callback(entry);
+  }
+}
+
+}   // End namespace
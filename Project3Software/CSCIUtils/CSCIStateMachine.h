@@ -0,0 +1,195 @@
+#ifndef INCLUDE_CSCI_STATE_MACHINE
+#define INCLUDE_CSCI_STATE_MACHINE
+
+// StateMachine class header file for table driven robot behaviors.
+
+#include "CSCICore.h"
+#include "CSCITimer.h"
+
+namespace csci
+{
+
+// Guard and action routines.  "context" is the pointer passed to
+// the state machine's constructor.
+
+typedef bool (*FSMGuard)(void* context);
+typedef void (*FSMAction)(void* context);
+
+// Table value meaning "no guard", "no action" or "no state change".
+
+const uint8_t FSM_NONE = 0xFF;
+
+/************************ FSM TABLES *******************************/
+// One FSMState per state (indexed by state id), and any number of
+// FSMTransitions.  Both tables live in PROGMEM.
+//
+// Transitions for the same (state, event) MUST be adjacent in the
+// table.  Their guards are tried in table order and the first one
+// that passes (or has no guard) is taken, so a guard-less transition
+// at the end of a group acts as an "else".
+
+struct FSMState
+{
+  uint8_t   entryAction;      // Action run on entering the state (or FSM_NONE)
+  uint16_t  timeoutMillis;    // Time in state before the timeout event (0 = never)
+};
+
+struct FSMTransition
+{
+  uint8_t   state;            // Current state
+  uint8_t   event;            // Event received
+  uint8_t   guard;            // Guard index (or FSM_NONE)
+  uint8_t   action;           // Transition action index (or FSM_NONE)
+  uint8_t   nextState;        // Next state (FSM_NONE = stay, no re-entry)
+};
+
+// Describes a complete state machine.  The definition itself is
+// small and lives in RAM; the tables it points to are PROGMEM.
+
+struct FSMDefinition
+{
+  const FSMState*       states;           // PROGMEM state table
+  uint8_t               numStates;
+  const FSMTransition*  transitions;      // PROGMEM transition table
+  uint8_t               numTransitions;
+  uint8_t               numEvents;
+  uint8_t               timeoutEvent;     // Event sent when a state times out
+  const FSMGuard*       guards;           // PROGMEM guard routines
+  const FSMAction*      actions;          // PROGMEM action routines
+};
+
+// One logged transition.
+
+struct FSMLogEntry
+{
+  uint32_t  timeMillis;       // When the transition was taken
+  uint8_t   fromState;
+  uint8_t   event;
+  uint8_t   toState;
+};
+
+/*********************** STATE MACHINE *****************************/
+// StateMachine runs a finite state machine described by PROGMEM
+// tables.  Behavior changes are table edits; nothing in the engine
+// changes.
+//
+// Dispatch is O(1): begin() builds a (state x event) index into the
+// transition table, so dispatching an event is one table lookup plus
+// one guard call per alternative for that (state, event).  The index
+// is supplied by the derived class (see FixedStateMachine), so
+// nothing is allocated from the heap.
+//
+// The most recent transitions are kept in a small log, and an
+// optional callback is called on every transition.
+//
+// Usage: Define the tables, then each pass through the control loop
+//        call dispatch() for events that occurred and update() to
+//        generate state timeout events.
+//
+// NOTE: Actions may NOT call dispatch() (it returns "false").
+
+class StateMachine
+{
+  public:
+  // Number of transitions kept in the log.
+
+  static const uint8_t LogSize = 8;
+
+  // Transition callback type.
+
+  typedef void (*TransitionCallback)(const FSMLogEntry& entry);
+
+  // Validate the tables, build the dispatch index and enter the
+  // initial state.  Returns "false" if the tables are invalid (ids
+  // out of range, too big for the index, or (state, event) groups
+  // that are not adjacent).
+
+  bool begin(uint8_t initialState);
+
+  // Dispatch an event.  Returns "true" if a transition was taken.
+
+  bool dispatch(uint8_t event);
+
+  // Dispatch the timeout event if the current state has timed out.
+  // Returns "true" if a transition was taken.
+
+  bool update();
+
+  // Returns the current state.
+
+  uint8_t getState() const;
+
+  // Returns time (in milliseconds) spent in the current state.
+
+  uint32_t getStateMillis() const;
+
+  // Set routine called on every transition (NULL for none).
+
+  void setTransitionCallback(TransitionCallback callback);
+
+  // Returns the number of entries in the log (up to LogSize).
+
+  uint8_t getLogCount() const;
+
+  // Returns a log entry.  Entry 0 is the most recent.
+
+  const FSMLogEntry& getLogEntry(uint8_t age) const;
+
+  protected:
+  // Construct using the definition, the context passed to guards and
+  // actions, and storage for the (numStates x numEvents) index.
+
+  StateMachine(const FSMDefinition& definition, void* context,
+               uint8_t* dispatchIndex, uint16_t dispatchSize);
+
+  // Copy a transition out of PROGMEM.
+
+  void readTransition(uint8_t index, FSMTransition& transition) const;
+
+  // Call a guard or action routine by index.
+
+  bool callGuard(uint8_t guard);
+  void callAction(uint8_t action);
+
+  // Enter a state (restart state timer, run entry action).
+
+  void enterState(uint8_t state);
+
+  // Add a transition to the log.
+
+  void logTransition(uint8_t fromState, uint8_t event, uint8_t toState);
+
+  protected:
+  const FSMDefinition&  m_def;            // Table definition
+  void*                 m_context;        // Guard/action context
+  uint8_t*              m_dispatch;       // Index of first transition per (state, event)
+  uint16_t              m_dispatchSize;   // Size of index storage
+  uint8_t               m_state;          // Current state
+  uint32_t              m_enteredMillis;  // Time current state was entered
+  TimerMillis           m_stateTimer;     // Current state timeout
+  bool                  m_dispatching;    // "true" while running a transition
+  TransitionCallback    m_callback;       // Transition callback
+  FSMLogEntry           m_log[LogSize];   // Transition log (ring buffer)
+  uint8_t               m_logNext;        // Next log slot to write
+  uint8_t               m_logCount;       // Number of log entries
+};
+
+/******************** FIXED STATE MACHINE **************************/
+// FixedStateMachine is a StateMachine that owns index storage for
+// up to NumStates x NumEvents.
+
+template <uint8_t NumStates, uint8_t NumEvents>
+class FixedStateMachine : public StateMachine
+{
+  public:
+  FixedStateMachine(const FSMDefinition& definition, void* context = NULL)
+    : StateMachine(definition, context, m_dispatchStorage,
+                   sizeof(m_dispatchStorage)) { }
+
+  protected:
+  uint8_t m_dispatchStorage[NumStates * NumEvents];
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_STATE_MACHINE
@@ -26,55 +26,6 @@ const PushButton& WaitForEitherButtonClick
   }    
 }
 
-// ---------------------------------------------------------
-void PushButton::waitForClick() const
-{
-  waitUntilClosed();
-  waitUntilOpen();
-}
-
-// ---------------------------------------------------------
-void PushButton::waitUntilClosed() const
-{
-  // Wait until button stays closed for a minimum amount of time.
-
-  const int minPressTime = 50;    // Min press time (in milliseconds)
-  
-  do
-  {
-    // Wait for initial button contact.
-  
-    while ( open() )
-      { }
-  
-    // Now wait a small time for button debounce.
-  
-    WaitMillis(minPressTime);
-    
-  } while ( open() );
-}
-
-// ---------------------------------------------------------
-void PushButton::waitUntilOpen() const
-{
-  // Wait until button stays open for a minimum amount of time.
-
-  const int minPressTime = 50;    // Min press time (in milliseconds)
-  
-  do
-  {
-    // Wait for initial button release.
-  
-    while ( closed() )
-      { }
-  
-    // Now wait a small time for button debounce.
-  
-    WaitMillis(minPressTime);
-    
-  } while ( closed() );
-}
-
 // ---------------------------------------------------------
 PrizmStartButton::PrizmStartButton(PRIZM& prizm)
   : m_Prizm(prizm)
@@ -13,30 +13,107 @@ namespace csci
 // A DigitalSwitch is associated with a digital input port and can be
 // either open (inactive) or closed (active).
 
-class DigitalSwitch : public DigitalInput
+template <class InputPin>
+class BasicDigitalSwitch : public BasicDigitalInput<InputPin>
 {
   public:  
-  DigitalSwitch(int pinNumber, int closedState = LOW, bool activateInternalPullUp = NoInternalPullUp)
-  : DigitalInput(pinNumber, closedState, activateInternalPullUp) { }
+  BasicDigitalSwitch(int pinNumber, int closedState = LOW, bool activateInternalPullUp = NoInternalPullUp)
+  : BasicDigitalInput<InputPin>(pinNumber, closedState, activateInternalPullUp) { }
+
+  explicit BasicDigitalSwitch(const InputPin& gpioPin)
+  : BasicDigitalInput<InputPin>(gpioPin) { }
   
-  bool  open() const    { return inactive(); }
-  bool  closed() const  { return active(); }
+  bool  open() const    { return this->inactive(); }
+  bool  closed() const  { return this->active(); }
+};
+
+typedef BasicDigitalSwitch<GPIOInputPin> DigitalSwitch;
+
+template <uint8_t Pin, uint8_t ClosedState = LOW>
+class FastDigitalSwitch : public BasicDigitalSwitch< FastInputPin<Pin, ClosedState> >
+{
+  public:
+  FastDigitalSwitch(bool activateInternalPullUp = NoInternalPullUp)
+  : BasicDigitalSwitch< FastInputPin<Pin, ClosedState> >
+      (FastInputPin<Pin, ClosedState>(activateInternalPullUp)) { }
 };
 
 /************************ PUSH BUTTON *******************************/
 // A PushButton is a DigitalSwitch which is momentarily closed when pushed.
 // It's either open (inactive) or closed (active).
 
-class PushButton : public DigitalSwitch
+template <class InputPin>
+class BasicPushButton : public BasicDigitalSwitch<InputPin>
 {
   public:  
-  PushButton(int pinNumber, int closedState = LOW, bool activateInternalPullUp = NoInternalPullUp)
-  : DigitalSwitch(pinNumber, closedState, activateInternalPullUp) { }
+  BasicPushButton(int pinNumber, int closedState = LOW, bool activateInternalPullUp = NoInternalPullUp)
+  : BasicDigitalSwitch<InputPin>(pinNumber, closedState, activateInternalPullUp) { }
+
+  explicit BasicPushButton(const InputPin& gpioPin)
+  : BasicDigitalSwitch<InputPin>(gpioPin) { }
+  
+  public:
+  // Wait until button is closed, then opened again.
+
+  void waitForClick() const
+  {
+    waitUntilClosed();
+    waitUntilOpen();
+  }
+
+  // Wait until button is closed.
+
+  void waitUntilClosed() const
+  {
+    // Wait until button stays closed for a minimum amount of time.
+
+    do
+    {
+      // Wait for initial button contact.
   
+      while ( this->open() )
+        { }
+  
+      // Now wait a small time for button debounce.
+  
+      WaitMillis(MinPressTime);
+    
+    } while ( this->open() );
+  }
+
+  // Wait until button is open. 
+
+  void waitUntilOpen() const
+  {
+    // Wait until button stays open for a minimum amount of time.
+
+    do
+    {
+      // Wait for initial button release.
+  
+      while ( this->closed() )
+        { }
+  
+      // Now wait a small time for button debounce.
+  
+      WaitMillis(MinPressTime);
+    
+    } while ( this->closed() );
+  }
+
+  protected:
+  static const int MinPressTime = 50;    // Min press time (in milliseconds)
+};
+
+typedef BasicPushButton<GPIOInputPin> PushButton;
+
+template <uint8_t Pin, uint8_t ClosedState = LOW>
+class FastPushButton : public BasicPushButton< FastInputPin<Pin, ClosedState> >
+{
   public:
-  void waitForClick() const;    // Wait until button is closed, then opened again.
-  void waitUntilClosed() const; // Wait until button is closed.
-  void waitUntilOpen() const;   // Wait until button is open. 
+  FastPushButton(bool activateInternalPullUp = NoInternalPullUp)
+  : BasicPushButton< FastInputPin<Pin, ClosedState> >
+      (FastInputPin<Pin, ClosedState>(activateInternalPullUp)) { }
 };
 
 // Routine to wait for either button to be clicked.
@@ -0,0 +1,276 @@
+// Telemetry class implementation file.
+
+#include "CSCITelemetry.h"
+
+namespace csci
+{
+
+// Store little-endian values.
+
+static uint8_t* putUInt16(uint8_t* data, uint16_t value)
+{
+  data[0] = static_cast<uint8_t>(value);
+  data[1] = static_cast<uint8_t>(value >> 8);
+  return data + 2;
+}
+
+static uint8_t* putUInt32(uint8_t* data, uint32_t value)
+{
+  data = putUInt16(data, static_cast<uint16_t>(value));
+  return putUInt16(data, static_cast<uint16_t>(value >> 16));
+}
+
+// Color ratio as uint16 (x 10000).
+
+static uint16_t ratioValue(double ratio)
+{
+  if ( ratio <= 0.0 )
+  {
+    return 0;
+  }
+
+  return ( ratio >= 6.5535 ) ? 0xFFFF : static_cast<uint16_t>(ratio * 10000.0 + 0.5);
+}
+
+// Millimeters as int16 (clamped).
+
+static uint16_t millimeterValue(float mm)
+{
+  if ( mm >= 32767.0 )
+  {
+    return 32767;
+  }
+
+  if ( mm <= -32767.0 )
+  {
+    return static_cast<uint16_t>(-32767);
+  }
+
+  return static_cast<uint16_t>(static_cast<int16_t>( mm < 0.0 ? mm - 0.5 : mm + 0.5 ));
+}
+
+/************************** TELEMETRY ******************************/
+
+Telemetry::Telemetry(Print& out)
+  : m_out(out),
+    m_enabled(true),
+    m_sent(0),
+    m_dropped(0)
+{
+}
+
+bool Telemetry::send(uint8_t type, const uint8_t* payload, uint8_t length)
+{
+  if ( !m_enabled )
+  {
+    return false;
+  }
+
+  if ( length > MaxPayload )
+  {
+    ++m_dropped;
+    return false;
+  }
+
+  uint8_t record[MaxRecord];
+  uint8_t* next = record;
+
+  *next++ = type;
+  next = putUInt32(next, micros());
+
+  for ( uint8_t index = 0; index < length; ++index )
+  {
+    *next++ = payload[index];
+  }
+
+  uint16_t crc = crc16(record, next - record);
+
+  *next++ = static_cast<uint8_t>(crc >> 8);
+  *next++ = static_cast<uint8_t>(crc);
+
+  // Delimiter, encoded record, delimiter.
+
+  uint8_t frame[MaxFrame];
+  uint8_t frameLength = cobsEncode(record, next - record, frame + 1) + 2;
+
+  frame[0] = 0;
+  frame[frameLength - 1] = 0;
+
+  if ( m_out.availableForWrite() < frameLength )
+  {
+    ++m_dropped;
+    return false;
+  }
+
+  m_out.write(frame, frameLength);
+  ++m_sent;
+
+  return true;
+}
+
+bool Telemetry::sendColor(ColorRatios& ratios, TapeColor tapeColor)
+{
+  uint8_t payload[9];
+  uint8_t* next = payload;
+
+  next = putUInt16(next, ratioValue(ratios.getCRatio()));
+  next = putUInt16(next, ratioValue(ratios.getRRatio()));
+  next = putUInt16(next, ratioValue(ratios.getGRatio()));
+  next = putUInt16(next, ratioValue(ratios.getBRatio()));
+  *next = static_cast<uint8_t>(tapeColor);
+
+  return send(tlColor, payload, sizeof(payload));
+}
+
+bool Telemetry::sendRange(const ScanReading& reading)
+{
+  uint8_t payload[3];
+
+  payload[0] = reading.angle;
+  putUInt16(payload + 1, reading.rangeCM);
+
+  return send(tlRange, payload, sizeof(payload));
+}
+
+bool Telemetry::sendEncoders(long count1, long count2, long count3, long count4)
+{
+  uint8_t payload[16];
+  uint8_t* next = payload;
+
+  next = putUInt32(next, static_cast<uint32_t>(count1));
+  next = putUInt32(next, static_cast<uint32_t>(count2));
+  next = putUInt32(next, static_cast<uint32_t>(count3));
+  putUInt32(next, static_cast<uint32_t>(count4));
+
+  return send(tlEncoders, payload, sizeof(payload));
+}
+
+bool Telemetry::sendState(uint8_t state, uint8_t moveState, uint8_t lineColor, uint8_t value)
+{
+  uint8_t payload[4] = { state, moveState, lineColor, value };
+
+  return send(tlState, payload, sizeof(payload));
+}
+
+bool Telemetry::sendDrive(uint8_t moveState, double speedFraction)
+{
+  uint8_t payload[3];
+
+  payload[0] = moveState;
+  putUInt16(payload + 1, ratioValue(speedFraction));
+
+  return send(tlDrive, payload, sizeof(payload));
+}
+
+bool Telemetry::sendBattery(double volts)
+{
+  uint8_t payload[2];
+
+  putUInt16(payload, ( volts > 0.0 ) ? static_cast<uint16_t>(volts * 100.0 + 0.5) : 0);
+
+  return send(tlBattery, payload, sizeof(payload));
+}
+
+bool Telemetry::sendPose(const Pose2D& pose)
+{
+  // Heading in (-PI, PI].
+
+  float heading = fmod(pose.headingRad, 2.0 * PI);
+
+  if ( heading > PI )
+  {
+    heading -= 2.0 * PI;
+  }
+  else if ( heading <= -PI )
+  {
+    heading += 2.0 * PI;
+  }
+
+  uint8_t payload[6];
+  uint8_t* next = payload;
+
+  next = putUInt16(next, millimeterValue(pose.xMM));
+  next = putUInt16(next, millimeterValue(pose.yMM));
+  putUInt16(next, millimeterValue(heading * 1000.0));
+
+  return send(tlPose, payload, sizeof(payload));
+}
+
+uint16_t Telemetry::crc16(const uint8_t* data, uint8_t length, uint16_t crc)
+{
+  for ( uint8_t index = 0; index < length; ++index )
+  {
+    crc ^= static_cast<uint16_t>(data[index]) << 8;
+
+    for ( uint8_t bit = 0; bit < 8; ++bit )
+    {
+      crc = ( crc & 0x8000 ) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) :
+                               static_cast<uint16_t>(crc << 1);
+    }
+  }
+
+  return crc;
+}
+
+uint8_t Telemetry::cobsEncode(const uint8_t* data, uint8_t length, uint8_t* encoded)
+{
+  // Each zero is replaced by the distance to the next one; the first
+  // byte is the distance to the first.  (Records are short, so no
+  // run reaches 254 bytes.)
+
+  uint8_t codeIndex = 0;
+  uint8_t out = 1;
+  uint8_t code = 1;
+
+  for ( uint8_t index = 0; index < length; ++index )
+  {
+    if ( data[index] == 0 )
+    {
+      encoded[codeIndex] = code;
+      codeIndex = out++;
+      code = 1;
+    }
+    else
+    {
+      encoded[out++] = data[index];
+      ++code;
+    }
+  }
+
+  encoded[codeIndex] = code;
+
+  return out;
+}
+
+int Telemetry::cobsDecode(const uint8_t* encoded, uint8_t length, uint8_t* data)
+{
+  uint8_t in = 0;
+  int out = 0;
+
+  while ( in < length )
+  {
+    uint8_t code = encoded[in++];
+
+    if ( (code == 0) || (in + code - 1 > length) )
+    {
+      return -1;
+    }
+
+    for ( uint8_t count = 1; count < code; ++count )
+    {
+      data[out++] = encoded[in++];
+    }
+
+    // A zero between runs (not after the last, and not after a full
+    // 254 byte run).
+
+    if ( (in < length) && (code < 0xFF) )
+    {
+      data[out++] = 0;
+    }
+  }
+
+  return out;
+}
+
+}   // End namespace
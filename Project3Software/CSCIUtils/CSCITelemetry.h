@@ -0,0 +1,126 @@
+#ifndef INCLUDE_CSCI_TELEMETRY
+#define INCLUDE_CSCI_TELEMETRY
+
+// Telemetry class header file for binary framed sensor and state logs.
+
+#include "CSCICore.h"
+#include "CSCIColorSensor.h"
+#include "CSCIScanner.h"
+#include "CSCIOccupancyGrid.h"    // Pose2D
+
+namespace csci
+{
+
+/********************** TELEMETRY RECORDS **************************/
+// Record types.  Types from tlUser on are free for sketches.
+
+enum TelemetryType
+{
+  tlColor = 1,        // Color ratios and tape color
+  tlRange = 2,        // Range finder reading
+  tlEncoders = 3,     // Four encoder counts
+  tlState = 4,        // State machine, movement and line state
+  tlDrive = 5,        // Drive train movement and speed
+  tlBattery = 6,      // Battery voltage
+  tlPose = 7,         // Dead reckoned pose
+  tlUser = 0x80
+};
+
+// Payload layouts (little-endian, packed):
+//
+//   tlColor     clear, red, green, blue ratios (uint16, x 10000),
+//               tape color (uint8)                              9 bytes
+//   tlRange     servo angle (uint8), range in cm (uint16)       3 bytes
+//   tlEncoders  counts 1 - 4 (int32)                           16 bytes
+//   tlState     state, move state, line color, value (uint8)    4 bytes
+//   tlDrive     move state (uint8), speed fraction (uint16,
+//               x 10000)                                        3 bytes
+//   tlBattery   voltage (uint16, centivolts)                    2 bytes
+//   tlPose      x, y (int16, mm), heading (int16, milliradians,
+//               -3142 to 3142)                                  6 bytes
+
+/************************** TELEMETRY ******************************/
+// Telemetry sends records as compact binary frames instead of text,
+// so sensors and state can be logged every pass through the control
+// loop.  A record is
+//
+//   type (uint8), timestamp (uint32, micros()), payload, CRC-16
+//
+// with the CRC (CCITT, initial 0xFFFF, sent high byte first) over the
+// type, timestamp and payload.  Each record is COBS encoded, so it
+// has no zero bytes, and sent between zero bytes.  A receiver can
+// start anywhere: it drops everything up to a zero, and any frame
+// with a bad CRC (text sent through the same port, say).
+//
+// Sending never waits: if the port's transmit buffer hasn't room for
+// the whole frame, the record is dropped and counted.
+//
+// A TelemetryRegistry (CSCITelemetryRegistry.h) sends records for a
+// set of channels at their own rates.  csci_telemetry
+// (CSCIHost/TelemetryMain.cpp) turns a capture into CSV.
+
+class Telemetry
+{
+  public:
+  static const uint8_t MaxPayload = 24;
+
+  // Largest record, and largest frame (record, COBS overhead and
+  // two delimiters).
+
+  static const uint8_t MaxRecord = 1 + 4 + MaxPayload + 2;
+  static const uint8_t MaxFrame = MaxRecord + 1 + 2;
+
+  // Send to "out" (e.g. Serial).  Starts enabled.
+
+  Telemetry(Print& out);
+
+  void setEnabled(bool enabled) { m_enabled = enabled; }
+  bool isEnabled() const { return m_enabled; }
+
+  // Send a record.  Returns "false" if it was dropped (or disabled).
+
+  bool send(uint8_t type, const uint8_t* payload, uint8_t length);
+
+  bool sendColor(ColorRatios& ratios, TapeColor tapeColor);
+  bool sendRange(const ScanReading& reading);
+  bool sendEncoders(long count1, long count2, long count3, long count4);
+  bool sendState(uint8_t state, uint8_t moveState, uint8_t lineColor, uint8_t value);
+  bool sendDrive(uint8_t moveState, double speedFraction);
+  bool sendBattery(double volts);
+  bool sendPose(const Pose2D& pose);
+
+  // Returns the size of a frame with "payloadLength" bytes of payload
+  // (at most).
+
+  static uint8_t frameSize(uint8_t payloadLength) { return payloadLength + MaxFrame - MaxPayload; }
+
+  // Records sent and dropped.
+
+  uint32_t getSentCount() const { return m_sent; }
+  uint32_t getDroppedCount() const { return m_dropped; }
+
+  // CRC-16 (CCITT) of "length" bytes, continuing from "crc".
+
+  static uint16_t crc16(const uint8_t* data, uint8_t length, uint16_t crc = 0xFFFF);
+
+  // COBS encode "length" bytes into "encoded" (length + 1 bytes).
+  // Returns the encoded length.
+
+  static uint8_t cobsEncode(const uint8_t* data, uint8_t length, uint8_t* encoded);
+
+  // COBS decode a frame (without delimiters) into "data" (at most
+  // "length" - 1 bytes).  Returns the decoded length, or -1 if the
+  // frame is malformed.
+
+  static int cobsDecode(const uint8_t* encoded, uint8_t length, uint8_t* data);
+
+  protected:
+  Print&    m_out;
+  bool      m_enabled;
+  uint32_t  m_sent;
+  uint32_t  m_dropped;
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_TELEMETRY
@@ -0,0 +1,275 @@
+// TelemetryRegistry class implementation file.
+
+#include "CSCITelemetryRegistry.h"
+
+namespace csci
+{
+
+// Budget credit is kept in thousandths of a byte, so a millisecond at
+// any budget adds a whole number.  At most two of the largest frames'
+// worth is saved up, so a quiet spell can't be followed by a burst.
+
+static const uint32_t CreditScale = 1000;
+static const uint32_t MaxCredit = 2UL * Telemetry::MaxFrame * CreditScale;
+
+// Parse a decimal number (1 - 65535).  Returns 0 if it isn't one.
+
+static uint16_t parseNumber(const char* text)
+{
+  if ( text == NULL )
+  {
+    return 0;
+  }
+
+  uint32_t value = 0;
+
+  for ( ; *text != '\0'; ++text )
+  {
+    if ( (*text < '0') || (*text > '9') || ((value = value * 10 + (*text - '0')) > 0xFFFF) )
+    {
+      return 0;
+    }
+  }
+
+  return static_cast<uint16_t>(value);
+}
+
+/********************* TELEMETRY REGISTRY **************************/
+
+TelemetryRegistry::TelemetryRegistry(Telemetry& telemetry, TelemetryChannel* channels, uint8_t maxChannels)
+  : m_telemetry(telemetry),
+    m_channels(channels),
+    m_maxChannels(maxChannels),
+    m_count(0),
+    m_next(0),
+    m_budget(DefaultBudget),
+    m_credit(0),
+    m_lastRefill(0),
+    m_input()
+{
+}
+
+bool TelemetryRegistry::add(const char* name, uint8_t payloadLength, TelemetrySampler sampler,
+                            void* context, uint16_t rateHz, bool enabled)
+{
+  if ( (m_count >= m_maxChannels) || (sampler == NULL) || (payloadLength > Telemetry::MaxPayload) )
+  {
+    return false;
+  }
+
+  TelemetryChannel& channel = m_channels[m_count++];
+
+  channel.name = name;
+  channel.sampler = sampler;
+  channel.context = context;
+  channel.payloadLength = payloadLength;
+  channel.enabled = enabled;
+  channel.periodMillis = ( (rateHz > 0) && (rateHz <= 1000) ) ? 1000 / rateHz : 1000;
+  channel.lastMillis = 0;
+
+  return true;
+}
+
+TelemetryChannel* TelemetryRegistry::find(const char* name)
+{
+  for ( uint8_t index = 0; index < m_count; ++index )
+  {
+    if ( strcmp(m_channels[index].name, name) == 0 )
+    {
+      return &m_channels[index];
+    }
+  }
+
+  return NULL;
+}
+
+bool TelemetryRegistry::setEnabled(const char* name, bool enabled)
+{
+  TelemetryChannel* channel = find(name);
+
+  if ( channel == NULL )
+  {
+    return false;
+  }
+
+  channel->enabled = enabled;
+  return true;
+}
+
+bool TelemetryRegistry::setRate(const char* name, uint16_t rateHz)
+{
+  TelemetryChannel* channel = find(name);
+
+  if ( (channel == NULL) || (rateHz == 0) || (rateHz > 1000) )
+  {
+    return false;
+  }
+
+  channel->periodMillis = 1000 / rateHz;
+  return true;
+}
+
+void TelemetryRegistry::refill()
+{
+  uint32_t now = millis();
+  uint32_t elapsed = now - m_lastRefill;
+
+  m_lastRefill = now;
+
+  // (Checked first, so a long gap can't overflow the product.)
+
+  if ( elapsed >= MaxCredit )
+  {
+    m_credit = MaxCredit;
+    return;
+  }
+
+  m_credit += elapsed * m_budget;
+
+  if ( m_credit > MaxCredit )
+  {
+    m_credit = MaxCredit;
+  }
+}
+
+uint8_t TelemetryRegistry::publish()
+{
+  refill();
+
+  if ( !m_telemetry.isEnabled() || (m_count == 0) )
+  {
+    return 0;
+  }
+
+  // Channels take turns: start after the last one sent, so a fast
+  // channel can't keep a slow one waiting for budget.
+
+  uint32_t now = millis();
+  uint8_t start = ( m_next < m_count ) ? m_next : 0;
+  uint8_t sent = 0;
+
+  for ( uint8_t offset = 0; offset < m_count; ++offset )
+  {
+    uint8_t index = (start + offset) % m_count;
+    TelemetryChannel& channel = m_channels[index];
+
+    if ( !channel.enabled || (now - channel.lastMillis < channel.periodMillis) )
+    {
+      continue;
+    }
+
+    uint32_t cost = static_cast<uint32_t>(Telemetry::frameSize(channel.payloadLength)) * CreditScale;
+
+    if ( m_credit < cost )
+    {
+      // Out of budget: this channel goes first next time.
+
+      m_next = index;
+      return sent;
+    }
+
+    // A record dropped by a full port still waits its period, so a
+    // busy link isn't asked again straight away.
+
+    channel.lastMillis = now;
+
+    if ( channel.sampler(channel.context, m_telemetry) )
+    {
+      m_credit -= cost;
+      m_next = index + 1;
+      ++sent;
+    }
+  }
+
+  return sent;
+}
+
+bool TelemetryRegistry::command(const char* line, Print& reply)
+{
+  char text[CommandLine::MaxLength + 1];
+
+  strncpy(text, line, CommandLine::MaxLength);
+  text[CommandLine::MaxLength] = '\0';
+
+  char* rest = text;
+  const char* word = CommandLine::nextWord(rest);
+
+  if ( (word == NULL) || (strcmp(word, "tm") != 0) )
+  {
+    return false;
+  }
+
+  const char* verb = CommandLine::nextWord(rest);
+  const char* name = CommandLine::nextWord(rest);
+  const char* value = CommandLine::nextWord(rest);
+  bool ok = false;
+
+  if ( verb == NULL )
+  {
+    ok = false;
+  }
+  else if ( strcmp(verb, "list") == 0 )
+  {
+    for ( uint8_t index = 0; index < m_count; ++index )
+    {
+      reply.print(F("tm_channel,"));
+      reply.print(m_channels[index].name);
+      reply.print(m_channels[index].enabled ? F(",on,") : F(",off,"));
+      reply.println(1000 / m_channels[index].periodMillis);
+    }
+
+    reply.print(F("tm_budget,"));
+    reply.println(m_budget);
+    ok = true;
+  }
+  else if ( ((strcmp(verb, "on") == 0) || (strcmp(verb, "off") == 0)) && (name != NULL) )
+  {
+    bool enabled = ( verb[1] == 'n' );
+
+    if ( strcmp(name, "all") == 0 )
+    {
+      for ( uint8_t index = 0; index < m_count; ++index )
+      {
+        m_channels[index].enabled = enabled;
+      }
+
+      ok = true;
+    }
+    else
+    {
+      ok = setEnabled(name, enabled);
+    }
+  }
+  else if ( (strcmp(verb, "rate") == 0) && (name != NULL) )
+  {
+    ok = setRate(name, parseNumber(value));
+  }
+  else if ( strcmp(verb, "budget") == 0 )
+  {
+    uint16_t budget = parseNumber(name);
+
+    if ( budget > 0 )
+    {
+      setBudget(budget);
+      ok = true;
+    }
+  }
+
+  reply.println(ok ? F("tm,ok") : F("tm,error"));
+  return true;
+}
+
+void TelemetryRegistry::receive(Stream& in, Print& reply)
+{
+  const char* line;
+
+  while ( (line = m_input.read(in)) != NULL )
+  {
+    if ( !command(line, reply) )
+    {
+      reply.println(F("tm,error"));
+    }
+  }
+}
+
+}   // End namespace
@@ -0,0 +1,144 @@
+#ifndef INCLUDE_CSCI_TELEMETRY_REGISTRY
+#define INCLUDE_CSCI_TELEMETRY_REGISTRY
+
+// TelemetryRegistry class header file for rate controlled telemetry
+// channels.
+
+#include "CSCITelemetry.h"
+#include "CSCICommandLine.h"
+
+namespace csci
+{
+
+/********************* TELEMETRY CHANNEL ***************************/
+// A channel is a named signal: a sampler routine that reads it and
+// sends one Telemetry record, and how often to do so.
+
+// Read the signal and send its record.  Returns "false" if it wasn't
+// sent.
+
+typedef bool (*TelemetrySampler)(void* context, Telemetry& telemetry);
+
+struct TelemetryChannel
+{
+  const char*       name;           // String constant
+  TelemetrySampler  sampler;
+  void*             context;        // Passed to the sampler (the component)
+  uint8_t           payloadLength;  // Record payload size
+  bool              enabled;
+  uint16_t          periodMillis;   // Time between records
+  uint32_t          lastMillis;     // When last sent
+};
+
+/********************* TELEMETRY REGISTRY **************************/
+// A TelemetryRegistry publishes a set of channels, each at its own
+// rate, within a share of the serial link.  Components register the
+// signals they can supply (ColorSensor::addTelemetry(),
+// TMDriveTrain::addTelemetry(), TMSmartCar::addTelemetry()) with
+// default rates; the sketch can add its own.
+//
+// publish() is called every pass through the loop.  It sends the
+// channels that are due, taking turns, but only while the byte budget
+// (a token bucket filled at the configured bytes per second) allows,
+// so telemetry never takes more than its share of the link.  A
+// channel that has to wait is sent on a later pass.
+//
+// Channels are controlled at run time by text commands over the
+// serial line (receive()), one per line:
+//
+//   tm list                 List channels: name,on/off,rate_hz
+//   tm on NAME | all        Enable a channel (or all of them)
+//   tm off NAME | all       Disable a channel (or all of them)
+//   tm rate NAME HZ         Set a channel's rate (1 - 1000 Hz)
+//   tm budget BYTES         Set the budget (bytes per second)
+//
+// Storage for the channels is supplied by the derived class (see
+// FixedTelemetryRegistry).  Nothing is allocated from the heap.
+
+class TelemetryRegistry
+{
+  public:
+  // Default budget (bytes per second): a quarter of a 38400 baud link.
+
+  static const uint16_t DefaultBudget = 960;
+
+  // Add a channel.  "rateHz" is its default rate.  Returns "false"
+  // if the registry is full.
+
+  bool add(const char* name, uint8_t payloadLength, TelemetrySampler sampler,
+           void* context, uint16_t rateHz, bool enabled = true);
+
+  // Returns the channel called "name" (NULL if there's none).
+
+  TelemetryChannel* find(const char* name);
+
+  uint8_t getChannelCount() const { return m_count; }
+  TelemetryChannel& getChannel(uint8_t index) { return m_channels[index]; }
+
+  // Enable or disable a channel, or set its rate (1 - 1000 Hz).
+  // Returns "false" if there's no such channel (or a bad rate).
+
+  bool setEnabled(const char* name, bool enabled);
+  bool setRate(const char* name, uint16_t rateHz);
+
+  // Set the budget (bytes per second).
+
+  void setBudget(uint16_t bytesPerSecond) { m_budget = bytesPerSecond; }
+  uint16_t getBudget() const { return m_budget; }
+
+  // Send the channels that are due, within the budget.  Does nothing
+  // if the Telemetry is disabled.  Returns the number sent.
+
+  uint8_t publish();
+
+  // Run a command line.  Replies go to "reply" (ending with "tm,ok"
+  // or "tm,error").  Returns "false" if it isn't a "tm" command.
+
+  bool command(const char* line, Print& reply);
+
+  // Read command characters from "in", running each complete line.
+  // (When other commands share the link, read lines with a
+  // CommandLine and pass them to command() instead.)
+
+  void receive(Stream& in, Print& reply);
+
+  protected:
+  // Construct using the Telemetry to send with and storage for up to
+  // "maxChannels" channels.
+
+  TelemetryRegistry(Telemetry& telemetry, TelemetryChannel* channels, uint8_t maxChannels);
+
+  // Add budget for the time since the last publish().
+
+  void refill();
+
+  protected:
+  Telemetry&          m_telemetry;
+  TelemetryChannel*   m_channels;
+  uint8_t             m_maxChannels;
+  uint8_t             m_count;
+  uint8_t             m_next;         // Channel to try first next time
+  uint16_t            m_budget;       // Bytes per second
+  uint32_t            m_credit;       // Bytes that may be sent (x 1000)
+  uint32_t            m_lastRefill;   // When credit was last added
+  CommandLine         m_input;
+};
+
+/****************** FIXED TELEMETRY REGISTRY ***********************/
+// FixedTelemetryRegistry is a TelemetryRegistry that owns storage for
+// up to MaxChannels channels.
+
+template <uint8_t MaxChannels>
+class FixedTelemetryRegistry : public TelemetryRegistry
+{
+  public:
+  FixedTelemetryRegistry(Telemetry& telemetry)
+    : TelemetryRegistry(telemetry, m_channelStorage, MaxChannels) { }
+
+  protected:
+  TelemetryChannel m_channelStorage[MaxChannels];
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_TELEMETRY_REGISTRY
@@ -0,0 +1,75 @@
+// Tunable class implementation file.
+
+#include "CSCITunable.h"
+#include <string.h>
+
+namespace csci
+{
+
+/************************** TUNABLE ********************************/
+
+// Zero initialized before any constructor runs, so tunables in other
+// files can link themselves in whatever order they're constructed.
+
+Tunable* Tunable::s_first = NULL;
+
+Tunable::Tunable(const char* name, double defaultValue)
+  : m_name(name),
+    m_value(defaultValue),
+    m_default(defaultValue),
+    m_minimum(-INFINITY),
+    m_maximum(INFINITY),
+    m_next(s_first)
+{
+  s_first = this;
+}
+
+Tunable::Tunable(const char* name, double defaultValue, double minimum, double maximum)
+  : m_name(name),
+    m_value(defaultValue),
+    m_default(defaultValue),
+    m_minimum(minimum),
+    m_maximum(maximum),
+    m_next(s_first)
+{
+  s_first = this;
+}
+
+uint8_t Tunable::getId() const
+{
+  uint8_t id = 0;
+
+  for ( Tunable* tunable = s_first; tunable != this; tunable = tunable->m_next )
+  {
+    ++id;
+  }
+
+  return id;
+}
+
+Tunable* Tunable::find(const char* name)
+{
+  for ( Tunable* tunable = s_first; tunable != NULL; tunable = tunable->m_next )
+  {
+    if ( strcmp(tunable->m_name, name) == 0 )
+    {
+      return tunable;
+    }
+  }
+
+  return NULL;
+}
+
+Tunable* Tunable::findId(uint8_t id)
+{
+  Tunable* tunable = s_first;
+
+  for ( ; (tunable != NULL) && (id > 0); --id )
+  {
+    tunable = tunable->m_next;
+  }
+
+  return tunable;
+}
+
+}   // End namespace
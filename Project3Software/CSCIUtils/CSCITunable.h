@@ -0,0 +1,93 @@
+#ifndef INCLUDE_CSCI_TUNABLE
+#define INCLUDE_CSCI_TUNABLE
+
+// Tunable class header file for named sketch parameters.
+
+#include "CSCICore.h"
+
+namespace csci
+{
+
+/************************** TUNABLE ********************************/
+// A Tunable is a named double a sketch uses in place of a constant
+// (speed fractions, thresholds, search multipliers...) so tools can
+// find and change it without editing the sketch.  On the robot it
+// behaves just like a double; on the host the simulator and the
+// parameter sweep set tunables by name before setup() runs.
+//
+// Tunables must be globals: each links itself into a list when
+// constructed.  No heap is used.
+//
+//   csci::Tunable SpeedFraction("SpeedFraction", 0.27, 0.05, 1.0);
+//   ...
+//   TMSCar.setSpeedFraction(SpeedFraction);
+//
+// A tunable may have bounds, which a ParameterServer (see
+// CSCIParameters.h) checks before changing it over the serial link.
+// Each also has an ID, its position in the list, which is the same
+// for every run of the same sketch build.
+
+class Tunable
+{
+  public:
+  // "name" must be a string constant.  Without bounds, any value is
+  // valid.
+
+  Tunable(const char* name, double defaultValue);
+  Tunable(const char* name, double defaultValue, double minimum, double maximum);
+
+  // Use as a double.
+
+  operator double() const { return m_value; }
+
+  Tunable& operator=(double value) { m_value = value; return *this; }
+
+  const char* getName() const { return m_name; }
+  double getDefault() const { return m_default; }
+  double getMinimum() const { return m_minimum; }
+  double getMaximum() const { return m_maximum; }
+
+  // Returns "true" if "value" is within the bounds.
+
+  bool isValid(double value) const { return (value >= m_minimum) && (value <= m_maximum); }
+
+  // Returns the tunable's ID.
+
+  uint8_t getId() const;
+
+  // Restore the default value.
+
+  void reset() { m_value = m_default; }
+
+  // Walk the list of tunables (in no particular order).
+  // Returns NULL at the end.
+
+  static Tunable* first() { return s_first; }
+  Tunable* next() const { return m_next; }
+
+  // Returns the tunable called "name" (NULL if there's none).
+
+  static Tunable* find(const char* name);
+
+  // Returns the tunable with ID "id" (NULL if there's none).
+
+  static Tunable* findId(uint8_t id);
+
+  private:
+  Tunable(const Tunable&);              // No copying
+  Tunable& operator=(const Tunable&);
+
+  protected:
+  const char*     m_name;
+  double          m_value;
+  double          m_default;
+  double          m_minimum;
+  double          m_maximum;
+  Tunable*        m_next;
+
+  static Tunable* s_first;
+};
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_TUNABLE
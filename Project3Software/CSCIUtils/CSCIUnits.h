@@ -0,0 +1,163 @@
+#ifndef INCLUDE_CSCI_UNITS
+#define INCLUDE_CSCI_UNITS
+
+// Units and drive train kinematics header file.
+
+#include "CSCICore.h"
+
+namespace csci
+{
+
+/**************************** UNITS ********************************/
+// A Quantity<Unit> is a double tagged with its unit, so millimeters
+// can't be passed where inches (or wheel degrees...) are expected:
+// the mistake is a compile error, and it costs nothing at run time.
+// Quantities of the same unit add, subtract and compare; scaling by a
+// plain number keeps the unit, and dividing two gives a plain ratio.
+//
+//   csci::Inches lineWidth(0.75);
+//   csci::Millimeters width = csci::toMillimeters(lineWidth);
+//   double mm = width.value();
+
+template <class Unit>
+class Quantity
+{
+  public:
+  constexpr explicit Quantity(double value) : m_value(value) { }
+
+  constexpr double value() const { return m_value; }
+
+  constexpr Quantity operator+(Quantity other) const { return Quantity(m_value + other.m_value); }
+  constexpr Quantity operator-(Quantity other) const { return Quantity(m_value - other.m_value); }
+  constexpr Quantity operator-() const { return Quantity(-m_value); }
+
+  constexpr Quantity operator*(double factor) const { return Quantity(m_value * factor); }
+  constexpr Quantity operator/(double divisor) const { return Quantity(m_value / divisor); }
+  constexpr double   operator/(Quantity other) const { return m_value / other.m_value; }
+
+  constexpr bool operator==(Quantity other) const { return m_value == other.m_value; }
+  constexpr bool operator!=(Quantity other) const { return m_value != other.m_value; }
+  constexpr bool operator<(Quantity other) const { return m_value < other.m_value; }
+  constexpr bool operator>(Quantity other) const { return m_value > other.m_value; }
+  constexpr bool operator<=(Quantity other) const { return m_value <= other.m_value; }
+  constexpr bool operator>=(Quantity other) const { return m_value >= other.m_value; }
+
+  private:
+  double m_value;
+};
+
+template <class Unit>
+constexpr Quantity<Unit> operator*(double factor, Quantity<Unit> quantity)
+{
+  return quantity * factor;
+}
+
+// Units (tags only).
+
+struct MillimeterUnit { };
+struct InchUnit { };
+struct WheelDegreeUnit { };     // Wheel (motor) rotation
+struct EncoderCountUnit { };    // Motor encoder counts
+struct SpinDegreeUnit { };      // Robot rotation (spinning in place)
+
+typedef Quantity<MillimeterUnit>    Millimeters;
+typedef Quantity<InchUnit>          Inches;
+typedef Quantity<WheelDegreeUnit>   WheelDegrees;
+typedef Quantity<EncoderCountUnit>  EncoderCounts;
+typedef Quantity<SpinDegreeUnit>    SpinDegrees;
+
+static constexpr double MMPerInch = 25.4;
+
+constexpr Millimeters toMillimeters(Inches inches)
+{
+  return Millimeters(inches.value() * MMPerInch);
+}
+
+constexpr Inches toInches(Millimeters millimeters)
+{
+  return Inches(millimeters.value() * (1.0 / MMPerInch));
+}
+
+/************************* KINEMATICS ******************************/
+// Kinematics<Geometry> converts between the units of a drive train
+// with the "Geometry" given, a struct of constants:
+//
+//   struct MyGeometry
+//   {
+//     static constexpr double WheelDiameterMM = 98.0;
+//     static constexpr double WheelbaseDiagonalMM = 15.0 * 25.4;
+//     static constexpr double CountsPerRevolution = 1440.0;
+//   };
+//
+//   typedef csci::Kinematics<MyGeometry> MyKinematics;
+//
+// Each conversion factor is worked out by the compiler, so each
+// conversion is a single multiply (and converting a constant costs
+// nothing).
+//
+// Spinning in place moves the wheels round the circle of the
+// wheelbase diagonal, so 360 spin degrees is WheelbaseDiagonalMM * PI
+// of wheel travel.
+
+template <class Geometry>
+class Kinematics
+{
+  public:
+  static constexpr double DegreesPerMM = 360.0 / (Geometry::WheelDiameterMM * PI);
+  static constexpr double MMPerDegree = (Geometry::WheelDiameterMM * PI) / 360.0;
+  static constexpr double CountsPerDegree = Geometry::CountsPerRevolution / 360.0;
+  static constexpr double DegreesPerCount = 360.0 / Geometry::CountsPerRevolution;
+  static constexpr double MMPerSpinDegree = (Geometry::WheelbaseDiagonalMM * PI) / 360.0;
+  static constexpr double SpinDegreesPerMM = 360.0 / (Geometry::WheelbaseDiagonalMM * PI);
+
+  // Mecanum wheels moving diagonally, or spinning the robot, roll
+  // sqrt(2) times the distance the robot moves.
+
+  static constexpr double MecanumFactor = 1.41421356237;
+
+  static constexpr WheelDegrees toWheelDegrees(Millimeters millimeters)
+  {
+    return WheelDegrees(millimeters.value() * DegreesPerMM);
+  }
+
+  static constexpr WheelDegrees toWheelDegrees(EncoderCounts counts)
+  {
+    return WheelDegrees(counts.value() * DegreesPerCount);
+  }
+
+  static constexpr EncoderCounts toEncoderCounts(WheelDegrees degrees)
+  {
+    return EncoderCounts(degrees.value() * CountsPerDegree);
+  }
+
+  // Distance the wheel rim travels turning "degrees".
+
+  static constexpr Millimeters toMillimeters(WheelDegrees degrees)
+  {
+    return Millimeters(degrees.value() * MMPerDegree);
+  }
+
+  // Wheel travel to spin the robot "degrees".
+
+  static constexpr Millimeters toMillimeters(SpinDegrees degrees)
+  {
+    return Millimeters(degrees.value() * MMPerSpinDegree);
+  }
+
+  static constexpr SpinDegrees toSpinDegrees(Millimeters millimeters)
+  {
+    return SpinDegrees(millimeters.value() * SpinDegreesPerMM);
+  }
+};
+
+template <class Geometry> constexpr double Kinematics<Geometry>::DegreesPerMM;
+template <class Geometry> constexpr double Kinematics<Geometry>::MMPerDegree;
+template <class Geometry> constexpr double Kinematics<Geometry>::CountsPerDegree;
+template <class Geometry> constexpr double Kinematics<Geometry>::DegreesPerCount;
+template <class Geometry> constexpr double Kinematics<Geometry>::MMPerSpinDegree;
+template <class Geometry> constexpr double Kinematics<Geometry>::SpinDegreesPerMM;
+template <class Geometry> constexpr double Kinematics<Geometry>::MecanumFactor;
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_UNITS
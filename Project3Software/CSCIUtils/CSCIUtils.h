@@ -18,13 +18,29 @@
 #include "CSCIGPIO.h"
 #include "CSCIDigitalPin.h"
 #include "CSCIAnalogPin.h"
+#include "CSCIAnalogSampler.h"
 #include "CSCILed.h"
 #include "CSCISwitch.h"
+#include "CSCIButtonEvents.h"
 #include "CSCISound.h"
+#include "CSCIPattern.h"
 #include "CSCITimer.h"
 #include "CSCIColorSensor.h"
 #include "CSCIDisplays.h"
+#include "CSCIUnits.h"
 #include "CSCIDriveTrain.h"
 #include "CSCISmartCar.h"
+#include "CSCIScanner.h"
+#include "CSCIOccupancyGrid.h"
+#include "CSCIOdometry.h"
+#include "CSCIDetourPlanner.h"
+#include "CSCIStateMachine.h"
+#include "CSCIMission.h"
+#include "CSCITunable.h"
+#include "CSCICommandLine.h"
+#include "CSCIParameters.h"
+#include "CSCILoopProfiler.h"
+#include "CSCITelemetry.h"
+#include "CSCITelemetryRegistry.h"
 
 #endif    // INCLUDE_CSCI_UTILS
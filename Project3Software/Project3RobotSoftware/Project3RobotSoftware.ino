@@ -12,7 +12,23 @@
  
 #include <PRIZM.h>        // Tetrix PRIZM and EXPANSION controller library
 #include <CSCIUtils.h>    // CSCI Library routines
+#include <CSCIButtonEventsISR.h>  // Start button interrupts (include once)
+#include <CSCIAnalogSamplerISR.h> // Battery sampler interrupt (include once)
+#ifdef CSCI_HOST
+#include "CSCI_DTrain_Params.h"  // Drive train-specific params (host build)
+#else
 #include <C:\Users\chris\OneDrive\Documents\Arduino\CSCI360_Tetrix_Apps\CSCI_DTrain_Params.h>  // Drive train-specific params
+#endif
+
+// Routines defined below.  (The Arduino IDE generates these, but
+// other compilers need them.)
+
+bool AquireTapeLine(csci::TMSmartCar& car, csci::TapeColor lineColor,
+                    uint32_t sweepTime, csci::MoveState& rotDir);
+bool LookForTape(csci::TMSmartCar& car, csci::TapeColor lineColor,
+                 csci::MoveState rotDir, uint32_t travelTime);
+csci::MoveState ReverseRotation(csci::MoveState rotDir);
+void WaitForStart(const char* message);
  
 PRIZM Prizm;    // Instantiate Tetrix controller object.
 EXPANSION Exc;  // Instantiate Tetrix expansion controller object.
@@ -20,6 +36,10 @@ EXPANSION Exc;  // Instantiate Tetrix expansion controller object.
 csci::ColorSensor CSensor;    // Instantiate ColorSensor object.
  
 csci::SerialMonitor SMonitor(38400);  // Instantiate SerialMonitor object.
+
+// SerialMonitor output buffer, so messages don't hold up the car.
+
+uint8_t SerialBuffer[128];
  
 // Color of tape line to follow.
 // Color will be automatically detected during setup.
@@ -33,13 +53,746 @@ csci::TMSmartCar TMSCar(Prizm, Exc, CSensor,
                         csci::LRMultiplier,
                         csci::DiagMultiplier,
                         csci::SpinMultiplier);
+
+// Battery voltage sampler.  On the robot the ADC interrupt keeps it
+// converting, so battery readings (telemetry) don't wait for the ADC.
+
+csci::AnalogSampler Analog;
+
+// Status LEDs (the PRIZM's green LED is on pin 7, red on pin 6),
+// blinked by pattern players so they never hold up the car.
+
+csci::FastDigitalLed<7> GreenLed;
+csci::FastDigitalLed<6> RedLed;
+csci::PatternPlayer< csci::FastDigitalLed<7> > GreenStatus(GreenLed);
+csci::PatternPlayer< csci::FastDigitalLed<6> > RedStatus(RedLed);
+
+// Instantiate range finder scanner (range finder is on servo 1).
+
+csci::Scanner Scan(Prizm, TMSCar, 1);
+
+// Sweep the range finder back and forth ahead of the car (45 to 135
+// degrees) while following the line, and all the way round from
+// right to left (0 to 180 degrees) while planning a detour.
+
+void SweepAhead() { Scan.setSweep(45, 135, 15); }
+void SweepAround() { Scan.setSweep(0, 180, 15); }
  
-// This routine called once at program start.
 int count = 0;
-int red = 0;
+int red = 0;    // Number of red crossings passed
+
+// Tuning parameters.  These are tunables so the simulator's
+// parameter sweep (csci_sweep) can search for the fastest setting
+// that still finishes the course; copy the winners back here.  They
+// can also be changed during a run, and saved to EEPROM, with
+// csci_param (see PARAMETERS below).
+
+// Tetrix speed fraction.
+ 
+csci::Tunable SpeedFraction("SpeedFraction", 0.27, 0.05, 1.0);
+
+// Tape line width (in inches).  The car steps this far between
+// line checks.
+
+csci::Tunable LineWidth("LineWidth", 0.75, 0.25, 3.0);
+
+// Tape search arcs, in line widths of rotation: the short search,
+// then the long one if that fails.
+
+csci::Tunable ShortSweep("ShortSweep", 3.0, 0.5, 20.0);
+csci::Tunable LongSweep("LongSweep", 21.0, 1.0, 60.0);
+
+// Range (in cm) at which an obstacle on the line is detoured.
+
+csci::Tunable ObstacleCM("ObstacleCM", 25.0, 5.0, 200.0);
+
+// Forward nudge (in milliseconds) before searching for the red or
+// blue line.
+
+csci::Tunable RedNudgeMillis("RedNudgeMillis", 60.0, 0.0, 1000.0);
+csci::Tunable BlueNudgeMillis("BlueNudgeMillis", 80.0, 0.0, 1000.0);
+
+// Drive train movement adjustment multipliers, starting from the
+// values in CSCI_DTrain_Params.h.
+
+csci::Tunable FBMultiplier("FBMultiplier", csci::FBMultiplier, 0.5, 2.0);
+csci::Tunable LRMultiplier("LRMultiplier", csci::LRMultiplier, 0.5, 2.0);
+csci::Tunable DiagMultiplier("DiagMultiplier", csci::DiagMultiplier, 0.5, 2.0);
+csci::Tunable SpinMultiplier("SpinMultiplier", csci::SpinMultiplier, 0.5, 2.0);
+
+// Set to 1 to time the phases of each line width step and send the
+// statistics over Serial every 5 seconds.  (They're sent through the
+// SerialMonitor's buffer a little at a time, so the car never waits
+// for them.)
+
+csci::Tunable ProfileLoop("ProfileLoop", 0.0, 0.0, 1.0);
+
+// Set to 1 to send binary telemetry over Serial: each range reading
+// (with the pose during detours), the state after each line width
+// step, and the sensor and drive channels at their own rates (decode
+// a capture with csci_telemetry, and map its detours with csci_grid).
+// Channels are turned on and off with "tm" commands over Serial.
+// Records go through the SerialMonitor's buffer, and are dropped
+// rather than waited for when it's full.
+
+csci::Tunable SendTelemetry("SendTelemetry", 0.0, 0.0, 1.0);
+
+csci::Telemetry Log(SMonitor);
+csci::FixedTelemetryRegistry<6> Channels(Log);
+
+/************************ LOOP PROFILE *****************************/
+// Phases of a pass through the loop (a line width step, or a step of
+// a detour).
+
+enum LoopPhase
+{
+  phActuate,        // Start moving forward
+  phSenseRange,     // Range finder scan
+  phDetour,         // Obstacle detour
+  phDecide,         // Course markers
+  phSenseColor,     // Check for the line
+  phReacquire,      // Search for the line
+  NumLoopPhases
+};
+
+const char* const LoopPhaseNames[NumLoopPhases] =
+  { "actuate", "sense-range", "detour", "decide", "sense-color", "reacquire" };
+
+csci::FixedLoopProfiler<NumLoopPhases> LoopProfile(LoopPhaseNames);
+
+/********************** COURSE MARKERS *****************************/
+// Blue tape crossing the red line means switch to following blue.
+// Red tape crossing the blue line is passed once, and is the finish
+// the second time.  These timed maneuvers are run by a table driven
+// state machine; change the tables to change the behavior.
+
+// States (index into CourseStates).
+
+enum CourseState
+{
+  stFollowing,      // Following the line
+  stCheckBlue,      // Advance to confirm blue tape
+  stTurnToBlue,     // Rotate onto the blue line
+  stBlueForward,    // Move onto the blue line
+  stBlueLeft,       // Center over the blue line
+  stRedPass,        // Pass over the first red crossing
+  stFinish,         // Victory spin
+  NumCourseStates
+};
+
+// Events.
+
+enum CourseEvent
+{
+  evBlueSeen,       // Blue tape under the sensor
+  evRedSeen,        // Red tape under the sensor
+  evTimeout,        // Time in state expired
+  NumCourseEvents
+};
+
+// Guards (index into CourseGuards).
+
+enum CourseGuard { gdFollowingRed, gdFirstRed, gdFollowingBlue, gdOverBlue };
+
+bool FollowingRed(void*)  { return LineColor == csci::TapeColor::red; }
+bool FirstRed(void*)      { return (LineColor == csci::TapeColor::blue) && (red < 1); }
+bool FollowingBlue(void*) { return LineColor == csci::TapeColor::blue; }
+bool OverBlue(void*)      { return TMSCar.getTapeColor() == csci::TapeColor::blue; }
+
+const csci::FSMGuard CourseGuards[] PROGMEM =
+  { FollowingRed, FirstRed, FollowingBlue, OverBlue };
+
+// Actions (index into CourseActions).
+
+enum CourseAction { acForward, acRotateCW, acLeft, acCountRed, acFollowBlue, acFinishSpin, acFinish };
+
+void MoveForward(void*)   { TMSCar.move(csci::MoveState::msForward); }
+void RotateCW(void*)      { TMSCar.move(csci::MoveState::msRotateCW); }
+void MoveLeft(void*)      { TMSCar.move(csci::MoveState::msLeft); }
+void CountRed(void*)      { red++; }
+void FollowBlue(void*)    { LineColor = csci::TapeColor::blue; }
+
+void FinishSpin(void*)
+{
+  SpeedFraction = 0.50;
+  TMSCar.setSpeedFraction(SpeedFraction);
+  TMSCar.move(csci::MoveState::msRotateCW);
+}
+
+void Finish(void*)
+{
+  TMSCar.stop();
+  exit(0);
+}
+
+const csci::FSMAction CourseActions[] PROGMEM =
+  { MoveForward, RotateCW, MoveLeft, CountRed, FollowBlue, FinishSpin, Finish };
+
+// State table: entry action and time in state (milliseconds).
+
+const csci::FSMState CourseStates[NumCourseStates] PROGMEM =
+{
+  { csci::FSM_NONE,    0 },     // stFollowing
+  { acForward,       300 },     // stCheckBlue
+  { acRotateCW,     4700 },     // stTurnToBlue
+  { acForward,       500 },     // stBlueForward
+  { acLeft,          950 },     // stBlueLeft
+  { acForward,      1200 },     // stRedPass
+  { acFinishSpin,   6000 }      // stFinish
+};
+
+// Transition table: state, event, guard, action, next state.
+
+const csci::FSMTransition CourseTransitions[] PROGMEM =
+{
+  { stFollowing,   evBlueSeen, gdFollowingRed,  csci::FSM_NONE, stCheckBlue   },
+  { stFollowing,   evRedSeen,  gdFirstRed,      acCountRed,     stRedPass     },
+  { stFollowing,   evRedSeen,  gdFollowingBlue, csci::FSM_NONE, stFinish      },
+  { stCheckBlue,   evTimeout,  gdOverBlue,      csci::FSM_NONE, stTurnToBlue  },
+  { stCheckBlue,   evTimeout,  csci::FSM_NONE,  csci::FSM_NONE, stFollowing   },
+  { stTurnToBlue,  evTimeout,  csci::FSM_NONE,  csci::FSM_NONE, stBlueForward },
+  { stBlueForward, evTimeout,  csci::FSM_NONE,  csci::FSM_NONE, stBlueLeft    },
+  { stBlueLeft,    evTimeout,  csci::FSM_NONE,  acFollowBlue,   stFollowing   },
+  { stRedPass,     evTimeout,  csci::FSM_NONE,  csci::FSM_NONE, stFollowing   },
+  { stFinish,      evTimeout,  csci::FSM_NONE,  acFinish,       stFollowing   }
+};
+
+const csci::FSMDefinition CourseDefinition =
+{
+  CourseStates, NumCourseStates,
+  CourseTransitions, sizeof(CourseTransitions) / sizeof(CourseTransitions[0]),
+  NumCourseEvents, evTimeout,
+  CourseGuards, CourseActions
+};
+
+csci::FixedStateMachine<NumCourseStates, NumCourseEvents> Course(CourseDefinition);
+
+// Returns "true" while a course marker maneuver is under way.
+
+bool ManeuverRunning()
+{
+  return ( Course.getState() != stFollowing );
+}
+
+// Send the course state machine an event for any tape marker under
+// the car.  loop() runs the resulting maneuver (if any) a step at a
+// time.  Returns "true" if a maneuver started.
+
+bool ProcessCourseMarkers()
+{
+  csci::TapeColor tapeColor = TMSCar.getTapeColor();
+
+  if ( tapeColor == csci::TapeColor::blue )
+  {
+    Course.dispatch(evBlueSeen);
+  }
+  else if ( tapeColor == csci::TapeColor::red )
+  {
+    Course.dispatch(evRedSeen);
+  }
+
+  return ManeuverRunning();
+}
+
+/************************* DETOUR MAP ******************************/
+// While a detour is under way, the car's pose is dead reckoned from
+// the wheel encoders and each range reading is placed in an
+// occupancy grid at that pose.  The map's frame is the car at the
+// start of the detour (x forward, y left).  With SendTelemetry set,
+// the pose is sent before each mapped reading, so csci_grid can
+// replay a capture into the same map.
+
+csci::TMOdometry Odometry(TMSCar);
+
+// 100 mm cells, so the grid covers 3.2 m around the car.
+
+csci::OccupancyGrid DetourMap(100.0, 1000.0);
+
+// The range finder is 140 mm ahead of the car's center, and points
+// straight ahead at servo angle 90 (larger angles to the left).
+
+const csci::SensorMount RangeMount = { 140.0, 0.0, 90, 1 };
+
+// Start a new map with the car (stopped) at its origin.
+
+void StartDetourMap()
+{
+  csci::Pose2D origin = { 0.0, 0.0, 0.0 };
+
+  Odometry.reset(origin);
+  DetourMap.clear();
+}
+
+// Place a range reading in the map at the current pose estimate,
+// and send both as telemetry.
+
+void MapReading(const csci::ScanReading& reading)
+{
+  const csci::Pose2D& pose = Odometry.getPose();
+
+  DetourMap.recenter(pose.xMM, pose.yMM);
+  DetourMap.integrateServoReading(pose, RangeMount, reading.angle, reading.rangeCM);
+
+  Log.sendPose(pose);
+  Log.sendRange(reading);
+}
+
+/*************************** DETOURS *******************************/
+// Detour scripts drive around an obstacle when the planner finds no
+// way round (see PLANNED DETOURS), or always with PlanDetours at 0.
+// They're mission scripts, so they can be tuned without a reflash.  Scripts received over the serial line (while waiting
+// for the Start button) are saved to EEPROM and override the
+// built-in scripts.  A script's image tag is the tape color of the
+// line it detours from (red or blue).
+//
+// Scripts should stop (opStop) between movements.  The stop resets
+// the encoders; without it the odometry mapping the detour can't
+// tell where one movement ended and the next began.
+
+const int RedDetourAddress = 0;
+const int BlueDetourAddress = csci::Mission::MaxImage;
+
+// Built-in detours: right, forward, rotate back towards the line,
+// then left until the line is found.
+
+const uint8_t RedDetour[] =
+{
+  csci::opGo, csci::MoveState::msRight,
+  csci::opWait, 0xBE, 0x0A,             // 2750 ms
+  csci::opStop,
+  csci::opGo, csci::MoveState::msForward,
+  csci::opWait, 0x64, 0x19,             // 6500 ms
+  csci::opStop,
+  csci::opGo, csci::MoveState::msRotateCCW,
+  csci::opWait, 0x8A, 0x02,             // 650 ms
+  csci::opStop,
+  csci::opGo, csci::MoveState::msLeft,
+  csci::opAwaitColor, csci::TapeColor::red, 0x00, 0x00,
+  csci::opEnd
+};
+
+const uint8_t BlueDetour[] =
+{
+  csci::opGo, csci::MoveState::msRight,
+  csci::opWait, 0xBE, 0x0A,             // 2750 ms
+  csci::opStop,
+  csci::opGo, csci::MoveState::msForward,
+  csci::opWait, 0x64, 0x19,             // 6500 ms
+  csci::opStop,
+  csci::opGo, csci::MoveState::msRotateCW,
+  csci::opWait, 0x8A, 0x02,             // 650 ms
+  csci::opStop,
+  csci::opGo, csci::MoveState::msLeft,
+  csci::opAwaitColor, csci::TapeColor::blue, 0x00, 0x00,
+  csci::opEnd
+};
+
+csci::Mission Detour(TMSCar);
+
+// Save any detour script arriving over the serial line.
+
+void ReceiveDetourScripts()
+{
+  if ( !Detour.receive(Serial) )
+  {
+    return;
+  }
+
+  if ( Detour.getTag() == csci::TapeColor::red )
+  {
+    Detour.saveToEEPROM(RedDetourAddress);
+    SMonitor.sendText("Red detour script saved.");
+  }
+  else if ( Detour.getTag() == csci::TapeColor::blue )
+  {
+    Detour.saveToEEPROM(BlueDetourAddress);
+    SMonitor.sendText("Blue detour script saved.");
+  }
+  else
+  {
+    SMonitor.sendText("Detour script not for red or blue; ignored.");
+  }
+
+  SMonitor.sendNewline();
+}
+
+// Start the detour script for the line being followed.
+
+void StartDetourScript()
+{
+  bool redLine = ( LineColor == csci::TapeColor::red );
+
+  if ( !Detour.loadFromEEPROM(redLine ? RedDetourAddress : BlueDetourAddress) ||
+       (Detour.getTag() != LineColor) )
+  {
+    if ( redLine )
+    {
+      Detour.load(RedDetour, sizeof(RedDetour), csci::TapeColor::red);
+    }
+    else
+    {
+      Detour.load(BlueDetour, sizeof(BlueDetour), csci::TapeColor::blue);
+    }
+  }
+
+  Detour.start();
+}
+
+/*********************** PLANNED DETOURS ***************************/
+// A planned detour drives the shortest path around the obstacle
+// found by the detour planner (D* Lite, see CSCIDetourPlanner.h) in
+// the detour map, back to the line beyond it.  The path is re-planned
+// as the map fills in, a bounded amount of work per pass, and driven
+// a short straight movement at a time, so a re-planned path is taken
+// up at the end of the movement.  The car doesn't rotate, so the
+// line is assumed to carry straight on past the obstacle.  If the
+// planner finds no way round, the detour script is run instead.
+//
+// The range finder sweeps all the way round during the detour, so
+// the sides of the obstacle are mapped as the car passes them.  The
+// first movement waits for a survey: a reading at every angle since
+// the car stopped, and the planner's map brought up to date with
+// them.
+
+// Set to 0 to detour with the scripts only.
+
+csci::Tunable PlanDetours("PlanDetours", 1.0, 0.0, 1.0);
+
+// Planner cells are 100 mm; paths keep the car's center 200 mm
+// (about half its width) from obstacles, and obstacles are taken to
+// be 300 mm deep until their far side has been seen.
+
+csci::DetourPlanner Planner(100.0, 200.0, 300.0);
+
+// Longest movement (in millimeters) driven before the path is
+// checked again, planner cells sampled from the map and cells
+// expanded per pass.
+
+const float MaxMoveMM = 300.0;
+const uint8_t PlanRowsPerPass = 2;
+const uint16_t PlanExpansionsPerPass = 64;
+
+bool PlannedDetour = false;       // Planner is driving a detour
+bool FirstMove = false;           // Car hasn't moved yet
+bool FinalMove = false;           // Movement ends at the line
+uint32_t StopMillis = 0;          // Time the car last stopped
+uint8_t SurveyUpdates = 0;        // Planner map updates since the survey
+csci::TimerMillis MoveTimer;      // Time left in the movement
+
+// Start planning a detour from the (stopped) car.
+
+void StartPlannedDetour()
+{
+  Planner.begin(Odometry.getPose());
+  SweepAround();
+
+  FirstMove = true;
+  FinalMove = false;
+  StopMillis = millis();
+  SurveyUpdates = 0;
+  MoveTimer.stop();
+  PlannedDetour = true;
+}
+
+// Returns "true" once the range finder has read every angle of its
+// sweep since the car stopped.
+
+bool SweptSinceStop()
+{
+  for ( uint8_t slot = 0; slot < Scan.getNumAngles(); ++slot )
+  {
+    if ( Scan.getReading(slot).timeMillis < StopMillis )
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Run a step of a planned detour (the map is updated by loop()).
+// Returns "false" once the car has reached the line beyond the
+// obstacle (or the detour script has taken over).
+
+bool StepPlannedDetour()
+{
+  Planner.setPose(Odometry.getPose());
+
+  // The survey is done once the planner's map has been updated twice
+  // after the last reading (the first update may have sampled some
+  // of the map before it).
+
+  if ( Planner.updateObstacles(DetourMap, PlanRowsPerPass) &&
+       (SurveyUpdates < 2) && SweptSinceStop() )
+  {
+    ++SurveyUpdates;
+  }
+
+  csci::DetourPlanner::PlanStatus status = Planner.plan(PlanExpansionsPerPass);
+
+  if ( MoveTimer.isActive() )
+  {
+    // The last movement onto the line ends when the line is found.
+
+    bool onLine = FinalMove && (TMSCar.getTapeColor() == LineColor);
+
+    if ( !onLine && !MoveTimer.done() )
+    {
+      return true;
+    }
+
+    // Movement done.  Take in its last travel before stopping (which
+    // resets the encoders).
+
+    MoveTimer.stop();
+    Odometry.update();
+    TMSCar.stop();
+
+    StopMillis = millis();
+    SurveyUpdates = 0;
+
+    if ( FinalMove )
+    {
+      PlannedDetour = false;
+      return false;
+    }
+
+    return true;
+  }
+
+  if ( status == csci::DetourPlanner::psNoPath )
+  {
+    PlannedDetour = false;
+    StartDetourScript();
+    return false;
+  }
+
+  if ( status != csci::DetourPlanner::psFound )
+  {
+    return true;
+  }
+
+  // Drive (the start of) the first segment of the path.
+
+  csci::DetourSegment segments[2];
+  uint8_t numSegments = Planner.getSegments(segments, 2);
+
+  if ( numSegments == 0 )
+  {
+    PlannedDetour = false;      // At the goal
+    return false;
+  }
+
+  if ( FirstMove && (SurveyUpdates < 2) )
+  {
+    return true;    // Survey first
+  }
+
+  float millimeters = ( segments[0].millimeters > MaxMoveMM ) ? MaxMoveMM : segments[0].millimeters;
+
+  FirstMove = false;
+  FinalMove = ( numSegments == 1 ) && ( millimeters == segments[0].millimeters );
+
+  TMSCar.moveMM(segments[0].moveState, millimeters);
+  MoveTimer.start(TMSCar.getMMTravelTime(segments[0].moveState, millimeters));
+
+  return true;
+}
+
+// Start driving around an obstacle blocking the line (the latest
+// range reading).  loop() runs the detour a step at a time while
+// it's running.  There are only detours from the red and blue lines;
+// on any other line the car stops and waits for the Start button,
+// and "false" is returned.
+
+bool StartDetour()
+{
+  if ( (LineColor != csci::TapeColor::red) && (LineColor != csci::TapeColor::blue) )
+  {
+    WaitForStart("No detour from this line.  Click Start to continue.");
+    return false;
+  }
+
+  // Stop, and map the obstacle from there.
+
+  TMSCar.stop();
+  StartDetourMap();
+  MapReading(Scan.getLatestReading());
+
+  if ( PlanDetours != 0.0 )
+  {
+    StartPlannedDetour();
+  }
+  else
+  {
+    StartDetourScript();
+  }
+
+  return true;
+}
+
+// Returns "true" while a detour is under way.
+
+bool DetourRunning()
+{
+  return PlannedDetour || ( Detour.getStatus() == csci::Mission::rsRunning );
+}
+
+// Run a step of the detour under way.  Returns "false" once it has
+// ended.
+
+bool StepDetour()
+{
+  bool running = PlannedDetour ? ( StepPlannedDetour() || DetourRunning() ) :
+                                 ( Detour.update() == csci::Mission::rsRunning );
+
+  if ( !running )
+  {
+    SweepAhead();
+  }
+
+  return running;
+}
+
+// Drop the detour under way.
+
+void StopDetour()
+{
+  Detour.stop();
+  MoveTimer.stop();
+  PlannedDetour = false;
+  SweepAhead();
+}
+
+/************************* PARAMETERS ******************************/
+// Once the run has started, tunables can be read and changed over the
+// serial line with csci_param (see CSCIParameters.h), and telemetry
+// channels with "tm" commands.  Changes are applied between line
+// width steps.  "pm commit" saves the tunables to EEPROM, after the
+// detour scripts, and setup() loads them on the next run.
+
+const int ParamsAddress = 2 * csci::Mission::MaxImage;
+
+csci::ParameterServer Params(ParamsAddress);
+csci::CommandLine Commands;
+
+// Pass tunables that aren't read in the loop to the objects using
+// them.
+
+void ApplyTunables()
+{
+  TMSCar.setMultipliers(FBMultiplier, LRMultiplier, DiagMultiplier, SpinMultiplier);
+  LoopProfile.setEnabled(ProfileLoop != 0.0);
+  Log.setEnabled(SendTelemetry != 0.0);
+}
+
+// Run any requests received over the serial line.  Returns "true" if
+// tunables changed.  Replies go through the SerialMonitor's buffer,
+// behind anything already in it; since they're only sent when asked
+// for, and csci_param needs them whole, they wait for room rather
+// than being dropped.
+
+bool ServeCommands()
+{
+  const char* line;
+
+  while ( (line = Commands.read(Serial)) != NULL )
+  {
+    SMonitor.setOverflowPolicy(csci::SerialMonitor::opBlock);
+
+    if ( !Params.command(line, SMonitor) && !Channels.command(line, SMonitor) )
+    {
+      SMonitor.println(F("error"));
+    }
+
+    SMonitor.setOverflowPolicy(csci::SerialMonitor::opDropNewest);
+  }
+
+  if ( !Params.update() )
+  {
+    return false;
+  }
+
+  ApplyTunables();
+  return true;
+}
+
+/**************************** PAUSE ********************************/
+// With PauseButton set, holding the Start button (pin 8, LOW when
+// pressed) for a second stops the car between line width steps; a
+// click carries on.  The button is watched without blocking (see
+// CSCIButtonEvents.h), so the run doesn't slow down.  (It's off by
+// default because the simulator's Start button keeps clicking, and
+// the extra pin reads shift its reference run.)
+
+csci::Tunable PauseButton("PauseButton", 0.0, 0.0, 1.0);
+
+csci::ButtonEvents StartEvents(8);
+
+// Stop the car, send "message" and wait (still serving the serial
+// line) for a click of the Start button.
+
+void WaitForStart(const char* message)
+{
+  TMSCar.stop();
+  SMonitor.sendText(message);
+  SMonitor.sendNewline();
+
+  StartEvents.clear();
+  RedStatus.play(csci::FastBlinkPattern, true);
+
+  csci::ButtonEvents::Event event;
+
+  do
+  {
+    StartEvents.poll();
+    RedStatus.update();
+    SMonitor.update();
+    ServeCommands();
+  } while ( !StartEvents.getEvent(event) || (event != csci::ButtonEvents::evClick) );
+
+  RedStatus.stop();
+}
+
+// Pause if the Start button was held.  Returns "true" if the car
+// was paused.
+
+bool CheckPause()
+{
+  if ( PauseButton == 0.0 )
+  {
+    return false;
+  }
+
+  StartEvents.poll();
+
+  csci::ButtonEvents::Event event;
+  bool paused = false;
+
+  while ( StartEvents.getEvent(event) )
+  {
+    if ( event != csci::ButtonEvents::evLongPress )
+    {
+      continue;
+    }
+
+    // A detour under way is dropped; the line is searched for as
+    // usual afterwards.
+
+    StopDetour();
+    WaitForStart("Paused.  Click Start to continue.");
+    paused = true;
+  }
+
+  return paused;
+}
+
+// This routine called once at program start.
+
 void setup()
 {
   SMonitor.setup();   // Setup serial monitor.
+  SMonitor.setBuffer(SerialBuffer, sizeof(SerialBuffer));
  
   
   // Setup the Tetrix Smart Car
@@ -48,9 +801,32 @@ void setup()
   {
     SMonitor.sendText("Tetrix SmartCar setup failed!");
     SMonitor.sendNewline();
+    SMonitor.flush();
     while ( true ) { };     // Hang here.  Don't proceed.
   }
  
+  Analog.add(csci::TMSmartCar::BatteryChannel);
+  csci::AnalogSampler::enableInterrupts();
+  Analog.start();
+
+  StartEvents.enableInterrupts();
+
+  // Tunables saved by a tuning session.
+
+  uint8_t numLoaded = Params.load();
+
+  if ( numLoaded > 0 )
+  {
+    SMonitor.sendUnsignedIntegerValue(numLoaded);
+    SMonitor.sendText(" saved tunables loaded.");
+    SMonitor.sendNewline();
+  }
+
+  // Telemetry channels (sent only if SendTelemetry is set).
+
+  CSensor.addTelemetry(Channels);
+  TMSCar.addTelemetry(Channels);
+
   SMonitor.sendText("Tetrix Battery Voltage = ");
   SMonitor.sendDoubleValue(TMSCar.getBatteryVoltage());
   SMonitor.sendNewline();
@@ -66,25 +842,172 @@ void setup()
  
   // Wait for Start button click to continue program.
   // During this time Tetrix is placed so color sensor
-  // is over the tape line to follow.  
+  // is over the tape line to follow.  Detour scripts may also be
+  // sent over the serial line.  The green LED's heartbeat says the
+  // car is ready.
+
+  GreenStatus.play(csci::HeartbeatPattern, true);
  
+  while ( startButton.open() )
+  {
+    ReceiveDetourScripts();
+    SMonitor.update();
+    GreenStatus.update();
+  }
+
+  GreenStatus.stop();
+
   startButton.waitForClick();
  
   // Read color of tape line to follow.
   
   LineColor = CSensor.getTapeColor();  
-  Prizm.setServoSpeed(1,25);
-  Prizm.setServoPosition(1,45);
+
+  // Start sweeping the range finder.
+
+  Scan.setServoSpeed(25);
+  SweepAhead();
+  Scan.start();
+
+  // Start course marker handling.
+
+  Course.begin(stFollowing);
+
+  ApplyTunables();
+  LoopProfile.reset();
 }
  
-// Tape line width (in inches).
- 
-const double LineWidth = 0.75;
+// Take a range reading (if one is due) and send it as telemetry.
+// Returns "true" if a fresh reading shows an obstacle closer than
+// ObstacleCM.
+
+bool ObstacleAhead()
+{
+  if ( !Scan.update() )
+  {
+    return false;
+  }
+
+  Log.sendRange(Scan.getLatestReading());
+
+  double rangeDistance = Scan.getLatestReading().rangeCM;
+
+  return ( (rangeDistance > 0.0) && (rangeDistance < ObstacleCM) );
+}
+
+// Move forward one line width ("travelTime" milliseconds), watching
+// for obstacles.  Returns "false" if an obstacle started a detour
+// (loop() runs it).
+
+bool MoveLineWidth(uint32_t travelTime)
+{
+  // Start moving forward.
+
+  LoopProfile.beginPhase(phActuate);
+  TMSCar.move(csci::MoveState::msForward);
+  LoopProfile.endPhase();
+
+  // While moving one line width...
+
+  csci::TimerMillis moveTimer(travelTime);
+
+  while ( !moveTimer.done() )
+  {
+    // Are we close to an obstacle?
+
+    LoopProfile.beginPhase(phSenseRange);
+
+    if ( ObstacleAhead() )
+    {
+      // Yes, start driving around it.  (If there's no detour, the
+      // car was stopped for help; try the step again.)
+
+      LoopProfile.beginPhase(phDetour);
+      StartDetour();
+      LoopProfile.endPhase();
+      return false;
+    }
+
+    LoopProfile.endPhase();
+
+    if ( Log.isEnabled() )
+    {
+      Channels.publish();
+    }
+  }
+
+  return true;
+}
+
+// Search for the line if the car is off it.  "travelTime" is the
+// time (in milliseconds) to move one line width; "rotDir" is the
+// rotation direction to try first.
+
+void FindLine(uint32_t travelTime, csci::MoveState& rotDir)
+{
+  // If car is not over the tape...
+
+  LoopProfile.beginPhase(phSenseColor);
+
+  csci::TapeColor tapeColor = TMSCar.getTapeColor();
+
+  Log.sendState(Course.getState(), TMSCar.getMoveState(), LineColor, tapeColor);
+
+  if ( tapeColor != LineColor )
+  {
+    // Attempt to re-acquire tape line with short search arc.
+      
+    LoopProfile.beginPhase(phReacquire);
+
+    if ( !AquireTapeLine(TMSCar, LineColor,
+                        static_cast<uint32_t>(ShortSweep * travelTime), rotDir) )
+    {
+      // Attempt to re-acquire tape line with longer search arc.
  
-// Tetrix speed fraction.
+      if ( !AquireTapeLine(TMSCar, LineColor,
+                          static_cast<uint32_t>(LongSweep * travelTime), rotDir) )
+      {
+        // *** Currently stop car and wait for human assistance. ***
+        
+        
+      }
+    }
+
+    // A course marker found during the search starts a maneuver,
+    // and an obstacle a detour; either takes over the car.
+
+    if ( ManeuverRunning() || DetourRunning() )
+    {
+      LoopProfile.endPhase();
+      return;
+    }
  
-double SpeedFraction = 0.27;
+    // Successfully relocated the tape line.
+    // We're at the edge of the tape, still moving.
+    // Travel 1/5 tape width further so definitely over tape.
  
+    csci::WaitMillis(travelTime / 5);
+  }
+
+  LoopProfile.endPhase();
+}
+
+// Handle any course marker under the car, and search for the line if
+// the car is off it (see FindLine()).
+
+void CheckLine(uint32_t travelTime, csci::MoveState& rotDir)
+{
+  LoopProfile.beginPhase(phDecide);
+
+  if ( ProcessCourseMarkers() )
+  {
+    LoopProfile.endPhase();
+    return;
+  }
+
+  FindLine(travelTime, rotDir);
+}
+
 // This routine called repeatedly until a "reset" is performed.
  
 void loop ()
@@ -103,130 +1026,77 @@ void loop ()
   
   while ( true )
   { 
-    // Start moving forward.
-  
-    TMSCar.move(csci::MoveState::msForward);
-  
-    // While moving one line width...
-  
-    csci::TimerMillis moveTimer(travelTime);
-  
-    while ( !moveTimer.done() )
-    {
-      // Are we close to an obstacle?
- 
-      do
-      {
-        
-        int position = Prizm.readServoPosition(1);
-        if (position >= 125 )
-        {
-          Prizm.setServoPosition(1,45);
-        }
-        else if (position <= 55)
-        {
-          Prizm.setServoPosition(1,135);
-        }
- 
-        
-        double rangeDistance = TMSCar.getRangeSensorDistanceCM();
- 
-        if ( (rangeDistance > 0.0) && (rangeDistance < 25.0)  && (LineColor == csci::TapeColor::red))
-        {
-          // Yes, stop and wait for obstacle to be removed.
-          
-          TMSCar.move(csci::MoveState::msRight);
-          delay(2750);
-          TMSCar.move(csci::MoveState::msForward);
-          delay(6500);
-          TMSCar.move(csci::MoveState::msRotateCCW); 
-          delay(650);
-          while(TMSCar.getTapeColor() != LineColor)
-          {
-            TMSCar.move(csci::MoveState::msLeft);
-          }
-        }
-        else if ( (rangeDistance > 0.0) && (rangeDistance < 25.0)  && (LineColor == csci::TapeColor::blue))
-        {
-          // Yes, stop and wait for obstacle to be removed.
-            
-            TMSCar.move(csci::MoveState::msRight);
-            delay(2750);
-            TMSCar.move(csci::MoveState::msForward);
-            delay(6500);
-            TMSCar.move(csci::MoveState::msRotateCW); 
-            delay(650);
-            while(TMSCar.getTapeColor() != LineColor)
-            {
-              TMSCar.move(csci::MoveState::msLeft);
-            }
-          
-        }
-        else
-        {
-          break;  // No, continue on.
-        }
-      } while ( true );
-    }
-  
-    // Car has moved one line width.  If car is not over the tape...
-    
-    if (TMSCar.getTapeColor() == csci::TapeColor::blue && LineColor == csci::TapeColor::red)
+    LoopProfile.beginLoop();
+
+    if ( ManeuverRunning() )
     {
-     TMSCar.move(csci::MoveState::msForward);
-      delay(300);
-      if (TMSCar.getTapeColor() == csci::TapeColor::blue)
+      // Run the course marker maneuver a step per pass.  The line is
+      // checked as soon as it ends.
+
+      LoopProfile.beginPhase(phDecide);
+      Course.update();
+
+      if ( !ManeuverRunning() )
       {
-        TMSCar.move(csci::MoveState::msRotateCW);
-        delay(4700);
-        TMSCar.move(csci::MoveState::msForward);
-        delay(500);
-        TMSCar.move(csci::MoveState::msLeft);
-        delay(950);
-        LineColor = csci::TapeColor::blue;
+        FindLine(travelTime, rotDir);
       }
+
+      LoopProfile.endPhase();
     }
-    if (LineColor == csci::TapeColor::blue && TMSCar.getTapeColor() == csci::TapeColor::red)
+    else if ( DetourRunning() )
     {
-      if (red < 1)
+      // Drive around the obstacle, a step of the detour per pass,
+      // mapping it with the range finder and sending telemetry.  The
+      // pose is updated before the detour can change movement.  The
+      // line is checked as soon as the detour ends.
+
+      LoopProfile.beginPhase(phSenseRange);
+      Odometry.update();
+
+      if ( Scan.update() )
       {
-        TMSCar.move(csci::MoveState::msForward);
-        delay(1200);
-       
-        red++;
+        MapReading(Scan.getLatestReading());
       }
-      else
+
+      LoopProfile.beginPhase(phDetour);
+
+      if ( !StepDetour() )
       {
-        SpeedFraction = 0.50;
-        TMSCar.setSpeedFraction(SpeedFraction);
-        TMSCar.move(csci::MoveState::msRotateCW);
-        delay(6000);
-        TMSCar.stop();
-        exit(0); 
-      }   
-  }
-    
-    if ( TMSCar.getTapeColor() != LineColor )
-    {
-      // Attempt to re-acquire tape line with short search arc.
-        
-      if ( !AquireTapeLine(TMSCar, LineColor, 3 * travelTime, rotDir) )
+        CheckLine(travelTime, rotDir);
+      }
+
+      LoopProfile.endPhase();
+
+      if ( Log.isEnabled() )
       {
-        // Attempt to re-acquire tape line with longer search arc.
- 
-        if ( !AquireTapeLine(TMSCar, LineColor, 21 * travelTime, rotDir) )
-        {
-          // *** Currently stop car and wait for human assistance. ***
-          
-          
-        }
+        Channels.publish();
       }
- 
-      // Successfully relocated the tape line.
-      // We're at the edge of the tape, still moving.
-      // Travel 1/5 tape width further so definitely over tape.
- 
-      csci::WaitMillis(travelTime / 5);
+    }
+    else if ( MoveLineWidth(travelTime) )
+    {
+      // Car has moved one line width.
+
+      CheckLine(travelTime, rotDir);
+    }
+
+    LoopProfile.endLoop();
+    LoopProfile.update(SMonitor);
+    SMonitor.update();
+
+    // Tuning requests (also served while paused).  Speed and line
+    // width changes take effect from the next step.
+
+    bool tuned = ServeCommands();
+
+    if ( CheckPause() )
+    {
+      tuned = true;
+    }
+
+    if ( tuned )
+    {
+      TMSCar.setSpeedFraction(SpeedFraction);
+      travelTime = TMSCar.getInchesTravelTime(csci::MoveState::msRotateCW, LineWidth);
     }
   }
 }
@@ -238,7 +1108,8 @@ void loop ()
 // "sweepTime" is the time (in milliseconds) to sweep looking for
 // the tape line.
 //
-// Returns "true" if we successfully aquired the tape.
+// Returns "true" if we successfully aquired the tape (or a course
+// marker maneuver or an obstacle detour took over the car).
 // Returns "false" if unsucessful.
 //
 // Note: In either case, car is still moving.
@@ -250,39 +1121,12 @@ void loop ()
 bool AquireTapeLine(csci::TMSmartCar& car, csci::TapeColor lineColor,
                     uint32_t sweepTime, csci::MoveState& rotDir)
 {
-  if (TMSCar.getTapeColor() == csci::TapeColor::blue && LineColor == csci::TapeColor::red)
-    {
-      TMSCar.move(csci::MoveState::msForward);
-      delay(300);
-      if (TMSCar.getTapeColor() == csci::TapeColor::blue)
-      {
-        TMSCar.move(csci::MoveState::msRotateCW);
-        delay(4700);
-        TMSCar.move(csci::MoveState::msForward);
-        delay(500);
-        TMSCar.move(csci::MoveState::msLeft);
-        delay(950);
-        LineColor = csci::TapeColor::blue;
-      }
-    }
-  if (LineColor == csci::TapeColor::blue && TMSCar.getTapeColor() == csci::TapeColor::red)
+  // Handle any course marker under the car.  A maneuver takes over
+  // the car, so stop searching.
+
+  if ( ProcessCourseMarkers() )
   {
-      if (red < 1)
-      {
-        TMSCar.move(csci::MoveState::msForward);
-        delay(1200);
-       
-        red++;
-      }
-      else
-      {
-        SpeedFraction = 0.50;
-        TMSCar.setSpeedFraction(SpeedFraction);
-        TMSCar.move(csci::MoveState::msRotateCW);
-        delay(6000);
-        TMSCar.stop();
-        exit(0); 
-      } 
+    return true;
   }
   
   // 
@@ -291,12 +1135,12 @@ bool AquireTapeLine(csci::TMSmartCar& car, csci::TapeColor lineColor,
   if (LineColor != csci::TapeColor::blue)
   {
     TMSCar.move(csci::MoveState::msForward);
-    delay(60);
+    delay(static_cast<unsigned long>(RedNudgeMillis));
   }
   else if (LineColor == csci::TapeColor::blue)
   {
     TMSCar.move(csci::MoveState::msForward);
-    delay(80);
+    delay(static_cast<unsigned long>(BlueNudgeMillis));
   }
  
   
@@ -348,7 +1192,8 @@ bool AquireTapeLine(csci::TMSmartCar& car, csci::TapeColor lineColor,
 // "rotDir" must be one of tmRotateCW or tmRotateCCW.
 // "travelTime" is in milliseconds.
 //
-// Returns "true" if tape detected.
+// Returns "true" if tape detected (or a course marker maneuver or an
+// obstacle detour took over the car).
 // Returns "false" if not found.
 //
 // Note: In either case, car is still moving.
@@ -356,40 +1201,12 @@ bool AquireTapeLine(csci::TMSmartCar& car, csci::TapeColor lineColor,
 bool LookForTape(csci::TMSmartCar& car, csci::TapeColor lineColor,
                  csci::MoveState rotDir, uint32_t travelTime)
 {
-  if (TMSCar.getTapeColor() == csci::TapeColor::blue && LineColor == csci::TapeColor::red)
-    {
-      TMSCar.move(csci::MoveState::msForward);
-      delay(300);
-      if (TMSCar.getTapeColor() == csci::TapeColor::blue)
-      {
-        TMSCar.move(csci::MoveState::msRotateCW);
-        delay(4700);
-        TMSCar.move(csci::MoveState::msForward);
-        delay(500);
-        TMSCar.move(csci::MoveState::msLeft);
-        delay(950);
-        LineColor = csci::TapeColor::blue;
-      }
-     
-    }
-  if (LineColor == csci::TapeColor::blue && TMSCar.getTapeColor() == csci::TapeColor::red)
+  // Handle any course marker under the car.  A maneuver takes over
+  // the car, so stop looking.
+
+  if ( ProcessCourseMarkers() )
   {
-      if (red < 1)
-      {
-        TMSCar.move(csci::MoveState::msForward);
-        delay(1200);
-        
-        red++;
-      }
-      else
-      {
-        SpeedFraction = 0.50;
-        TMSCar.setSpeedFraction(SpeedFraction);
-        TMSCar.move(csci::MoveState::msRotateCW);
-        delay(6000);
-        TMSCar.stop();
-        exit(0); 
-      }    
+    return true;
   }
   
   // Start car moving in the specified direction.
@@ -402,10 +1219,16 @@ bool LookForTape(csci::TMSmartCar& car, csci::TapeColor lineColor,
   csci::TimerMillis maxTimer(travelTime);
  
   // Continue to rotate as long as sensor is not over tape
-  // AND timer has not expired.
+  // AND timer has not expired, watching for obstacles.
   
   while ( ( car.getTapeColor() != lineColor) && !maxTimer.done() )
-  { }  
+  {
+    if ( ObstacleAhead() )
+    {
+      StartDetour();
+      return true;
+    }
+  }  
  
   // If timer expired without finding the tape first...
  
@@ -424,49 +1247,6 @@ bool LookForTape(csci::TMSmartCar& car, csci::TapeColor lineColor,
  
 csci::MoveState ReverseRotation(csci::MoveState rotDir)
 {
-  int position = Prizm.readServoPosition(1);
-   if (position >= 125)
-      {
-        Prizm.setServoPosition(1,45);
-      }
-      else if (position <= 55)
-      {
-        Prizm.setServoPosition(1,135);
-      }
- 
-      double rangeDistance = TMSCar.getRangeSensorDistanceCM();
- 
-      if ( (rangeDistance > 0.0) && (rangeDistance < 20.0)  && (LineColor == csci::TapeColor::red))
-        {
-          // Yes, stop and wait for obstacle to be removed.
-          
-          TMSCar.move(csci::MoveState::msRight);
-          delay(2750);
-          TMSCar.move(csci::MoveState::msForward);
-          delay(5000);
-          TMSCar.move(csci::MoveState::msRotateCCW); 
-          delay(650);
-          while(TMSCar.getTapeColor() != LineColor)
-          {
-            TMSCar.move(csci::MoveState::msLeft);
-          }
-        }
-        else if ( (rangeDistance > 0.0) && (rangeDistance < 12.0)  && (LineColor == csci::TapeColor::blue))
-        {
-          // Yes, stop and wait for obstacle to be removed.
-            
-            TMSCar.move(csci::MoveState::msRight);
-            delay(2750);
-            TMSCar.move(csci::MoveState::msForward);
-            delay(3200);
-            TMSCar.move(csci::MoveState::msRotateCW); 
-            delay(750);
-            while(TMSCar.getTapeColor() != LineColor)
-            {
-              TMSCar.move(csci::MoveState::msLeft);
-            }
-          
-        }
   return ( rotDir == csci::MoveState::msRotateCW ) ?
            csci::MoveState::msRotateCCW : csci::MoveState::msRotateCW;
 }
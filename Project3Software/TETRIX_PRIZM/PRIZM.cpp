@@ -19,6 +19,9 @@
 #include <Wire.h>
 #include "PRIZM.h"
 
+#define PRIZM_WIRE_SHIM
+#include "PRIZMProfiler.h"		// Opt-in I2C transaction profiling (see PRIZMProfiler.h)
+
 //#include "utility/WSWire.h" 
 
 void EXPANSION::controllerEnable(int address){
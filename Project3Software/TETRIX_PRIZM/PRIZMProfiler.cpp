@@ -0,0 +1,378 @@
+// PRIZM I2C profiler implementation file.
+
+#include "PRIZMProfiler.h"
+#include <Wire.h>
+#ifdef CSCI_HOST
+#include <CSCIHost.h>
+#endif
+
+namespace csci
+{
+
+// Zero initialized: empty and recording.
+
+I2CProfiler I2CProfile;
+ProfiledWire PRIZMWire;
+
+uint32_t profilerMicros()
+{
+#ifdef CSCI_HOST
+  return static_cast<uint32_t>(host::nowMicros());
+#else
+  return micros();
+#endif
+}
+
+/************************ COMMAND NAMES ****************************/
+// PRIZM and EXPANSION methods by the command byte they send.  DC
+// and servo controller commands don't overlap, apart from the
+// common ones (0x23 - 0x27).
+
+struct CommandName
+{
+  uint8_t first;
+  uint8_t last;
+  char    name[20];
+};
+
+static const CommandName CommandNames[] PROGMEM =
+{
+  { 0x23, 0x23, "WDT_STOP" },
+  { 0x24, 0x24, "setExpID" },
+  { 0x25, 0x25, "controllerEnable" },
+  { 0x26, 0x26, "readFirmware" },
+  { 0x27, 0x27, "controllerReset" },
+  { 0x28, 0x2D, "setServoSpeed" },
+  { 0x2E, 0x2E, "setServoSpeeds" },
+  { 0x2F, 0x34, "setServoPosition" },
+  { 0x35, 0x35, "setServoPositions" },
+  { 0x36, 0x37, "setCRServoState" },
+  { 0x38, 0x3D, "readServoPosition" },
+  { 0x40, 0x41, "setMotorPower" },
+  { 0x42, 0x42, "setMotorPowers" },
+  { 0x43, 0x44, "setMotorSpeed" },
+  { 0x45, 0x45, "setMotorSpeeds" },
+  { 0x46, 0x47, "setMotorTarget" },
+  { 0x48, 0x48, "setMotorTargets" },
+  { 0x49, 0x4A, "readEncoderCount" },
+  { 0x4C, 0x4D, "resetEncoder" },
+  { 0x4E, 0x4E, "resetEncoders" },
+  { 0x4F, 0x50, "readMotorBusy" },
+  { 0x51, 0x52, "setMotorInvert" },
+  { 0x53, 0x53, "readBatteryVoltage" },
+  { 0x54, 0x55, "readMotorCurrent" },
+  { 0x56, 0x56, "setMotorSpeedPID" },
+  { 0x57, 0x57, "setMotorTargetPID" },
+  { 0x58, 0x59, "setMotorDegree" },
+  { 0x5A, 0x5A, "setMotorDegrees" },
+  { 0x5B, 0x5C, "readEncoderDegrees" }
+};
+
+/************************** I2C PROFILER ***************************/
+
+void I2CProfiler::reset()
+{
+  m_nextRecord = 0;
+  m_recordCount = 0;
+  m_methodCount = 0;
+  m_lastMethod = 0;
+  m_transactions = 0;
+  m_busMicros = 0;
+  m_delayMillis = 0;
+}
+
+bool I2CProfiler::getRecord(uint8_t index, I2CRecord& record) const
+{
+  if ( index >= m_recordCount )
+  {
+    return false;
+  }
+
+  record = m_records[(m_nextRecord + TraceSize - m_recordCount + index) % TraceSize];
+  return true;
+}
+
+const __FlashStringHelper* I2CProfiler::commandName(uint8_t command)
+{
+  for ( uint8_t index = 0; index < sizeof(CommandNames) / sizeof(CommandNames[0]); ++index )
+  {
+    if ( (command >= pgm_read_byte(&CommandNames[index].first)) &&
+         (command <= pgm_read_byte(&CommandNames[index].last)) )
+    {
+      return reinterpret_cast<const __FlashStringHelper*>(CommandNames[index].name);
+    }
+  }
+
+  return NULL;
+}
+
+void I2CProfiler::dump(Print& out) const
+{
+  out.print(F("i2c_totals,"));
+  out.print(m_transactions);
+  out.print(',');
+  out.print(m_busMicros);
+  out.print(',');
+  out.println(m_delayMillis);
+
+  out.println(F("i2c_method,address,command,name,count,bus_us,delay_ms"));
+
+  for ( uint8_t index = 0; index < m_methodCount; ++index )
+  {
+    const I2CMethodStats& method = m_methods[index];
+    const __FlashStringHelper* name = commandName(method.command);
+
+    out.print(F("i2c_method,"));
+    out.print(method.address);
+    out.print(F(",0x"));
+    out.print(method.command, HEX);
+    out.print(',');
+    out.print(( name != NULL ) ? name : F("?"));
+    out.print(',');
+    out.print(method.count);
+    out.print(',');
+    out.print(method.busMicros);
+    out.print(',');
+    out.println(method.delayMillis);
+  }
+
+  out.println(F("i2c_trace,start_us,address,command,written,read,bus_us,delay_ms"));
+
+  I2CRecord record;
+
+  for ( uint8_t index = 0; getRecord(index, record); ++index )
+  {
+    out.print(F("i2c_trace,"));
+    out.print(record.startMicros);
+    out.print(',');
+    out.print(record.address);
+    out.print(F(",0x"));
+    out.print(record.command, HEX);
+    out.print(',');
+    out.print(record.written);
+    out.print(',');
+    out.print(record.read);
+    out.print(',');
+    out.print(record.busMicros);
+    out.print(',');
+    out.println(record.delayMillis);
+  }
+}
+
+void I2CProfiler::recordTransaction(uint8_t address, uint8_t command, uint8_t written,
+                                    uint8_t read, uint32_t startMicros, uint32_t busMicros)
+{
+  if ( m_paused )
+  {
+    return;
+  }
+
+  ++m_transactions;
+  m_busMicros += busMicros;
+
+  // Ring buffer (overwrites the oldest).
+
+  I2CRecord& record = m_records[m_nextRecord];
+
+  record.startMicros = startMicros;
+  record.busMicros = ( busMicros > 0xFFFF ) ? 0xFFFF : static_cast<uint16_t>(busMicros);
+  record.delayMillis = 0;
+  record.address = address;
+  record.command = command;
+  record.written = written;
+  record.read = read;
+
+  m_nextRecord = (m_nextRecord + 1) % TraceSize;
+
+  if ( m_recordCount < TraceSize )
+  {
+    ++m_recordCount;
+  }
+
+  // Method totals.
+
+  uint8_t index = 0;
+
+  while ( (index < m_methodCount) &&
+          ((m_methods[index].address != address) || (m_methods[index].command != command)) )
+  {
+    ++index;
+  }
+
+  if ( index == m_methodCount )
+  {
+    if ( m_methodCount == MaxMethods )
+    {
+      m_lastMethod = 0;     // Table full; only the totals count it.
+      return;
+    }
+
+    I2CMethodStats& method = m_methods[m_methodCount++];
+
+    method.address = address;
+    method.command = command;
+    method.count = 0;
+    method.busMicros = 0;
+    method.delayMillis = 0;
+  }
+
+  ++m_methods[index].count;
+  m_methods[index].busMicros += busMicros;
+  m_lastMethod = index + 1;
+}
+
+void I2CProfiler::recordDelay(unsigned long milliseconds)
+{
+  if ( m_paused || (m_recordCount == 0) )
+  {
+    return;
+  }
+
+  // Charge the delay to the last transaction.
+
+  I2CRecord& record = m_records[(m_nextRecord + TraceSize - 1) % TraceSize];
+  uint32_t delayMillis = record.delayMillis + milliseconds;
+
+  record.delayMillis = ( delayMillis > 0xFFFF ) ? 0xFFFF : static_cast<uint16_t>(delayMillis);
+  m_delayMillis += milliseconds;
+
+  if ( m_lastMethod > 0 )
+  {
+    m_methods[m_lastMethod - 1].delayMillis += milliseconds;
+  }
+}
+
+/*************************** WIRE SHIM *****************************/
+
+void ProfiledWire::begin()
+{
+  Wire.begin();
+}
+
+void ProfiledWire::beginTransmission(int address)
+{
+  m_address = static_cast<uint8_t>(address);
+  m_written = 0;
+  m_startMicros = profilerMicros();
+
+  Wire.beginTransmission(address);
+}
+
+size_t ProfiledWire::write(uint8_t value)
+{
+  if ( m_written == 0 )
+  {
+    m_command = value;
+  }
+
+  if ( m_written < BufferSize )
+  {
+    m_txData[m_written] = value;
+  }
+
+  ++m_written;
+
+  return Wire.write(value);
+}
+
+uint8_t ProfiledWire::endTransmission()
+{
+  // Wire buffers the bytes; they go out on the bus here.
+
+  uint32_t busStart = profilerMicros();
+  uint8_t status = Wire.endTransmission();
+
+  I2CProfile.recordTransaction(m_address, m_command, m_written, 0,
+                               m_startMicros, profilerMicros() - busStart);
+  recordWrite(status);
+  return status;
+}
+
+uint8_t ProfiledWire::requestFrom(int address, int quantity)
+{
+  // A read follows a command written to the same address.
+
+  uint32_t start = profilerMicros();
+  uint8_t received = Wire.requestFrom(address, quantity);
+
+  I2CProfile.recordTransaction(static_cast<uint8_t>(address), m_command, 0, received,
+                               start, profilerMicros() - start);
+
+  // Take the reply now, so it can be recorded.
+
+  m_address = static_cast<uint8_t>(address);
+  m_rxLength = 0;
+  m_rxIndex = 0;
+
+  while ( (m_rxLength < received) && (m_rxLength < BufferSize) )
+  {
+    m_rxData[m_rxLength++] = static_cast<uint8_t>(Wire.read());
+  }
+
+  recordRead(static_cast<uint8_t>(quantity));
+  return received;
+}
+
+int ProfiledWire::read()
+{
+  return ( m_rxIndex < m_rxLength ) ? m_rxData[m_rxIndex++] : Wire.read();
+}
+
+void ProfiledWire::recordWrite(uint8_t status)
+{
+  Print* out = I2CProfile.getRecorder();
+
+  if ( out != NULL )
+  {
+    out->print(F("@i2c W "));
+    sendBytes(*out, &m_address, 1);
+    out->print(' ');
+    sendBytes(*out, m_txData, ( m_written < BufferSize ) ? m_written : BufferSize);
+    out->print(' ');
+    out->println(status);
+  }
+}
+
+void ProfiledWire::recordRead(uint8_t requested)
+{
+  Print* out = I2CProfile.getRecorder();
+
+  if ( out != NULL )
+  {
+    out->print(F("@i2c R "));
+    sendBytes(*out, &m_address, 1);
+    out->print(' ');
+    sendBytes(*out, &requested, 1);
+    out->print(' ');
+    sendBytes(*out, m_rxData, m_rxLength);
+    out->println();
+  }
+}
+
+void ProfiledWire::sendBytes(Print& out, const uint8_t* data, uint8_t length)
+{
+  // Two hex digits each ("-" if none).
+
+  if ( length == 0 )
+  {
+    out.print('-');
+  }
+
+  for ( uint8_t index = 0; index < length; ++index )
+  {
+    if ( data[index] < 0x10 )
+    {
+      out.print('0');
+    }
+
+    out.print(data[index], HEX);
+  }
+}
+
+void profiledDelay(unsigned long milliseconds)
+{
+  I2CProfile.recordDelay(milliseconds);
+  delay(milliseconds);
+}
+
+}   // End namespace
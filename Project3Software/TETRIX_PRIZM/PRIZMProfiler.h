@@ -0,0 +1,204 @@
+#ifndef INCLUDE_CSCI_PRIZM_PROFILER
+#define INCLUDE_CSCI_PRIZM_PROFILER
+
+// PRIZM I2C profiler header file.
+//
+// Opt-in instrumentation of the PRIZM library's I2C traffic.  With
+// CSCI_I2C_PROFILE defined, PRIZM.cpp talks to the controllers
+// through a Wire shim that records every transaction:
+//
+//   - address and command byte (the first byte written),
+//   - bytes written or read,
+//   - start time and time on the bus,
+//   - time burned in the library's delay() after it.
+//
+// Records go to a small ring buffer (the most recent TraceSize), and
+// are totalled per (address, command), which identifies the PRIZM or
+// EXPANSION method (see commandName()).  Dump them over Serial with
+// I2CProfile.dump(Serial), or read them directly on the host.
+//
+// The profiler can also send every transaction, with the bytes
+// written and read, as it happens (I2CProfile.setRecorder(&Serial)).
+// That's a trace the host can replay the library against without the
+// robot (see CSCIHost/I2CReplay.h).  Sending slows the library down,
+// so record and profile in separate runs.
+//
+// To profile on the robot, uncomment the #define below.  On the host
+// configure with -DCSCI_I2C_PROFILE=ON.  Without it the PRIZM library
+// is unchanged and this costs nothing.
+
+// #define CSCI_I2C_PROFILE
+
+#include <Arduino.h>
+
+namespace csci
+{
+
+/************************* I2C RECORD ******************************/
+// One transaction.
+
+struct I2CRecord
+{
+  uint32_t  startMicros;      // When it started
+  uint16_t  busMicros;        // Time in endTransmission() or requestFrom()
+  uint16_t  delayMillis;      // Library delay() time after it
+  uint8_t   address;
+  uint8_t   command;          // Command byte (for reads, the one written before)
+  uint8_t   written;          // Bytes written (0 for a read)
+  uint8_t   read;             // Bytes read (0 for a write)
+};
+
+/************************ I2C METHOD STATS *************************/
+// Totals for one (address, command).
+
+struct I2CMethodStats
+{
+  uint8_t   address;
+  uint8_t   command;
+  uint16_t  count;            // Transactions
+  uint32_t  busMicros;        // Total time on the bus
+  uint32_t  delayMillis;      // Total delay() time after them
+};
+
+/************************** I2C PROFILER ***************************/
+
+class I2CProfiler
+{
+  public:
+  // Most recent transactions kept, and (address, command) pairs
+  // totalled.  RAM is plentiful on the host.
+
+#ifdef CSCI_HOST
+  static const uint8_t TraceSize = 64;
+  static const uint8_t MaxMethods = 64;
+#else
+  static const uint8_t TraceSize = 16;
+  static const uint8_t MaxMethods = 16;
+#endif
+
+  // Forget everything recorded.
+
+  void reset();
+
+  // Pause (or resume) recording.
+
+  void pause(bool paused) { m_paused = paused; }
+
+  // Send each transaction to "out" as a trace line (NULL = don't).
+
+  void setRecorder(Print* out) { m_recorder = out; }
+  Print* getRecorder() const { return m_paused ? NULL : m_recorder; }
+
+  // Ring buffer: "index" 0 is the oldest record kept.  Returns
+  // "false" if there's no such record.
+
+  uint8_t getRecordCount() const { return m_recordCount; }
+  bool getRecord(uint8_t index, I2CRecord& record) const;
+
+  // Per method totals.
+
+  uint8_t getMethodCount() const { return m_methodCount; }
+  const I2CMethodStats& getMethod(uint8_t index) const { return m_methods[index]; }
+
+  // Totals over all transactions (including any not in the method
+  // table because it was full).
+
+  uint32_t getTransactionCount() const { return m_transactions; }
+  uint32_t getBusMicros() const { return m_busMicros; }
+  uint32_t getDelayMillis() const { return m_delayMillis; }
+
+  // Returns the PRIZM method sending "command" (in PROGMEM), or
+  // NULL if unknown.
+
+  static const __FlashStringHelper* commandName(uint8_t command);
+
+  // Send the method totals and the ring buffer, as CSV.
+
+  void dump(Print& out) const;
+
+  // Called by the Wire shim.
+
+  void recordTransaction(uint8_t address, uint8_t command, uint8_t written, uint8_t read,
+                         uint32_t startMicros, uint32_t busMicros);
+  void recordDelay(unsigned long milliseconds);
+
+  // Fields are public only so the profiler needs no constructor (it
+  // starts zeroed) and costs nothing unless it's used.
+
+  public:
+  I2CRecord       m_records[TraceSize];
+  I2CMethodStats  m_methods[MaxMethods];
+  uint8_t         m_nextRecord;
+  uint8_t         m_recordCount;
+  uint8_t         m_methodCount;
+  uint8_t         m_lastMethod;       // Method of the last transaction + 1 (0 = none)
+  bool            m_paused;
+  Print*          m_recorder;
+  uint32_t        m_transactions;
+  uint32_t        m_busMicros;
+  uint32_t        m_delayMillis;
+};
+
+extern I2CProfiler I2CProfile;
+
+// Profiler time base: micros() on the robot, the virtual clock
+// (without the cost of a poll) on the host.
+
+uint32_t profilerMicros();
+
+/*************************** WIRE SHIM *****************************/
+// Stands in for Wire in PRIZM.cpp, recording each transaction.  It
+// keeps the bytes of the current transaction for the recorder (PRIZM
+// commands and replies are short).
+
+class ProfiledWire
+{
+  public:
+  static const uint8_t BufferSize = 16;
+
+  void begin();
+
+  void    beginTransmission(int address);
+  size_t  write(uint8_t value);
+  uint8_t endTransmission();
+
+  uint8_t requestFrom(int address, int quantity);
+  int     read();
+
+  protected:
+  // Send a trace line for a write or a read.
+
+  void recordWrite(uint8_t status);
+  void recordRead(uint8_t requested);
+
+  static void sendBytes(Print& out, const uint8_t* data, uint8_t length);
+
+  protected:
+  uint8_t   m_address;
+  uint8_t   m_command;
+  uint8_t   m_written;
+  uint8_t   m_txData[BufferSize];
+  uint8_t   m_rxData[BufferSize];
+  uint8_t   m_rxLength;
+  uint8_t   m_rxIndex;
+  uint32_t  m_startMicros;
+};
+
+extern ProfiledWire PRIZMWire;
+
+// Stands in for delay() in PRIZM.cpp.
+
+void profiledDelay(unsigned long milliseconds);
+
+}   // End namespace
+
+#endif    // INCLUDE_CSCI_PRIZM_PROFILER
+
+// PRIZM.cpp defines PRIZM_WIRE_SHIM before including this header, to
+// send its Wire and delay() calls through the shim.  (Outside the
+// include guard, in case it was included before.)
+
+#if defined(CSCI_I2C_PROFILE) && defined(PRIZM_WIRE_SHIM) && !defined(Wire)
+#define Wire  csci::PRIZMWire
+#define delay csci::profiledDelay
+#endif